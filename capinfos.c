@@ -57,6 +57,7 @@
 
 #include <wiretap/wtap.h>
 
+#include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/privileges.h>
@@ -72,6 +73,7 @@
 #include <wsutil/str_util.h>
 #include <wsutil/to_str.h>
 #include <wsutil/file_util.h>
+#include <wsutil/json_dumper.h>
 #include <wsutil/ws_assert.h>
 #include <wsutil/wslog.h>
 
@@ -100,6 +102,13 @@ static bool table_report_header       = true;  /* Generate column header by defa
 static char field_separator           = '\t';  /* Use TAB as field separator by default */
 static char quote_char                = '\0';  /* Do NOT quote fields by default        */
 static bool machine_readable; /* Display machine-readable numbers      */
+static bool json_report;      /* One JSON object per file instead     */
+
+/*
+ * Files are read by a pool of num_jobs threads, and reported in the order
+ * they were given on the command line.
+ */
+static unsigned num_jobs = 1;
 
 /*
  * capinfos has the ability to report on a number of
@@ -147,16 +156,13 @@ static bool cap_file_hashes    = true;  /* Calculate file hashes */
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
-
-static char file_sha256[HASH_STR_SIZE];
-static char file_sha1[HASH_STR_SIZE];
-
-static char  *hash_buf;
-static gcry_md_hd_t hd;
-
-static unsigned int num_ipv4_addresses;
-static unsigned int num_ipv6_addresses;
-static unsigned int num_decryption_secrets;
+/*
+ * The wiretap callbacks for name resolution and decryption secrets don't
+ * take user data, so they count here; each file is read by one thread.
+ */
+static WS_THREAD_LOCAL unsigned int num_ipv4_addresses;
+static WS_THREAD_LOCAL unsigned int num_ipv6_addresses;
+static WS_THREAD_LOCAL unsigned int num_decryption_secrets;
 
 /*
  * If we have at least two packets with time stamps, and they're not in
@@ -217,6 +223,12 @@ typedef struct _capture_info {
     GArray               *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
     uint32_t              pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
     GArray               *idb_info_strings;         /* array of IDB info strings */
+
+    char                  sha256[HASH_STR_SIZE];
+    char                  sha1[HASH_STR_SIZE];
+    unsigned int          num_ipv4_addresses;
+    unsigned int          num_ipv6_addresses;
+    unsigned int          num_decryption_secrets;
 } capture_info;
 
 static char *decimal_point;
@@ -591,8 +603,8 @@ print_stats(const char *filename, capture_info *cf_info)
         }
     }
     if (cap_file_hashes) {
-        printf     ("SHA256:              %s\n", file_sha256);
-        printf     ("SHA1:                %s\n", file_sha1);
+        printf     ("SHA256:              %s\n", cf_info->sha256);
+        printf     ("SHA1:                %s\n", cf_info->sha1);
     }
     if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -656,14 +668,14 @@ print_stats(const char *filename, capture_info *cf_info)
         }
 
         if (cap_file_nrb) {
-            if (num_ipv4_addresses != 0)
-                printf   ("Number of resolved IPv4 addresses in file: %u\n", num_ipv4_addresses);
-            if (num_ipv6_addresses != 0)
-                printf   ("Number of resolved IPv6 addresses in file: %u\n", num_ipv6_addresses);
+            if (cf_info->num_ipv4_addresses != 0)
+                printf   ("Number of resolved IPv4 addresses in file: %u\n", cf_info->num_ipv4_addresses);
+            if (cf_info->num_ipv6_addresses != 0)
+                printf   ("Number of resolved IPv6 addresses in file: %u\n", cf_info->num_ipv6_addresses);
         }
         if (cap_file_dsb) {
-            if (num_decryption_secrets != 0)
-                printf   ("Number of decryption secrets in file: %u\n", num_decryption_secrets);
+            if (cf_info->num_decryption_secrets != 0)
+                printf   ("Number of decryption secrets in file: %u\n", cf_info->num_decryption_secrets);
         }
     }
 }
@@ -898,12 +910,12 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_file_hashes) {
         putsep();
         putquote();
-        printf("%s", file_sha256);
+        printf("%s", cf_info->sha256);
         putquote();
 
         putsep();
         putquote();
-        printf("%s", file_sha1);
+        printf("%s", cf_info->sha1);
         putquote();
     }
 
@@ -1001,6 +1013,242 @@ print_stats_table(const char *filename, capture_info *cf_info)
     printf("\n");
 }
 
+static void
+json_time_value(json_dumper *dumper, const char *name, nstime_t *timer, capture_info *cf_info)
+{
+    char time_string_buf[39];
+
+    json_dumper_set_member_name(dumper, name);
+    if (cf_info->times_known && cf_info->packet_count > 0) {
+        display_epoch_time(time_string_buf, sizeof time_string_buf, timer, WTAP_TSPREC_NSEC);
+        json_dumper_value_anyf(dumper, "%s", time_string_buf);
+    } else {
+        json_dumper_value_anyf(dumper, "null");
+    }
+}
+
+static void
+json_rate_value(json_dumper *dumper, const char *name, double value, capture_info *cf_info)
+{
+    json_dumper_set_member_name(dumper, name);
+    if (cf_info->times_known)
+        json_dumper_value_double(dumper, value);
+    else
+        json_dumper_value_anyf(dumper, "null");
+}
+
+static void
+json_string_option(json_dumper *dumper, const char *name, wtap_block_t shb, unsigned option_id)
+{
+    char *str;
+
+    if (wtap_block_get_string_option_value(shb, option_id, &str) == WTAP_OPTTYPE_SUCCESS) {
+        json_dumper_set_member_name(dumper, name);
+        json_dumper_value_string(dumper, str);
+    }
+}
+
+/*
+ * One line with a JSON object per file. The members are those of the
+ * table report, with times as seconds since the epoch and sizes, counts
+ * and rates as plain numbers, so the output of many runs can be
+ * aggregated without parsing the human-readable formats.
+ */
+static void
+print_stats_json(const char *filename, capture_info *cf_info)
+{
+    json_dumper dumper = {
+        .output_file = stdout,
+    };
+    const char *compression_type_name;
+    pkt_cmt *p, *prev;
+
+    json_dumper_begin_object(&dumper);
+
+    json_dumper_set_member_name(&dumper, "file");
+    json_dumper_value_string(&dumper, filename);
+
+    if (cap_file_type) {
+        json_dumper_set_member_name(&dumper, "file_type");
+        json_dumper_value_string(&dumper, wtap_file_type_subtype_name(cf_info->file_type));
+        compression_type_name = wtap_compression_type_name(cf_info->compression_type);
+        if (compression_type_name != NULL) {
+            json_dumper_set_member_name(&dumper, "compression");
+            json_dumper_value_string(&dumper, compression_type_name);
+        }
+    }
+
+    if (cap_file_encap) {
+        json_dumper_set_member_name(&dumper, "encapsulation");
+        json_dumper_value_string(&dumper, wtap_encap_name(cf_info->file_encap));
+        if (cf_info->file_encap == WTAP_ENCAP_PER_PACKET) {
+            json_dumper_set_member_name(&dumper, "packet_encapsulations");
+            json_dumper_begin_object(&dumper);
+            for (int i = 0; i < WTAP_NUM_ENCAP_TYPES; i++) {
+                if (cf_info->encap_counts[i] > 0) {
+                    json_dumper_set_member_name(&dumper, wtap_encap_name(i));
+                    json_dumper_value_anyf(&dumper, "%d", cf_info->encap_counts[i]);
+                }
+            }
+            json_dumper_end_object(&dumper);
+        }
+    }
+
+    if (cap_file_more_info) {
+        json_dumper_set_member_name(&dumper, "timestamp_precision");
+        json_dumper_value_anyf(&dumper, "%d", cf_info->file_tsprec);
+    }
+
+    if (cap_snaplen) {
+        json_dumper_set_member_name(&dumper, "snaplen");
+        if (cf_info->snap_set)
+            json_dumper_value_anyf(&dumper, "%u", cf_info->snaplen);
+        else
+            json_dumper_value_anyf(&dumper, "null");
+        if (cf_info->snaplen_max_inferred > 0) {
+            json_dumper_set_member_name(&dumper, "snaplen_inferred_min");
+            json_dumper_value_anyf(&dumper, "%u", cf_info->snaplen_min_inferred);
+            json_dumper_set_member_name(&dumper, "snaplen_inferred_max");
+            json_dumper_value_anyf(&dumper, "%u", cf_info->snaplen_max_inferred);
+        }
+    }
+
+    if (cap_packet_count) {
+        json_dumper_set_member_name(&dumper, "packets");
+        json_dumper_value_anyf(&dumper, "%u", cf_info->packet_count);
+    }
+
+    if (cap_file_size) {
+        json_dumper_set_member_name(&dumper, "file_size");
+        json_dumper_value_anyf(&dumper, "%" PRId64, cf_info->filesize);
+    }
+
+    if (cap_data_size) {
+        json_dumper_set_member_name(&dumper, "data_size");
+        json_dumper_value_anyf(&dumper, "%" PRIu64, cf_info->packet_bytes);
+    }
+
+    if (cap_duration)
+        json_time_value(&dumper, "duration", &cf_info->duration, cf_info);
+    if (cap_earliest_packet_time)
+        json_time_value(&dumper, "earliest_packet_time", &cf_info->earliest_packet_time, cf_info);
+    if (cap_latest_packet_time)
+        json_time_value(&dumper, "latest_packet_time", &cf_info->latest_packet_time, cf_info);
+    if (cap_data_rate_byte)
+        json_rate_value(&dumper, "data_byte_rate", cf_info->data_rate, cf_info);
+    if (cap_data_rate_bit)
+        json_rate_value(&dumper, "data_bit_rate", cf_info->data_rate*8, cf_info);
+
+    if (cap_packet_size) {
+        json_dumper_set_member_name(&dumper, "average_packet_size");
+        json_dumper_value_double(&dumper, cf_info->packet_size);
+    }
+
+    if (cap_packet_rate)
+        json_rate_value(&dumper, "average_packet_rate", cf_info->packet_rate, cf_info);
+
+    if (cap_file_hashes) {
+        json_dumper_set_member_name(&dumper, "sha256");
+        json_dumper_value_string(&dumper, cf_info->sha256);
+        json_dumper_set_member_name(&dumper, "sha1");
+        json_dumper_value_string(&dumper, cf_info->sha1);
+    }
+
+    if (cap_order) {
+        json_dumper_set_member_name(&dumper, "strict_time_order");
+        switch (cf_info->order) {
+            case IN_ORDER:
+                json_dumper_value_anyf(&dumper, "true");
+                break;
+            case NOT_IN_ORDER:
+                json_dumper_value_anyf(&dumper, "false");
+                break;
+            default:
+                json_dumper_value_anyf(&dumper, "null");
+                break;
+        }
+    }
+
+    if (cap_file_more_info || cap_comment) {
+        json_dumper_set_member_name(&dumper, "sections");
+        json_dumper_begin_array(&dumper);
+        for (unsigned section_number = 0;
+                section_number < wtap_file_get_num_shbs(cf_info->wth);
+                section_number++) {
+            wtap_block_t shb = wtap_file_get_shb(cf_info->wth, section_number);
+
+            json_dumper_begin_object(&dumper);
+            if (shb != NULL) {
+                if (cap_file_more_info) {
+                    json_string_option(&dumper, "hardware", shb, OPT_SHB_HARDWARE);
+                    json_string_option(&dumper, "os", shb, OPT_SHB_OS);
+                    json_string_option(&dumper, "application", shb, OPT_SHB_USERAPPL);
+                }
+                if (cap_comment) {
+                    char *str;
+
+                    json_dumper_set_member_name(&dumper, "comments");
+                    json_dumper_begin_array(&dumper);
+                    for (unsigned i = 0; wtap_block_get_nth_string_option_value(shb, OPT_COMMENT, i, &str) == WTAP_OPTTYPE_SUCCESS; i++) {
+                        json_dumper_value_string(&dumper, str);
+                    }
+                    json_dumper_end_array(&dumper);
+                }
+            }
+            json_dumper_end_object(&dumper);
+        }
+        json_dumper_end_array(&dumper);
+    }
+
+    if (pkt_comments) {
+        json_dumper_set_member_name(&dumper, "packet_comments");
+        json_dumper_begin_array(&dumper);
+        for (p = cf_info->pkt_cmts; p != NULL; prev = p, p = p->next, g_free(prev)) {
+            json_dumper_begin_object(&dumper);
+            json_dumper_set_member_name(&dumper, "packet");
+            json_dumper_value_anyf(&dumper, "%d", p->recno);
+            json_dumper_set_member_name(&dumper, "comment");
+            json_dumper_value_string(&dumper, p->cmt);
+            json_dumper_end_object(&dumper);
+            g_free(p->cmt);
+        }
+        cf_info->pkt_cmts = NULL;
+        json_dumper_end_array(&dumper);
+    }
+
+    if (cap_file_idb) {
+        json_dumper_set_member_name(&dumper, "interfaces");
+        json_dumper_begin_array(&dumper);
+        for (unsigned i = 0; i < cf_info->idb_info_strings->len; i++) {
+            uint32_t packet_count = 0;
+            if (i < cf_info->interface_packet_counts->len)
+                packet_count = g_array_index(cf_info->interface_packet_counts, uint32_t, i);
+            json_dumper_begin_object(&dumper);
+            json_dumper_set_member_name(&dumper, "description");
+            json_dumper_value_string(&dumper, g_array_index(cf_info->idb_info_strings, char*, i));
+            json_dumper_set_member_name(&dumper, "packets");
+            json_dumper_value_anyf(&dumper, "%u", packet_count);
+            json_dumper_end_object(&dumper);
+        }
+        json_dumper_end_array(&dumper);
+    }
+
+    if (cap_file_nrb) {
+        json_dumper_set_member_name(&dumper, "resolved_ipv4_addresses");
+        json_dumper_value_anyf(&dumper, "%u", cf_info->num_ipv4_addresses);
+        json_dumper_set_member_name(&dumper, "resolved_ipv6_addresses");
+        json_dumper_value_anyf(&dumper, "%u", cf_info->num_ipv6_addresses);
+    }
+
+    if (cap_file_dsb) {
+        json_dumper_set_member_name(&dumper, "decryption_secrets");
+        json_dumper_value_anyf(&dumper, "%u", cf_info->num_decryption_secrets);
+    }
+
+    json_dumper_end_object(&dumper);
+    json_dumper_finish(&dumper);
+}
+
 static void
 cleanup_capture_info(capture_info *cf_info)
 {
@@ -1053,32 +1301,122 @@ hash_to_str(const unsigned char *hash, size_t length, char *str)
     }
 }
 
+/*
+ * The hashes are computed from the data the sequential reader reads from
+ * the file, so the file is read only once. Whatever the reader doesn't
+ * hand us - what was read while the file type was being determined,
+ * what it skipped by seeking, and anything after the last record - is
+ * read with a descriptor of our own.
+ */
+typedef struct {
+    const char   *filename;
+    gcry_md_hd_t  hd;
+    int64_t       hashed;   /* number of bytes hashed so far */
+    int           fd;       /* for the data the reader didn't give us */
+    char         *buf;
+    bool          failed;
+} hash_state_t;
+
 static void
-calculate_hashes(const char *filename)
+hash_init(hash_state_t *hs, const char *filename)
 {
-    FILE  *fh;
-    size_t hash_bytes;
+    hs->filename = filename;
+    hs->hashed = 0;
+    hs->fd = -1;
+    hs->buf = NULL;
+    hs->failed = false;
+    if (gcry_md_open(&hs->hd, GCRY_MD_SHA256, 0) == 0)
+        gcry_md_enable(hs->hd, GCRY_MD_SHA1);
+    else
+        hs->failed = true;
+}
 
-    (void) g_strlcpy(file_sha256, "<unknown>", HASH_STR_SIZE);
-    (void) g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
+/* Hash the file from where we are up to offset, or up to its end. */
+static void
+hash_catch_up(hash_state_t *hs, int64_t offset)
+{
+    ssize_t bytes;
+    size_t  to_read;
 
-    if (cap_file_hashes) {
-        fh = ws_fopen(filename, "rb");
-        if (fh && hd) {
-            while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
-                gcry_md_write(hd, hash_buf, hash_bytes);
-            }
-            gcry_md_final(hd);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, file_sha256);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
+    if (hs->failed)
+        return;
+
+    if (hs->fd == -1) {
+        hs->fd = ws_open(hs->filename, O_RDONLY | O_BINARY, 0000 /* no creation so don't matter */);
+        if (hs->fd == -1) {
+            hs->failed = true;
+            return;
         }
-        if (fh) fclose(fh);
-        if (hd) gcry_md_reset(hd);
+        hs->buf = (char *)g_malloc(HASH_BUF_SIZE);
+    }
+
+    if (ws_lseek64(hs->fd, hs->hashed, SEEK_SET) == -1) {
+        hs->failed = true;
+        return;
+    }
+    while (hs->hashed < offset) {
+        to_read = HASH_BUF_SIZE;
+        if (offset - hs->hashed < (int64_t)to_read)
+            to_read = (size_t)(offset - hs->hashed);
+        bytes = ws_read(hs->fd, hs->buf, to_read);
+        if (bytes < 0) {
+            hs->failed = true;
+            return;
+        }
+        if (bytes == 0)
+            break;
+        gcry_md_write(hs->hd, hs->buf, bytes);
+        hs->hashed += bytes;
+    }
+}
+
+static void
+hash_raw_read(const uint8_t *data, size_t len, int64_t offset, void *user_data)
+{
+    hash_state_t *hs = (hash_state_t *)user_data;
+    uint64_t      already_hashed;
+
+    if (hs->failed)
+        return;
+
+    if (offset > hs->hashed) {
+        hash_catch_up(hs, offset);
+        if (hs->hashed != offset)
+            hs->failed = true;
+        if (hs->failed)
+            return;
     }
+
+    /* The reader may read some data again after seeking backwards. */
+    already_hashed = (uint64_t)(hs->hashed - offset);
+    if (already_hashed >= len)
+        return;
+    gcry_md_write(hs->hd, data + already_hashed, len - (size_t)already_hashed);
+    hs->hashed += len - already_hashed;
 }
 
+static void
+hash_finish(hash_state_t *hs, capture_info *cf_info)
+{
+    hash_catch_up(hs, INT64_MAX);
+    if (!hs->failed) {
+        gcry_md_final(hs->hd);
+        hash_to_str(gcry_md_read(hs->hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, cf_info->sha256);
+        hash_to_str(gcry_md_read(hs->hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, cf_info->sha1);
+    }
+    if (hs->fd != -1)
+        ws_close(hs->fd);
+    g_free(hs->buf);
+    gcry_md_close(hs->hd);
+}
+
+/*
+ * Read a file and fill in cf_info. This runs in the worker threads, so
+ * it doesn't print anything except errors; on success, the file is left
+ * open for report_cap_file().
+ */
 static int
-process_cap_file(const char *filename, bool need_separator)
+scan_cap_file(const char *filename, capture_info *cf_info)
 {
     int                   status = 0;
     int                   err;
@@ -1092,7 +1430,7 @@ process_cap_file(const char *filename, bool need_separator)
     uint32_t              snaplen_max_inferred =          0;
     wtap_rec              rec;
     Buffer                buf;
-    capture_info          cf_info;
+    hash_state_t          hash_state;
     bool                  have_times = true;
     nstime_t              earliest_packet_time;
     int                   earliest_packet_time_tsprec;
@@ -1107,21 +1445,23 @@ process_cap_file(const char *filename, bool need_separator)
 
     pkt_cmt *pc = NULL, *prev = NULL;
 
-    cf_info.wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, false);
-    if (!cf_info.wth) {
+    cf_info->filename = filename;
+    cf_info->wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, false);
+    if (!cf_info->wth) {
         cfile_open_failure_message(filename, err, err_info);
         return 2;
     }
 
     /*
-     * Calculate the checksums. Do this after wtap_open_offline, so we don't
-     * bother calculating them for files that are not known capture types
-     * where we wouldn't print them anyway.
+     * Calculate the checksums while reading the file. Start after
+     * wtap_open_offline, so we don't bother calculating them for files
+     * that are not known capture types where we wouldn't print them anyway.
      */
-    calculate_hashes(filename);
-
-    if (need_separator && long_report) {
-        printf("\n");
+    (void) g_strlcpy(cf_info->sha256, "<unknown>", HASH_STR_SIZE);
+    (void) g_strlcpy(cf_info->sha1, "<unknown>", HASH_STR_SIZE);
+    if (cap_file_hashes) {
+        hash_init(&hash_state, filename);
+        wtap_set_cb_raw_read(cf_info->wth, hash_raw_read, &hash_state);
     }
 
     nstime_set_zero(&earliest_packet_time);
@@ -1131,17 +1471,17 @@ process_cap_file(const char *filename, bool need_separator)
     nstime_set_zero(&cur_time);
     nstime_set_zero(&prev_time);
 
-    cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+    cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
     ws_assert(idb_info->interface_data != NULL);
 
-    cf_info.pkt_cmts = NULL;
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    cf_info.interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info.num_interfaces);
-    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-    cf_info.pkt_interface_id_unknown = 0;
+    cf_info->pkt_cmts = NULL;
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    cf_info->interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info->num_interfaces);
+    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+    cf_info->pkt_interface_id_unknown = 0;
 
     g_free(idb_info);
     idb_info = NULL;
@@ -1153,14 +1493,14 @@ process_cap_file(const char *filename, bool need_separator)
 
     /* Register callbacks for new name<->address maps from the file and
        decryption secrets from the file. */
-    wtap_set_cb_new_ipv4(cf_info.wth, count_ipv4_address);
-    wtap_set_cb_new_ipv6(cf_info.wth, count_ipv6_address);
-    wtap_set_cb_new_secrets(cf_info.wth, count_decryption_secret);
+    wtap_set_cb_new_ipv4(cf_info->wth, count_ipv4_address);
+    wtap_set_cb_new_ipv6(cf_info->wth, count_ipv6_address);
+    wtap_set_cb_new_secrets(cf_info->wth, count_decryption_secret);
 
     /* Tally up data that we need to parse through the file to find */
     wtap_rec_init(&rec);
     ws_buffer_init(&buf, 1514);
-    while (wtap_read(cf_info.wth, &rec, &buf, &err, &err_info, &data_offset))  {
+    while (wtap_read(cf_info->wth, &rec, &buf, &err, &err_info, &data_offset))  {
         if (rec.presence_flags & WTAP_HAS_TS) {
             prev_time = cur_time;
             cur_time = rec.ts;
@@ -1202,7 +1542,7 @@ process_cap_file(const char *filename, bool need_separator)
                 pc->next = NULL;
 
                 if (prev == NULL)
-                  cf_info.pkt_cmts = pc;
+                  cf_info->pkt_cmts = pc;
                 else
                   prev->next = pc;
 
@@ -1223,7 +1563,7 @@ process_cap_file(const char *filename, bool need_separator)
 
             if ((rec.rec_header.packet_header.pkt_encap > 0) &&
                     (rec.rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-                cf_info.encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
+                cf_info->encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
             } else {
                 fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
                         rec.rec_header.packet_header.pkt_encap, packet, filename);
@@ -1231,37 +1571,37 @@ process_cap_file(const char *filename, bool need_separator)
 
             /* Packet interface_id info */
             if (rec.presence_flags & WTAP_HAS_INTERFACE_ID) {
-                /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-                if (rec.rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
+                /* cf_info->num_interfaces is size, not index, so it's one more than max index */
+                if (rec.rec_header.packet_header.interface_id >= cf_info->num_interfaces) {
                     /*
                      * OK, re-fetch the number of interfaces, as there might have
                      * been an interface that was in the middle of packets, and
                      * grow the array to be big enough for the new number of
                      * interfaces.
                      */
-                    idb_info = wtap_file_get_idb_info(cf_info.wth);
+                    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-                    cf_info.num_interfaces = idb_info->interface_data->len;
-                    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+                    cf_info->num_interfaces = idb_info->interface_data->len;
+                    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
 
                     g_free(idb_info);
                     idb_info = NULL;
                 }
-                if (rec.rec_header.packet_header.interface_id < cf_info.num_interfaces) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t,
+                if (rec.rec_header.packet_header.interface_id < cf_info->num_interfaces) {
+                    g_array_index(cf_info->interface_packet_counts, uint32_t,
                             rec.rec_header.packet_header.interface_id) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
             else {
                 /* it's for interface_id 0 */
-                if (cf_info.num_interfaces != 0) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t, 0) += 1;
+                if (cf_info->num_interfaces != 0) {
+                    g_array_index(cf_info->interface_packet_counts, uint32_t, 0) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
         }
@@ -1271,6 +1611,15 @@ process_cap_file(const char *filename, bool need_separator)
     wtap_rec_cleanup(&rec);
     ws_buffer_free(&buf);
 
+    if (cap_file_hashes) {
+        wtap_set_cb_raw_read(cf_info->wth, NULL, NULL);
+        hash_finish(&hash_state, cf_info);
+    }
+
+    cf_info->num_ipv4_addresses = num_ipv4_addresses;
+    cf_info->num_ipv6_addresses = num_ipv6_addresses;
+    cf_info->num_decryption_secrets = num_decryption_secrets;
+
     /*
      * Get IDB info strings.
      * We do this at the end, so we can get information for all IDBs in
@@ -1278,14 +1627,15 @@ process_cap_file(const char *filename, bool need_separator)
      * we get, for example, a count of the number of statistics entries
      * for each interface as of the *end* of the file.
      */
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-    cf_info.idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info.num_interfaces);
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    for (i = 0; i < cf_info.num_interfaces; i++) {
+    cf_info->idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info->num_interfaces);
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    for (i = 0; i < cf_info->num_interfaces; i++) {
         const wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
-        char *s = wtap_get_debug_if_descr(if_descr, 21, "\n");
-        g_array_append_val(cf_info.idb_info_strings, s);
+        /* The JSON report has no use for the long report's indentation. */
+        char *s = wtap_get_debug_if_descr(if_descr, json_report ? 0 : 21, "\n");
+        g_array_append_val(cf_info->idb_info_strings, s);
     }
 
     g_free(idb_info);
@@ -1302,92 +1652,205 @@ process_cap_file(const char *filename, bool need_separator)
             fprintf(stderr,
                     "  (will continue anyway, checksums might be incorrect)\n");
         } else {
-            cleanup_capture_info(&cf_info);
-            wtap_close(cf_info.wth);
+            cleanup_capture_info(cf_info);
+            wtap_close(cf_info->wth);
             return 2;
         }
     }
 
     /* File size */
-    size = wtap_file_size(cf_info.wth, &err);
+    size = wtap_file_size(cf_info->wth, &err);
     if (size == -1) {
         fprintf(stderr,
                 "capinfos: Can't get size of \"%s\": %s.\n",
                 filename, g_strerror(err));
-        cleanup_capture_info(&cf_info);
-        wtap_close(cf_info.wth);
+        cleanup_capture_info(cf_info);
+        wtap_close(cf_info->wth);
         return 2;
     }
 
-    cf_info.filesize = size;
+    cf_info->filesize = size;
 
     /* File Type */
-    cf_info.file_type = wtap_file_type_subtype(cf_info.wth);
-    cf_info.compression_type = wtap_get_compression_type(cf_info.wth);
+    cf_info->file_type = wtap_file_type_subtype(cf_info->wth);
+    cf_info->compression_type = wtap_get_compression_type(cf_info->wth);
 
     /* File Encapsulation */
-    cf_info.file_encap = wtap_file_encap(cf_info.wth);
+    cf_info->file_encap = wtap_file_encap(cf_info->wth);
 
-    cf_info.file_tsprec = wtap_file_tsprec(cf_info.wth);
+    cf_info->file_tsprec = wtap_file_tsprec(cf_info->wth);
 
     /* Packet size limit (snaplen) */
-    cf_info.snaplen = wtap_snapshot_length(cf_info.wth);
-    if (cf_info.snaplen > 0)
-        cf_info.snap_set = true;
+    cf_info->snaplen = wtap_snapshot_length(cf_info->wth);
+    if (cf_info->snaplen > 0)
+        cf_info->snap_set = true;
     else
-        cf_info.snap_set = false;
+        cf_info->snap_set = false;
 
-    cf_info.snaplen_min_inferred = snaplen_min_inferred;
-    cf_info.snaplen_max_inferred = snaplen_max_inferred;
+    cf_info->snaplen_min_inferred = snaplen_min_inferred;
+    cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
     /* # of packets */
-    cf_info.packet_count = packet;
+    cf_info->packet_count = packet;
 
     /* File Times */
-    cf_info.times_known = have_times;
-    cf_info.earliest_packet_time = earliest_packet_time;
-    cf_info.earliest_packet_time_tsprec = earliest_packet_time_tsprec;
-    cf_info.latest_packet_time = latest_packet_time;
-    cf_info.latest_packet_time_tsprec = latest_packet_time_tsprec;
-    nstime_delta(&cf_info.duration, &latest_packet_time, &earliest_packet_time);
+    cf_info->times_known = have_times;
+    cf_info->earliest_packet_time = earliest_packet_time;
+    cf_info->earliest_packet_time_tsprec = earliest_packet_time_tsprec;
+    cf_info->latest_packet_time = latest_packet_time;
+    cf_info->latest_packet_time_tsprec = latest_packet_time_tsprec;
+    nstime_delta(&cf_info->duration, &latest_packet_time, &earliest_packet_time);
     /* Duration precision is the higher of the earliest and latest packet timestamp precisions. */
-    if (cf_info.latest_packet_time_tsprec > cf_info.earliest_packet_time_tsprec)
-        cf_info.duration_tsprec = cf_info.latest_packet_time_tsprec;
+    if (cf_info->latest_packet_time_tsprec > cf_info->earliest_packet_time_tsprec)
+        cf_info->duration_tsprec = cf_info->latest_packet_time_tsprec;
     else
-        cf_info.duration_tsprec = cf_info.earliest_packet_time_tsprec;
-    cf_info.know_order = know_order;
-    cf_info.order = order;
+        cf_info->duration_tsprec = cf_info->earliest_packet_time_tsprec;
+    cf_info->know_order = know_order;
+    cf_info->order = order;
 
     /* Number of packet bytes */
-    cf_info.packet_bytes = bytes;
+    cf_info->packet_bytes = bytes;
 
-    cf_info.data_rate   = 0.0;
-    cf_info.packet_rate = 0.0;
-    cf_info.packet_size = 0.0;
+    cf_info->data_rate   = 0.0;
+    cf_info->packet_rate = 0.0;
+    cf_info->packet_size = 0.0;
 
     if (packet > 0) {
         double delta_time = nstime_to_sec(&latest_packet_time) - nstime_to_sec(&earliest_packet_time);
         if (delta_time > 0.0) {
-            cf_info.data_rate   = (double)bytes  / delta_time; /* Data rate per second */
-            cf_info.packet_rate = (double)packet / delta_time; /* packet rate per second */
+            cf_info->data_rate   = (double)bytes  / delta_time; /* Data rate per second */
+            cf_info->packet_rate = (double)packet / delta_time; /* packet rate per second */
         }
-        cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+        cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
     }
 
-    if (!long_report && table_report_header) {
-      print_stats_table_header(&cf_info);
-    }
+    return status;
+}
 
-    if (long_report) {
-        print_stats(filename, &cf_info);
+static void
+report_cap_file(capture_info *cf_info, bool need_separator)
+{
+    if (json_report) {
+        print_stats_json(cf_info->filename, cf_info);
     } else {
-        print_stats_table(filename, &cf_info);
+        if (need_separator && long_report) {
+            printf("\n");
+        }
+
+        if (!long_report && table_report_header) {
+          print_stats_table_header(cf_info);
+        }
+
+        if (long_report) {
+            print_stats(cf_info->filename, cf_info);
+        } else {
+            print_stats_table(cf_info->filename, cf_info);
+        }
     }
 
-    cleanup_capture_info(&cf_info);
-    wtap_close(cf_info.wth);
+    cleanup_capture_info(cf_info);
+    wtap_close(cf_info->wth);
+}
 
-    return status;
+/*
+ * With more than one job, files are read by a thread pool. At most
+ * 2 * num_jobs files are queued or waiting to be reported at any time,
+ * as each of them stays open until it's reported.
+ */
+typedef struct {
+    const char   *filename;
+    capture_info  cf_info;
+    int           status;
+    bool          done;
+} capinfos_job_t;
+
+static GMutex jobs_mtx;
+static GCond jobs_cond;
+
+static void
+scan_job(void *data, void *user_data _U_)
+{
+    capinfos_job_t *job = (capinfos_job_t *)data;
+    int status;
+
+    status = scan_cap_file(job->filename, &job->cf_info);
+
+    g_mutex_lock(&jobs_mtx);
+    job->status = status;
+    job->done = true;
+    g_cond_broadcast(&jobs_cond);
+    g_mutex_unlock(&jobs_mtx);
+}
+
+static int
+process_cap_files(char **filenames, int num_files)
+{
+    capinfos_job_t *jobs;
+    GThreadPool    *pool = NULL;
+    int             num_queued = 0;
+    int             overall_error_status = 0;
+    int             status;
+    bool            need_separator = false;
+    int             i;
+
+    jobs = g_new0(capinfos_job_t, num_files);
+    for (i = 0; i < num_files; i++) {
+        jobs[i].filename = filenames[i];
+    }
+
+    if (num_jobs > 1) {
+        pool = g_thread_pool_new(scan_job, NULL, num_jobs, true, NULL);
+    }
+
+    for (i = 0; i < num_files; i++) {
+        if (pool) {
+            while (num_queued < num_files && num_queued < i + (int)(2 * num_jobs)) {
+                g_thread_pool_push(pool, &jobs[num_queued], NULL);
+                num_queued++;
+            }
+            g_mutex_lock(&jobs_mtx);
+            while (!jobs[i].done) {
+                g_cond_wait(&jobs_cond, &jobs_mtx);
+            }
+            g_mutex_unlock(&jobs_mtx);
+        } else {
+            jobs[i].status = scan_cap_file(jobs[i].filename, &jobs[i].cf_info);
+        }
+
+        status = jobs[i].status;
+        if (status != 2) {
+            /* Either it succeeded or it got a "short read" but we print
+               information anyway. */
+            report_cap_file(&jobs[i].cf_info, need_separator);
+        }
+        if (status) {
+            /* Something failed.  It's been reported; remember that processing
+               one file failed and, if -C was specified, stop. */
+            overall_error_status = status;
+            if (stop_after_failure)
+                break;
+        }
+        if (status != 2) {
+            /* Note that we need a blank line before the next file's
+               information, to separate it from the previous file. */
+            need_separator = true;
+        }
+    }
+
+    if (pool) {
+        /* Don't start the files that are still queued, and drop the ones
+           that were read after a failure with -C. */
+        g_thread_pool_free(pool, true, true);
+        for (i++; i < num_queued; i++) {
+            if (jobs[i].done && jobs[i].status != 2) {
+                cleanup_capture_info(&jobs[i].cf_info);
+                wtap_close(jobs[i].cf_info.wth);
+            }
+        }
+    }
+    g_free(jobs);
+
+    return overall_error_status;
 }
 
 static void
@@ -1432,6 +1895,7 @@ print_usage(FILE *output)
     fprintf(output, "  -L generate long report (default)\n");
     fprintf(output, "  -T generate table report\n");
     fprintf(output, "  -M display machine-readable values in long reports\n");
+    fprintf(output, "  -J generate a JSON object per file, one per line\n");
     fprintf(output, "\n");
     fprintf(output, "Table report options:\n");
     fprintf(output, "  -R generate header record (default)\n");
@@ -1449,6 +1913,8 @@ print_usage(FILE *output)
     fprintf(output, "  -h, --help               display this help and exit\n");
     fprintf(output, "  -v, --version            display version info and exit\n");
     fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
+    fprintf(output, "  -j <jobs> read up to <jobs> files at the same time (default 1);\n");
+    fprintf(output, "            files are still reported in command line order\n");
     fprintf(output, "  -A generate all infos (default)\n");
     fprintf(output, "  -K disable displaying the capture comment\n");
     fprintf(output, "  -P disable displaying individual packet comments\n");
@@ -1497,7 +1963,6 @@ main(int argc, char *argv[])
         cfile_write_failure_message,
         cfile_close_failure_message
     };
-    bool need_separator = false;
     int    opt;
     int    overall_error_status = EXIT_SUCCESS;
     static const struct ws_option long_options[] = {
@@ -1506,8 +1971,6 @@ main(int argc, char *argv[])
         {0, 0, 0, 0 }
     };
 
-    int status = 0;
-
     /*
      * Set the C-language locale to the native environment and set the
      * code page to UTF-8 on Windows.
@@ -1560,7 +2023,7 @@ main(int argc, char *argv[])
     wtap_init(true);
 
     /* Process the options */
-    while ((opt = ws_getopt_long(argc, argv, "abcdehiklmnopqrstuvxyzABCDEFHIKLMNPQRST", long_options, NULL)) !=-1) {
+    while ((opt = ws_getopt_long(argc, argv, "abcdehij:klmnopqrstuvxyzABCDEFHIJKLMNPQRST", long_options, NULL)) !=-1) {
 
         switch (opt) {
 
@@ -1691,10 +2154,20 @@ main(int argc, char *argv[])
 
             case 'L':
                 long_report = true;
+                json_report = false;
                 break;
 
             case 'T':
                 long_report = false;
+                json_report = false;
+                break;
+
+            case 'J':
+                json_report = true;
+                break;
+
+            case 'j':
+                num_jobs = get_positive_int(ws_optarg, "number of jobs");
                 break;
 
             case 'M':
@@ -1760,37 +2233,11 @@ main(int argc, char *argv[])
 
     if (cap_file_hashes) {
         gcry_check_version(NULL);
-        gcry_md_open(&hd, GCRY_MD_SHA256, 0);
-        if (hd)
-            gcry_md_enable(hd, GCRY_MD_SHA1);
-
-        hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
     }
 
-    overall_error_status = 0;
-
-    for (opt = ws_optind; opt < argc; opt++) {
-
-        status = process_cap_file(argv[opt], need_separator);
-        if (status) {
-            /* Something failed.  It's been reported; remember that processing
-               one file failed and, if -C was specified, stop. */
-            overall_error_status = status;
-            if (stop_after_failure)
-                goto exit;
-        }
-        if (status != 2) {
-            /* Either it succeeded or it got a "short read" but printed
-               information anyway.  Note that we need a blank line before
-               the next file's information, to separate it from the
-               previous file. */
-            need_separator = true;
-        }
-    }
+    overall_error_status = process_cap_files(&argv[ws_optind], argc - ws_optind);
 
 exit:
-    g_free(hash_buf);
-    gcry_md_close(hd);
     wtap_cleanup();
     free_progdirs();
     return overall_error_status;
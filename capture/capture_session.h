@@ -63,6 +63,15 @@ typedef void (*new_packets_fn)(capture_session *cap_session, int to_read);
 typedef void (*drops_fn)(capture_session *cap_session, uint32_t dropped,
                          const char *interface_name);
 
+/**
+ * Capture child told us how full the queue of packets waiting to be
+ * written got for an interface, and how many packets it dropped because
+ * the queue was full. Those drops are also counted by drops_fn.
+ */
+typedef void (*queue_stats_fn)(capture_session *cap_session, uint32_t full_drops,
+                               uint32_t max_packets, uint64_t max_bytes,
+                               const char *interface_name);
+
 /**
  * Capture child told us that an error has occurred while starting
  * the capture.
@@ -119,6 +128,7 @@ struct _capture_session {
     new_file_fn new_file;
     new_packets_fn new_packets;
     drops_fn drops;
+    queue_stats_fn queue_stats;
     error_fn error;
     cfilter_error_fn cfilter_error;
     closed_fn closed;
@@ -127,7 +137,7 @@ struct _capture_session {
 extern void
 capture_session_init(capture_session *cap_session, capture_file *cf,
                      new_file_fn new_file, new_packets_fn new_packets,
-                     drops_fn drops, error_fn error,
+                     drops_fn drops, queue_stats_fn queue_stats, error_fn error,
                      cfilter_error_fn cfilter_error, closed_fn closed);
 
 void capture_process_finished(capture_session *cap_session);
@@ -120,7 +120,7 @@ static void (*fetch_dumpcap_pid)(ws_process_id);
 void
 capture_session_init(capture_session *cap_session, capture_file *cf,
                      new_file_fn new_file, new_packets_fn new_packets,
-                     drops_fn drops, error_fn error,
+                     drops_fn drops, queue_stats_fn queue_stats, error_fn error,
                      cfilter_error_fn cfilter_error, closed_fn closed)
 {
     cap_session->cf                              = cf;
@@ -141,6 +141,7 @@ capture_session_init(capture_session *cap_session, capture_file *cf,
     cap_session->new_file                        = new_file;
     cap_session->new_packets                     = new_packets;
     cap_session->drops                           = drops;
+    cap_session->queue_stats                     = queue_stats;
     cap_session->error                           = error;
     cap_session->cfilter_error                   = cfilter_error;
     cap_session->closed                          = closed;
@@ -2022,6 +2023,24 @@ sync_pipe_input_cb(GIOChannel *pipe_io, capture_session *cap_session)
         cap_session->drops(cap_session, num, name);
         break;
         }
+    case SP_QUEUE_STATS: {
+        /* <full drops>:<max packets>:<max bytes>:<interface name> */
+        const char *name = NULL;
+        const char *end = buffer;
+        uint32_t full_drops = 0, max_packets = 0;
+        uint64_t max_bytes = 0;
+
+        if (ws_strtou32(end, &end, &full_drops) && end[0] == ':' &&
+            ws_strtou32(end + 1, &end, &max_packets) && end[0] == ':' &&
+            ws_strtou64(end + 1, &end, &max_bytes) && end[0] == ':') {
+            name = end + 1;
+        } else {
+            ws_warning("Invalid queue statistics: %s", buffer);
+        }
+
+        cap_session->queue_stats(cap_session, full_drops, max_packets, max_bytes, name);
+        break;
+        }
     default:
         if (g_ascii_isprint(indicator))
             ws_warning("Unknown indicator '%c'", indicator);
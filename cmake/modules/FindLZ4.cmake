@@ -37,6 +37,7 @@ find_package_handle_standard_args( LZ4 DEFAULT_MSG LZ4_LIBRARY LZ4_INCLUDE_DIR )
 
 if( LZ4_FOUND )
   include( CheckIncludeFile )
+  include( CheckCSourceCompiles )
   include( CMakePushCheckState )
 
   set( LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR} )
@@ -45,6 +46,14 @@ if( LZ4_FOUND )
   cmake_push_check_state()
   set( CMAKE_REQUIRED_INCLUDES ${LZ4_INCLUDE_DIRS} )
   check_include_file( lz4frame.h HAVE_LZ4FRAME_H )
+  # Wiretap reads and writes lz4 files with the frame API of 1.7.3 and later.
+  check_c_source_compiles( "
+    #include <lz4.h>
+    #include <lz4frame.h>
+    #if LZ4_VERSION_NUMBER < 10703
+    #error lz4 is too old
+    #endif
+    int main(void) { return 0; }" HAVE_LZ4_FRAME_API )
   cmake_pop_check_state()
 
   if (WIN32)
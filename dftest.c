@@ -22,7 +22,10 @@
 #include <ws_exit_codes.h>
 
 #include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/frame_data.h>
 #include <epan/timestamp.h>
+#include <epan/tvbuff.h>
 #include <epan/prefs.h>
 #include <epan/dfilter/dfilter.h>
 #include <epan/dfilter/dfilter-macro.h>
@@ -33,6 +36,7 @@
 #include <wsutil/filesystem.h>
 #include <wsutil/privileges.h>
 #include <wsutil/report_message.h>
+#include <wsutil/time_util.h>
 #include <wsutil/wslog.h>
 #include <wsutil/ws_getopt.h>
 #include <wsutil/utf8_entities.h>
@@ -55,10 +59,27 @@ static long opt_optimize = 1;
 static int opt_show_types;
 static int opt_dump_refs;
 static int opt_dump_macros;
+static char *opt_bench_file;
+static char *opt_filters_file;
+static int opt_opcode_stats;
 
 static int64_t elapsed_expand;
 static int64_t elapsed_compile;
 
+/* A filter applied by the benchmark and its results. */
+typedef struct {
+    char      *text;
+    dfilter_t *df;
+    uint64_t   matches;
+    uint64_t   elapsed_ns;
+} bench_filter_t;
+
+/* The frames the benchmark dissection refers back to. */
+struct packet_provider_data {
+    const frame_data *ref;
+    const frame_data *prev_dis;
+};
+
 /*
  * Report an error in command-line arguments.
  */
@@ -100,6 +121,7 @@ print_usage(int status)
     FILE *fp = stdout;
     fprintf(fp, "\n");
     fprintf(fp, "Usage: dftest [OPTIONS] -- EXPRESSION\n");
+    fprintf(fp, "       dftest --bench=<file> [--filters=<file>] [OPTIONS] [-- EXPRESSION]\n");
     fprintf(fp, "Options:\n");
     fprintf(fp, "  -V, --verbose       enable verbose mode\n");
     fprintf(fp, "  -d, --debug[=N]     increase or set debug level\n");
@@ -117,6 +139,14 @@ print_usage(int status)
      * development the --refs option to dftest is useless because it will just
      * print empty reference vectors. */
     fprintf(fp, "      --refs          dump some runtime data structures\n");
+    fprintf(fp, "      --bench=<file>  apply the filters to every packet of a capture file\n");
+    fprintf(fp, "                      and report the time spent in each\n");
+    fprintf(fp, "      --filters=<file>\n");
+    fprintf(fp, "                      with --bench, also apply the filters in a file, one\n");
+    fprintf(fp, "                      per line (blank lines and lines starting with # are\n");
+    fprintf(fp, "                      ignored)\n");
+    fprintf(fp, "      --opcodes       with --bench, also count and time the instructions\n");
+    fprintf(fp, "                      executed, by opcode (slows down the filters)\n");
     fprintf(fp, "  -h, --help          display this help and exit\n");
     fprintf(fp, "  -v, --version       print version\n");
     fprintf(fp, "\n");
@@ -235,6 +265,245 @@ compile_filter(const char *text, dfilter_t **dfp)
     return ok;
 }
 
+static const nstime_t *
+bench_get_frame_ts(struct packet_provider_data *prov, uint32_t frame_num)
+{
+    if (prov->ref && prov->ref->num == frame_num)
+        return &prov->ref->abs_ts;
+    if (prov->prev_dis && prov->prev_dis->num == frame_num)
+        return &prov->prev_dis->abs_ts;
+    return NULL;
+}
+
+static bool
+bench_add_filter(GArray *filters, const char *text)
+{
+    bench_filter_t filter = { 0 };
+    char *expanded_text;
+
+    expanded_text = expand_filter(text);
+    if (expanded_text == NULL)
+        return false;
+    if (!compile_filter(expanded_text, &filter.df)) {
+        fprintf(stderr, "  in filter: %s\n", text);
+        g_free(expanded_text);
+        return false;
+    }
+    g_free(expanded_text);
+
+    if (filter.df == NULL) {
+        /* Empty filter, nothing to apply. */
+        return true;
+    }
+    if (opt_opcode_stats)
+        dfilter_enable_opcode_stats(filter.df, true);
+    filter.text = g_strdup(text);
+    g_array_append_val(filters, filter);
+    return true;
+}
+
+static bool
+bench_read_filters(GArray *filters, const char *path)
+{
+    char *contents;
+    char **lines;
+    GError *error = NULL;
+    bool ok = true;
+
+    if (!g_file_get_contents(path, &contents, NULL, &error)) {
+        fprintf(stderr, "Error: %s\n", error->message);
+        g_error_free(error);
+        return false;
+    }
+
+    lines = g_strsplit(contents, "\n", -1);
+    for (char **line = lines; *line != NULL && ok; line++) {
+        g_strstrip(*line);
+        if (**line == '\0' || **line == '#')
+            continue;
+        ok = bench_add_filter(filters, *line);
+    }
+    g_strfreev(lines);
+    g_free(contents);
+    return ok;
+}
+
+static void
+bench_free_filters(GArray *filters)
+{
+    for (unsigned i = 0; i < filters->len; i++) {
+        bench_filter_t *filter = &g_array_index(filters, bench_filter_t, i);
+        dfilter_free(filter->df);
+        g_free(filter->text);
+    }
+    g_array_free(filters, true);
+}
+
+static int
+compare_opcode_elapsed(const void *a, const void *b)
+{
+    const dfilter_opcode_stats_t *stats_a = (const dfilter_opcode_stats_t *)a;
+    const dfilter_opcode_stats_t *stats_b = (const dfilter_opcode_stats_t *)b;
+
+    if (stats_a->elapsed_ns != stats_b->elapsed_ns)
+        return stats_a->elapsed_ns < stats_b->elapsed_ns ? 1 : -1;
+    return strcmp(stats_a->opcode, stats_b->opcode);
+}
+
+/* Sums the opcode statistics of all the filters. */
+static void
+print_opcode_stats(GArray *filters)
+{
+    GArray *totals = g_array_new(false, false, sizeof(dfilter_opcode_stats_t));
+    dfilter_opcode_stats_t *total;
+    GArray *stats;
+    unsigned i, j, k;
+
+    for (i = 0; i < filters->len; i++) {
+        stats = dfilter_get_opcode_stats(g_array_index(filters, bench_filter_t, i).df);
+        for (j = 0; j < stats->len; j++) {
+            dfilter_opcode_stats_t *entry = &g_array_index(stats, dfilter_opcode_stats_t, j);
+            for (k = 0; k < totals->len; k++) {
+                total = &g_array_index(totals, dfilter_opcode_stats_t, k);
+                if (strcmp(total->opcode, entry->opcode) == 0)
+                    break;
+            }
+            if (k == totals->len) {
+                g_array_append_val(totals, *entry);
+            }
+            else {
+                total->count += entry->count;
+                total->elapsed_ns += entry->elapsed_ns;
+            }
+        }
+        g_array_free(stats, true);
+    }
+    g_array_sort(totals, compare_opcode_elapsed);
+
+    printf("\nOpcodes (all filters, including the cost of timing them):\n");
+    printf("%-24s %14s %12s %9s\n", "Opcode", "Count", "Total ms", "ns/insn");
+    for (i = 0; i < totals->len; i++) {
+        total = &g_array_index(totals, dfilter_opcode_stats_t, i);
+        printf("%-24s %14" PRIu64 " %12.3f %9" PRIu64 "\n",
+                total->opcode, total->count, total->elapsed_ns / 1e6,
+                total->elapsed_ns / total->count);
+    }
+    g_array_free(totals, true);
+}
+
+static void
+print_bench(GArray *filters, const char *path, uint32_t packets, uint64_t dissect_ns)
+{
+    printf("Capture: %s\n", path);
+    printf("Packets: %u, dissected in %.3f ms\n\n", packets, dissect_ns / 1e6);
+    printf("%10s %12s %10s  %s\n", "Matches", "Total ms", "ns/packet", "Filter");
+    for (unsigned i = 0; i < filters->len; i++) {
+        bench_filter_t *filter = &g_array_index(filters, bench_filter_t, i);
+        printf("%10" PRIu64 " %12.3f %10" PRIu64 "  %s\n",
+                filter->matches, filter->elapsed_ns / 1e6,
+                packets ? filter->elapsed_ns / packets : 0,
+                filter->text);
+    }
+
+    if (opt_opcode_stats)
+        print_opcode_stats(filters);
+}
+
+/*
+ * Read the capture file once and, for every packet, dissect it with the
+ * fields of all the filters primed and apply each filter in turn, timing
+ * only dfilter_apply_edt().
+ */
+static int
+run_bench(GArray *filters)
+{
+    static const struct packet_provider_funcs funcs = {
+        bench_get_frame_ts,
+        NULL,
+        NULL,
+        NULL
+    };
+    struct packet_provider_data provider = { 0 };
+    frame_data ref_frame, prev_dis_frame;
+    frame_data fdata;
+    nstime_t elapsed_time = NSTIME_INIT_ZERO;
+    uint32_t cum_bytes = 0;
+    uint32_t framenum = 0;
+    uint64_t dissect_ns = 0;
+    uint64_t start;
+    epan_t *session;
+    epan_dissect_t *edt;
+    wtap *wth;
+    wtap_rec rec;
+    Buffer buf;
+    int64_t data_offset;
+    int err;
+    char *err_info = NULL;
+    unsigned i;
+
+    wth = wtap_open_offline(opt_bench_file, WTAP_TYPE_AUTO, &err, &err_info, false);
+    if (wth == NULL) {
+        cfile_open_failure_message(opt_bench_file, err, err_info);
+        return WS_EXIT_INVALID_FILE;
+    }
+
+    session = epan_new(&provider, &funcs);
+    edt = epan_dissect_new(session, true, false);
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+
+    while (wtap_read(wth, &rec, &buf, &err, &err_info, &data_offset)) {
+        frame_data_init(&fdata, ++framenum, &rec, data_offset, cum_bytes);
+
+        for (i = 0; i < filters->len; i++)
+            epan_dissect_prime_with_dfilter(edt, g_array_index(filters, bench_filter_t, i).df);
+
+        frame_data_set_before_dissect(&fdata, &elapsed_time, &provider.ref, provider.prev_dis);
+        if (provider.ref == &fdata) {
+            ref_frame = fdata;
+            provider.ref = &ref_frame;
+        }
+
+        start = ws_clock_get_monotonic_ns();
+        epan_dissect_run(edt, wtap_file_type_subtype(wth), &rec,
+                tvb_new_real_data(ws_buffer_start_ptr(&buf), fdata.cap_len, fdata.pkt_len),
+                &fdata, NULL);
+        dissect_ns += ws_clock_get_monotonic_ns() - start;
+
+        for (i = 0; i < filters->len; i++) {
+            bench_filter_t *filter = &g_array_index(filters, bench_filter_t, i);
+
+            start = ws_clock_get_monotonic_ns();
+            if (dfilter_apply_edt(filter->df, edt))
+                filter->matches++;
+            filter->elapsed_ns += ws_clock_get_monotonic_ns() - start;
+        }
+
+        frame_data_set_after_dissect(&fdata, &cum_bytes);
+        prev_dis_frame = fdata;
+        provider.prev_dis = &prev_dis_frame;
+
+        epan_dissect_reset(edt);
+        frame_data_destroy(&fdata);
+        wtap_rec_reset(&rec);
+    }
+
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    epan_dissect_free(edt);
+    epan_free(session);
+    wtap_close(wth);
+
+    if (err != 0) {
+        cfile_read_failure_message(opt_bench_file, err, err_info);
+        return WS_EXIT_INVALID_FILE;
+    }
+
+    print_bench(filters, opt_bench_file, framenum, dissect_ns);
+    return 0;
+}
+
 static int
 optarg_to_digit(const char *arg)
 {
@@ -297,6 +566,9 @@ main(int argc, char **argv)
         { "optimize", ws_required_argument, 0, 1000 },
         { "types",    ws_no_argument,   0, 2000 },
         { "refs",     ws_no_argument,   0, 3000 },
+        { "bench",    ws_required_argument, 0, 4000 },
+        { "filters",  ws_required_argument, 0, 4001 },
+        { "opcodes",  ws_no_argument,   0, 4002 },
         { NULL,       0,                0,  0   }
     };
     int opt;
@@ -355,6 +627,15 @@ main(int argc, char **argv)
             case 3000:
                 opt_dump_refs = 1;
                 break;
+            case 4000:
+                opt_bench_file = ws_optarg;
+                break;
+            case 4001:
+                opt_filters_file = ws_optarg;
+                break;
+            case 4002:
+                opt_opcode_stats = 1;
+                break;
             case 'v':
                 show_version();
                 exit(EXIT_SUCCESS);
@@ -370,10 +651,15 @@ main(int argc, char **argv)
         }
     }
 
+    if (opt_filters_file && !opt_bench_file) {
+        printf("Error: --filters requires --bench.\n");
+        print_usage(WS_EXIT_INVALID_OPTION);
+    }
+
     /* Check for filter on command line. */
     if (argv[ws_optind] == NULL) {
         /* If not printing macros we need a filter expression to compile. */
-        if (!opt_dump_macros) {
+        if (!opt_dump_macros && !opt_filters_file) {
             printf("Error: Missing argument.\n");
             print_usage(EXIT_FAILURE);
         }
@@ -447,12 +733,38 @@ main(int argc, char **argv)
 
     if (opt_dump_macros) {
         print_macros();
-        if (argv[ws_optind] == NULL) {
+        if (argv[ws_optind] == NULL && !opt_filters_file) {
             /* No filter expression, we're done. */
             exit(EXIT_SUCCESS);
         }
     }
 
+    if (opt_bench_file) {
+        GArray *filters = g_array_new(false, true, sizeof(bench_filter_t));
+
+        exit_status = WS_EXIT_INVALID_FILTER;
+        if (argv[ws_optind] != NULL) {
+            text = get_args_as_string(argc, argv, ws_optind);
+            if (!bench_add_filter(filters, text)) {
+                bench_free_filters(filters);
+                goto out;
+            }
+        }
+        if (opt_filters_file && !bench_read_filters(filters, opt_filters_file)) {
+            bench_free_filters(filters);
+            goto out;
+        }
+        if (filters->len == 0) {
+            printf("Error: No filters to apply.\n");
+            bench_free_filters(filters);
+            goto out;
+        }
+
+        exit_status = run_bench(filters);
+        bench_free_filters(filters);
+        goto out;
+    }
+
     /* Check again for filter on command line */
     if (argv[ws_optind] == NULL) {
         printf("Error: Missing argument.\n");
@@ -121,12 +121,14 @@ FILE *debug_log;   /* for logging debug messages to  */
 #include <stdarg.h> /* va_copy */
 #endif
 
-static GAsyncQueue *pcap_queue;
-static int64_t pcap_queue_bytes;
-static int64_t pcap_queue_packets;
 static int64_t pcap_queue_byte_limit;
 static int64_t pcap_queue_packet_limit;
 
+/* The writer thread sleeps on this while all the capture queues are empty. */
+static GMutex pcap_queue_mtx;
+static GCond pcap_queue_cond;
+static int pcap_queue_writer_waiting;
+
 static bool capture_child; /* false: standalone call, true: this is an Wireshark capture child */
 static const char *report_capture_filename; /* capture child file name */
 #ifdef _WIN32
@@ -268,6 +270,44 @@ typedef struct _pcapng_pipe_info {
 
 struct _loop_data; /* forward declaration so we can use it in the cap_pipe_dispatch function pointer */
 
+/*
+ * A packet or pcapng block waiting to be written. The data buffer belongs
+ * to the slot and is reused by the packets that go through it, unless
+ * pcap_queue_release() decides it's too big to keep.
+ */
+typedef struct _pcap_queue_element {
+    struct _capture_src *pcap_src;
+    union {
+        struct pcap_pkthdr  phdr;
+        pcapng_block_header_t  bh;
+    } u;
+    uint8_t             *pd;
+    size_t               pd_size;      /**< Allocated size of pd */
+    int64_t              queued_at;    /**< g_get_monotonic_time() when queued; the writer writes the oldest packet first */
+} pcap_queue_element;
+
+/*
+ * Ring of packets captured on one interface, with one capture thread
+ * adding to it and the writer thread removing from it, so neither has
+ * to take a lock.
+ */
+typedef struct _pcap_queue {
+    pcap_queue_element  *slots;
+    int                  n_slots;      /**< One more than the packets the ring holds */
+    int                  head;         /**< Next slot to write out; only the writer thread changes it */
+    int                  tail;         /**< Next slot to fill; only the capture thread changes it */
+    /*
+     * Byte counts are pointer sized, so that they can be updated atomically
+     * and still hold as many bytes as the queue can allocate.
+     */
+    gsize                bytes;        /**< Bytes of queued packets; updated atomically */
+    gsize                retained;     /**< Bytes allocated for slot buffers; updated atomically */
+    /* Statistics, kept by the capture thread */
+    unsigned             max_packets;  /**< Largest number of packets queued at once */
+    uint64_t             max_bytes;    /**< Largest number of bytes queued at once */
+    uint32_t             full_drops;   /**< Packets dropped because the queue was full */
+} pcap_queue;
+
 /*
  * A source of packets from which we're capturing.
  */
@@ -283,6 +323,7 @@ typedef struct _capture_src {
     unsigned                     interface_id;
     unsigned                     idb_id;                 /**< If from_pcapng is false, the output IDB interface ID. Otherwise the mapping in src_iface_to_global is used. */
     GThread                     *tid;
+    pcap_queue                   queue;                  /**< Packets waiting for the writer thread if use_threads is set */
     int                          snaplen;
     int                          linktype;
     bool                         ts_nsec;                /**< true if we're using nanosecond precision. */
@@ -358,15 +399,6 @@ typedef struct _loop_data {
     int      interval_s;
 } loop_data;
 
-typedef struct _pcap_queue_element {
-    capture_src        *pcap_src;
-    union {
-        struct pcap_pkthdr  phdr;
-        pcapng_block_header_t  bh;
-    } u;
-    uint8_t             *pd;
-} pcap_queue_element;
-
 /*
  * This needs to be static, so that the SIGINT handler can clear the "go"
  * flag and for saved_shb_idb_lock.
@@ -408,6 +440,18 @@ static bool need_timeout_workaround;
 
 #define WRITER_THREAD_TIMEOUT 100000 /* usecs */
 
+/*
+ * Most packets each capture queue holds, whatever -N says; a ring's slots
+ * are allocated up front. Also its size if only a byte limit was given.
+ */
+#define PCAP_QUEUE_MAX_PACKETS 65536
+
+/* Largest slot buffer kept for reuse once its packet has been written */
+#define PCAP_QUEUE_KEEP_SIZE 2048
+
+/* Longest time to keep reading packets from an interface once they arrive */
+#define DISPATCH_BATCH_TIMEOUT 10000 /* usecs */
+
 static void
 dumpcap_log_writer(const char *domain, enum ws_log_level level,
                                    const char *file, long line, const char *func,
@@ -421,6 +465,7 @@ static GPtrArray *capture_comments;
 static bool quiet;
 static bool really_quiet;
 static bool use_threads;
+static int dispatch_batch_size = 1; /* Packets to process per wakeup at most */
 static uint64_t start_time;
 
 static void capture_loop_write_packet_cb(uint8_t *pcap_src_p, const struct pcap_pkthdr *phdr,
@@ -429,6 +474,8 @@ static void capture_loop_queue_packet_cb(uint8_t *pcap_src_p, const struct pcap_
                                          const uint8_t *pd);
 static void capture_loop_write_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t *bh, uint8_t *pd);
 static void capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t *bh, uint8_t *pd);
+static void pcap_queue_init(pcap_queue *queue);
+static void pcap_queue_free(pcap_queue *queue);
 static void capture_loop_get_errmsg(char *errmsg, size_t errmsglen,
                                     char *secondary_errmsg,
                                     size_t secondary_errmsglen,
@@ -440,6 +487,7 @@ WS_NORETURN static void exit_main(int err);
 static void report_new_capture_file(const char *filename);
 static void report_packet_count(unsigned int packet_count);
 static void report_packet_drops(uint32_t received, uint32_t pcap_drops, uint32_t drops, uint32_t flushed, uint32_t ps_ifdrop, char *name);
+static void report_queue_stats(const pcap_queue *queue, const char *name);
 static void report_capture_error(const char *error_msg, const char *secondary_error_msg);
 static void report_cfilter_error(capture_options *capture_opts, unsigned i, const char *errmsg);
 
@@ -539,10 +587,12 @@ print_usage(FILE *output)
     fprintf(output, "\n");
 
     fprintf(output, "Miscellaneous:\n");
-    fprintf(output, "  -N <packet_limit>        maximum number of packets buffered within dumpcap\n");
-    fprintf(output, "  -C <byte_limit>          maximum number of bytes used for buffering packets\n");
+    fprintf(output, "  -N <packet_limit>        maximum number of packets buffered for each interface\n");
+    fprintf(output, "  -C <byte_limit>          maximum number of bytes buffered for each interface\n");
     fprintf(output, "                           within dumpcap\n");
     fprintf(output, "  -t                       use a separate thread per interface\n");
+    fprintf(output, "  --batch-size <packets>   maximum number of packets to read from an interface,\n");
+    fprintf(output, "                           or write out with -t, at a time (def: 1)\n");
     fprintf(output, "  -q                       don't report packet capture counts\n");
     fprintf(output, "  -v, --version            print version information and exit\n");
     fprintf(output, "  -h, --help               display this help and exit\n");
@@ -3635,6 +3685,61 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
     }
 }
 
+#ifdef MUST_DO_SELECT
+/* Returns true if a read from fd won't block */
+static bool
+cap_fd_readable(int fd)
+{
+    fd_set      rfds;
+    struct timeval timeout = { 0, 0 };
+
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+
+    return select(fd+1, &rfds, NULL, NULL, &timeout) > 0;
+}
+
+/*
+ * Process up to dispatch_batch_size packets from a pcap source whose
+ * descriptor select() says is readable. We keep calling pcap_dispatch()
+ * while more packets are ready, until we have the batch or have spent
+ * DISPATCH_BATCH_TIMEOUT on it.
+ *
+ * Returns the number of packets processed, or the negative return value
+ * of pcap_dispatch() on an error or pcap_breakloop().
+ */
+static int
+capture_loop_dispatch_batch(loop_data *ld, capture_src *pcap_src)
+{
+    pcap_handler callback = use_threads ? capture_loop_queue_packet_cb : capture_loop_write_packet_cb;
+    int          remaining = dispatch_batch_size;
+    int          inpkts = 0;
+    int          ret;
+    int64_t      end_time = 0;
+
+    for (;;) {
+        ret = pcap_dispatch(pcap_src->pcap_h, remaining, callback, (uint8_t *)pcap_src);
+        if (ret < 0) {
+            return ret;
+        }
+        inpkts += ret;
+        remaining -= ret;
+        if (ret == 0 || remaining <= 0 || !ld->go) {
+            break;
+        }
+        if (end_time == 0) {
+            end_time = g_get_monotonic_time() + DISPATCH_BATCH_TIMEOUT;
+        } else if (g_get_monotonic_time() >= end_time) {
+            break;
+        }
+        if (!cap_fd_readable(pcap_src->pcap_fd)) {
+            break;
+        }
+    }
+    return inpkts;
+}
+#endif /* MUST_DO_SELECT */
+
 /* dispatch incoming packets (pcap or capture pipe)
  *
  * Waits for incoming packets to be available, and calls pcap_dispatch()
@@ -3720,16 +3825,12 @@ capture_loop_dispatch(loop_data *ld,
                  * "select()" says we can read from it without blocking; go for
                  * it.
                  *
-                 * We don't have pcap_breakloop(), so we only process one packet
-                 * per pcap_dispatch() call, to allow a signal to stop the
-                 * processing immediately, rather than processing all packets
-                 * in a batch before quitting.
+                 * We don't have pcap_breakloop(), so by default we only
+                 * process one packet per pcap_dispatch() call, to allow a
+                 * signal to stop the processing immediately, rather than
+                 * processing all packets in a batch before quitting.
                  */
-                if (use_threads) {
-                    inpkts = pcap_dispatch(pcap_src->pcap_h, 1, capture_loop_queue_packet_cb, (uint8_t *)pcap_src);
-                } else {
-                    inpkts = pcap_dispatch(pcap_src->pcap_h, 1, capture_loop_write_packet_cb, (uint8_t *)pcap_src);
-                }
+                inpkts = capture_loop_dispatch_batch(ld, pcap_src);
                 if (inpkts < 0) {
                     if (inpkts == -1) {
                         /* Error, rather than pcap_breakloop(). */
@@ -3759,12 +3860,13 @@ capture_loop_dispatch(loop_data *ld,
              * On Windows, we don't support asynchronously telling a process to
              * stop capturing; instead, we check for an indication on a pipe
              * after processing packets.  We therefore process only one packet
-             * at a time, so that we can check the pipe after every packet.
+             * at a time by default, so that we can check the pipe after every
+             * packet.
              */
             if (use_threads) {
-                inpkts = pcap_dispatch(pcap_src->pcap_h, 1, capture_loop_queue_packet_cb, (uint8_t *)pcap_src);
+                inpkts = pcap_dispatch(pcap_src->pcap_h, dispatch_batch_size, capture_loop_queue_packet_cb, (uint8_t *)pcap_src);
             } else {
-                inpkts = pcap_dispatch(pcap_src->pcap_h, 1, capture_loop_write_packet_cb, (uint8_t *)pcap_src);
+                inpkts = pcap_dispatch(pcap_src->pcap_h, dispatch_batch_size, capture_loop_write_packet_cb, (uint8_t *)pcap_src);
             }
 #else
             if (use_threads) {
@@ -4131,22 +4233,80 @@ pcap_read_handler(void* arg)
     return (NULL);
 }
 
-/* Try to pop an item off the packet queue and if it exists, write it */
+/* The oldest packet in the capture queues, or NULL if they're all empty */
+static pcap_queue_element *
+pcap_queue_oldest(void)
+{
+    pcap_queue_element *oldest = NULL;
+    pcap_queue_element *queue_element;
+    capture_src        *pcap_src;
+    pcap_queue         *queue;
+
+    for (unsigned i = 0; i < global_ld.pcaps->len; i++) {
+        pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+        queue = &pcap_src->queue;
+        if (queue->head == g_atomic_int_get(&queue->tail)) {
+            continue;
+        }
+        queue_element = &queue->slots[queue->head];
+        if (oldest == NULL || queue_element->queued_at < oldest->queued_at) {
+            oldest = queue_element;
+        }
+    }
+    return oldest;
+}
+
+/*
+ * Give the slot of a written packet back to its capture thread. Buffers of
+ * jumbo packets aren't kept, and neither is anything past the byte limit,
+ * so that the idle slots don't hold on to more memory than the queue may.
+ */
+static void
+pcap_queue_release(pcap_queue_element *queue_element)
+{
+    pcap_queue *queue = &queue_element->pcap_src->queue;
+    gssize      len;
+
+    if (queue_element->pcap_src->from_pcapng) {
+        len = (gssize)queue_element->u.bh.block_total_length;
+    } else {
+        len = (gssize)queue_element->u.phdr.caplen;
+    }
+    if (queue_element->pd_size > PCAP_QUEUE_KEEP_SIZE ||
+        ((pcap_queue_byte_limit > 0) &&
+         ((int64_t)(gsize)g_atomic_pointer_get(&queue->retained) > pcap_queue_byte_limit))) {
+        g_atomic_pointer_add(&queue->retained, -(gssize)queue_element->pd_size);
+        g_free(queue_element->pd);
+        queue_element->pd = NULL;
+        queue_element->pd_size = 0;
+    }
+    g_atomic_pointer_add(&queue->bytes, -len);
+    g_atomic_int_set(&queue->head, queue->head + 1 == queue->n_slots ? 0 : queue->head + 1);
+}
+
+/*
+ * Write the oldest packet in the capture queues, if there is one. If
+ * wait is true, wait up to WRITER_THREAD_TIMEOUT for a packet to arrive.
+ */
 static bool
-capture_loop_dequeue_packet(void) {
+capture_loop_dequeue_packet(bool wait) {
     pcap_queue_element *queue_element;
 
-    g_async_queue_lock(pcap_queue);
-    queue_element = (pcap_queue_element *)g_async_queue_timeout_pop_unlocked(pcap_queue, WRITER_THREAD_TIMEOUT);
-    if (queue_element) {
-        if (queue_element->pcap_src->from_pcapng) {
-            pcap_queue_bytes -= queue_element->u.bh.block_total_length;
-        } else {
-            pcap_queue_bytes -= queue_element->u.phdr.caplen;
+    queue_element = pcap_queue_oldest();
+    if (queue_element == NULL && wait) {
+        int64_t end_time = g_get_monotonic_time() + WRITER_THREAD_TIMEOUT;
+
+        g_mutex_lock(&pcap_queue_mtx);
+        g_atomic_int_set(&pcap_queue_writer_waiting, 1);
+        /* Look again: a packet queued before the flag was set didn't wake us. */
+        while ((queue_element = pcap_queue_oldest()) == NULL) {
+            if (!g_cond_wait_until(&pcap_queue_cond, &pcap_queue_mtx, end_time)) {
+                break;
+            }
         }
-        pcap_queue_packets -= 1;
+        g_atomic_int_set(&pcap_queue_writer_waiting, 0);
+        g_mutex_unlock(&pcap_queue_mtx);
     }
-    g_async_queue_unlock(pcap_queue);
     if (queue_element) {
         if (queue_element->pcap_src->from_pcapng) {
             ws_info("Dequeued a block of type 0x%08x of length %d captured on interface %d.",
@@ -4164,8 +4324,7 @@ capture_loop_dequeue_packet(void) {
                                         &queue_element->u.phdr,
                                         queue_element->pd);
         }
-        g_free(queue_element->pd);
-        g_free(queue_element);
+        pcap_queue_release(queue_element);
         return true;
     }
     return false;
@@ -4348,9 +4507,10 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
     /* WOW, everything is prepared! */
     /* please fasten your seat belts, we will enter now the actual capture loop */
     if (use_threads) {
-        pcap_queue = g_async_queue_new();
-        pcap_queue_bytes = 0;
-        pcap_queue_packets = 0;
+        for (i = 0; i < global_ld.pcaps->len; i++) {
+            pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+            pcap_queue_init(&pcap_src->queue);
+        }
         for (i = 0; i < global_ld.pcaps->len; i++) {
             pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
             /* XXX - Add an interface name here? */
@@ -4360,12 +4520,11 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
     while (global_ld.go) {
         /* dispatch incoming packets */
         if (use_threads) {
-            bool dequeued = capture_loop_dequeue_packet();
-
-            if (dequeued) {
-                inpkts = 1;
-            } else {
-                inpkts = 0;
+            /* Write up to a batch of packets, so that we flush once for them. */
+            inpkts = 0;
+            while (inpkts < dispatch_batch_size && global_ld.go &&
+                   capture_loop_dequeue_packet(inpkts == 0)) {
+                inpkts++;
             }
         } else {
             pcap_src = g_array_index(global_ld.pcaps, capture_src *, 0);
@@ -4477,7 +4636,7 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
             ws_info("Thread of interface %u terminated.", pcap_src->interface_id);
         }
         while (1) {
-            bool dequeued = capture_loop_dequeue_packet();
+            bool dequeued = capture_loop_dequeue_packet(false);
             if (!dequeued) {
                 break;
             }
@@ -4679,6 +4838,10 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
             }
         }
         report_packet_drops(received, pcap_dropped, pcap_src->dropped, pcap_src->flushed, stats->ps_ifdrop, interface_opts->display_name);
+        if (use_threads) {
+            report_queue_stats(&pcap_src->queue, interface_opts->display_name);
+            pcap_queue_free(&pcap_src->queue);
+        }
     }
 
     /* close the input file (pcap or capture pipe) */
@@ -4946,6 +5109,97 @@ capture_loop_write_packet_cb(uint8_t *pcap_src_p, const struct pcap_pkthdr *phdr
     }
 }
 
+static void
+pcap_queue_init(pcap_queue *queue)
+{
+    /* A ring can't grow, so it needs some packet limit. */
+    if (pcap_queue_packet_limit > 0 && pcap_queue_packet_limit < PCAP_QUEUE_MAX_PACKETS) {
+        queue->n_slots = (int)pcap_queue_packet_limit + 1;
+    } else {
+        queue->n_slots = PCAP_QUEUE_MAX_PACKETS + 1;
+    }
+    queue->slots = g_new0(pcap_queue_element, queue->n_slots);
+    queue->head = 0;
+    queue->tail = 0;
+    queue->bytes = 0;
+    queue->retained = 0;
+    queue->max_packets = 0;
+    queue->max_bytes = 0;
+    queue->full_drops = 0;
+}
+
+static void
+pcap_queue_free(pcap_queue *queue)
+{
+    for (int i = 0; i < queue->n_slots; i++) {
+        g_free(queue->slots[i].pd);
+    }
+    g_free(queue->slots);
+    queue->slots = NULL;
+    queue->n_slots = 0;
+}
+
+/*
+ * Get the next free slot of a capture queue, with room for len bytes, or
+ * NULL if the queue is full. Called from the capture thread only.
+ */
+static pcap_queue_element *
+pcap_queue_reserve(capture_src *pcap_src, size_t len)
+{
+    pcap_queue         *queue = &pcap_src->queue;
+    pcap_queue_element *queue_element;
+    int                 next = queue->tail + 1 == queue->n_slots ? 0 : queue->tail + 1;
+
+    if (next == g_atomic_int_get(&queue->head) ||
+        ((pcap_queue_byte_limit > 0) &&
+         ((int64_t)(gsize)g_atomic_pointer_get(&queue->bytes) >= pcap_queue_byte_limit))) {
+        queue->full_drops++;
+        return NULL;
+    }
+
+    queue_element = &queue->slots[queue->tail];
+    if (queue_element->pd_size < len) {
+        g_free(queue_element->pd);
+        queue_element->pd = (uint8_t *)g_malloc(len);
+        g_atomic_pointer_add(&queue->retained, (gssize)(len - queue_element->pd_size));
+        queue_element->pd_size = len;
+    }
+    queue_element->pcap_src = pcap_src;
+    return queue_element;
+}
+
+/*
+ * Hand the slot returned by pcap_queue_reserve() to the writer thread.
+ * Called from the capture thread only.
+ */
+static void
+pcap_queue_push(capture_src *pcap_src, size_t len)
+{
+    pcap_queue *queue = &pcap_src->queue;
+    int         next = queue->tail + 1 == queue->n_slots ? 0 : queue->tail + 1;
+    uint64_t    bytes;
+    unsigned    packets;
+
+    bytes = (uint64_t)((gsize)g_atomic_pointer_add(&queue->bytes, (gssize)len) + len);
+    g_atomic_int_set(&queue->tail, next);
+
+    packets = (unsigned)((next - g_atomic_int_get(&queue->head) + queue->n_slots) % queue->n_slots);
+    if (packets > queue->max_packets) {
+        queue->max_packets = packets;
+    }
+    if (bytes > queue->max_bytes) {
+        queue->max_bytes = bytes;
+    }
+    ws_info("Queue of interface %u is now %" PRIu64 " bytes (%u packets)",
+          pcap_src->interface_id, bytes, packets);
+
+    if (g_atomic_int_get(&pcap_queue_writer_waiting)) {
+        g_mutex_lock(&pcap_queue_mtx);
+        g_cond_signal(&pcap_queue_cond);
+        g_mutex_unlock(&pcap_queue_mtx);
+    }
+}
+
 /* one packet was captured, queue it */
 static void
 capture_loop_queue_packet_cb(uint8_t *pcap_src_p, const struct pcap_pkthdr *phdr,
@@ -4953,7 +5207,6 @@ capture_loop_queue_packet_cb(uint8_t *pcap_src_p, const struct pcap_pkthdr *phdr
 {
     capture_src        *pcap_src = (capture_src *) (void *) pcap_src_p;
     pcap_queue_element *queue_element;
-    bool                limit_reached;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -4963,46 +5216,20 @@ capture_loop_queue_packet_cb(uint8_t *pcap_src_p, const struct pcap_pkthdr *phdr
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
+    queue_element = pcap_queue_reserve(pcap_src, phdr->caplen);
     if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
-    queue_element->pcap_src = pcap_src;
-    queue_element->u.phdr = *phdr;
-    queue_element->pd = (uint8_t *)g_malloc(phdr->caplen);
-    if (queue_element->pd == NULL) {
-        pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
-    memcpy(queue_element->pd, pd, phdr->caplen);
-    g_async_queue_lock(pcap_queue);
-    if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
-        ((pcap_queue_packet_limit == 0) || (pcap_queue_packets < pcap_queue_packet_limit))) {
-        limit_reached = false;
-        g_async_queue_push_unlocked(pcap_queue, queue_element);
-        pcap_queue_bytes += phdr->caplen;
-        pcap_queue_packets += 1;
-    } else {
-        limit_reached = true;
-    }
-    g_async_queue_unlock(pcap_queue);
-    if (limit_reached) {
         pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
         ws_info("Dropped a packet of length %d captured on interface %u.",
               phdr->caplen, pcap_src->interface_id);
-    } else {
-        pcap_src->received++;
-        ws_info("Queued a packet of length %d captured on interface %u.",
-              phdr->caplen, pcap_src->interface_id);
+        return;
     }
-    /* I don't want to hold the mutex over the debug output. So the
-       output may be wrong */
-    ws_info("Queue size is now %" PRId64 " bytes (%" PRId64 " packets)",
-          pcap_queue_bytes, pcap_queue_packets);
+    queue_element->u.phdr = *phdr;
+    queue_element->queued_at = g_get_monotonic_time();
+    memcpy(queue_element->pd, pd, phdr->caplen);
+    pcap_src->received++;
+    ws_info("Queued a packet of length %d captured on interface %u.",
+          phdr->caplen, pcap_src->interface_id);
+    pcap_queue_push(pcap_src, phdr->caplen);
 }
 
 /* one pcapng block was captured, queue it */
@@ -5010,7 +5237,6 @@ static void
 capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t *bh, uint8_t *pd)
 {
     pcap_queue_element *queue_element;
-    bool                limit_reached;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -5020,46 +5246,26 @@ capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
+    queue_element = pcap_queue_reserve(pcap_src, bh->block_total_length);
     if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
-    queue_element->pcap_src = pcap_src;
-    queue_element->u.bh = *bh;
-    queue_element->pd = (uint8_t *)g_malloc(bh->block_total_length);
-    if (queue_element->pd == NULL) {
         pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
-    memcpy(queue_element->pd, pd, bh->block_total_length);
-    g_async_queue_lock(pcap_queue);
-    if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
-        ((pcap_queue_packet_limit == 0) || (pcap_queue_packets < pcap_queue_packet_limit))) {
-        limit_reached = false;
-        g_async_queue_push_unlocked(pcap_queue, queue_element);
-        pcap_queue_bytes += bh->block_total_length;
-        pcap_queue_packets += 1;
-    } else {
-        limit_reached = true;
-    }
-    g_async_queue_unlock(pcap_queue);
-    if (limit_reached) {
-        pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
         ws_info("Dropped a packet of length %d captured on interface %u.",
               bh->block_total_length, pcap_src->interface_id);
-    } else {
-        pcap_src->received++;
-        ws_info("Queued a block of type 0x%08x of length %d captured on interface %u.",
-              bh->block_type, bh->block_total_length, pcap_src->interface_id);
+        return;
     }
-    /* I don't want to hold the mutex over the debug output. So the
-       output may be wrong */
-    ws_info("Queue size is now %" PRId64 " bytes (%" PRId64 " packets)",
-          pcap_queue_bytes, pcap_queue_packets);
+    queue_element->u.bh = *bh;
+    /*
+     * Packets and blocks are both ordered by when they were queued, which
+     * is the order a single queue wrote them in: finding the timestamp of a
+     * block means knowing its type and its interface's resolution, and
+     * capture timestamps of different interfaces needn't come from one clock.
+     */
+    queue_element->queued_at = g_get_monotonic_time();
+    memcpy(queue_element->pd, pd, bh->block_total_length);
+    pcap_src->received++;
+    ws_info("Queued a block of type 0x%08x of length %d captured on interface %u.",
+          bh->block_type, bh->block_total_length, pcap_src->interface_id);
+    pcap_queue_push(pcap_src, bh->block_total_length);
 }
 
 static int
@@ -5141,6 +5347,7 @@ gather_dumpcap_runtime_info(feature_list l)
 #ifdef _WIN32
 #define LONGOPT_SIGNAL_PIPE        LONGOPT_BASE_APPLICATION+4
 #endif
+#define LONGOPT_BATCH_SIZE         LONGOPT_BASE_APPLICATION+5
 
 /* And now our feature presentation... [ fade to music ] */
 int
@@ -5158,6 +5365,7 @@ main(int argc, char *argv[])
 #ifdef _WIN32
         {"signal-pipe", ws_required_argument, NULL, LONGOPT_SIGNAL_PIPE},
 #endif
+        {"batch-size", ws_required_argument, NULL, LONGOPT_BATCH_SIZE},
         {0, 0, 0, 0 }
     };
 
@@ -5641,6 +5849,9 @@ main(int argc, char *argv[])
         case 'N':
             pcap_queue_packet_limit = get_positive_int(ws_optarg, "packet_limit");
             break;
+        case LONGOPT_BATCH_SIZE:
+            dispatch_batch_size = get_positive_int(ws_optarg, "batch size");
+            break;
         default:
             cmdarg_err("Invalid Option: %s", argv[ws_optind-1]);
             /* FALLTHROUGH */
@@ -6233,6 +6444,27 @@ report_packet_drops(uint32_t received, uint32_t pcap_drops, uint32_t drops, uint
     }
 }
 
+static void
+report_queue_stats(const pcap_queue *queue, const char *name)
+{
+    if (capture_child) {
+        char* tmp = ws_strdup_printf("%u:%u:%" PRIu64 ":%s", queue->full_drops, queue->max_packets, queue->max_bytes, name);
+
+        ws_debug("Queue of interface '%s': max depth %u packets/%" PRIu64 " bytes, dropped when full: %u",
+            name, queue->max_packets, queue->max_bytes, queue->full_drops);
+        sync_pipe_write_string_msg(sync_pipe_fd, SP_QUEUE_STATS, tmp);
+        g_free(tmp);
+    } else {
+        if (!really_quiet) {
+            fprintf(stderr,
+                "Queue of interface '%s': max depth %u packets/%" PRIu64 " bytes, dropped when full: %u\n",
+                name, queue->max_packets, queue->max_bytes, queue->full_drops);
+            /* stderr could be line buffered */
+            fflush(stderr);
+        }
+    }
+}
+
 
 /************************************************************************************************/
 /* signal_pipe handling */
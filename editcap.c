@@ -65,6 +65,7 @@
 #include <wiretap/wtap_opttypes.h>
 
 #include "ui/failure_message.h"
+#include "ui/util.h"
 
 #include "ringbuffer.h" /* For RINGBUFFER_MAX_NUM_FILES */
 
@@ -141,6 +142,7 @@ static struct select_item     selectfrm[MAX_SELECTIONS];
 static unsigned               max_selected;
 static bool                   keep_em;
 static int                    out_file_type_subtype     = WTAP_FILE_TYPE_SUBTYPE_UNKNOWN;
+static wtap_compression_type  compression_type          = WTAP_UNCOMPRESSED;
 static int                    out_frame_type            = -2; /* Leave frame type alone */
 static bool                   verbose; /* Not so verbose         */
 static struct time_adjustment time_adj; /* no adjustment */
@@ -893,6 +895,13 @@ print_usage(FILE *output)
     fprintf(output, "  -T <encap type>        set the output file encapsulation type; default is the\n");
     fprintf(output, "                         same as the input file. An empty \"-T\" option will\n");
     fprintf(output, "                         list the encapsulation types.\n");
+    fprintf(output, "  --compress <type>      compress the output file using the type compression\n");
+    fprintf(output, "                         format. An empty \"--compress\" option will list the\n");
+    fprintf(output, "                         available compression types.\n");
+    fprintf(output, "  --compress-level <level>  set the compression level; default depends on the\n");
+    fprintf(output, "                         compression type.\n");
+    fprintf(output, "  --compress-threads <n> compress using <n> worker threads, if supported by the\n");
+    fprintf(output, "                         compression type (zstd).\n");
     fprintf(output, "  --inject-secrets <type>,<file>  Insert decryption secrets from <file>. List\n");
     fprintf(output, "                         supported secret types with \"--inject-secrets help\".\n");
     fprintf(output, "  --extract-secrets      Extract decryption secrets into the output file instead.\n");
@@ -915,6 +924,9 @@ print_usage(FILE *output)
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -h, --help             display this help and exit.\n");
+    fprintf(output, "  -j <jobs>              use up to <jobs> threads: with 2 or more, the input is\n");
+    fprintf(output, "                         read in a thread of its own; any more compress zstd\n");
+    fprintf(output, "                         output if --compress-threads isn't given.\n");
     fprintf(output, "  -V                     verbose output.\n");
     fprintf(output, "                         If -V is used with any of the 'Duplicate Packet\n");
     fprintf(output, "                         Removal' options (-d, -D or -w) then Packet lengths\n");
@@ -1056,10 +1068,10 @@ editcap_dump_open(const char *filename, const wtap_dump_params *params,
 
     if (strcmp(filename, "-") == 0) {
         /* Write to the standard output. */
-        pdh = wtap_dump_open_stdout(out_file_type_subtype, WTAP_UNCOMPRESSED,
+        pdh = wtap_dump_open_stdout(out_file_type_subtype, compression_type,
                                     params, err, err_info);
     } else {
-        pdh = wtap_dump_open(filename, out_file_type_subtype, WTAP_UNCOMPRESSED,
+        pdh = wtap_dump_open(filename, out_file_type_subtype, compression_type,
                              params, err, err_info);
     }
     if (pdh == NULL)
@@ -1119,13 +1131,328 @@ editcap_dump_open(const char *filename, const wtap_dump_params *params,
     return pdh;
 }
 
+/*
+ * With -j, the input file is read in a separate thread, which hands the
+ * records over in batches, so that reading, parsing and decompressing
+ * the input overlaps with editing, compressing and writing the output.
+ * The main thread still sees the records one at a time and in order, so
+ * every edit, including the ones that depend on earlier packets, works
+ * as it does without -j.
+ *
+ * While the thread is running, only it may use the wtap. Whatever the
+ * main thread would take from the wtap as it appears - interface
+ * descriptions, name resolution blocks, decryption secrets and the
+ * section to interface mapping - is passed along with the record it
+ * precedes, and the dumper gets our copies of the arrays it would
+ * otherwise share with the wtap.
+ */
+#define READ_BATCH_SIZE 256     /* records per batch */
+#define READ_BATCHES    4       /* batches in flight */
+
+typedef enum {
+    READ_BLOCK_IDB,
+    READ_BLOCK_NRB,
+    READ_BLOCK_DSB,
+    READ_BLOCK_SHB_IFACE        /* new entry in shb_iface_to_global */
+} read_block_type_e;
+
+typedef struct {
+    unsigned          recno;    /* index in the batch of the record it precedes */
+    read_block_type_e type;
+    wtap_block_t      block;    /* copy for IDBs, owned by the wtap otherwise */
+    unsigned          value;    /* READ_BLOCK_SHB_IFACE */
+} read_block_t;
+
+typedef struct {
+    wtap_rec  recs[READ_BATCH_SIZE];
+    Buffer    bufs[READ_BATCH_SIZE];
+    int64_t   offsets[READ_BATCH_SIZE];
+    unsigned  count;
+    GArray   *blocks;           /* read_block_t */
+    bool      eof;
+    int       err;
+    char     *err_info;
+} read_batch_t;
+
+typedef struct {
+    wtap         *wth;
+    GThread      *thread;
+    GAsyncQueue  *full;         /* batches that were read, in order */
+    GAsyncQueue  *empty;        /* batches to read into */
+    read_batch_t *batches[READ_BATCHES];
+    int           stop;
+
+    /* Used by the thread */
+    GArray       *wth_nrbs;
+    GArray       *wth_dsbs;
+    GArray       *wth_shb_iface_to_global;
+    unsigned      nrbs_seen;
+    unsigned      dsbs_seen;
+    unsigned      shb_ifaces_seen;
+
+    /* Used by the main thread */
+    read_batch_t *cur;
+    unsigned      next_rec;
+    unsigned      next_block;
+    GQueue        new_idbs;
+    GPtrArray    *idbs;         /* all the IDB copies, to free them */
+    GArray       *nrbs;
+    GArray       *dsbs;
+    GArray       *shb_iface_to_global;
+} editcap_reader_t;
+
+static GArray *
+copy_growing_array(GArray *array, size_t elt_size, unsigned *seen)
+{
+    GArray *copy;
+
+    *seen = 0;
+    if (array == NULL)
+        return NULL;
+    copy = g_array_sized_new(false, false, (unsigned)elt_size, array->len);
+    g_array_append_vals(copy, array->data, array->len);
+    *seen = array->len;
+    return copy;
+}
+
+static void
+reader_add_block(read_batch_t *batch, read_block_type_e type, wtap_block_t block, unsigned value)
+{
+    read_block_t rb;
+
+    rb.recno = batch->count;
+    rb.type = type;
+    rb.block = block;
+    rb.value = value;
+    g_array_append_val(batch->blocks, rb);
+}
+
+/* Pick up what the wtap added while reading the last record. */
+static void
+reader_collect_blocks(editcap_reader_t *reader, read_batch_t *batch)
+{
+    wtap_block_t if_data;
+
+    /*
+     * Copy IDBs here, as the wtap may add statistics to them while the
+     * main thread is using them.
+     */
+    while ((if_data = wtap_get_next_interface_description(reader->wth)) != NULL)
+        reader_add_block(batch, READ_BLOCK_IDB, wtap_block_make_copy(if_data), 0);
+
+    for (; reader->wth_shb_iface_to_global && reader->shb_ifaces_seen < reader->wth_shb_iface_to_global->len; reader->shb_ifaces_seen++)
+        reader_add_block(batch, READ_BLOCK_SHB_IFACE, NULL,
+                         g_array_index(reader->wth_shb_iface_to_global, unsigned, reader->shb_ifaces_seen));
+    for (; reader->wth_nrbs && reader->nrbs_seen < reader->wth_nrbs->len; reader->nrbs_seen++)
+        reader_add_block(batch, READ_BLOCK_NRB,
+                         g_array_index(reader->wth_nrbs, wtap_block_t, reader->nrbs_seen), 0);
+    for (; reader->wth_dsbs && reader->dsbs_seen < reader->wth_dsbs->len; reader->dsbs_seen++)
+        reader_add_block(batch, READ_BLOCK_DSB,
+                         g_array_index(reader->wth_dsbs, wtap_block_t, reader->dsbs_seen), 0);
+}
+
+static void *
+reader_thread(void *data)
+{
+    editcap_reader_t *reader = (editcap_reader_t *)data;
+    read_batch_t     *batch;
+    bool              more = true;
+
+    while (more) {
+        batch = (read_batch_t *)g_async_queue_pop(reader->empty);
+        batch->count = 0;
+        g_array_set_size(batch->blocks, 0);
+        while (batch->count < READ_BATCH_SIZE) {
+            unsigned i = batch->count;
+
+            batch->err = 0;
+            batch->err_info = NULL;
+            more = !g_atomic_int_get(&reader->stop) &&
+                wtap_read(reader->wth, &batch->recs[i], &batch->bufs[i],
+                          &batch->err, &batch->err_info, &batch->offsets[i]);
+            reader_collect_blocks(reader, batch);
+            if (!more)
+                break;
+            batch->count++;
+        }
+        batch->eof = !more;
+        g_async_queue_push(reader->full, batch);
+    }
+
+    return NULL;
+}
+
+/*
+ * Start reading in a thread, and point the dump parameters at our copies
+ * of the arrays that the wtap grows as it reads.
+ */
+static void
+reader_start(editcap_reader_t *reader, wtap_dump_params *params)
+{
+    read_batch_t *batch;
+
+    reader->wth_nrbs = params->nrbs_growing;
+    reader->wth_dsbs = params->dsbs_growing;
+    reader->wth_shb_iface_to_global = params->shb_iface_to_global;
+    reader->nrbs = copy_growing_array(reader->wth_nrbs, sizeof(wtap_block_t), &reader->nrbs_seen);
+    reader->dsbs = copy_growing_array(reader->wth_dsbs, sizeof(wtap_block_t), &reader->dsbs_seen);
+    reader->shb_iface_to_global = copy_growing_array(reader->wth_shb_iface_to_global, sizeof(unsigned), &reader->shb_ifaces_seen);
+    params->nrbs_growing = reader->nrbs;
+    params->dsbs_growing = reader->dsbs;
+    params->shb_iface_to_global = reader->shb_iface_to_global;
+
+    reader->idbs = g_ptr_array_new_with_free_func((GDestroyNotify)wtap_block_unref);
+    reader->full = g_async_queue_new();
+    reader->empty = g_async_queue_new();
+    for (unsigned i = 0; i < READ_BATCHES; i++) {
+        batch = g_new0(read_batch_t, 1);
+        for (unsigned j = 0; j < READ_BATCH_SIZE; j++) {
+            wtap_rec_init(&batch->recs[j]);
+            ws_buffer_init(&batch->bufs[j], 1514);
+        }
+        batch->blocks = g_array_new(false, false, sizeof(read_block_t));
+        reader->batches[i] = batch;
+        g_async_queue_push(reader->empty, batch);
+    }
+    reader->thread = g_thread_new("editcap reader", reader_thread, reader);
+}
+
+/* Hand over the blocks that precede record recno of the current batch. */
+static void
+reader_take_blocks(editcap_reader_t *reader, unsigned recno)
+{
+    read_batch_t *batch = reader->cur;
+    read_block_t *rb;
+
+    for (; reader->next_block < batch->blocks->len; reader->next_block++) {
+        rb = &g_array_index(batch->blocks, read_block_t, reader->next_block);
+        if (rb->recno > recno)
+            break;
+        switch (rb->type) {
+
+        case READ_BLOCK_IDB:
+            g_ptr_array_add(reader->idbs, rb->block);
+            g_queue_push_tail(&reader->new_idbs, rb->block);
+            break;
+
+        case READ_BLOCK_NRB:
+            g_array_append_val(reader->nrbs, rb->block);
+            break;
+
+        case READ_BLOCK_DSB:
+            g_array_append_val(reader->dsbs, rb->block);
+            break;
+
+        case READ_BLOCK_SHB_IFACE:
+            g_array_append_val(reader->shb_iface_to_global, rb->value);
+            break;
+        }
+    }
+}
+
+/* Like wtap_read(), but takes the records from the thread if there is one. */
+static bool
+reader_read(editcap_reader_t *reader, wtap_rec *rec, Buffer *buf,
+            int *err, char **err_info, int64_t *data_offset)
+{
+    read_batch_t *batch;
+    wtap_rec      tmp_rec;
+    Buffer        tmp_buf;
+
+    if (reader->thread == NULL)
+        return wtap_read(reader->wth, rec, buf, err, err_info, data_offset);
+
+    for (;;) {
+        if (reader->cur == NULL) {
+            reader->cur = (read_batch_t *)g_async_queue_pop(reader->full);
+            reader->next_rec = 0;
+            reader->next_block = 0;
+        }
+        batch = reader->cur;
+
+        reader_take_blocks(reader, reader->next_rec);
+        if (reader->next_rec < batch->count) {
+            /* Swap buffers with the batch; the thread reuses ours. */
+            wtap_rec_reset(rec);
+            tmp_rec = *rec;
+            *rec = batch->recs[reader->next_rec];
+            batch->recs[reader->next_rec] = tmp_rec;
+            tmp_buf = *buf;
+            *buf = batch->bufs[reader->next_rec];
+            batch->bufs[reader->next_rec] = tmp_buf;
+            *data_offset = batch->offsets[reader->next_rec];
+            reader->next_rec++;
+            return true;
+        }
+        if (batch->eof) {
+            *err = batch->err;
+            *err_info = batch->err_info;
+            batch->err_info = NULL;
+            return false;
+        }
+        g_async_queue_push(reader->empty, batch);
+        reader->cur = NULL;
+    }
+}
+
+static wtap_block_t
+reader_next_idb(editcap_reader_t *reader)
+{
+    if (reader->thread == NULL)
+        return wtap_get_next_interface_description(reader->wth);
+    return (wtap_block_t)g_queue_pop_head(&reader->new_idbs);
+}
+
+/*
+ * Stop the thread, if it's still reading, and free everything. This has
+ * to wait until the dumper using our arrays has been closed.
+ */
+static void
+reader_stop(editcap_reader_t *reader)
+{
+    read_batch_t *batch;
+
+    if (reader->thread == NULL)
+        return;
+
+    g_atomic_int_set(&reader->stop, 1);
+    while (reader->cur == NULL || !reader->cur->eof) {
+        if (reader->cur != NULL)
+            g_async_queue_push(reader->empty, reader->cur);
+        reader->cur = (read_batch_t *)g_async_queue_pop(reader->full);
+    }
+    g_thread_join(reader->thread);
+    reader->thread = NULL;
+
+    for (unsigned i = 0; i < READ_BATCHES; i++) {
+        batch = reader->batches[i];
+        for (unsigned j = 0; j < READ_BATCH_SIZE; j++) {
+            wtap_rec_cleanup(&batch->recs[j]);
+            ws_buffer_free(&batch->bufs[j]);
+        }
+        g_array_free(batch->blocks, true);
+        g_free(batch->err_info);
+        g_free(batch);
+    }
+    g_async_queue_unref(reader->full);
+    g_async_queue_unref(reader->empty);
+    g_queue_clear(&reader->new_idbs);
+    g_ptr_array_free(reader->idbs, true);
+    if (reader->nrbs)
+        g_array_free(reader->nrbs, true);
+    if (reader->dsbs)
+        g_array_free(reader->dsbs, true);
+    if (reader->shb_iface_to_global)
+        g_array_free(reader->shb_iface_to_global, true);
+}
+
 static bool
-process_new_idbs(wtap *wth, wtap_dumper *pdh, GArray *idbs_seen,
+process_new_idbs(editcap_reader_t *reader, wtap_dumper *pdh, GArray *idbs_seen,
                  int *err, char **err_info)
 {
     wtap_block_t if_data;
 
-    while ((if_data = wtap_get_next_interface_description(wth)) != NULL) {
+    while ((if_data = reader_next_idb(reader)) != NULL) {
         /*
          * Only add interface blocks if the output file supports (meaning
          * *requires*) them.
@@ -1276,6 +1603,8 @@ main(int argc, char *argv[])
         cfile_close_failure_message
     };
     wtap         *wth = NULL;
+    editcap_reader_t reader;
+    unsigned      num_jobs           = 1;
     int           i, j, read_err, write_err;
     char         *read_err_info, *write_err_info;
     int           opt;
@@ -1290,6 +1619,9 @@ main(int argc, char *argv[])
 #define LONGOPT_SET_UNUSED           LONGOPT_BASE_APPLICATION+8
 #define LONGOPT_DISCARD_PACKET_COMMENTS LONGOPT_BASE_APPLICATION+9
 #define LONGOPT_EXTRACT_SECRETS      LONGOPT_BASE_APPLICATION+10
+#define LONGOPT_COMPRESS             LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_COMPRESS_LEVEL       LONGOPT_BASE_APPLICATION+12
+#define LONGOPT_COMPRESS_THREADS     LONGOPT_BASE_APPLICATION+13
 
     static const struct ws_option long_options[] = {
         {"novlan", ws_no_argument, NULL, LONGOPT_NO_VLAN},
@@ -1304,11 +1636,16 @@ main(int argc, char *argv[])
         {"set-unused", ws_no_argument, NULL, LONGOPT_SET_UNUSED},
         {"discard-packet-comments", ws_no_argument, NULL, LONGOPT_DISCARD_PACKET_COMMENTS},
         {"extract-secrets", ws_no_argument, NULL, LONGOPT_EXTRACT_SECRETS},
+        {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"compress-level", ws_required_argument, NULL, LONGOPT_COMPRESS_LEVEL},
+        {"compress-threads", ws_required_argument, NULL, LONGOPT_COMPRESS_THREADS},
         {0, 0, 0, 0 }
     };
 
     char         *p;
     uint32_t      snaplen            = 0; /* No limit               */
+    int           compression_level  = 0; /* Library default        */
+    int           compression_threads = 0;
     chop_t        chop               = {0, 0, 0, 0, 0, 0}; /* No chop */
     bool          adjlen             = false;
     wtap_dumper  *pdh                = NULL;
@@ -1347,6 +1684,7 @@ main(int argc, char *argv[])
 
     cmdarg_err_init(editcap_cmdarg_err, editcap_cmdarg_err_cont);
     memset(&read_rec, 0, sizeof *rec);
+    memset(&reader, 0, sizeof reader);
 
     /* Initialize log handler early so we can have proper logging during startup. */
     ws_log_init("editcap", vcmdarg_err);
@@ -1384,7 +1722,7 @@ main(int argc, char *argv[])
     wtap_init(true);
 
     /* Process the options */
-    while ((opt = ws_getopt_long(argc, argv, "a:A:B:c:C:dD:E:F:hi:I:Lo:rs:S:t:T:vVw:", long_options, NULL)) != -1) {
+    while ((opt = ws_getopt_long(argc, argv, "a:A:B:c:C:dD:E:F:hi:I:j:Lo:rs:S:t:T:vVw:", long_options, NULL)) != -1) {
         if (opt != LONGOPT_EXTRACT_SECRETS && opt != 'V') {
             edit_option_specified = true;
         }
@@ -1505,6 +1843,32 @@ main(int argc, char *argv[])
             break;
         }
 
+        case LONGOPT_COMPRESS:
+        {
+            compression_type = wtap_name_to_compression_type(ws_optarg);
+            if (compression_type == WTAP_UNKNOWN_COMPRESSION ||
+                !wtap_can_write_compression_type(compression_type)) {
+                cmdarg_err("\"%s\" isn't a valid output compression mode",
+                            ws_optarg);
+                list_output_compression_types("editcap", stderr);
+                ret = WS_EXIT_INVALID_OPTION;
+                goto clean_exit;
+            }
+            break;
+        }
+
+        case LONGOPT_COMPRESS_LEVEL:
+        {
+            compression_level = get_int(ws_optarg, "compression level");
+            break;
+        }
+
+        case LONGOPT_COMPRESS_THREADS:
+        {
+            compression_threads = get_natural_int(ws_optarg, "number of compression threads");
+            break;
+        }
+
         case 'a':
         {
             uint64_t frame_number;
@@ -1669,6 +2033,10 @@ main(int argc, char *argv[])
             ignored_bytes = get_guint32(ws_optarg, "number of bytes to ignore");
             break;
 
+        case 'j':
+            num_jobs = get_positive_int(ws_optarg, "number of jobs");
+            break;
+
         case 'L':
             adjlen = true;
             break;
@@ -1748,6 +2116,9 @@ main(int argc, char *argv[])
             case'T':
                 list_encap_types(stdout);
                 break;
+            case LONGOPT_COMPRESS:
+                list_output_compression_types("editcap", stdout);
+                break;
             default:
                 print_usage(stderr);
                 ret = WS_EXIT_INVALID_OPTION;
@@ -1768,6 +2139,32 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (compression_level != 0) {
+        int min_level, max_level;
+
+        if (!wtap_compression_type_level_range(compression_type, &min_level, &max_level)) {
+            cmdarg_err("A compression level can't be set with compression type \"%s\"",
+                       wtap_compression_type_name(compression_type));
+            ret = WS_EXIT_INVALID_OPTION;
+            goto clean_exit;
+        }
+        if (compression_level < min_level || compression_level > max_level) {
+            cmdarg_err("The specified compression level %d isn't between %d and %d for compression type \"%s\"",
+                       compression_level, min_level, max_level,
+                       wtap_compression_type_name(compression_type));
+            ret = WS_EXIT_INVALID_OPTION;
+            goto clean_exit;
+        }
+    }
+
+    /* Only zstd compression uses worker threads. */
+    if (num_jobs > 2 && compression_threads == 0 &&
+        compression_type != WTAP_ZSTD_COMPRESSED) {
+        fprintf(stderr,
+                "editcap: Warning: only 2 of the %u jobs are used, as the output isn't zstd compressed.\n",
+                num_jobs);
+    }
+
     if (out_file_type_subtype == WTAP_FILE_TYPE_SUBTYPE_UNKNOWN) {
       /* default to pcapng   */
       out_file_type_subtype = wtap_pcapng_file_type_subtype();
@@ -1850,6 +2247,11 @@ main(int argc, char *argv[])
     }
 
     wtap_dump_params_init_no_idbs(&params, wth);
+    params.compression_level = compression_level;
+    params.compression_threads = compression_threads;
+    /* Jobs beyond the reader and the main thread go to the compressor. */
+    if (compression_threads == 0 && num_jobs > 2)
+        params.compression_threads = num_jobs - 2;
 
     /*
      * Discard any secrets we read in while opening the file.
@@ -1969,9 +2371,12 @@ main(int argc, char *argv[])
     idbs_seen = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
 
     /* Read all of the packets in turn */
+    reader.wth = wth;
+    if (num_jobs > 1)
+        reader_start(&reader, &params);
     wtap_rec_init(&read_rec);
     ws_buffer_init(&read_buf, 1514);
-    while (wtap_read(wth, &read_rec, &read_buf, &read_err, &read_err_info, &data_offset)) {
+    while (reader_read(&reader, &read_rec, &read_buf, &read_err, &read_err_info, &data_offset)) {
         /*
          * XXX - what about non-packet records in the file after this?
          * NRBs, DSBs, and ISBs are now written when wtap_dump_close() calls
@@ -2019,7 +2424,7 @@ main(int argc, char *argv[])
         /*
          * Process whatever IDBs we haven't seen yet.
          */
-        if (!process_new_idbs(wth, pdh, idbs_seen, &write_err, &write_err_info)) {
+        if (!process_new_idbs(&reader, pdh, idbs_seen, &write_err, &write_err_info)) {
             cfile_write_failure_message(argv[ws_optind], filename,
                                         write_err, write_err_info,
                                         read_count,
@@ -2560,7 +2965,7 @@ main(int argc, char *argv[])
     /*
      * Process whatever IDBs we haven't seen yet.
      */
-    if (!process_new_idbs(wth, pdh, idbs_seen, &write_err, &write_err_info)) {
+    if (!process_new_idbs(&reader, pdh, idbs_seen, &write_err, &write_err_info)) {
         cfile_write_failure_message(argv[ws_optind], filename,
                                     write_err, write_err_info,
                                     read_count,
@@ -2614,6 +3019,7 @@ clean_exit:
     }
     g_free(params.idb_inf);
     wtap_dump_params_cleanup(&params);
+    reader_stop(&reader);
     if (wth != NULL)
         wtap_close(wth);
     wtap_rec_reset(&read_rec);
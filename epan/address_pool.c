@@ -0,0 +1,117 @@
+/* address_pool.c
+ * Interning of addresses, which gives each distinct address a small id
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <wsutil/ws_assert.h>
+
+#include "address_pool.h"
+
+struct address_pool {
+    wmem_allocator_t *scope;    /* Addresses and their data */
+    GHashTable *ids;            /* address * -> id */
+    GPtrArray *addresses;       /* address *, indexed by id */
+};
+
+static unsigned
+address_pool_hash(const void *key)
+{
+    const address *addr = (const address *)key;
+
+    return add_address_to_hash(addr->type, addr);
+}
+
+static gboolean
+address_pool_equal(const void *key1, const void *key2)
+{
+    return addresses_equal((const address *)key1, (const address *)key2);
+}
+
+address_pool_t *
+address_pool_new(void)
+{
+    address_pool_t *pool = g_new(address_pool_t, 1);
+
+    pool->scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    /* The keys are the addresses in the array. */
+    pool->ids = g_hash_table_new(address_pool_hash, address_pool_equal);
+    pool->addresses = g_ptr_array_new();
+
+    return pool;
+}
+
+void
+address_pool_free(address_pool_t *pool)
+{
+    if (pool == NULL)
+        return;
+
+    g_hash_table_destroy(pool->ids);
+    g_ptr_array_free(pool->addresses, true);
+    wmem_destroy_allocator(pool->scope);
+    g_free(pool);
+}
+
+uint32_t
+address_pool_intern(address_pool_t *pool, const address *addr)
+{
+    address *copy;
+    void *value;
+    uint32_t id;
+
+    if (g_hash_table_lookup_extended(pool->ids, addr, NULL, &value))
+        return GPOINTER_TO_UINT(value);
+
+    copy = wmem_new(pool->scope, address);
+    copy_address_wmem(pool->scope, copy, addr);
+
+    id = pool->addresses->len;
+    g_ptr_array_add(pool->addresses, copy);
+    g_hash_table_insert(pool->ids, copy, GUINT_TO_POINTER(id));
+
+    return id;
+}
+
+uint32_t
+address_pool_lookup(const address_pool_t *pool, const address *addr)
+{
+    void *value;
+
+    if (g_hash_table_lookup_extended(pool->ids, addr, NULL, &value))
+        return GPOINTER_TO_UINT(value);
+    return ADDRESS_POOL_NO_ID;
+}
+
+const address *
+address_pool_get(const address_pool_t *pool, uint32_t id)
+{
+    ws_assert(id < pool->addresses->len);
+
+    return (const address *)g_ptr_array_index(pool->addresses, id);
+}
+
+unsigned
+address_pool_count(const address_pool_t *pool)
+{
+    return pool->addresses->len;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,84 @@
+/** @file
+ * Interning of addresses, which gives each distinct address a small id
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ADDRESS_POOL_H__
+#define __ADDRESS_POOL_H__
+
+#include <glib.h>
+#include <ws_symbol_export.h>
+
+#include <epan/address.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * An address pool stores one copy of each distinct address added to it and
+ * numbers them from 0, so that tables keyed by addresses can use the ids
+ * instead: they are cheaper to store, hash and compare than the addresses.
+ *
+ * Addresses are never removed; they stay in the pool until it is freed. A
+ * pool is meant to live as long as one table, e.g. a conversation table is
+ * reset, and its pool freed, when the capture file is closed or retapped.
+ */
+
+typedef struct address_pool address_pool_t;
+
+/** Returned by address_pool_lookup() for an address that isn't in the pool. */
+#define ADDRESS_POOL_NO_ID UINT32_MAX
+
+/** Create an empty pool. */
+WS_DLL_PUBLIC address_pool_t *address_pool_new(void);
+
+/** Free a pool and all the addresses in it. */
+WS_DLL_PUBLIC void address_pool_free(address_pool_t *pool);
+
+/**
+ * Find an address, copying it into the pool if it isn't there yet.
+ *
+ * @return The id of the address.
+ */
+WS_DLL_PUBLIC uint32_t address_pool_intern(address_pool_t *pool, const address *addr);
+
+/**
+ * Find an address without adding it.
+ *
+ * @return The id of the address, or ADDRESS_POOL_NO_ID.
+ */
+WS_DLL_PUBLIC uint32_t address_pool_lookup(const address_pool_t *pool, const address *addr);
+
+/**
+ * Get the address with the given id. Its data belongs to the pool and
+ * stays valid until the pool is freed.
+ */
+WS_DLL_PUBLIC const address *address_pool_get(const address_pool_t *pool, uint32_t id);
+
+/** @return The number of distinct addresses in the pool. */
+WS_DLL_PUBLIC unsigned address_pool_count(const address_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ADDRESS_POOL_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
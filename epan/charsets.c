@@ -11,6 +11,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <string.h>
 #include <glib.h>
 
 #include <epan/proto.h>
@@ -70,6 +71,26 @@
  * code page mappings to Unicode.
  */
 
+/*
+ * Most strings in ASCII-based encodings are plain ASCII, which is the same
+ * in UTF-8. If the string is, copy it with a single allocation; otherwise
+ * return NULL and the length of its ASCII prefix.
+ */
+static uint8_t *
+get_ascii_prefix(wmem_allocator_t *scope, const uint8_t *ptr, int length, size_t *ascii_bytes)
+{
+    uint8_t *buf;
+
+    *ascii_bytes = length > 0 ? ws_ascii_span(ptr, length) : 0;
+    if (*ascii_bytes != (size_t)MAX(length, 0))
+        return NULL;
+
+    buf = (uint8_t *)wmem_alloc(scope, *ascii_bytes + 1);
+    memcpy(buf, ptr, *ascii_bytes);
+    buf[*ascii_bytes] = '\0';
+    return buf;
+}
+
 /*
  * Given a wmem scope, a pointer, and a length, treat the string of bytes
  * referred to by the pointer and length as an ASCII string, with all bytes
@@ -83,28 +104,28 @@ uint8_t *
 get_ascii_string(wmem_allocator_t *scope, const uint8_t *ptr, int length)
 {
     wmem_strbuf_t *str;
-    const uint8_t *prev = ptr;
-    size_t valid_bytes = 0;
+    uint8_t *buf;
+    size_t valid_bytes;
+
+    buf = get_ascii_prefix(scope, ptr, length, &valid_bytes);
+    if (buf)
+        return buf;
 
     str = wmem_strbuf_new_sized(scope, length+1);
 
-    while (length > 0) {
-        uint8_t ch = *ptr++;
+    for (;;) {
+        wmem_strbuf_append_len(str, (const char *)ptr, valid_bytes);
+        ptr += valid_bytes;
+        length -= (int)valid_bytes;
 
-        if (ch < 0x80) {
-            valid_bytes++;
-        } else {
-            if (valid_bytes) {
-                wmem_strbuf_append_len(str, prev, valid_bytes);
-                valid_bytes = 0;
-            }
-            prev = ptr;
+        while (length > 0 && *ptr >= 0x80) {
             wmem_strbuf_append_unichar_repl(str);
+            ptr++;
+            length--;
         }
-        length--;
-    }
-    if (valid_bytes) {
-        wmem_strbuf_append_len(str, prev, valid_bytes);
+        if (length <= 0)
+            break;
+        valid_bytes = ws_ascii_span(ptr, length);
     }
 
     return (uint8_t *) wmem_strbuf_finalize(str);
@@ -178,8 +199,17 @@ uint8_t *
 get_8859_1_string(wmem_allocator_t *scope, const uint8_t *ptr, int length)
 {
     wmem_strbuf_t *str;
+    uint8_t *buf;
+    size_t ascii_bytes;
+
+    buf = get_ascii_prefix(scope, ptr, length, &ascii_bytes);
+    if (buf)
+        return buf;
 
     str = wmem_strbuf_new_sized(scope, length+1);
+    wmem_strbuf_append_len(str, (const char *)ptr, ascii_bytes);
+    ptr += ascii_bytes;
+    length -= (int)ascii_bytes;
 
     while (length > 0) {
         uint8_t ch = *ptr;
@@ -678,8 +708,17 @@ uint8_t *
 get_unichar2_string(wmem_allocator_t *scope, const uint8_t *ptr, int length, const gunichar2 table[0x80])
 {
     wmem_strbuf_t *str;
+    uint8_t *buf;
+    size_t ascii_bytes;
+
+    buf = get_ascii_prefix(scope, ptr, length, &ascii_bytes);
+    if (buf)
+        return buf;
 
     str = wmem_strbuf_new_sized(scope, length+1);
+    wmem_strbuf_append_len(str, (const char *)ptr, ascii_bytes);
+    ptr += ascii_bytes;
+    length -= (int)ascii_bytes;
 
     while (length > 0) {
         uint8_t ch = *ptr;
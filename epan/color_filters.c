@@ -48,6 +48,12 @@ static GSList *color_filter_list;
 static GSList *color_filter_deleted_list;
 static GSList *color_filter_valid_list;
 
+/* The enabled, compiled filters of color_filter_list as a dfilter set,
+ * and the color filter for each index in the set. Built on first use and
+ * thrown away whenever color_filter_list or one of its filters changes. */
+static dfilter_set_t *color_filter_set;
+static color_filter_t **color_filter_set_filters;
+
 /* Color Filters can en-/disabled. */
 static bool filters_enabled = true;
 
@@ -75,6 +81,34 @@ color_filter_new(const char *name,          /* The name of the filter to create
     return colorf;
 }
 
+static void
+color_filters_invalidate_set(void)
+{
+    dfilter_set_free(color_filter_set);
+    color_filter_set = NULL;
+    g_free(color_filter_set_filters);
+    color_filter_set_filters = NULL;
+}
+
+static void
+color_filters_build_set(void)
+{
+    GSList         *curr;
+    color_filter_t *colorf;
+    unsigned        idx;
+
+    color_filter_set = dfilter_set_new();
+    color_filter_set_filters = g_new(color_filter_t *, g_slist_length(color_filter_list));
+
+    for (curr = color_filter_list; curr != NULL; curr = g_slist_next(curr)) {
+        colorf = (color_filter_t *)curr->data;
+        if ((!colorf->disabled) && (colorf->c_colorfilter != NULL)) {
+            idx = dfilter_set_add(color_filter_set, colorf->c_colorfilter);
+            color_filter_set_filters[idx] = colorf;
+        }
+    }
+}
+
 /* Add ten empty (temporary) colorfilters for easy coloring */
 static void
 color_filters_add_tmp(GSList **cfl)
@@ -159,6 +193,9 @@ color_filters_set_tmp(uint8_t filt_nr, const char *filter, bool disabled, char *
     dfilter_t      *compiled_filter;
     uint8_t        i;
     df_error_t     *df_err = NULL;
+
+    color_filters_invalidate_set();
+
     /* Go through the temporary filters and look for the same filter string.
      * If found, clear it so that a filter can be "moved" up and down the list
      */
@@ -351,6 +388,7 @@ bool
 color_filters_init(char** err_msg, color_filter_add_cb_func add_cb)
 {
     /* delete all currently existing filters */
+    color_filters_invalidate_set();
     color_filter_list_delete(&color_filter_list);
 
     /* now try to construct the filters list */
@@ -362,6 +400,7 @@ color_filters_reload(char** err_msg, color_filter_add_cb_func add_cb)
 {
     /* "move" old entries to the deleted list
      * we must keep them until the dissection no longer needs them */
+    color_filters_invalidate_set();
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
     color_filter_list = NULL;
 
@@ -460,6 +499,7 @@ color_filters_apply(GSList *tmp_cfl, GSList *edit_cfl, char** err_msg)
 
     /* "move" old entries to the deleted list
      * we must keep them until the dissection no longer needs them */
+    color_filters_invalidate_set();
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
     color_filter_list = NULL;
 
@@ -569,21 +609,17 @@ color_filters_use_proto(int proto_id)
 const color_filter_t *
 color_filters_colorize_packet(epan_dissect_t *edt)
 {
-    GSList         *curr;
-    color_filter_t *colorf;
+    int idx;
 
     /* If we have color filters, "search" for the matching one. */
     if ((edt->tree != NULL) && (color_filters_used())) {
-        curr = color_filter_list;
-
-        while(curr != NULL) {
-            colorf = (color_filter_t *)curr->data;
-            if ( (!colorf->disabled) &&
-                 (colorf->c_colorfilter != NULL) &&
-                 dfilter_apply_edt(colorf->c_colorfilter, edt)) {
-                return colorf;
-            }
-            curr = g_slist_next(curr);
+        if (color_filter_set == NULL) {
+            color_filters_build_set();
+        }
+
+        idx = dfilter_set_apply_edt(color_filter_set, edt);
+        if (idx >= 0) {
+            return color_filter_set_filters[idx];
         }
     }
 
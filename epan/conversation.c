@@ -10,6 +10,7 @@
 
 #include "config.h"
 
+#include <errno.h>
 #include <string.h>
 
 #include <glib.h>
@@ -159,6 +160,19 @@ static wmem_map_t *conversation_hashtable_deinterlacer = NULL;
 
 static uint32_t new_index;
 
+/*
+ * Stream index fields (e.g. tcp.stream) whose frames are indexed, and the
+ * frames of each stream, keyed by field and value.
+ */
+static wmem_map_t *stream_index_fields;
+static wmem_map_t *stream_frame_index;
+
+typedef struct {
+    uint64_t key;           /* hf_stream << 32 | stream */
+    uint32_t last_frame;
+    wmem_array_t *deltas;   /* uint8_t, frame number deltas as LEB128 */
+} stream_frames_t;
+
 /*
  * Placeholder for address-less conversations.
  */
@@ -688,6 +702,9 @@ conversation_init(void)
     wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), addrs_anc_map_key),
                     conversation_hashtable_exact_addr_anc);
 
+    stream_index_fields = wmem_map_new(wmem_epan_scope(), g_direct_hash, g_direct_equal);
+    stream_frame_index = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
+                                                g_int64_hash, g_int64_equal);
 }
 
 /**
@@ -2463,6 +2480,151 @@ conversation_get_id_from_elements(struct _packet_info *pinfo, conversation_type
     return pinfo->conv_elements[0].uint_val;
 }
 
+void
+conversation_index_register_field(const int hf_stream)
+{
+    wmem_map_insert(stream_index_fields, GINT_TO_POINTER(hf_stream), GINT_TO_POINTER(hf_stream));
+}
+
+void
+conversation_index_add_frame(const packet_info *pinfo, const int hf_stream, const uint32_t stream)
+{
+    stream_frames_t *frames;
+    uint64_t key = (uint64_t)(unsigned)hf_stream << 32 | stream;
+    uint32_t delta;
+    uint8_t buf[5];
+    unsigned len = 0;
+
+    if (PINFO_FD_VISITED(pinfo))
+        return;
+
+    frames = (stream_frames_t *)wmem_map_lookup(stream_frame_index, &key);
+    if (!frames) {
+        frames = wmem_new(wmem_file_scope(), stream_frames_t);
+        frames->key = key;
+        frames->last_frame = 0;
+        frames->deltas = wmem_array_sized_new(wmem_file_scope(), 1, 16);
+        wmem_map_insert(stream_frame_index, &frames->key, frames);
+    } else if (frames->last_frame == pinfo->num) {
+        /* Another layer of the same frame, e.g. tunneled over itself. */
+        return;
+    }
+
+    /* Frames are visited in order, so the deltas are small and positive. */
+    delta = pinfo->num - frames->last_frame;
+    do {
+        buf[len] = delta & 0x7f;
+        delta >>= 7;
+        if (delta)
+            buf[len] |= 0x80;
+        len++;
+    } while (delta);
+    wmem_array_append(frames->deltas, buf, len);
+    frames->last_frame = pinfo->num;
+}
+
+/*
+ * Parse "<field> == <number>", with "eq" or "any_eq" for "==". Anything
+ * else, including a filter that uses other fields, is left to the display
+ * filter engine.
+ */
+static bool
+stream_filter_parse(const char *dftext, int *hf_stream, uint32_t *stream)
+{
+    const char *p = dftext, *start;
+    char *name, *endp;
+    header_field_info *hfinfo;
+    uint64_t val;
+
+    if (!dftext)
+        return false;
+
+    while (g_ascii_isspace(*p))
+        p++;
+    start = p;
+    while (g_ascii_isalnum(*p) || *p == '.' || *p == '_' || *p == '-')
+        p++;
+    if (p == start)
+        return false;
+
+    name = g_strndup(start, p - start);
+    hfinfo = proto_registrar_get_byname(name);
+    g_free(name);
+    if (!hfinfo || !wmem_map_contains(stream_index_fields, GINT_TO_POINTER(hfinfo->id)))
+        return false;
+
+    while (g_ascii_isspace(*p))
+        p++;
+    if (strncmp(p, "==", 2) == 0)
+        p += 2;
+    else if (strncmp(p, "eq", 2) == 0 && g_ascii_isspace(p[2]))
+        p += 2;
+    else if (strncmp(p, "any_eq", 6) == 0 && g_ascii_isspace(p[6]))
+        p += 6;
+    else
+        return false;
+
+    while (g_ascii_isspace(*p))
+        p++;
+    if (!g_ascii_isdigit(*p))
+        return false;
+    errno = 0;
+    val = g_ascii_strtoull(p, &endp, 0);
+    if (errno != 0 || val > UINT32_MAX)
+        return false;
+    p = endp;
+    while (g_ascii_isspace(*p))
+        p++;
+    if (*p != '\0')
+        return false;
+
+    *hf_stream = hfinfo->id;
+    *stream = (uint32_t)val;
+    return true;
+}
+
+bool
+conversation_index_filter_frames(const char *dftext, conversation_frame_iter_t *iter)
+{
+    stream_frames_t *frames;
+    int hf_stream;
+    uint32_t stream;
+    uint64_t key;
+
+    if (!stream_filter_parse(dftext, &hf_stream, &stream))
+        return false;
+
+    key = (uint64_t)(unsigned)hf_stream << 32 | stream;
+    frames = (stream_frames_t *)wmem_map_lookup(stream_frame_index, &key);
+    iter->frames = frames;
+    iter->pos = 0;
+    iter->frame = 0;
+    return true;
+}
+
+bool
+conversation_frame_iter_next(conversation_frame_iter_t *iter, uint32_t *frame)
+{
+    const stream_frames_t *frames = (const stream_frames_t *)iter->frames;
+    const uint8_t *deltas;
+    uint32_t delta = 0;
+    unsigned shift = 0;
+
+    /* The array can grow and move while frames are being added. */
+    if (!frames || iter->pos >= wmem_array_get_count(frames->deltas))
+        return false;
+
+    deltas = (const uint8_t *)wmem_array_get_raw(frames->deltas);
+    do {
+        delta |= (uint32_t)(deltas[iter->pos] & 0x7f) << shift;
+        shift += 7;
+    } while (deltas[iter->pos++] & 0x80);
+
+    iter->frame += delta;
+    *frame = iter->frame;
+    return true;
+}
+
 wmem_map_t *
 get_conversation_hashtables(void)
 {
@@ -556,6 +556,55 @@ WS_DLL_PUBLIC void conversation_set_port2(conversation_t *conv, const uint32_t p
  */
 WS_DLL_PUBLIC void conversation_set_addr2(conversation_t *conv, const address *addr);
 
+/**
+ * Iterator over the frames recorded for a stream with
+ * conversation_index_add_frame().
+ */
+typedef struct {
+    const void *frames;     /* Private */
+    unsigned pos;
+    uint32_t frame;
+} conversation_frame_iter_t;
+
+/**
+ * Index the frames of each stream of a stream index field such as
+ * tcp.stream, so that a display filter that only compares that field with
+ * a number can be answered without dissecting every frame.
+ * @param hf_stream The stream index field, an unsigned integer.
+ */
+WS_DLL_PUBLIC void conversation_index_register_field(const int hf_stream);
+
+/**
+ * Record that the current frame has the given value of a stream index
+ * field. Must be called wherever the field is added to the tree, with or
+ * without a tree, so that the index holds every frame the field could
+ * match. Does nothing once the frame has been visited.
+ * @param pinfo Packet info.
+ * @param hf_stream A field registered with conversation_index_register_field().
+ * @param stream The value of the field.
+ */
+WS_DLL_PUBLIC void conversation_index_add_frame(const packet_info *pinfo, const int hf_stream, const uint32_t stream);
+
+/**
+ * Check whether a display filter is a single equality test of an indexed
+ * field, e.g. "tcp.stream eq 3", and if so get the frames it can match.
+ * Frames that have not been visited yet are not in the index and must be
+ * checked separately. The iterator is valid until the capture file is
+ * closed or redissected; frames added meanwhile are returned as well.
+ * @param dftext The display filter.
+ * @param iter Set to iterate over the matching frames, in increasing order.
+ * @return true if the filter can be answered with the index.
+ */
+WS_DLL_PUBLIC bool conversation_index_filter_frames(const char *dftext, conversation_frame_iter_t *iter);
+
+/**
+ * Get the next frame of a stream.
+ * @param iter An iterator set up by conversation_index_filter_frames().
+ * @param frame Set to the frame number.
+ * @return false if there are no more frames.
+ */
+WS_DLL_PUBLIC bool conversation_frame_iter_next(conversation_frame_iter_t *iter, uint32_t *frame);
+
 /**
  * @brief Get a hash table of conversation hash table.
  *
@@ -218,11 +218,10 @@ conversation_hash(const void *v)
     const conv_key_t *key = (const conv_key_t *)v;
     unsigned hash_val;
 
-    hash_val = 0;
-    hash_val = add_address_to_hash(hash_val, &key->addr1);
-    hash_val += key->port1;
-    hash_val = add_address_to_hash(hash_val, &key->addr2);
-    hash_val += key->port2;
+    hash_val = key->addr1;
+    hash_val = hash_val * 31 + key->port1;
+    hash_val = hash_val * 31 + key->addr2;
+    hash_val = hash_val * 31 + key->port2;
     hash_val ^= key->conv_id;
 
     return hash_val;
@@ -245,15 +244,15 @@ conversation_equal(const void *key1, const void *key2)
     {
         if (ck1->port1 == ck2->port1 &&
             ck1->port2 == ck2->port2 &&
-            addresses_equal(&ck1->addr1, &ck2->addr1) &&
-            addresses_equal(&ck1->addr2, &ck2->addr2)) {
+            ck1->addr1 == ck2->addr1 &&
+            ck1->addr2 == ck2->addr2) {
             return TRUE;
         }
 
         if (ck1->port2 == ck2->port1 &&
             ck1->port1 == ck2->port2 &&
-            addresses_equal(&ck1->addr2, &ck2->addr1) &&
-            addresses_equal(&ck1->addr1, &ck2->addr2)) {
+            ck1->addr2 == ck2->addr1 &&
+            ck1->addr1 == ck2->addr2) {
             return TRUE;
         }
     }
@@ -272,14 +271,9 @@ reset_conversation_table_data(conv_hash_t *ch)
     }
 
     if (ch->conv_array != NULL) {
-        unsigned i;
-        for(i = 0; i < ch->conv_array->len; i++){
-            conv_item_t *conv = &g_array_index(ch->conv_array, conv_item_t, i);
-            free_address(&conv->src_address);
-            free_address(&conv->dst_address);
-        }
-
+        /* The addresses of the conversations belong to the pool. */
         g_array_free(ch->conv_array, true);
+        address_pool_free(ch->addresses);
     }
 
     if (ch->hashtable != NULL) {
@@ -288,6 +282,7 @@ reset_conversation_table_data(conv_hash_t *ch)
 
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->addresses=NULL;
 }
 
 void reset_endpoint_table_data(conv_hash_t *ch)
@@ -297,13 +292,9 @@ void reset_endpoint_table_data(conv_hash_t *ch)
     }
 
     if (ch->conv_array != NULL) {
-        unsigned i;
-        for(i = 0; i < ch->conv_array->len; i++){
-            endpoint_item_t *endpoint = &g_array_index(ch->conv_array, endpoint_item_t, i);
-            free_address(&endpoint->myaddress);
-        }
-
+        /* The addresses of the endpoints belong to the pool. */
         g_array_free(ch->conv_array, true);
+        address_pool_free(ch->addresses);
     }
 
     if (ch->hashtable != NULL) {
@@ -312,6 +303,7 @@ void reset_endpoint_table_data(conv_hash_t *ch)
 
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->addresses=NULL;
 }
 
 /* For backwards source and binary compatibility */
@@ -664,6 +656,7 @@ add_conversation_table_data_with_conv_id(
 {
     conv_item_t *conv_item = NULL;
     bool is_fwd_direction = false; /* direction of any conversation found */
+    uint32_t src_id, dst_id;
 
     /* if we don't have any entries at all yet */
     if (ch->conv_array == NULL) {
@@ -673,14 +666,22 @@ add_conversation_table_data_with_conv_id(
                                               conversation_equal, /* key_equal_func */
                                               g_free,             /* key_destroy_func */
                                               NULL);              /* value_destroy_func */
+        ch->addresses = address_pool_new();
 
+        src_id = dst_id = ADDRESS_POOL_NO_ID;
     } else { /* try to find it among the existing known conversations */
+        /* no conversation has an address the pool doesn't know */
+        src_id = address_pool_lookup(ch->addresses, src);
+        dst_id = address_pool_lookup(ch->addresses, dst);
+    }
+
+    if (src_id != ADDRESS_POOL_NO_ID && dst_id != ADDRESS_POOL_NO_ID) {
         /* first, check in the fwd conversations */
         conv_key_t existing_key;
         void *conversation_idx_hash_val;
 
-        existing_key.addr1 = *src;
-        existing_key.addr2 = *dst;
+        existing_key.addr1 = src_id;
+        existing_key.addr2 = dst_id;
         existing_key.port1 = src_port;
         existing_key.port2 = dst_port;
         existing_key.conv_id = conv_id;
@@ -689,8 +690,8 @@ add_conversation_table_data_with_conv_id(
         }
         if (conv_item == NULL) {
             /* then, check in the rev conversations if not found in 'fwd' */
-            existing_key.addr1 = *dst;
-            existing_key.addr2 = *src;
+            existing_key.addr1 = dst_id;
+            existing_key.addr2 = src_id;
             existing_key.port1 = dst_port;
             existing_key.port2 = src_port;
             if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
@@ -709,8 +710,11 @@ add_conversation_table_data_with_conv_id(
         conv_item_t new_conv_item;
         unsigned int conversation_idx;
 
-        copy_address(&new_conv_item.src_address, src);
-        copy_address(&new_conv_item.dst_address, dst);
+        /* the conversation shares the pool's copies of its addresses */
+        src_id = address_pool_intern(ch->addresses, src);
+        dst_id = address_pool_intern(ch->addresses, dst);
+        copy_address_shallow(&new_conv_item.src_address, address_pool_get(ch->addresses, src_id));
+        copy_address_shallow(&new_conv_item.dst_address, address_pool_get(ch->addresses, dst_id));
         new_conv_item.dissector_info = ct_info;
         new_conv_item.ctype = ctype;
         new_conv_item.src_port = src_port;
@@ -738,10 +742,9 @@ add_conversation_table_data_with_conv_id(
         conversation_idx = ch->conv_array->len - 1;
         conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
 
-        /* ct->conversations address is not a constant but src/dst_address.data are */
         new_key = g_new(conv_key_t, 1);
-        set_address(&new_key->addr1, conv_item->src_address.type, conv_item->src_address.len, conv_item->src_address.data);
-        set_address(&new_key->addr2, conv_item->dst_address.type, conv_item->dst_address.len, conv_item->dst_address.data);
+        new_key->addr1 = src_id;
+        new_key->addr2 = dst_id;
         new_key->port1 = src_port;
         new_key->port2 = dst_port;
         new_key->conv_id = conv_id;
@@ -899,9 +902,8 @@ endpoint_hash(const void *v)
     const endpoint_key_t *key = (const endpoint_key_t *)v;
     unsigned hash_val;
 
-    hash_val = 0;
-    hash_val = add_address_to_hash(hash_val, &key->myaddress);
-    hash_val += key->port;
+    hash_val = key->myaddress;
+    hash_val = hash_val * 31 + key->port;
     return hash_val;
 }
 
@@ -915,7 +917,7 @@ endpoint_match(const void *v, const void *w)
     const endpoint_key_t *v2 = (const endpoint_key_t *)w;
 
     if (v1->port == v2->port &&
-        addresses_equal(&v1->myaddress, &v2->myaddress)) {
+        v1->myaddress == v2->myaddress) {
         return 1;
     }
     /*
@@ -928,6 +930,7 @@ void
 add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, bool sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype)
 {
     endpoint_item_t *endpoint_item = NULL;
+    uint32_t addr_id = ADDRESS_POOL_NO_ID;
 
     /* XXX should be optimized to allocate n extra entries at a time
        instead of just one */
@@ -938,13 +941,19 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
                                               endpoint_match, /* key_equal_func */
                                               g_free,     /* key_destroy_func */
                                               NULL);      /* value_destroy_func */
+        ch->addresses = address_pool_new();
     }
     else {
+        /* no endpoint has an address the pool doesn't know */
+        addr_id = address_pool_lookup(ch->addresses, addr);
+    }
+
+    if (addr_id != ADDRESS_POOL_NO_ID) {
         /* try to find it among the existing known conversations */
         endpoint_key_t existing_key;
         void *endpoint_idx_hash_val;
 
-        copy_address_shallow(&existing_key.myaddress, addr);
+        existing_key.myaddress = addr_id;
         existing_key.port = port;
 
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &endpoint_idx_hash_val)) {
@@ -959,7 +968,9 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         endpoint_item_t new_endpoint_item;
         unsigned int endpoint_idx;
 
-        copy_address(&new_endpoint_item.myaddress, addr);
+        /* the endpoint shares the pool's copy of its address */
+        addr_id = address_pool_intern(ch->addresses, addr);
+        copy_address_shallow(&new_endpoint_item.myaddress, address_pool_get(ch->addresses, addr_id));
         new_endpoint_item.dissector_info = et_info;
         new_endpoint_item.etype=etype;
         new_endpoint_item.port=port;
@@ -978,9 +989,8 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         endpoint_idx = ch->conv_array->len - 1;
         endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
 
-        /* hl->hosts address is not a constant but address.data is */
         new_key = g_new(endpoint_key_t,1);
-        set_address(&new_key->myaddress, endpoint_item->myaddress.type, endpoint_item->myaddress.len, endpoint_item->myaddress.data);
+        new_key->myaddress = addr_id;
         new_key->port = port;
         g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(endpoint_idx));
     }
@@ -15,6 +15,7 @@
 #include "conv_id.h"
 #include "tap.h"
 #include "conversation.h"
+#include <epan/address_pool.h>
 #include <epan/wmem_scopes.h>
 
 #ifdef __cplusplus
@@ -48,26 +49,31 @@ typedef enum {
 } conv_direction_e;
 
 /** Conversation hash + value storage
- * Hash table keys are conv_key_t. Hash table values are indexes into conv_array.
+ * Hash table keys are conv_key_t or endpoint_key_t. Hash table values are
+ * indexes into conv_array. The addresses of the items are interned in
+ * addresses, and the keys hold their ids. hashtable and addresses are
+ * created along with conv_array, and all of them are freed when the table
+ * is reset; addresses only grows until then.
  */
 typedef struct _conversation_hash_t {
     GHashTable  *hashtable;       /**< conversations hash table */
     GArray      *conv_array;      /**< array of conversation values */
     void        *user_data;       /**< "GUI" specifics (if necessary) */
     unsigned    flags;            /**< flags given to the tap packet */
+    address_pool_t *addresses;    /**< addresses of the conversations */
 } conv_hash_t;
 
-/** Key for hash lookups */
+/** Key for hash lookups. The addresses are ids in conv_hash_t addresses. */
 typedef struct _conversation_key_t {
-    address     addr1;
-    address     addr2;
+    uint32_t    addr1;
+    uint32_t    addr2;
     uint32_t    port1;
     uint32_t    port2;
     conv_id_t   conv_id;
 } conv_key_t;
 
 typedef struct {
-    address  myaddress;
+    uint32_t myaddress;
     uint32_t port;
 } endpoint_key_t;
 
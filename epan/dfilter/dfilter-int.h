@@ -38,6 +38,11 @@ struct epan_dfilter {
 	df_cell_t	*registers;
 	int		*interesting_fields;
 	int		num_interesting_fields;
+	/* Fields that must be present for the filter to match, in
+	 * conjunctive normal form: an array of clauses, each clause an
+	 * array of header_field_info of which at least one must be in
+	 * the tree. NULL if nothing is known. */
+	GPtrArray	*required_fields;
 	GPtrArray	*deprecated;
 	GSList		*warnings;
 	char		*expanded_text;
@@ -47,6 +52,9 @@ struct epan_dfilter {
 	/* Used to pass arguments to functions. List of Lists (list of registers). */
 	GSList		*function_stack;
 	GSList		*set_stack;
+	/* Instruction counts and times by opcode, NULL unless enabled
+	 * with dfilter_enable_opcode_stats(). */
+	struct dfvm_opcode_counter *opcode_counters;
 };
 
 typedef struct {
@@ -81,6 +89,7 @@ typedef struct {
 	GHashTable	*loaded_fields;
 	GHashTable	*loaded_raw_fields;
 	GHashTable	*interesting_fields;
+	GPtrArray	*required_fields;
 	int		next_insn_id;
 	int		next_register;
 	GPtrArray	*deprecated;
@@ -0,0 +1,205 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+#define WS_LOG_DOMAIN LOG_DOMAIN_DFILTER
+
+#include <string.h>
+
+#include "dfilter-int.h"
+#include "dfvm.h"
+#include <epan/epan_dissect.h>
+#include <wsutil/array.h>
+
+/*
+ * A set of filters applied in order to the same packet.
+ *
+ * Each filter carries the fields it needs to match (required_fields, see
+ * gencode.c). The set collects the distinct fields of all its filters and
+ * turns each filter's requirements into a guard of indexes into that list:
+ *
+ *   num_clauses, { num_fields, field_index... } * num_clauses
+ *
+ * While applying the set, whether a field is in the tree is looked up at
+ * most once per packet and shared by all filters, and a filter is only run
+ * if its guard holds. With a typical list of coloring rules most of them
+ * test for a protocol that is not in the packet at all.
+ */
+
+enum {
+	FIELD_UNKNOWN = 0,
+	FIELD_ABSENT,
+	FIELD_PRESENT
+};
+
+struct epan_dfilter_set {
+	GPtrArray	*filters;	/* dfilter_t *, not owned */
+	GArray		*guard_offsets;	/* unsigned, offset in guards per filter */
+	GArray		*guards;	/* unsigned */
+	GPtrArray	*fields;	/* header_field_info * */
+	uint8_t		*field_state;	/* FIELD_*, one per field */
+	unsigned	field_state_size;
+};
+
+dfilter_set_t *
+dfilter_set_new(void)
+{
+	dfilter_set_t *set = g_new0(dfilter_set_t, 1);
+
+	set->filters = g_ptr_array_new();
+	set->guard_offsets = g_array_new(false, false, sizeof(unsigned));
+	set->guards = g_array_new(false, false, sizeof(unsigned));
+	set->fields = g_ptr_array_new();
+
+	return set;
+}
+
+void
+dfilter_set_free(dfilter_set_t *set)
+{
+	if (!set)
+		return;
+
+	g_ptr_array_free(set->filters, true);
+	g_array_free(set->guard_offsets, true);
+	g_array_free(set->guards, true);
+	g_ptr_array_free(set->fields, true);
+	g_free(set->field_state);
+	g_free(set);
+}
+
+static unsigned
+field_index(dfilter_set_t *set, header_field_info *hfinfo)
+{
+	unsigned idx;
+
+	if (!g_ptr_array_find(set->fields, hfinfo, &idx)) {
+		idx = set->fields->len;
+		g_ptr_array_add(set->fields, hfinfo);
+	}
+	return idx;
+}
+
+static void
+guard_append(dfilter_set_t *set, unsigned val)
+{
+	g_array_append_val(set->guards, val);
+}
+
+unsigned
+dfilter_set_add(dfilter_set_t *set, dfilter_t *df)
+{
+	GPtrArray *clause;
+	unsigned offset = set->guards->len;
+	unsigned num_clauses = df->required_fields ? df->required_fields->len : 0;
+
+	guard_append(set, num_clauses);
+	for (unsigned i = 0; i < num_clauses; i++) {
+		clause = g_ptr_array_index(df->required_fields, i);
+		guard_append(set, clause->len);
+		for (unsigned j = 0; j < clause->len; j++) {
+			guard_append(set, field_index(set, g_ptr_array_index(clause, j)));
+		}
+	}
+
+	g_array_append_val(set->guard_offsets, offset);
+	g_ptr_array_add(set->filters, df);
+
+	return set->filters->len - 1;
+}
+
+unsigned
+dfilter_set_count(const dfilter_set_t *set)
+{
+	return set->filters->len;
+}
+
+/* Same test as DFVM_CHECK_EXISTS without a layer range. */
+static bool
+field_present(dfilter_set_t *set, proto_tree *tree, unsigned idx)
+{
+	header_field_info *hfinfo;
+	GPtrArray *finfos;
+
+	if (set->field_state[idx] != FIELD_UNKNOWN)
+		return set->field_state[idx] == FIELD_PRESENT;
+
+	set->field_state[idx] = FIELD_ABSENT;
+	for (hfinfo = g_ptr_array_index(set->fields, idx); hfinfo; hfinfo = hfinfo->same_name_next) {
+		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
+		if (finfos != NULL && g_ptr_array_len(finfos) > 0) {
+			set->field_state[idx] = FIELD_PRESENT;
+			break;
+		}
+	}
+	return set->field_state[idx] == FIELD_PRESENT;
+}
+
+static bool
+guard_holds(dfilter_set_t *set, proto_tree *tree, unsigned filter)
+{
+	const unsigned *guard;
+	unsigned num_clauses, num_fields;
+	bool clause_holds;
+
+	guard = &g_array_index(set->guards, unsigned,
+			g_array_index(set->guard_offsets, unsigned, filter));
+	num_clauses = *guard++;
+
+	for (unsigned i = 0; i < num_clauses; i++) {
+		num_fields = *guard++;
+		clause_holds = false;
+		for (unsigned j = 0; j < num_fields && !clause_holds; j++) {
+			clause_holds = field_present(set, tree, guard[j]);
+		}
+		if (!clause_holds)
+			return false;
+		guard += num_fields;
+	}
+
+	return true;
+}
+
+int
+dfilter_set_apply(dfilter_set_t *set, proto_tree *tree)
+{
+	if (set->field_state_size != set->fields->len) {
+		set->field_state_size = set->fields->len;
+		set->field_state = g_renew(uint8_t, set->field_state, set->field_state_size);
+	}
+	if (set->field_state_size > 0)
+		memset(set->field_state, FIELD_UNKNOWN, set->field_state_size);
+
+	for (unsigned i = 0; i < set->filters->len; i++) {
+		if (guard_holds(set, tree, i) &&
+				dfvm_apply(g_ptr_array_index(set->filters, i), tree)) {
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
+
+int
+dfilter_set_apply_edt(dfilter_set_t *set, epan_dissect_t *edt)
+{
+	return dfilter_set_apply(set, edt->tree);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
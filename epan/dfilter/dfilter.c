@@ -179,6 +179,9 @@ dfilter_free(dfilter_t *df)
 
 	g_free(df->interesting_fields);
 
+	if (df->required_fields)
+		g_ptr_array_unref(df->required_fields);
+
 	g_hash_table_destroy(df->references);
 	g_hash_table_destroy(df->raw_references);
 
@@ -201,6 +204,7 @@ dfilter_free(dfilter_t *df)
 	g_free(df->registers);
 	g_free(df->expanded_text);
 	g_free(df->syntax_tree_str);
+	g_free(df->opcode_counters);
 	g_free(df);
 }
 
@@ -281,6 +285,10 @@ dfwork_free(dfwork_t *dfw)
 		g_hash_table_destroy(dfw->interesting_fields);
 	}
 
+	if (dfw->required_fields) {
+		g_ptr_array_unref(dfw->required_fields);
+	}
+
 	if (dfw->references) {
 		g_hash_table_destroy(dfw->references);
 	}
@@ -493,6 +501,8 @@ dfwork_build(dfwork_t *dfw)
 	dfw->insns = NULL;
 	dfilter->interesting_fields = dfw_interesting_fields(dfw,
 		&dfilter->num_interesting_fields);
+	dfilter->required_fields = dfw->required_fields;
+	dfw->required_fields = NULL;
 	dfilter->expanded_text = dfw->expanded_text;
 	dfw->expanded_text = NULL;
 	dfilter->references = dfw->references;
@@ -786,6 +796,35 @@ dfilter_get_warnings(dfilter_t *df)
 	return df->warnings;
 }
 
+void
+dfilter_enable_opcode_stats(dfilter_t *df, bool enable)
+{
+	g_free(df->opcode_counters);
+	df->opcode_counters = NULL;
+	if (enable)
+		df->opcode_counters = g_new0(dfvm_opcode_counter_t, DFVM_NUM_OPCODES);
+}
+
+GArray *
+dfilter_get_opcode_stats(const dfilter_t *df)
+{
+	GArray *stats = g_array_new(false, false, sizeof(dfilter_opcode_stats_t));
+	dfilter_opcode_stats_t entry;
+
+	if (df->opcode_counters == NULL)
+		return stats;
+
+	for (int op = 0; op < DFVM_NUM_OPCODES; op++) {
+		if (df->opcode_counters[op].count == 0)
+			continue;
+		entry.opcode = dfvm_opcode_tostr(op);
+		entry.count = df->opcode_counters[op].count;
+		entry.elapsed_ns = df->opcode_counters[op].elapsed_ns;
+		g_array_append_val(stats, entry);
+	}
+	return stats;
+}
+
 void
 dfilter_dump(FILE *fp, dfilter_t *df, uint16_t flags)
 {
@@ -126,6 +126,43 @@ dfilter_apply_edt(dfilter_t *df, struct epan_dissect *edt);
 bool
 dfilter_apply(dfilter_t *df, proto_tree *tree);
 
+/* A list of compiled dfilters that are applied to the same packets, in
+ * order, to find the first one that matches (e.g. coloring rules). Fields
+ * that a filter needs in order to match at all are looked up once per
+ * packet for the whole set, and filters whose fields are missing are
+ * skipped without being run. */
+typedef struct epan_dfilter_set dfilter_set_t;
+
+WS_DLL_PUBLIC
+dfilter_set_t *
+dfilter_set_new(void);
+
+/* Frees the set, but not the dfilters in it. */
+WS_DLL_PUBLIC
+void
+dfilter_set_free(dfilter_set_t *set);
+
+/* Appends a dfilter to the set and returns its index. The dfilter is not
+ * copied and must stay alive as long as the set is used. */
+WS_DLL_PUBLIC
+unsigned
+dfilter_set_add(dfilter_set_t *set, dfilter_t *df);
+
+WS_DLL_PUBLIC
+unsigned
+dfilter_set_count(const dfilter_set_t *set);
+
+/* Returns the index of the first dfilter in the set that matches,
+ * or -1 if none does. */
+WS_DLL_PUBLIC
+int
+dfilter_set_apply_edt(dfilter_set_t *set, struct epan_dissect *edt);
+
+/* Like dfilter_set_apply_edt(), for an already dissected proto_tree. */
+WS_DLL_PUBLIC
+int
+dfilter_set_apply(dfilter_set_t *set, proto_tree *tree);
+
 /* Apply compiled dfilter and return final set of fvalues (if they
  * exist) in addition to true/false determination. */
 bool
@@ -180,6 +217,27 @@ WS_DLL_PUBLIC
 GSList *
 dfilter_get_warnings(dfilter_t *df);
 
+/* Instructions of one opcode executed by a dfilter. */
+typedef struct {
+	const char	*opcode;
+	uint64_t	count;
+	uint64_t	elapsed_ns;
+} dfilter_opcode_stats_t;
+
+/* Count and time the instructions executed each time the dfilter is
+ * applied, by opcode. Enabling clears the counters. This reads the clock
+ * for every instruction, so it slows down applying the filter and the
+ * times include that overhead; it is meant for benchmarking. */
+WS_DLL_PUBLIC
+void
+dfilter_enable_opcode_stats(dfilter_t *df, bool enable);
+
+/* Returns a GArray of dfilter_opcode_stats_t, in opcode order, for the
+ * opcodes executed at least once. Free it with g_array_free(). */
+WS_DLL_PUBLIC
+GArray *
+dfilter_get_opcode_stats(const dfilter_t *df);
+
 #define DF_DUMP_REFERENCES	(1U << 0)
 #define DF_DUMP_SHOW_FTYPE	(1U << 1)
 
@@ -13,6 +13,7 @@
 
 #include <ftypes/ftypes.h>
 #include <wsutil/array.h>
+#include <wsutil/time_util.h>
 #include <wsutil/ws_assert.h>
 
 static void
@@ -1649,6 +1650,23 @@ check_exists(proto_tree *tree, dfvm_value_t *arg1, dfvm_value_t *arg2)
 	return false;
 }
 
+/* Charges the time since the previous instruction started to its opcode
+ * and starts timing the next one, if any. The clock is read once per
+ * instruction, so its own cost is included in the times. */
+static void
+count_opcode(dfvm_opcode_counter_t *counters, dfvm_opcode_t *op,
+		uint64_t *start_ns, dfvm_opcode_t next_op)
+{
+	uint64_t now = ws_clock_get_monotonic_ns();
+
+	if (*op != DFVM_NULL)
+		counters[*op].elapsed_ns += now - *start_ns;
+	if (next_op != DFVM_NULL)
+		counters[next_op].count++;
+	*op = next_op;
+	*start_ns = now;
+}
+
 bool
 dfvm_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals)
 {
@@ -1658,6 +1676,9 @@ dfvm_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals)
 	dfvm_value_t	*arg1;
 	dfvm_value_t	*arg2;
 	dfvm_value_t	*arg3 = NULL;
+	dfvm_opcode_counter_t *counters = df->opcode_counters;
+	dfvm_opcode_t	counted_op = DFVM_NULL;
+	uint64_t	counted_start = 0;
 
 	ws_assert(tree);
 
@@ -1671,6 +1692,9 @@ dfvm_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals)
 		arg2 = insn->arg2;
 		arg3 = insn->arg3;
 
+		if (G_UNLIKELY(counters != NULL))
+			count_opcode(counters, &counted_op, &counted_start, insn->op);
+
 		switch (insn->op) {
 			case DFVM_CHECK_EXISTS:
 				accum = check_exists(tree, arg1, NULL);
@@ -1860,6 +1884,8 @@ dfvm_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals)
 					}
 				}
 				free_register_overhead(df);
+				if (G_UNLIKELY(counters != NULL))
+					count_opcode(counters, &counted_op, &counted_start, DFVM_NULL);
 				return accum;
 
 			case DFVM_NO_OP:
@@ -102,9 +102,16 @@ typedef enum {
 	DFVM_NO_OP,
 } dfvm_opcode_t;
 
+#define DFVM_NUM_OPCODES	(DFVM_NO_OP + 1)
+
 const char *
 dfvm_opcode_tostr(dfvm_opcode_t code);
 
+typedef struct dfvm_opcode_counter {
+	uint64_t	count;
+	uint64_t	elapsed_ns;
+} dfvm_opcode_counter_t;
+
 typedef struct {
 	int		id;
 	dfvm_opcode_t	op;
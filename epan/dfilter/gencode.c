@@ -918,9 +918,164 @@ optimize(dfwork_t *dfw)
 	}
 }
 
+/*
+ * Required fields.
+ *
+ * Work out from the syntax tree which fields have to be present in the
+ * tree for the filter to possibly match, so that callers that apply many
+ * filters to the same packet (see dfilter-set.c) can skip a filter without
+ * running it. The result is in conjunctive normal form: a list of clauses,
+ * each a list of fields at least one of which must be present.
+ *
+ * This only ever needs to be a necessary condition, so anything that
+ * doesn't fit is dropped: negations, function calls (count() and friends
+ * are fine with missing fields), references, clauses or lists that grow
+ * past the limits below.
+ */
+#define REQUIRED_MAX_CLAUSES	8
+#define REQUIRED_MAX_FIELDS	8
+
+static GPtrArray *
+required_new(void)
+{
+	return g_ptr_array_new_with_free_func((GDestroyNotify)g_ptr_array_unref);
+}
+
+static void
+required_add_clause(GPtrArray *req, GPtrArray *clause)
+{
+	if (req->len < REQUIRED_MAX_CLAUSES && clause->len <= REQUIRED_MAX_FIELDS)
+		g_ptr_array_add(req, clause);
+	else
+		g_ptr_array_unref(clause);
+}
+
+/* a AND b: all clauses of both. Consumes both arguments. */
+static GPtrArray *
+required_and(GPtrArray *a, GPtrArray *b)
+{
+	for (unsigned i = 0; i < b->len; i++) {
+		required_add_clause(a, g_ptr_array_ref(g_ptr_array_index(b, i)));
+	}
+	g_ptr_array_unref(b);
+	return a;
+}
+
+/* a OR b: the pairwise unions of their clauses. Consumes both arguments. */
+static GPtrArray *
+required_or(GPtrArray *a, GPtrArray *b)
+{
+	GPtrArray *req = required_new();
+	GPtrArray *ca, *cb, *clause;
+
+	for (unsigned i = 0; i < a->len; i++) {
+		ca = g_ptr_array_index(a, i);
+		for (unsigned j = 0; j < b->len; j++) {
+			cb = g_ptr_array_index(b, j);
+			clause = g_ptr_array_sized_new(ca->len + cb->len);
+			for (unsigned k = 0; k < ca->len; k++) {
+				g_ptr_array_add(clause, g_ptr_array_index(ca, k));
+			}
+			for (unsigned k = 0; k < cb->len; k++) {
+				if (!g_ptr_array_find(clause, g_ptr_array_index(cb, k), NULL))
+					g_ptr_array_add(clause, g_ptr_array_index(cb, k));
+			}
+			required_add_clause(req, clause);
+		}
+	}
+	g_ptr_array_unref(a);
+	g_ptr_array_unref(b);
+	return req;
+}
+
+static GPtrArray *
+required_field(stnode_t *st_node)
+{
+	GPtrArray *req = required_new();
+	GPtrArray *clause = g_ptr_array_new();
+	header_field_info *hfinfo = sttype_field_hfinfo(st_node);
+
+	/* Rewind to find the first field of this name. */
+	while (hfinfo->same_name_prev_id != -1) {
+		hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+	}
+	g_ptr_array_add(clause, hfinfo);
+	required_add_clause(req, clause);
+	return req;
+}
+
+/* An entity that is loaded with gen_entity(): the relation is false if it
+ * fails to load. */
+static GPtrArray *
+required_entity(stnode_t *st_arg)
+{
+	stnode_op_t	st_op;
+	stnode_t	*left, *right;
+
+	switch (stnode_type_id(st_arg)) {
+		case STTYPE_FIELD:
+			return required_field(st_arg);
+		case STTYPE_SLICE:
+			return required_entity(sttype_slice_entity(st_arg));
+		case STTYPE_ARITHMETIC:
+			sttype_oper_get(st_arg, &st_op, &left, &right);
+			if (right == NULL)
+				return required_entity(left);
+			return required_and(required_entity(left), required_entity(right));
+		default:
+			return required_new();
+	}
+}
+
+static GPtrArray *
+required_test(stnode_t *st_node)
+{
+	stnode_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+
+	switch (stnode_type_id(st_node)) {
+		case STTYPE_TEST:
+			break;
+		case STTYPE_FIELD:
+		case STTYPE_SLICE:
+		case STTYPE_ARITHMETIC:
+			return required_entity(st_node);
+		default:
+			return required_new();
+	}
+
+	sttype_oper_get(st_node, &st_op, &st_arg1, &st_arg2);
+
+	switch (st_op) {
+		case STNODE_OP_NOT:
+			return required_new();
+		case STNODE_OP_AND:
+			return required_and(required_test(st_arg1), required_test(st_arg2));
+		case STNODE_OP_OR:
+			return required_or(required_test(st_arg1), required_test(st_arg2));
+		case STNODE_OP_IN:
+		case STNODE_OP_NOT_IN:
+			/* Missing set elements are skipped, a missing LHS is false. */
+			return required_entity(st_arg1);
+		default:
+			return required_and(required_entity(st_arg1), required_entity(st_arg2));
+	}
+}
+
 void
 dfw_gencode(dfwork_t *dfw)
 {
+	GPtrArray *required;
+
+	/* Must come first, generating code steals data from the tree. */
+	required = required_test(dfw->st_root);
+	if (required->len > 0) {
+		dfw->required_fields = required;
+	}
+	else {
+		g_ptr_array_unref(required);
+	}
+
 	dfw->insns = g_ptr_array_new();
 	dfw->loaded_fields = g_hash_table_new(g_direct_hash, g_direct_equal);
 	dfw->loaded_raw_fields = g_hash_table_new(g_direct_hash, g_direct_equal);
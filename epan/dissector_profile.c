@@ -0,0 +1,171 @@
+/* dissector_profile.c
+ * Per-protocol CPU time and allocation profiling of dissectors
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <epan/wmem_scopes.h>
+#include <wsutil/time_util.h>
+
+#include "dissector_profile.h"
+
+typedef struct {
+    uint64_t calls;
+    uint64_t inclusive_ns;
+    uint64_t exclusive_ns;
+    uint64_t inclusive_bytes;
+    uint64_t exclusive_bytes;
+    unsigned active;        /* Calls of this protocol in progress */
+} profile_counters_t;
+
+bool dissector_profile_active;
+
+/* profile_counters_t, indexed by protocol ID */
+static GArray *profile_counters;
+
+/* Innermost profiled dissector call in progress */
+static dissector_profile_frame_t *current_frame;
+
+/* The scopes dissectors allocate from, the packet scope by far the most. */
+static inline uint64_t
+profile_allocated_bytes(packet_info *pinfo)
+{
+    uint64_t bytes;
+
+    bytes = wmem_allocated_bytes(wmem_file_scope()) +
+            wmem_allocated_bytes(wmem_epan_scope());
+    if (pinfo->pool != NULL)
+        bytes += wmem_allocated_bytes(pinfo->pool);
+    return bytes;
+}
+
+static profile_counters_t *
+profile_counters_get(int proto_id)
+{
+    if (profile_counters == NULL)
+        profile_counters = g_array_new(false, true, sizeof(profile_counters_t));
+    if ((unsigned)proto_id >= profile_counters->len)
+        g_array_set_size(profile_counters, proto_id + 1);
+    return &g_array_index(profile_counters, profile_counters_t, proto_id);
+}
+
+void
+dissector_profile_enable(bool enable)
+{
+    dissector_profile_active = enable;
+}
+
+bool
+dissector_profile_enabled(void)
+{
+    return dissector_profile_active;
+}
+
+void
+dissector_profile_reset(void)
+{
+    profile_counters_t *counters;
+
+    if (profile_counters == NULL)
+        return;
+
+    for (unsigned i = 0; i < profile_counters->len; i++) {
+        counters = &g_array_index(profile_counters, profile_counters_t, i);
+        /* Keep the nesting state of calls in progress. */
+        *counters = (profile_counters_t){ .active = counters->active };
+    }
+}
+
+static int
+compare_exclusive_ns(const void *a, const void *b)
+{
+    const dissector_profile_stats_t *stats_a = (const dissector_profile_stats_t *)a;
+    const dissector_profile_stats_t *stats_b = (const dissector_profile_stats_t *)b;
+
+    if (stats_a->exclusive_ns != stats_b->exclusive_ns)
+        return stats_a->exclusive_ns < stats_b->exclusive_ns ? 1 : -1;
+    return stats_a->proto_id - stats_b->proto_id;
+}
+
+GArray *
+dissector_profile_get_stats(void)
+{
+    GArray *stats = g_array_new(false, false, sizeof(dissector_profile_stats_t));
+    profile_counters_t *counters;
+    dissector_profile_stats_t entry;
+
+    if (profile_counters == NULL)
+        return stats;
+
+    for (unsigned i = 0; i < profile_counters->len; i++) {
+        counters = &g_array_index(profile_counters, profile_counters_t, i);
+        if (counters->calls == 0)
+            continue;
+        entry.proto_id = (int)i;
+        entry.calls = counters->calls;
+        entry.inclusive_ns = counters->inclusive_ns;
+        entry.exclusive_ns = counters->exclusive_ns;
+        entry.inclusive_bytes = counters->inclusive_bytes;
+        entry.exclusive_bytes = counters->exclusive_bytes;
+        g_array_append_val(stats, entry);
+    }
+    g_array_sort(stats, compare_exclusive_ns);
+
+    return stats;
+}
+
+void
+dissector_profile_enter(dissector_profile_frame_t *frame, packet_info *pinfo, int proto_id)
+{
+    profile_counters_get(proto_id)->active++;
+
+    frame->parent = current_frame;
+    frame->proto_id = proto_id;
+    frame->child_ns = 0;
+    frame->child_bytes = 0;
+    frame->start_bytes = profile_allocated_bytes(pinfo);
+    /* Read the clock last so that the bookkeeping isn't charged. */
+    frame->start_ns = ws_clock_get_monotonic_ns();
+    current_frame = frame;
+}
+
+void
+dissector_profile_leave(dissector_profile_frame_t *frame, packet_info *pinfo)
+{
+    uint64_t elapsed_ns = ws_clock_get_monotonic_ns() - frame->start_ns;
+    uint64_t bytes = profile_allocated_bytes(pinfo) - frame->start_bytes;
+    profile_counters_t *counters = profile_counters_get(frame->proto_id);
+
+    counters->calls++;
+    counters->exclusive_ns += elapsed_ns - frame->child_ns;
+    counters->exclusive_bytes += bytes - frame->child_bytes;
+    if (--counters->active == 0) {
+        counters->inclusive_ns += elapsed_ns;
+        counters->inclusive_bytes += bytes;
+    }
+
+    current_frame = frame->parent;
+    if (current_frame != NULL) {
+        current_frame->child_ns += elapsed_ns;
+        current_frame->child_bytes += bytes;
+    }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,96 @@
+/** @file
+ * Per-protocol CPU time and allocation profiling of dissectors
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __DISSECTOR_PROFILE_H__
+#define __DISSECTOR_PROFILE_H__
+
+#include <glib.h>
+#include <ws_symbol_export.h>
+
+#include <epan/packet_info.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * While profiling is enabled, every call of a dissector that belongs to a
+ * protocol, through a handle or from a heuristic list, is timed with the
+ * monotonic clock and the wmem bytes it requests from the packet, file and
+ * epan scopes are counted.
+ *
+ * Inclusive figures cover the dissector and everything it called; a
+ * protocol that calls itself (e.g. IP in IP) is only counted once.
+ * Exclusive figures leave out the time and allocations of the profiled
+ * dissectors it called. Heuristic dissectors that reject the packet count
+ * as calls too, since they cost time all the same.
+ */
+
+typedef struct {
+    int      proto_id;
+    uint64_t calls;
+    uint64_t inclusive_ns;
+    uint64_t exclusive_ns;
+    uint64_t inclusive_bytes;
+    uint64_t exclusive_bytes;
+} dissector_profile_stats_t;
+
+/** Turn profiling on or off. Turning it on doesn't clear earlier figures. */
+WS_DLL_PUBLIC void dissector_profile_enable(bool enable);
+
+/** @return true if profiling is on. */
+WS_DLL_PUBLIC bool dissector_profile_enabled(void);
+
+/** Clear the figures of all protocols. */
+WS_DLL_PUBLIC void dissector_profile_reset(void);
+
+/**
+ * Get the figures of every protocol that was called at least once, sorted
+ * by exclusive time, largest first.
+ *
+ * @return A GArray of dissector_profile_stats_t. Free it with g_array_free().
+ */
+WS_DLL_PUBLIC GArray *dissector_profile_get_stats(void);
+
+/* Used by packet.c around each profiled dissector call. */
+
+typedef struct dissector_profile_frame {
+    struct dissector_profile_frame *parent;
+    int      proto_id;
+    uint64_t start_ns;
+    uint64_t start_bytes;
+    uint64_t child_ns;
+    uint64_t child_bytes;
+} dissector_profile_frame_t;
+
+WS_DLL_LOCAL extern bool dissector_profile_active;
+
+WS_DLL_LOCAL void dissector_profile_enter(dissector_profile_frame_t *frame, packet_info *pinfo, int proto_id);
+
+WS_DLL_LOCAL void dissector_profile_leave(dissector_profile_frame_t *frame, packet_info *pinfo);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __DISSECTOR_PROFILE_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -262,6 +262,7 @@ static const char* st_str_service_unsolicited = "no. of unsolicited responses";
 static const char* st_str_service_retransmission = "no. of retransmissions";
 static const char* st_str_service_rrt = "request-response time (msec)";
 
+static int st_node_packets = -1;
 static int st_node_packet_qr = -1;
 static int st_node_packet_qtypes = -1;
 static int st_node_packet_qnames = -1;
@@ -5154,12 +5155,12 @@ dissect_dns_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
 
 static void dns_stats_tree_init(stats_tree* st)
 {
-  stats_tree_create_node(st, st_str_packets, 0, STAT_DT_INT, true);
-  stat_node_set_flags(st, st_str_packets, 0, false, ST_FLG_SORT_TOP);
+  st_node_packets = stats_tree_create_node(st, st_str_packets, 0, STAT_DT_INT, true);
+  stat_node_set_flags_by_id(st, st_node_packets, ST_FLG_SORT_TOP);
   st_node_packet_qr = stats_tree_create_pivot(st, st_str_packet_qr, 0);
   st_node_packet_qtypes = stats_tree_create_pivot(st, st_str_packet_qtypes, 0);
   st_node_rr_types = stats_tree_create_pivot(st, st_str_rr_types, 0);
-  st_node_packet_qnames = stats_tree_create_pivot(st, st_str_packet_qnames, 0);
+  st_node_packet_qnames = stats_tree_create_pivot_topk(st, st_str_packet_qnames, 0);
   st_node_packet_qclasses = stats_tree_create_pivot(st, st_str_packet_qclasses, 0);
   st_node_packet_rcodes = stats_tree_create_pivot(st, st_str_packet_rcodes, 0);
   st_node_packet_opcodes = stats_tree_create_pivot(st, st_str_packet_opcodes, 0);
@@ -5189,7 +5190,7 @@ static void dns_stats_tree_init(stats_tree* st)
 static tap_packet_status dns_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p, tap_flags_t flags _U_)
 {
   const struct DnsTap *pi = (const struct DnsTap *)p;
-  tick_stat_node(st, st_str_packets, 0, false);
+  tick_stat_node_by_id(st, st_node_packets);
   stats_tree_tick_pivot(st, st_node_packet_qr,
           val_to_str(pi->packet_qr, dns_qr_vals, "Unknown qr (%d)"));
   stats_tree_tick_pivot(st, st_node_packet_qtypes,
@@ -5203,31 +5204,30 @@ static tap_packet_status dns_stats_tree_packet(stats_tree* st, packet_info* pinf
           val_to_str(pi->packet_rcode, rcode_vals, "Unknown rcode (%d)"));
   stats_tree_tick_pivot(st, st_node_packet_opcodes,
           val_to_str(pi->packet_opcode, opcode_vals, "Unknown opcode (%d)"));
-  avg_stat_node_add_value_int(st, st_str_packets_avg_size, 0, false,
-          pi->payload_size);
+  avg_stat_node_add_value_int_by_id(st, st_node_packets_avg_size, pi->payload_size);
 
   /* split up stats for queries and responses */
   if (pi->packet_qr == 0) {
-    avg_stat_node_add_value_int(st, st_str_query_qname_len, 0, false, pi->qname_len);
+    avg_stat_node_add_value_int_by_id(st, st_node_query_qname_len, pi->qname_len);
     switch(pi->qname_labels) {
       case 1:
-        tick_stat_node(st, st_str_query_domains_l1, 0, false);
+        tick_stat_node_by_id(st, st_node_query_domains_l1);
         break;
       case 2:
-        tick_stat_node(st, st_str_query_domains_l2, 0, false);
+        tick_stat_node_by_id(st, st_node_query_domains_l2);
         break;
       case 3:
-        tick_stat_node(st, st_str_query_domains_l3, 0, false);
+        tick_stat_node_by_id(st, st_node_query_domains_l3);
         break;
       default:
-        tick_stat_node(st, st_str_query_domains_lmore, 0, false);
+        tick_stat_node_by_id(st, st_node_query_domains_lmore);
         break;
     }
   } else {
-    avg_stat_node_add_value_int(st, st_str_response_nquestions, 0, false, pi->nquestions);
-    avg_stat_node_add_value_int(st, st_str_response_nanswers, 0, false, pi->nanswers);
-    avg_stat_node_add_value_int(st, st_str_response_nauthorities, 0, false, pi->nauthorities);
-    avg_stat_node_add_value_int(st, st_str_response_nadditionals, 0, false, pi->nadditionals);
+    avg_stat_node_add_value_int_by_id(st, st_node_response_nquestions, pi->nquestions);
+    avg_stat_node_add_value_int_by_id(st, st_node_response_nanswers, pi->nanswers);
+    avg_stat_node_add_value_int_by_id(st, st_node_response_nauthorities, pi->nauthorities);
+    avg_stat_node_add_value_int_by_id(st, st_node_response_nadditionals, pi->nadditionals);
 
     /* add answer types to stats */
     for (wmem_list_frame_t *type_entry = wmem_list_head(pi->rr_types); type_entry != NULL; type_entry = wmem_list_frame_next(type_entry)) {
@@ -5237,19 +5237,19 @@ static tap_packet_status dns_stats_tree_packet(stats_tree* st, packet_info* pinf
     }
 
     if (pi->unsolicited) {
-      tick_stat_node(st, st_str_service_unsolicited, 0, false);
+      tick_stat_node_by_id(st, st_node_service_unsolicited);
     } else {
-        avg_stat_node_add_value_int(st, st_str_response_nquestions, 0, false, pi->nquestions);
-        avg_stat_node_add_value_int(st, st_str_response_nanswers, 0, false, pi->nanswers);
-        avg_stat_node_add_value_int(st, st_str_response_nauthorities, 0, false, pi->nauthorities);
-        avg_stat_node_add_value_int(st, st_str_response_nadditionals, 0, false, pi->nadditionals);
+        avg_stat_node_add_value_int_by_id(st, st_node_response_nquestions, pi->nquestions);
+        avg_stat_node_add_value_int_by_id(st, st_node_response_nanswers, pi->nanswers);
+        avg_stat_node_add_value_int_by_id(st, st_node_response_nauthorities, pi->nauthorities);
+        avg_stat_node_add_value_int_by_id(st, st_node_response_nadditionals, pi->nadditionals);
         if (pi->unsolicited) {
-          tick_stat_node(st, st_str_service_unsolicited, 0, false);
+          tick_stat_node_by_id(st, st_node_service_unsolicited);
         } else {
           if (pi->retransmission)
-            tick_stat_node(st, st_str_service_retransmission, 0, false);
+            tick_stat_node_by_id(st, st_node_service_retransmission);
           else
-            avg_stat_node_add_value_float(st, st_str_service_rrt, 0, false, (float)(pi->rrt.secs*1000. + pi->rrt.nsecs/1000000.0));
+            avg_stat_node_add_value_float_by_id(st, st_node_service_rrt, (float)(pi->rrt.secs*1000. + pi->rrt.nsecs/1000000.0));
         }
     }
   }
@@ -578,9 +578,9 @@ static void
 http_reqs_stats_tree_init(stats_tree* st)
 {
 	st_node_reqs = stats_tree_create_node(st, st_str_reqs, 0, STAT_DT_INT, true);
-	st_node_reqs_by_srv_addr = stats_tree_create_node(st, st_str_reqs_by_srv_addr, st_node_reqs, STAT_DT_INT, true);
-	st_node_reqs_by_http_host = stats_tree_create_node(st, st_str_reqs_by_http_host, st_node_reqs, STAT_DT_INT, true);
-	st_node_resps_by_srv_addr = stats_tree_create_node(st, st_str_resps_by_srv_addr, 0, STAT_DT_INT, true);
+	st_node_reqs_by_srv_addr = stats_tree_create_node_topk(st, st_str_reqs_by_srv_addr, st_node_reqs);
+	st_node_reqs_by_http_host = stats_tree_create_node_topk(st, st_str_reqs_by_http_host, st_node_reqs);
+	st_node_resps_by_srv_addr = stats_tree_create_node_topk(st, st_str_resps_by_srv_addr, 0);
 }
 
 /* HTTP/Load Distribution stats packet function */
@@ -642,7 +642,7 @@ static const char *st_str_requests_by_host = "HTTP Requests by HTTP Host";
 static void
 http_req_stats_tree_init(stats_tree* st)
 {
-	st_node_requests_by_host = stats_tree_create_node(st, st_str_requests_by_host, 0, STAT_DT_INT, true);
+	st_node_requests_by_host = stats_tree_create_node_topk(st, st_str_requests_by_host, 0);
 }
 
 /* HTTP/Requests stats packet function */
@@ -715,35 +715,28 @@ http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* e
 	const http_info_value_t* v = (const http_info_value_t*)p;
 	unsigned i = v->response_code;
 	int resp_grp;
-	const char *resp_str;
 	char str[64];
 
-	tick_stat_node(st, st_str_packets, 0, false);
+	tick_stat_node_by_id(st, st_node_packets);
 
 	if (i) {
-		tick_stat_node(st, st_str_responses, st_node_packets, false);
+		tick_stat_node_by_id(st, st_node_responses);
 
 		if ( (i<100)||(i>=600) ) {
 			resp_grp = st_node_resp_broken;
-			resp_str = st_str_resp_broken;
 		} else if (i<200) {
 			resp_grp = st_node_resp_100;
-			resp_str = st_str_resp_100;
 		} else if (i<300) {
 			resp_grp = st_node_resp_200;
-			resp_str = st_str_resp_200;
 		} else if (i<400) {
 			resp_grp = st_node_resp_300;
-			resp_str = st_str_resp_300;
 		} else if (i<500) {
 			resp_grp = st_node_resp_400;
-			resp_str = st_str_resp_400;
 		} else {
 			resp_grp = st_node_resp_500;
-			resp_str = st_str_resp_500;
 		}
 
-		tick_stat_node(st, resp_str, st_node_responses, false);
+		tick_stat_node_by_id(st, resp_grp);
 
 		snprintf(str, sizeof(str), "%u %s", i,
 			   val_to_str(i, vals_http_status_code, "Unknown (%d)"));
@@ -751,7 +744,7 @@ http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* e
 	} else if (v->request_method) {
 		stats_tree_tick_pivot(st,st_node_requests,v->request_method);
 	} else {
-		tick_stat_node(st, st_str_other, st_node_packets, false);
+		tick_stat_node_by_id(st, st_node_other);
 	}
 
 	return TAP_PACKET_REDRAW;
@@ -1319,6 +1319,8 @@ void proto_reg_handoff_icep(void)
     /* Register as a heuristic TCP/UDP dissector */
     heur_dissector_add("tcp", dissect_icep_tcp_heur, "ICEP over TCP", "icep_tcp", proto_icep, HEURISTIC_ENABLE);
     heur_dissector_add("udp", dissect_icep_udp_heur, "ICEP over UDP", "icep_udp", proto_icep, HEURISTIC_ENABLE);
+    heur_dissector_set_prescreen("icep_tcp", sizeof(icep_magic), 0, icep_magic, sizeof(icep_magic));
+    heur_dissector_set_prescreen("icep_udp", sizeof(icep_magic), 0, icep_magic, sizeof(icep_magic));
 
     /* Register TCP port for dissection */
     dissector_add_for_decode_as_with_preference("tcp.port", icep_tcp_handle);
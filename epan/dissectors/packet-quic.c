@@ -4879,24 +4879,19 @@ quic_follow_address_filter(address *src_addr _U_, address *dst_addr _U_, int src
 static tap_packet_status
 follow_quic_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data, tap_flags_t flags _U_)
 {
-    follow_record_t *follow_record;
     follow_info_t *follow_info = (follow_info_t *)tapdata;
     const quic_follow_tap_data_t *follow_data = (const quic_follow_tap_data_t *)data;
+    unsigned len = tvb_captured_length(follow_data->tvb);
+    bool is_server;
 
     if (follow_info->substream_id != SUBSTREAM_UNUSED &&
         follow_info->substream_id != follow_data->stream_id) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    follow_record = g_new(follow_record_t, 1);
-
     // XXX: Ideally, we should also deal with stream retransmission
     // and out of order packets in a similar manner to the TCP dissector,
     // using the offset, plus ACKs and other information.
-    follow_record->data = g_byte_array_sized_new(tvb_captured_length(follow_data->tvb));
-    follow_record->data = g_byte_array_append(follow_record->data, tvb_get_ptr(follow_data->tvb, 0, -1), tvb_captured_length(follow_data->tvb));
-    follow_record->packet_num = pinfo->fd->num;
-    follow_record->abs_ts = pinfo->fd->abs_ts;
 
     /* This sets the address and port information the first time this
      * stream is tapped. It will no longer be true after migration, but
@@ -4905,7 +4900,7 @@ follow_quic_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt
      */
 
     if (follow_data->from_server) {
-        follow_record->is_server = true;
+        is_server = true;
         if (follow_info->client_port == 0) {
             follow_info->server_port = pinfo->srcport;
             copy_address(&follow_info->server_ip, &pinfo->src);
@@ -4913,7 +4908,7 @@ follow_quic_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt
             copy_address(&follow_info->client_ip, &pinfo->dst);
         }
     } else {
-        follow_record->is_server = false;
+        is_server = false;
         if (follow_info->client_port == 0) {
             follow_info->client_port = pinfo->srcport;
             copy_address(&follow_info->client_ip, &pinfo->src);
@@ -4922,9 +4917,10 @@ follow_quic_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt
         }
     }
 
-    follow_info->bytes_written[follow_record->is_server] += follow_record->data->len;
+    follow_info->bytes_written[is_server] += len;
 
-    follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
+    follow_info_add_payload(follow_info, is_server, pinfo->fd->num, &pinfo->fd->abs_ts,
+                            tvb_get_ptr(follow_data->tvb, 0, len), len);
     return TAP_PACKET_DONT_REDRAW;
 }
 
@@ -18668,9 +18668,17 @@ void proto_register_rtps(void) {
 }
 
 void proto_reg_handoff_rtps(void) {
+  /* Common prefix of RTPS_MAGIC_NUMBER and RTPX_MAGIC_NUMBER */
+  static const uint8_t rtps_magic_prefix[] = { 'R', 'T', 'P' };
+
   heur_dissector_add("rtitcp", dissect_rtps_rtitcp, "RTPS over RTITCP", "rtps_rtitcp", proto_rtps, HEURISTIC_ENABLE);
   heur_dissector_add("udp", dissect_rtps_udp, "RTPS over UDP", "rtps_udp", proto_rtps, HEURISTIC_ENABLE);
   heur_dissector_add("tcp", dissect_rtps_tcp, "RTPS over TCP", "rtps_tcp", proto_rtps, HEURISTIC_ENABLE);
+
+  /* dissect_rtps() wants a 16 byte header starting with the magic number */
+  heur_dissector_set_prescreen("rtps_rtitcp", 16, 0, rtps_magic_prefix, sizeof(rtps_magic_prefix));
+  heur_dissector_set_prescreen("rtps_udp", 16, 0, rtps_magic_prefix, sizeof(rtps_magic_prefix));
+  heur_dissector_set_prescreen("rtps_tcp", 4 + 16, 4, rtps_magic_prefix, sizeof(rtps_magic_prefix));
 }
 
 /*
@@ -1236,7 +1236,7 @@ static bool
 check_follow_fragments(follow_info_t *follow_info, bool is_server, uint32_t acknowledged, uint32_t packet_num, bool use_ack)
 {
     GList *fragment_entry;
-    follow_record_t *fragment, *follow_record;
+    follow_record_t *fragment;
     uint32_t lowest_seq = 0;
     char *dummy_str;
 
@@ -1273,18 +1273,9 @@ check_follow_fragments(follow_info_t *follow_info, bool is_server, uint32_t ackn
                 if ( fragment->data->len > new_pos ) {
                     uint32_t new_frag_size = fragment->data->len - new_pos;
 
-                    follow_record = g_new0(follow_record_t,1);
-
-                    follow_record->is_server = is_server;
-                    follow_record->packet_num = fragment->packet_num;
-                    follow_record->abs_ts = fragment->abs_ts;
-                    follow_record->seq = follow_info->seq[is_server] + new_frag_size;
-
-                    follow_record->data = g_byte_array_append(g_byte_array_new(),
-                                                              fragment->data->data + new_pos,
-                                                              new_frag_size);
-
-                    follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
+                    follow_info_add_payload(follow_info, is_server, fragment->packet_num,
+                                            &fragment->abs_ts, fragment->data->data + new_pos,
+                                            new_frag_size);
                 }
 
                 follow_info->seq[is_server] += (fragment->data->len - new_pos);
@@ -1302,10 +1293,14 @@ check_follow_fragments(follow_info_t *follow_info, bool is_server, uint32_t ackn
         if( EQ_SEQ(fragment->seq, follow_info->seq[is_server]) ) {
             /* this fragment fits the stream */
             if( fragment->data->len > 0 ) {
-                follow_info->payload = g_list_prepend(follow_info->payload, fragment);
+                follow_info_add_payload(follow_info, is_server, fragment->packet_num,
+                                        &fragment->abs_ts, fragment->data->data,
+                                        fragment->data->len);
             }
 
             follow_info->seq[is_server] += fragment->data->len;
+            g_byte_array_free(fragment->data, true);
+            g_free(fragment);
             follow_info->fragments[is_server] = g_list_delete_link(follow_info->fragments[is_server], fragment_entry);
             return true;
         }
@@ -1320,18 +1315,11 @@ check_follow_fragments(follow_info_t *follow_info, bool is_server, uint32_t ackn
                         (int)(lowest_seq - follow_info->seq[is_server]) );
         // XXX the dummy replacement could be larger than the actual missing bytes.
 
-        follow_record = g_new0(follow_record_t,1);
-
-        follow_record->data = g_byte_array_append(g_byte_array_new(),
-                                                  (unsigned char*)dummy_str,
-                                                  (unsigned)strlen(dummy_str)+1);
+        follow_info_add_payload(follow_info, is_server, packet_num, NULL,
+                                (const uint8_t*)dummy_str, (unsigned)strlen(dummy_str)+1);
         g_free(dummy_str);
-        follow_record->is_server = is_server;
-        follow_record->packet_num = packet_num;
-        follow_record->seq = lowest_seq;
 
         follow_info->seq[is_server] = lowest_seq;
-        follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
         return true;
     }
 
@@ -1410,25 +1398,26 @@ follow_tcp_tap_listener(void *tapdata, packet_info *pinfo,
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    follow_record = g_new0(follow_record_t, 1);
-    follow_record->is_server = is_server;
-    follow_record->packet_num = pinfo->fd->num;
-    follow_record->abs_ts = pinfo->fd->abs_ts;
-    follow_record->seq = sequence;  /* start of fragment, used by check_follow_fragments. */
-    follow_record->data = g_byte_array_append(g_byte_array_new(),
-                                              tvb_get_ptr(follow_data->tvb, data_offset, data_length),
-                                              data_length);
-
     if (EQ_SEQ(sequence, follow_info->seq[is_server])) {
         /* The segment overlaps or extends the previous end of stream. */
         follow_info->seq[is_server] += length;
-        follow_info->bytes_written[is_server] += follow_record->data->len;
-        follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
+        follow_info->bytes_written[is_server] += data_length;
+        follow_info_add_payload(follow_info, is_server, pinfo->fd->num, &pinfo->fd->abs_ts,
+                                tvb_get_ptr(follow_data->tvb, data_offset, data_length),
+                                data_length);
 
         /* done with the packet, see if it caused a fragment to fit */
         while(check_follow_fragments(follow_info, is_server, 0, pinfo->fd->num, false));
     } else {
         /* Out of order packet (more preceding segments are expected). */
+        follow_record = g_new0(follow_record_t, 1);
+        follow_record->is_server = is_server;
+        follow_record->packet_num = pinfo->fd->num;
+        follow_record->abs_ts = pinfo->fd->abs_ts;
+        follow_record->seq = sequence;  /* start of fragment, used by check_follow_fragments. */
+        follow_record->data = g_byte_array_append(g_byte_array_new(),
+                                                  tvb_get_ptr(follow_data->tvb, data_offset, data_length),
+                                                  data_length);
         follow_info->fragments[is_server] = g_list_append(follow_info->fragments[is_server], follow_record);
     }
     return TAP_PACKET_DONT_REDRAW;
@@ -8075,6 +8064,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
     if (tcpd) {
         item = proto_tree_add_uint(tcp_tree, hf_tcp_stream, tvb, offset, 0, tcpd->stream);
         proto_item_set_generated(item);
+        conversation_index_add_frame(pinfo, hf_tcp_stream, tcpd->stream);
 
         if (tcppd) {
             item = proto_tree_add_uint(tcp_tree, hf_tcp_stream_pnum, tvb, offset, 0, tcppd->pnum);
@@ -10260,6 +10250,8 @@ proto_reg_handoff_tcp(void)
 
     capture_dissector_add_uint("ip.proto", IP_PROTO_TCP, tcp_cap_handle);
 
+    conversation_index_register_field(hf_tcp_stream);
+
     /* Create dissection function handles for all TCP options */
     dissector_add_uint("tcp.option", TCPOPT_TIMESTAMP, create_dissector_handle( dissect_tcpopt_timestamp, proto_tcp_option_timestamp ));
     dissector_add_uint("tcp.option", TCPOPT_MSS, create_dissector_handle( dissect_tcpopt_mss, proto_tcp_option_mss ));
@@ -465,7 +465,6 @@ static tap_packet_status
 ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *ssl, tap_flags_t flags _U_)
 {
     follow_info_t *      follow_info = (follow_info_t*) tapdata;
-    follow_record_t * follow_record = NULL;
     const SslRecordInfo *appl_data = NULL;
     const SslPacketInfo *pi = (const SslPacketInfo*)ssl;
     show_stream_t        from = FROM_CLIENT;
@@ -502,27 +501,17 @@ ssl_follow_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _
            already been processed and must be skipped. */
         if (appl_data->seq < follow_info->bytes_written[from]) continue;
 
-        /* Allocate a follow_record_t to hold the current appl_data
-           instance's decrypted data. Even though it would be possible to
+        /* Add a record holding the current appl_data instance's
+           decrypted data. Even though it would be possible to
            consolidate multiple appl_data instances into a single record, it is
            beneficial to use a one-to-one mapping. This affords the Follow
            Stream dialog view modes (ASCII, EBCDIC, Hex Dump, C Arrays, Raw)
            the opportunity to accurately reflect TLS PDU boundaries. Currently
            the Hex Dump view does by starting a new line, and the C Arrays
            view does by starting a new array declaration. */
-        follow_record = g_new(follow_record_t,1);
-
-        follow_record->is_server = (from == FROM_SERVER);
-        follow_record->packet_num = pinfo->num;
-        follow_record->abs_ts = pinfo->abs_ts;
-
-        follow_record->data = g_byte_array_sized_new(appl_data->data_len);
-        follow_record->data = g_byte_array_append(follow_record->data,
-                                              appl_data->plain_data,
-                                              appl_data->data_len);
-
-        /* Add the record to the follow_info structure. */
-        follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
+        follow_info_add_payload(follow_info, from == FROM_SERVER, pinfo->num,
+                                &pinfo->abs_ts, appl_data->plain_data,
+                                appl_data->data_len);
         follow_info->bytes_written[from] += appl_data->data_len;
     }
 
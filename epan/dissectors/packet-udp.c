@@ -1227,6 +1227,7 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uint32_t ip_proto)
     if (udpd) {
         item = proto_tree_add_uint(udp_tree, hf_udp_stream, tvb, offset, 0, udpd->stream);
         proto_item_set_generated(item);
+        conversation_index_add_frame(pinfo, hf_udp_stream, udpd->stream);
 
         /* Copy the stream index into the header as well to make it available
         * to tap listeners.
@@ -1541,6 +1542,8 @@ proto_reg_handoff_udp(void)
     capture_dissector_add_uint("ip.proto", IP_PROTO_UDP, udp_cap_handle);
     capture_dissector_add_uint("ip.proto", IP_PROTO_UDPLITE, udplite_cap_handle);
 
+    conversation_index_register_field(hf_udp_stream);
+
     exported_pdu_tap = find_tap_id(EXPORT_PDU_TAP_NAME_LAYER_4);
 }
 
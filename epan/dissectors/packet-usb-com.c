@@ -948,7 +948,6 @@ static tap_packet_status
 follow_cdc_data_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_,
                              const void *data, tap_flags_t flags _U_)
 {
-    follow_record_t *follow_record;
     follow_info_t *follow_info = (follow_info_t *)tapdata;
     tvbuff_t *tvb = (tvbuff_t *)data;
     uint32_t data_length = tvb_captured_length(tvb);
@@ -976,16 +975,9 @@ follow_cdc_data_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *
 
     is_server = pinfo->srcport == NO_ENDPOINT;
 
-    follow_record = g_new0(follow_record_t, 1);
-    follow_record->is_server = is_server;
-    follow_record->packet_num = pinfo->fd->num;
-    follow_record->abs_ts = pinfo->fd->abs_ts;
-    follow_record->data = g_byte_array_append(g_byte_array_new(),
-                                              tvb_get_ptr(tvb, 0, data_length),
-                                              data_length);
-
-    follow_info->bytes_written[is_server] += follow_record->data->len;
-    follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
+    follow_info->bytes_written[is_server] += data_length;
+    follow_info_add_payload(follow_info, is_server, pinfo->fd->num, &pinfo->fd->abs_ts,
+                            tvb_get_ptr(tvb, 0, data_length), data_length);
 
     return TAP_PACKET_DONT_REDRAW;
 }
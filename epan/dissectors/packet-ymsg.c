@@ -1335,6 +1335,7 @@ proto_reg_handoff_ymsg(void)
      * that doesn't begin with a YMSG signature.
      */
     heur_dissector_add("tcp", dissect_ymsg, "Yahoo YMSG Messenger over TCP", "ymsg_tcp", proto_ymsg, HEURISTIC_ENABLE);
+    heur_dissector_set_prescreen("ymsg_tcp", 4, 0, (const uint8_t*)"YMSG", 4);
 }
 
 /*
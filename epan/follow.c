@@ -12,6 +12,7 @@
 
 #include "config.h"
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -19,6 +20,40 @@
 #include <epan/packet.h>
 #include "follow.h"
 #include <epan/tap.h>
+#include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
+#include <wsutil/wslog.h>
+
+/* Data kept in memory per followed stream before the rest goes to disk. */
+#define FOLLOW_STORE_MEMORY_LIMIT   (64 * 1024 * 1024)
+#define FOLLOW_STORE_CHUNK_MIN      (4 * 1024)
+#define FOLLOW_STORE_CHUNK_MAX      (1024 * 1024)
+
+#define STORE_SPILLED   UINT_MAX    /* store_record_t.chunk of data in the temporary file */
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t used;
+} store_chunk_t;
+
+typedef struct {
+    follow_store_record_t pub;
+    unsigned chunk;     /* index in chunks, or STORE_SPILLED */
+    uint64_t offset;    /* in the chunk or in the temporary file */
+} store_record_t;
+
+struct _follow_store {
+    GArray *records;        /* store_record_t */
+    GArray *chunks;         /* store_chunk_t, only the last one is appended to */
+    size_t mem_size;        /* bytes allocated for chunks */
+    size_t memory_limit;
+    int spill_fd;
+    char *spill_path;
+    uint64_t spill_size;
+    bool spill_failed;      /* keep everything in memory from now on */
+    GByteArray *scratch;    /* data read back from the temporary file */
+};
 
 struct register_follow {
     int proto_id;              /* protocol id (0-indexed) */
@@ -143,6 +178,180 @@ char* follow_get_stat_tap_string(register_follow_t* follower)
     return g_string_free(cmd_str, FALSE);
 }
 
+follow_store_t *
+follow_store_new(size_t memory_limit)
+{
+    follow_store_t *store = g_new0(follow_store_t, 1);
+
+    store->records = g_array_new(false, false, sizeof(store_record_t));
+    store->chunks = g_array_new(false, false, sizeof(store_chunk_t));
+    store->memory_limit = memory_limit;
+    store->spill_fd = -1;
+
+    return store;
+}
+
+void
+follow_store_free(follow_store_t *store)
+{
+    if (!store)
+        return;
+
+    for (unsigned i = 0; i < store->chunks->len; i++) {
+        g_free(g_array_index(store->chunks, store_chunk_t, i).data);
+    }
+    g_array_free(store->chunks, true);
+    g_array_free(store->records, true);
+
+    if (store->spill_fd != -1) {
+        ws_close(store->spill_fd);
+        ws_unlink(store->spill_path);
+    }
+    g_free(store->spill_path);
+    if (store->scratch)
+        g_byte_array_free(store->scratch, true);
+    g_free(store);
+}
+
+static bool
+follow_store_spill(follow_store_t *store, const uint8_t *data, unsigned len)
+{
+    GError *err = NULL;
+    unsigned written = 0;
+    int ret;
+
+    if (store->spill_fd == -1) {
+        store->spill_fd = create_tempfile(NULL, &store->spill_path, "wireshark_follow_", NULL, &err);
+        if (store->spill_fd == -1) {
+            ws_warning("Could not create a temporary file for a followed stream: %s", err->message);
+            g_error_free(err);
+            store->spill_failed = true;
+            return false;
+        }
+    }
+
+    if (ws_lseek64(store->spill_fd, store->spill_size, SEEK_SET) == -1) {
+        store->spill_failed = true;
+        return false;
+    }
+    while (written < len) {
+        ret = (int)ws_write(store->spill_fd, data + written, len - written);
+        if (ret <= 0) {
+            ws_warning("Could not write to %s: %s", store->spill_path, g_strerror(errno));
+            store->spill_failed = true;
+            return false;
+        }
+        written += ret;
+    }
+    return true;
+}
+
+void
+follow_store_append(follow_store_t *store, bool is_server, uint32_t packet_num,
+                    const nstime_t *abs_ts, const uint8_t *data, unsigned len)
+{
+    store_record_t record;
+    store_chunk_t *chunk = NULL;
+    store_chunk_t new_chunk;
+
+    record.pub.is_server = is_server;
+    record.pub.packet_num = packet_num;
+    if (abs_ts)
+        record.pub.abs_ts = *abs_ts;
+    else
+        nstime_set_zero(&record.pub.abs_ts);
+    record.pub.len = len;
+
+    if (store->chunks->len > 0)
+        chunk = &g_array_index(store->chunks, store_chunk_t, store->chunks->len - 1);
+
+    if (chunk == NULL || chunk->size - chunk->used < len) {
+        new_chunk.size = chunk ? MIN(chunk->size * 2, FOLLOW_STORE_CHUNK_MAX) : FOLLOW_STORE_CHUNK_MIN;
+        new_chunk.size = MAX(new_chunk.size, len);
+
+        /*
+         * Once data has been written to the temporary file, everything
+         * after it goes there too, so that the file is only appended to.
+         */
+        if (store->memory_limit > 0 && !store->spill_failed &&
+                (store->spill_fd != -1 || store->mem_size + new_chunk.size > store->memory_limit)) {
+            if (follow_store_spill(store, data, len)) {
+                record.chunk = STORE_SPILLED;
+                record.offset = store->spill_size;
+                store->spill_size += len;
+                g_array_append_val(store->records, record);
+                return;
+            }
+        }
+
+        new_chunk.data = (uint8_t *)g_malloc(new_chunk.size);
+        new_chunk.used = 0;
+        store->mem_size += new_chunk.size;
+        g_array_append_val(store->chunks, new_chunk);
+        chunk = &g_array_index(store->chunks, store_chunk_t, store->chunks->len - 1);
+    }
+
+    record.chunk = store->chunks->len - 1;
+    record.offset = chunk->used;
+    if (len > 0)
+        memcpy(chunk->data + chunk->used, data, len);
+    chunk->used += len;
+    g_array_append_val(store->records, record);
+}
+
+unsigned
+follow_store_count(const follow_store_t *store)
+{
+    return store ? store->records->len : 0;
+}
+
+const follow_store_record_t *
+follow_store_get_record(const follow_store_t *store, unsigned idx)
+{
+    ws_assert(idx < store->records->len);
+    return &g_array_index(store->records, store_record_t, idx).pub;
+}
+
+const uint8_t *
+follow_store_get_data(follow_store_t *store, unsigned idx)
+{
+    store_record_t *record;
+    unsigned nread = 0;
+    int ret;
+
+    ws_assert(idx < store->records->len);
+    record = &g_array_index(store->records, store_record_t, idx);
+
+    if (record->chunk != STORE_SPILLED)
+        return g_array_index(store->chunks, store_chunk_t, record->chunk).data + record->offset;
+
+    if (!store->scratch)
+        store->scratch = g_byte_array_new();
+    g_byte_array_set_size(store->scratch, record->pub.len);
+
+    if (ws_lseek64(store->spill_fd, record->offset, SEEK_SET) == -1)
+        return NULL;
+    while (nread < record->pub.len) {
+        ret = (int)ws_read(store->spill_fd, store->scratch->data + nread, record->pub.len - nread);
+        if (ret <= 0) {
+            ws_warning("Could not read from %s: %s", store->spill_path,
+                       ret == 0 ? "short read" : g_strerror(errno));
+            return NULL;
+        }
+        nread += ret;
+    }
+    return store->scratch->data;
+}
+
+void
+follow_info_add_payload(follow_info_t *info, bool is_server, uint32_t packet_num,
+                        const nstime_t *abs_ts, const uint8_t *data, unsigned len)
+{
+    if (!info->payload)
+        info->payload = follow_store_new(FOLLOW_STORE_MEMORY_LIMIT);
+    follow_store_append(info->payload, is_server, packet_num, abs_ts, data, len);
+}
+
 /* here we are going to try and reconstruct the data portion of a TCP
    session. We will try and handle duplicates, TCP fragments, and out
    of order packets in a smart way. */
@@ -159,14 +368,7 @@ follow_reset_stream(follow_info_t* info)
     free_address(&info->client_ip);
     free_address(&info->server_ip);
 
-    for (cur = info->payload; cur; cur = g_list_next(cur)) {
-        follow_record = (follow_record_t *)cur->data;
-        if(follow_record->data)
-            g_byte_array_free(follow_record->data, true);
-
-        g_free(follow_record);
-    }
-    g_list_free(info->payload);
+    follow_store_free(info->payload);
     info->payload = NULL;
 
     //Only TCP stream uses fragments
@@ -210,18 +412,10 @@ tap_packet_status
 follow_tvb_tap_listener(void *tapdata, packet_info *pinfo,
                       epan_dissect_t *edt _U_, const void *data, tap_flags_t flags _U_)
 {
-    follow_record_t *follow_record;
     follow_info_t *follow_info = (follow_info_t *)tapdata;
     tvbuff_t *next_tvb = (tvbuff_t *)data;
-
-    follow_record = g_new(follow_record_t,1);
-
-    follow_record->data = g_byte_array_sized_new(tvb_captured_length(next_tvb));
-    follow_record->data = g_byte_array_append(follow_record->data,
-                                              tvb_get_ptr(next_tvb, 0, -1),
-                                              tvb_captured_length(next_tvb));
-    follow_record->packet_num = pinfo->fd->num;
-    follow_record->abs_ts = pinfo->fd->abs_ts;
+    unsigned len = tvb_captured_length(next_tvb);
+    bool is_server;
 
     if (follow_info->client_port == 0) {
         follow_info->client_port = pinfo->srcport;
@@ -231,14 +425,15 @@ follow_tvb_tap_listener(void *tapdata, packet_info *pinfo,
     }
 
     if (addresses_equal(&follow_info->client_ip, &pinfo->src) && follow_info->client_port == pinfo->srcport)
-        follow_record->is_server = false;
+        is_server = false;
     else
-        follow_record->is_server = true;
+        is_server = true;
 
     /* update stream counter */
-    follow_info->bytes_written[follow_record->is_server] += follow_record->data->len;
+    follow_info->bytes_written[is_server] += len;
 
-    follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
+    follow_info_add_payload(follow_info, is_server, pinfo->fd->num, &pinfo->fd->abs_ts,
+                            tvb_get_ptr(next_tvb, 0, len), len);
     return TAP_PACKET_DONT_REDRAW;
 }
 
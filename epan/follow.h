@@ -40,6 +40,7 @@ struct _follow_info;
 
 #define SUBSTREAM_UNUSED	UINT64_C(0xFFFFFFFFFFFFFFFF)
 
+/** Out of order TCP segment waiting in follow_info_t.fragments. */
 typedef struct {
     bool is_server;
     uint32_t packet_num;
@@ -48,10 +49,27 @@ typedef struct {
     GByteArray *data;
 } follow_record_t;
 
+/** A record of a follow_store_t. The data is read with follow_store_get_data(). */
+typedef struct {
+    bool is_server;
+    uint32_t packet_num;
+    nstime_t abs_ts; /**< Packet absolute time stamp */
+    uint32_t len;    /**< Length of the data */
+} follow_store_record_t;
+
+/*
+ * Append-only store of the data of a followed stream. Data is copied into
+ * large contiguous chunks instead of one allocation per packet, and once
+ * the chunks reach a memory limit further data is written to a temporary
+ * file. Records are indexed, so they can be read in any order without
+ * walking the whole stream.
+ */
+typedef struct _follow_store follow_store_t;
+
 typedef struct _follow_info {
     show_stream_t   show_stream;
     char            *filter_out_filter;
-    GList           *payload;   /* "follow_record_t" entries, in reverse order. */
+    follow_store_t  *payload;   /* Tapped data, in stream order. NULL until the first record. */
     unsigned        bytes_written[2]; /* Index with FROM_CLIENT or FROM_SERVER for readability. */
     uint32_t        seq[2]; /* TCP only */
     GList           *fragments[2]; /* TCP only */
@@ -194,6 +212,72 @@ WS_DLL_PUBLIC char* follow_get_stat_tap_string(register_follow_t* follower);
  */
 WS_DLL_PUBLIC void follow_reset_stream(follow_info_t* info);
 
+/** Append data to the payload of a follow_info_t, creating its store
+ * if needed.
+ *
+ * @param info [in] follower info
+ * @param is_server [in] true if the data was sent by the server
+ * @param packet_num [in] frame number the data comes from
+ * @param abs_ts [in] absolute time stamp of the frame, may be NULL
+ * @param data [in] the data
+ * @param len [in] length of the data
+ */
+WS_DLL_PUBLIC void follow_info_add_payload(follow_info_t *info, bool is_server,
+                                           uint32_t packet_num, const nstime_t *abs_ts,
+                                           const uint8_t *data, unsigned len);
+
+/** Create a follow_store_t.
+ *
+ * @param memory_limit [in] number of bytes kept in memory before data is
+ *                     written to a temporary file, 0 for no limit
+ * @return a new store
+ */
+WS_DLL_PUBLIC follow_store_t *follow_store_new(size_t memory_limit);
+
+/** Free a follow_store_t and remove its temporary file. NULL is allowed.
+ *
+ * @param store [in] the store
+ */
+WS_DLL_PUBLIC void follow_store_free(follow_store_t *store);
+
+/** Append a record to a follow_store_t.
+ *
+ * @param store [in] the store
+ * @param is_server [in] true if the data was sent by the server
+ * @param packet_num [in] frame number the data comes from
+ * @param abs_ts [in] absolute time stamp of the frame, may be NULL
+ * @param data [in] the data
+ * @param len [in] length of the data
+ */
+WS_DLL_PUBLIC void follow_store_append(follow_store_t *store, bool is_server,
+                                       uint32_t packet_num, const nstime_t *abs_ts,
+                                       const uint8_t *data, unsigned len);
+
+/** Get the number of records of a follow_store_t.
+ *
+ * @param store [in] the store, may be NULL
+ * @return number of records
+ */
+WS_DLL_PUBLIC unsigned follow_store_count(const follow_store_t *store);
+
+/** Get a record of a follow_store_t.
+ *
+ * @param store [in] the store
+ * @param idx [in] index of the record, less than follow_store_count()
+ * @return the record
+ */
+WS_DLL_PUBLIC const follow_store_record_t *follow_store_get_record(const follow_store_t *store, unsigned idx);
+
+/** Get the data of a record of a follow_store_t.
+ *
+ * @param store [in] the store
+ * @param idx [in] index of the record, less than follow_store_count()
+ * @return the data, record->len bytes. Valid until the next call for the
+ *         same store. NULL if the data could not be read back from the
+ *         temporary file.
+ */
+WS_DLL_PUBLIC const uint8_t *follow_store_get_data(follow_store_t *store, unsigned idx);
+
 /** Free follow_info_t structure
  * Free everything except the GUI element
  *
@@ -33,6 +33,7 @@ static mmdb_lookup_t mmdb_not_found;
 #include <epan/wmem_scopes.h>
 
 #include <epan/addr_resolv.h>
+#include <epan/mmdb_reader.h>
 #include <epan/uat.h>
 #include <epan/prefs.h>
 
@@ -84,6 +85,26 @@ static wmem_map_t *mmdb_ipv6_chunk;
 /* Child mmdbresolve process */
 static ws_pipe_t mmdbr_pipe; // Requires mutex
 
+// In-process lookups. If we can read all of the databases ourselves we
+// don't start mmdbresolve, and look addresses up synchronously instead.
+// Results are kept in a bounded LRU cache, since a long capture can
+// contain many more addresses than we want to keep around.
+static GPtrArray *mmdb_reader_arr; // mmdb_reader_t *
+static GMutex mmdb_cache_mtx;
+
+#define MMDB_CACHE_SIZE 8192
+// Address family (4 or 6) followed by the address.
+#define MMDB_CACHE_KEY_LEN (1 + sizeof(ws_in6_addr))
+
+typedef struct _mmdb_cache_entry_t {
+    uint8_t key[MMDB_CACHE_KEY_LEN];
+    mmdb_lookup_t mmdb_val;
+    GList lru_link;
+} mmdb_cache_entry_t;
+
+static GHashTable *mmdb_cache_ht; // key -> mmdb_cache_entry_t *. Requires mutex
+static GQueue mmdb_cache_lru = G_QUEUE_INIT; // Most recently used first. Requires mutex
+
 /* UAT definitions. Copied from oids.c */
 typedef struct _maxmind_db_path_t {
     char* path;
@@ -111,6 +132,15 @@ static bool resolve_synchronously;
 
 static void mmdb_resolve_stop(void);
 
+static const char *co_iso_key[]     = {"country", "iso_code", NULL};
+static const char *co_name_key[]    = {"country", "names", "en", NULL};
+static const char *ci_name_key[]    = {"city", "names", "en", NULL};
+static const char *asn_o_key[]      = {"autonomous_system_organization", NULL};
+static const char *asn_key[]        = {"autonomous_system_number", NULL};
+static const char *l_lat_key[]      = {"location", "latitude", NULL};
+static const char *l_lon_key[]      = {"location", "longitude", NULL};
+static const char *l_accuracy_key[] = {"location", "accuracy_radius", NULL};
+
 // Hopefully scanning a few lines asynchronously has less overhead than
 // reading in a child thread.
 #define RES_INVALID_LINE        "# Invalid"
@@ -160,6 +190,196 @@ static bool mmdbr_pipe_valid(void) {
     return pipe_valid;
 }
 
+static bool mmdb_resolver_valid(void) {
+    return mmdb_reader_arr != NULL || mmdbr_pipe_valid();
+}
+
+static unsigned mmdb_cache_key_hash(const void *key) {
+    const uint8_t *bytes = (const uint8_t *) key;
+    unsigned hash = 0;
+
+    // Jenkins' one-at-a-time hash, as in ipv6_oat_hash.
+    for (size_t i = 0; i < MMDB_CACHE_KEY_LEN; i++) {
+        hash += bytes[i];
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
+    }
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+    return hash;
+}
+
+static gboolean mmdb_cache_key_equal(const void *a, const void *b) {
+    return memcmp(a, b, MMDB_CACHE_KEY_LEN) == 0;
+}
+
+/**
+ * Open every database in-process.
+ * Main thread only.
+ */
+static bool mmdb_readers_open(void) {
+    GPtrArray *readers = g_ptr_array_new_with_free_func((GDestroyNotify) mmdb_reader_close);
+
+    for (unsigned i = 0; i < mmdb_file_arr->len; i++) {
+        const char *path = (const char *) g_ptr_array_index(mmdb_file_arr, i);
+        char *err_str = NULL;
+        mmdb_reader_t *reader = mmdb_reader_open(path, &err_str);
+        if (!reader) {
+            // Let mmdbresolve (libmaxminddb) have a go at it.
+            ws_debug("can't read %s in-process: %s", path, err_str);
+            g_free(err_str);
+            g_ptr_array_free(readers, true);
+            return false;
+        }
+        g_ptr_array_add(readers, reader);
+    }
+
+    mmdb_cache_ht = g_hash_table_new(mmdb_cache_key_hash, mmdb_cache_key_equal);
+    mmdb_reader_arr = readers;
+    return true;
+}
+
+/**
+ * Close our in-process databases and clear the cache.
+ * Main thread only.
+ */
+static void mmdb_readers_close(void) {
+    GList *link;
+
+    if (!mmdb_reader_arr) {
+        return;
+    }
+
+    g_mutex_lock(&mmdb_cache_mtx);
+    while ((link = g_queue_pop_head_link(&mmdb_cache_lru)) != NULL) {
+        g_free(link->data);
+    }
+    g_hash_table_destroy(mmdb_cache_ht);
+    mmdb_cache_ht = NULL;
+    g_ptr_array_free(mmdb_reader_arr, true);
+    mmdb_reader_arr = NULL;
+    g_mutex_unlock(&mmdb_cache_mtx);
+}
+
+// Requires mmdb_cache_mtx.
+static bool mmdb_reader_get(const mmdb_reader_t *reader, uint32_t entry, const char **path, mmdb_value_type_e type, mmdb_value_t *value) {
+    return mmdb_reader_get_value(reader, entry, path, value) && value->type == type;
+}
+
+// Requires mmdb_cache_mtx.
+static const char *mmdb_reader_string(const mmdb_value_t *value) {
+    char *str = g_strndup(value->str, value->str_len);
+    const char *chunk_string = chunkify_string(str);
+    g_free(str);
+    return chunk_string;
+}
+
+/**
+ * Look an address up in each database. As with mmdbresolve, values in
+ * later databases replace ones found in earlier databases.
+ * Requires mmdb_cache_mtx.
+ */
+static void mmdb_reader_resolve(mmdb_lookup_t *mmdb_val, const ws_in4_addr *ipv4_addr, const ws_in6_addr *ipv6_addr) {
+    mmdb_value_t value;
+    uint32_t entry;
+
+    init_lookup(mmdb_val);
+
+    for (unsigned i = 0; i < mmdb_reader_arr->len; i++) {
+        const mmdb_reader_t *reader = (const mmdb_reader_t *) g_ptr_array_index(mmdb_reader_arr, i);
+        bool found = ipv4_addr ? mmdb_reader_lookup_ipv4(reader, ipv4_addr, &entry)
+                               : mmdb_reader_lookup_ipv6(reader, ipv6_addr, &entry);
+        if (!found) {
+            continue;
+        }
+
+        if (mmdb_reader_get(reader, entry, co_iso_key, MMDB_VALUE_STRING, &value)) {
+            mmdb_val->found = true;
+            mmdb_val->country_iso = mmdb_reader_string(&value);
+        }
+        if (mmdb_reader_get(reader, entry, co_name_key, MMDB_VALUE_STRING, &value)) {
+            mmdb_val->found = true;
+            mmdb_val->country = mmdb_reader_string(&value);
+        }
+        if (mmdb_reader_get(reader, entry, ci_name_key, MMDB_VALUE_STRING, &value)) {
+            mmdb_val->found = true;
+            mmdb_val->city = mmdb_reader_string(&value);
+        }
+        if (mmdb_reader_get(reader, entry, asn_o_key, MMDB_VALUE_STRING, &value)) {
+            mmdb_val->found = true;
+            mmdb_val->as_org = mmdb_reader_string(&value);
+        }
+        if (mmdb_reader_get(reader, entry, asn_key, MMDB_VALUE_UINT, &value) && value.uint <= UINT32_MAX) {
+            mmdb_val->found = true;
+            mmdb_val->as_number = (uint32_t) value.uint;
+        }
+        if (mmdb_reader_get(reader, entry, l_lat_key, MMDB_VALUE_DOUBLE, &value)) {
+            mmdb_val->found = true;
+            mmdb_val->latitude = value.dbl;
+        }
+        if (mmdb_reader_get(reader, entry, l_lon_key, MMDB_VALUE_DOUBLE, &value)) {
+            mmdb_val->found = true;
+            mmdb_val->longitude = value.dbl;
+        }
+        if (mmdb_reader_get(reader, entry, l_accuracy_key, MMDB_VALUE_UINT, &value) && value.uint <= UINT16_MAX) {
+            mmdb_val->found = true;
+            mmdb_val->accuracy = (uint16_t) value.uint;
+        }
+    }
+}
+
+// The in-process lookup result of each thread. See mmdb_cache_lookup.
+static GPrivate mmdb_lookup_result = G_PRIVATE_INIT(g_free);
+
+/**
+ * Look an address up in-process, via the LRU cache. Other threads can
+ * recycle a cache entry as soon as we unlock it, so the entry is copied
+ * to the calling thread's own result while the lock is held. The result
+ * stays valid until the thread's next lookup; its strings are interned.
+ */
+static const mmdb_lookup_t *mmdb_cache_lookup(const ws_in4_addr *ipv4_addr, const ws_in6_addr *ipv6_addr) {
+    uint8_t key[MMDB_CACHE_KEY_LEN] = { 0 };
+    mmdb_cache_entry_t *cache_entry;
+    mmdb_lookup_t *result = (mmdb_lookup_t *) g_private_get(&mmdb_lookup_result);
+
+    if (!result) {
+        result = g_new(mmdb_lookup_t, 1);
+        g_private_set(&mmdb_lookup_result, result);
+    }
+
+    if (ipv4_addr) {
+        key[0] = 4;
+        memcpy(key + 1, ipv4_addr, sizeof(*ipv4_addr));
+    } else {
+        key[0] = 6;
+        memcpy(key + 1, ipv6_addr->bytes, sizeof(ipv6_addr->bytes));
+    }
+
+    g_mutex_lock(&mmdb_cache_mtx);
+    cache_entry = (mmdb_cache_entry_t *) g_hash_table_lookup(mmdb_cache_ht, key);
+    if (cache_entry) {
+        g_queue_unlink(&mmdb_cache_lru, &cache_entry->lru_link);
+    } else {
+        if (mmdb_cache_lru.length >= MMDB_CACHE_SIZE) {
+            // Recycle the least recently used entry.
+            cache_entry = (mmdb_cache_entry_t *) g_queue_pop_tail_link(&mmdb_cache_lru)->data;
+            g_hash_table_remove(mmdb_cache_ht, cache_entry->key);
+        } else {
+            cache_entry = g_new0(mmdb_cache_entry_t, 1);
+            cache_entry->lru_link.data = cache_entry;
+        }
+        memcpy(cache_entry->key, key, MMDB_CACHE_KEY_LEN);
+        mmdb_reader_resolve(&cache_entry->mmdb_val, ipv4_addr, ipv6_addr);
+        g_hash_table_insert(mmdb_cache_ht, cache_entry->key, cache_entry);
+    }
+    g_queue_push_head_link(&mmdb_cache_lru, &cache_entry->lru_link);
+    *result = cache_entry->mmdb_val;
+    g_mutex_unlock(&mmdb_cache_mtx);
+
+    return result;
+}
+
 // Writing to mmdbr_pipe.stdin_fd can block. Do so in a separate thread.
 static void *
 write_mmdbr_stdin_worker(void *data _U_) {
@@ -373,6 +593,8 @@ static void mmdb_resolve_stop(void) {
     char *request;
     mmdb_response_t *response;
 
+    mmdb_readers_close();
+
     while (mmdbr_request_q && (request = (char *) g_async_queue_try_pop(mmdbr_request_q)) != NULL) {
         g_free(request);
     }
@@ -485,6 +707,11 @@ static void mmdb_resolve_start(void) {
         return;
     }
 
+    if (mmdb_readers_open()) {
+        ws_debug("resolving in-process");
+        return;
+    }
+
     GPtrArray *args = g_ptr_array_new();
     char *mmdbresolve = get_executable_path("mmdbresolve");
     g_ptr_array_add(args, mmdbresolve);
@@ -657,11 +884,11 @@ void maxmind_db_pref_cleanup(void)
 void maxmind_db_pref_apply(void)
 {
     if (gbl_resolv_flags.maxmind_geoip) {
-        if (!mmdbr_pipe_valid()) {
+        if (!mmdb_resolver_valid()) {
             mmdb_resolve_start();
         }
     } else {
-        if (mmdbr_pipe_valid()) {
+        if (mmdb_resolver_valid()) {
             mmdb_resolve_stop();
         }
     }
@@ -741,6 +968,10 @@ maxmind_db_lookup_ipv4(const ws_in4_addr *addr) {
         return &mmdb_not_found;
     }
 
+    if (mmdb_reader_arr) {
+        return mmdb_cache_lookup(addr, NULL);
+    }
+
     mmdb_lookup_t *result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv4_map, GUINT_TO_POINTER(*addr));
 
     if (!result) {
@@ -768,6 +999,10 @@ maxmind_db_lookup_ipv6(const ws_in6_addr *addr) {
         return &mmdb_not_found;
     }
 
+    if (mmdb_reader_arr) {
+        return mmdb_cache_lookup(NULL, addr);
+    }
+
     mmdb_lookup_t * result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv6_map, addr->bytes);
 
     if (!result) {
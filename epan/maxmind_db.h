@@ -50,7 +50,10 @@ WS_DLL_LOCAL void maxmind_db_pref_apply(void);
  *
  * @param addr IPv4 address to look up
  *
- * @return The database entry if found, else NULL.
+ * @return The database entry if found, else NULL. If the databases are
+ * read in-process the entry is a copy owned by the calling thread, which is
+ * overwritten by the thread's next lookup, so it should be used right away
+ * instead of being stored.
  */
 WS_DLL_PUBLIC WS_RETNONNULL const mmdb_lookup_t *maxmind_db_lookup_ipv4(const ws_in4_addr *addr);
 
@@ -89,7 +92,9 @@ static inline bool maxmind_db_has_coords(const mmdb_lookup_t *result)
 
 /**
  * Select whether lookups should be performed synchronously.
- * Default is asynchronous lookups.
+ * Default is asynchronous lookups. This only applies to lookups done by
+ * mmdbresolve; databases that can be read in-process are always looked
+ * up synchronously.
  *
  * @param synchronous Whether maxmind lookups should be synchronous.
  *
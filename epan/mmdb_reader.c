@@ -0,0 +1,589 @@
+/* mmdb_reader.c
+ * In-process reader for MaxMind DB (.mmdb) files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#define WS_LOG_DOMAIN  LOG_DOMAIN_MMDB
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/mmdb_reader.h>
+
+#include <wsutil/pint.h>
+#include <wsutil/wslog.h>
+
+/*
+ * The file format is described at https://maxmind.github.io/MaxMind-DB/.
+ * It's a binary search tree over address bits whose leaves point into a
+ * data section, followed by a metadata map:
+ *
+ *   search tree | 16 zero bytes | data section | marker | metadata
+ *
+ * We don't link with libmaxminddb here (see mmdbresolve.c); the subset of
+ * the format we need to read is small.
+ */
+
+#define MMDB_METADATA_MARKER        "\xAB\xCD\xEFMaxMind.com"
+#define MMDB_METADATA_MARKER_LEN    (sizeof(MMDB_METADATA_MARKER) - 1)
+#define MMDB_METADATA_MAX_SIZE      (128 * 1024)
+#define MMDB_DATA_SECTION_SEPARATOR 16
+/* Maps and arrays in GeoIP databases are a few levels deep. */
+#define MMDB_MAX_DEPTH              32
+
+enum {
+    MMDB_TYPE_EXTENDED = 0,
+    MMDB_TYPE_POINTER = 1,
+    MMDB_TYPE_UTF8_STRING = 2,
+    MMDB_TYPE_DOUBLE = 3,
+    MMDB_TYPE_BYTES = 4,
+    MMDB_TYPE_UINT16 = 5,
+    MMDB_TYPE_UINT32 = 6,
+    MMDB_TYPE_MAP = 7,
+    MMDB_TYPE_INT32 = 8,
+    MMDB_TYPE_UINT64 = 9,
+    MMDB_TYPE_UINT128 = 10,
+    MMDB_TYPE_ARRAY = 11,
+    MMDB_TYPE_CONTAINER = 12,
+    MMDB_TYPE_END_MARKER = 13,
+    MMDB_TYPE_BOOLEAN = 14,
+    MMDB_TYPE_FLOAT = 15
+};
+
+typedef struct {
+    const uint8_t *base;
+    size_t size;
+} mmdb_section_t;
+
+typedef struct {
+    unsigned type;
+    uint32_t size;      /* Payload bytes, entries for maps and arrays, or the boolean value */
+    size_t offset;      /* Payload offset */
+} mmdb_field_t;
+
+struct _mmdb_reader_t {
+    GMappedFile *mapped_file;
+    const uint8_t *tree;
+    uint32_t node_count;
+    uint16_t record_size;   /* bits: 24, 28 or 32 */
+    uint16_t ip_version;
+    uint32_t ipv4_start;    /* node reached after 96 zero bits in an IPv6 tree */
+    unsigned ipv4_start_depth;
+    mmdb_section_t data;
+    mmdb_section_t metadata;
+    char *database_type;
+};
+
+static bool
+mmdb_read_be(const mmdb_section_t *sec, size_t offset, unsigned len, uint64_t *val)
+{
+    *val = 0;
+    if (len > 8 || offset > sec->size || sec->size - offset < len) {
+        return false;
+    }
+    for (unsigned i = 0; i < len; i++) {
+        *val = (*val << 8) | sec->base[offset + i];
+    }
+    return true;
+}
+
+/*
+ * Decode the control byte(s) at *offset. Afterwards *offset points at the
+ * payload, or past the pointer for a pointer, whose target is stored in
+ * field->offset.
+ */
+static bool
+mmdb_decode_ctrl(const mmdb_section_t *sec, size_t *offset, mmdb_field_t *field)
+{
+    size_t pos = *offset;
+    uint64_t val;
+    uint8_t ctrl;
+
+    if (pos >= sec->size) {
+        return false;
+    }
+    ctrl = sec->base[pos++];
+    field->type = ctrl >> 5;
+
+    if (field->type == MMDB_TYPE_POINTER) {
+        unsigned ptr_size = ((ctrl >> 3) & 0x03) + 1;
+        if (!mmdb_read_be(sec, pos, ptr_size, &val)) {
+            return false;
+        }
+        switch (ptr_size) {
+        case 1:
+            val |= (uint64_t)(ctrl & 0x07) << 8;
+            break;
+        case 2:
+            val = (val | (uint64_t)(ctrl & 0x07) << 16) + 2048;
+            break;
+        case 3:
+            val = (val | (uint64_t)(ctrl & 0x07) << 24) + 526336;
+            break;
+        default:
+            break;
+        }
+        if (val >= sec->size) {
+            return false;
+        }
+        field->size = 0;
+        field->offset = (size_t)val;
+        *offset = pos + ptr_size;
+        return true;
+    }
+
+    if (field->type == MMDB_TYPE_EXTENDED) {
+        if (pos >= sec->size) {
+            return false;
+        }
+        field->type = 7 + sec->base[pos++];
+        if (field->type < MMDB_TYPE_INT32 || field->type > MMDB_TYPE_FLOAT) {
+            return false;
+        }
+    }
+
+    field->size = ctrl & 0x1f;
+    if (field->size >= 29) {
+        unsigned size_len = field->size - 28;
+        static const uint32_t size_base[] = { 29, 285, 65821 };
+        if (!mmdb_read_be(sec, pos, size_len, &val)) {
+            return false;
+        }
+        field->size = size_base[size_len - 1] + (uint32_t)val;
+        pos += size_len;
+    }
+
+    switch (field->type) {
+    case MMDB_TYPE_MAP:
+    case MMDB_TYPE_ARRAY:
+    case MMDB_TYPE_BOOLEAN:
+        break;
+    case MMDB_TYPE_CONTAINER:
+    case MMDB_TYPE_END_MARKER:
+        return false;
+    default:
+        if (pos > sec->size || sec->size - pos < field->size) {
+            return false;
+        }
+        break;
+    }
+
+    field->offset = pos;
+    *offset = pos;
+    return true;
+}
+
+static bool
+mmdb_is_container(unsigned type)
+{
+    return type == MMDB_TYPE_MAP || type == MMDB_TYPE_ARRAY;
+}
+
+static size_t
+mmdb_payload_len(const mmdb_field_t *field)
+{
+    if (mmdb_is_container(field->type) || field->type == MMDB_TYPE_BOOLEAN) {
+        return 0;
+    }
+    return field->size;
+}
+
+/*
+ * Decode the field at *offset, following a pointer. Afterwards *offset
+ * points past the field, or only past its control bytes for a map or
+ * array whose entries follow.
+ */
+static bool
+mmdb_decode(const mmdb_section_t *sec, size_t *offset, mmdb_field_t *field)
+{
+    size_t pos = *offset;
+
+    if (!mmdb_decode_ctrl(sec, &pos, field)) {
+        return false;
+    }
+
+    if (field->type == MMDB_TYPE_POINTER) {
+        size_t target = field->offset;
+        /* Pointers to pointers aren't allowed. */
+        if (!mmdb_decode_ctrl(sec, &target, field) || field->type == MMDB_TYPE_POINTER) {
+            return false;
+        }
+        *offset = pos;
+        return true;
+    }
+
+    *offset = pos + mmdb_payload_len(field);
+    return true;
+}
+
+/* Move *offset past the field there, including any map or array entries. */
+static bool
+mmdb_skip(const mmdb_section_t *sec, size_t *offset, unsigned depth)
+{
+    mmdb_field_t field;
+    size_t pos = *offset;
+
+    if (depth > MMDB_MAX_DEPTH || !mmdb_decode_ctrl(sec, &pos, &field)) {
+        return false;
+    }
+
+    if (mmdb_is_container(field.type)) {
+        uint64_t count = field.type == MMDB_TYPE_MAP ? 2 * (uint64_t)field.size : field.size;
+        for (uint64_t i = 0; i < count; i++) {
+            if (!mmdb_skip(sec, &pos, depth + 1)) {
+                return false;
+            }
+        }
+    } else if (field.type != MMDB_TYPE_POINTER) {
+        pos += mmdb_payload_len(&field);
+    }
+
+    *offset = pos;
+    return true;
+}
+
+static bool
+mmdb_get_field(const mmdb_section_t *sec, size_t offset, const char * const *path, mmdb_field_t *field)
+{
+    if (!mmdb_decode(sec, &offset, field)) {
+        return false;
+    }
+
+    for (unsigned depth = 0; path[depth]; depth++) {
+        size_t key_len = strlen(path[depth]);
+        size_t pos = field->offset;
+        uint32_t num_pairs = field->size;
+        mmdb_field_t key;
+        bool found = false;
+
+        if (field->type != MMDB_TYPE_MAP || depth > MMDB_MAX_DEPTH) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < num_pairs && !found; i++) {
+            if (!mmdb_decode(sec, &pos, &key) || key.type != MMDB_TYPE_UTF8_STRING) {
+                return false;
+            }
+            if (key.size == key_len && memcmp(sec->base + key.offset, path[depth], key_len) == 0) {
+                if (!mmdb_decode(sec, &pos, field)) {
+                    return false;
+                }
+                found = true;
+            } else if (!mmdb_skip(sec, &pos, depth + 1)) {
+                return false;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool
+mmdb_field_value(const mmdb_section_t *sec, const mmdb_field_t *field, mmdb_value_t *value)
+{
+    const uint8_t *payload = sec->base + field->offset;
+    uint64_t val;
+
+    memset(value, 0, sizeof(*value));
+    switch (field->type) {
+    case MMDB_TYPE_UTF8_STRING:
+        value->type = MMDB_VALUE_STRING;
+        value->str = (const char *)payload;
+        value->str_len = field->size;
+        break;
+    case MMDB_TYPE_DOUBLE:
+        if (field->size != 8) {
+            return false;
+        }
+        value->type = MMDB_VALUE_DOUBLE;
+        val = pntoh64(payload);
+        memcpy(&value->dbl, &val, sizeof(value->dbl));
+        break;
+    case MMDB_TYPE_FLOAT:
+    {
+        uint32_t val32;
+        float flt;
+        if (field->size != 4) {
+            return false;
+        }
+        value->type = MMDB_VALUE_DOUBLE;
+        val32 = pntoh32(payload);
+        memcpy(&flt, &val32, sizeof(flt));
+        value->dbl = flt;
+        break;
+    }
+    case MMDB_TYPE_UINT16:
+    case MMDB_TYPE_UINT32:
+    case MMDB_TYPE_UINT64:
+        if (!mmdb_read_be(sec, field->offset, field->size, &val)) {
+            return false;
+        }
+        value->type = MMDB_VALUE_UINT;
+        value->uint = val;
+        break;
+    case MMDB_TYPE_INT32:
+        if (!mmdb_read_be(sec, field->offset, field->size, &val) || field->size > 4) {
+            return false;
+        }
+        value->type = MMDB_VALUE_INT;
+        value->sint = (int32_t)(uint32_t)val;
+        break;
+    case MMDB_TYPE_BOOLEAN:
+        value->type = MMDB_VALUE_BOOLEAN;
+        value->uint = field->size != 0;
+        break;
+    default:
+        value->type = MMDB_VALUE_NONE;
+        break;
+    }
+    return true;
+}
+
+static bool
+mmdb_metadata_uint(mmdb_reader_t *reader, const char *key, uint64_t *val)
+{
+    const char *path[] = { key, NULL };
+    mmdb_field_t field;
+    mmdb_value_t value;
+
+    if (!mmdb_get_field(&reader->metadata, 0, path, &field) ||
+            !mmdb_field_value(&reader->metadata, &field, &value) ||
+            value.type != MMDB_VALUE_UINT) {
+        return false;
+    }
+    *val = value.uint;
+    return true;
+}
+
+static uint32_t
+mmdb_read_record(const mmdb_reader_t *reader, uint32_t node, unsigned bit)
+{
+    const uint8_t *p;
+
+    switch (reader->record_size) {
+    case 24:
+        p = reader->tree + (size_t)node * 6 + bit * 3;
+        return pntoh24(p);
+    case 28:
+        p = reader->tree + (size_t)node * 7;
+        if (bit) {
+            return ((uint32_t)(p[3] & 0x0f) << 24) | pntoh24(p + 4);
+        }
+        return ((uint32_t)(p[3] & 0xf0) << 20) | pntoh24(p);
+    default:
+        p = reader->tree + (size_t)node * 8 + bit * 4;
+        return pntoh32(p);
+    }
+}
+
+/*
+ * Walk the tree from node, using the first num_bits bits of addr.
+ * Returns the node or record reached, and the number of bits used in depth.
+ */
+static uint32_t
+mmdb_walk(const mmdb_reader_t *reader, uint32_t node, const uint8_t *addr, unsigned num_bits, unsigned *depth)
+{
+    unsigned i;
+
+    for (i = 0; i < num_bits && node < reader->node_count; i++) {
+        unsigned bit = (addr[i >> 3] >> (7 - (i & 7))) & 1;
+        node = mmdb_read_record(reader, node, bit);
+    }
+    if (depth) {
+        *depth = i;
+    }
+    return node;
+}
+
+static bool
+mmdb_record_entry(const mmdb_reader_t *reader, uint32_t record, uint32_t *entry)
+{
+    uint64_t offset;
+
+    /* record == node_count means "no data"; a record inside the tree
+     * means we ran out of address bits. */
+    if (record <= reader->node_count) {
+        return false;
+    }
+    offset = (uint64_t)record - reader->node_count - MMDB_DATA_SECTION_SEPARATOR;
+    if (offset >= reader->data.size) {
+        ws_debug("%s: record %u points past the data section", reader->database_type, record);
+        return false;
+    }
+    *entry = (uint32_t)offset;
+    return true;
+}
+
+mmdb_reader_t *
+mmdb_reader_open(const char *path, char **err_str)
+{
+    GError *err = NULL;
+    GMappedFile *mapped_file;
+    const uint8_t *contents;
+    size_t size, search_len, metadata_pos = 0;
+    mmdb_reader_t *reader;
+    uint64_t val;
+    size_t tree_size;
+
+    mapped_file = g_mapped_file_new(path, FALSE, &err);
+    if (!mapped_file) {
+        if (err_str) {
+            *err_str = g_strdup(err->message);
+        }
+        g_clear_error(&err);
+        return NULL;
+    }
+
+    contents = (const uint8_t *)g_mapped_file_get_contents(mapped_file);
+    size = g_mapped_file_get_length(mapped_file);
+
+    /* The metadata starts after the last marker in the file. */
+    search_len = MIN(size, MMDB_METADATA_MAX_SIZE);
+    for (size_t i = MMDB_METADATA_MARKER_LEN; i <= search_len; i++) {
+        const uint8_t *candidate = contents + size - i;
+        if (memcmp(candidate, MMDB_METADATA_MARKER, MMDB_METADATA_MARKER_LEN) == 0) {
+            metadata_pos = size - i + MMDB_METADATA_MARKER_LEN;
+            break;
+        }
+    }
+    if (metadata_pos == 0) {
+        if (err_str) {
+            *err_str = g_strdup("metadata section not found");
+        }
+        g_mapped_file_unref(mapped_file);
+        return NULL;
+    }
+
+    reader = g_new0(mmdb_reader_t, 1);
+    reader->mapped_file = mapped_file;
+    reader->tree = contents;
+    reader->metadata.base = contents + metadata_pos;
+    reader->metadata.size = size - metadata_pos;
+
+    if (!mmdb_metadata_uint(reader, "node_count", &val) || val > UINT32_MAX) {
+        goto invalid;
+    }
+    reader->node_count = (uint32_t)val;
+    if (!mmdb_metadata_uint(reader, "record_size", &val) ||
+            (val != 24 && val != 28 && val != 32)) {
+        goto invalid;
+    }
+    reader->record_size = (uint16_t)val;
+    if (!mmdb_metadata_uint(reader, "ip_version", &val) || (val != 4 && val != 6)) {
+        goto invalid;
+    }
+    reader->ip_version = (uint16_t)val;
+
+    tree_size = (size_t)reader->node_count * reader->record_size / 4;
+    if (tree_size + MMDB_DATA_SECTION_SEPARATOR > metadata_pos - MMDB_METADATA_MARKER_LEN) {
+        goto invalid;
+    }
+    reader->data.base = contents + tree_size + MMDB_DATA_SECTION_SEPARATOR;
+    reader->data.size = metadata_pos - MMDB_METADATA_MARKER_LEN - tree_size - MMDB_DATA_SECTION_SEPARATOR;
+
+    {
+        const char *db_type_path[] = { "database_type", NULL };
+        mmdb_field_t field;
+        mmdb_value_t value;
+        if (mmdb_get_field(&reader->metadata, 0, db_type_path, &field) &&
+                mmdb_field_value(&reader->metadata, &field, &value) &&
+                value.type == MMDB_VALUE_STRING) {
+            reader->database_type = g_strndup(value.str, value.str_len);
+        } else {
+            reader->database_type = g_strdup("unknown");
+        }
+    }
+
+    if (reader->ip_version == 6) {
+        static const uint8_t zero_bits[12] = { 0 };
+        reader->ipv4_start = mmdb_walk(reader, 0, zero_bits, 96, &reader->ipv4_start_depth);
+    }
+
+    ws_debug("opened %s: %s, %u nodes, %u bit records, IPv%u",
+             path, reader->database_type, reader->node_count, reader->record_size, reader->ip_version);
+    return reader;
+
+invalid:
+    if (err_str) {
+        *err_str = g_strdup("invalid or unsupported metadata");
+    }
+    mmdb_reader_close(reader);
+    return NULL;
+}
+
+void
+mmdb_reader_close(mmdb_reader_t *reader)
+{
+    if (!reader) {
+        return;
+    }
+    g_mapped_file_unref(reader->mapped_file);
+    g_free(reader->database_type);
+    g_free(reader);
+}
+
+const char *
+mmdb_reader_database_type(const mmdb_reader_t *reader)
+{
+    return reader->database_type;
+}
+
+bool
+mmdb_reader_lookup_ipv4(const mmdb_reader_t *reader, const ws_in4_addr *addr, uint32_t *entry)
+{
+    /* ws_in4_addr is in network byte order. */
+    const uint8_t *addr_bytes = (const uint8_t *)addr;
+    uint32_t record;
+
+    if (reader->ip_version == 4) {
+        record = mmdb_walk(reader, 0, addr_bytes, 32, NULL);
+    } else if (reader->ipv4_start_depth < 96) {
+        /* The record for ::/n, n < 96 covers all of IPv4. */
+        record = reader->ipv4_start;
+    } else {
+        record = mmdb_walk(reader, reader->ipv4_start, addr_bytes, 32, NULL);
+    }
+    return mmdb_record_entry(reader, record, entry);
+}
+
+bool
+mmdb_reader_lookup_ipv6(const mmdb_reader_t *reader, const ws_in6_addr *addr, uint32_t *entry)
+{
+    if (reader->ip_version == 4) {
+        return false;
+    }
+    return mmdb_record_entry(reader, mmdb_walk(reader, 0, addr->bytes, 128, NULL), entry);
+}
+
+bool
+mmdb_reader_get_value(const mmdb_reader_t *reader, uint32_t entry, const char * const *path, mmdb_value_t *value)
+{
+    mmdb_field_t field;
+
+    return mmdb_get_field(&reader->data, entry, path, &field) &&
+           mmdb_field_value(&reader->data, &field, value);
+}
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
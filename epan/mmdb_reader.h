@@ -0,0 +1,108 @@
+/** @file
+ *
+ * In-process reader for MaxMind DB (.mmdb) files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __MMDB_READER_H__
+#define __MMDB_READER_H__
+
+#include <wsutil/inet_addr.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A read-only view of a memory-mapped MaxMind DB file, as described in
+ * https://maxmind.github.io/MaxMind-DB/. Lookups don't modify the reader,
+ * so a reader can be shared between threads.
+ */
+typedef struct _mmdb_reader_t mmdb_reader_t;
+
+typedef enum {
+    MMDB_VALUE_NONE,
+    MMDB_VALUE_STRING,
+    MMDB_VALUE_DOUBLE,
+    MMDB_VALUE_UINT,
+    MMDB_VALUE_INT,
+    MMDB_VALUE_BOOLEAN
+} mmdb_value_type_e;
+
+typedef struct _mmdb_value_t {
+    mmdb_value_type_e type;
+    const char *str;        /**< MMDB_VALUE_STRING. Not NUL terminated. */
+    uint32_t str_len;
+    double dbl;             /**< MMDB_VALUE_DOUBLE (doubles and floats). */
+    uint64_t uint;          /**< MMDB_VALUE_UINT (up to 64 bits) and MMDB_VALUE_BOOLEAN. */
+    int32_t sint;           /**< MMDB_VALUE_INT. */
+} mmdb_value_t;
+
+/**
+ * Map a database file and validate its metadata.
+ *
+ * @param path The .mmdb file.
+ * @param err_str Set to a g_allocated error message on failure. May be NULL.
+ * @return A new reader, or NULL on failure.
+ */
+WS_DLL_LOCAL mmdb_reader_t *mmdb_reader_open(const char *path, char **err_str);
+
+/**
+ * Unmap a database file and free its reader. NULL is allowed.
+ */
+WS_DLL_LOCAL void mmdb_reader_close(mmdb_reader_t *reader);
+
+/**
+ * @return The database_type metadata value, e.g. "GeoLite2-City".
+ */
+WS_DLL_LOCAL const char *mmdb_reader_database_type(const mmdb_reader_t *reader);
+
+/**
+ * Look up an address in the search tree.
+ *
+ * @param reader The database.
+ * @param addr The address.
+ * @param entry Set to the offset of the address's record in the data section.
+ * @return true if the database has a record for the address.
+ */
+WS_DLL_LOCAL bool mmdb_reader_lookup_ipv4(const mmdb_reader_t *reader, const ws_in4_addr *addr, uint32_t *entry);
+
+/** IPv6 version of mmdb_reader_lookup_ipv4. */
+WS_DLL_LOCAL bool mmdb_reader_lookup_ipv6(const mmdb_reader_t *reader, const ws_in6_addr *addr, uint32_t *entry);
+
+/**
+ * Fetch a value from a record by following a path of map keys, like
+ * MMDB_aget_value does.
+ *
+ * @param reader The database.
+ * @param entry A record offset returned by a lookup.
+ * @param path NULL-terminated list of map keys, e.g. { "city", "names", "en", NULL }.
+ * @param value Set to the value. Containers are reported as MMDB_VALUE_NONE.
+ * @return true if the value exists.
+ */
+WS_DLL_LOCAL bool mmdb_reader_get_value(const mmdb_reader_t *reader, uint32_t entry, const char * const *path, mmdb_value_t *value);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MMDB_READER_H__ */
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
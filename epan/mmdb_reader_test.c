@@ -0,0 +1,426 @@
+/* mmdb_reader_test.c
+ * Unit tests for the MaxMind DB reader
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <epan/mmdb_reader.h>
+
+#include <wsutil/inet_addr.h>
+#include <wsutil/wslog.h>
+
+/*
+ * The databases in test/mmdb are written by make-test-mmdb.py. All of them
+ * map 1.2.3.0/24 to a Swedish record, and the IPv6 ones also map
+ * 2001:db8::/32 to a German record.
+ */
+static const char *mmdb_dir;
+
+#define MMDB_MARKER     "\xAB\xCD\xEFMaxMind.com"
+#define MMDB_MARKER_LEN (sizeof(MMDB_MARKER) - 1)
+
+static const char *databases[] = {
+    "test-ipv6-24.mmdb",
+    "test-ipv6-28.mmdb",
+    "test-ipv4-32.mmdb",
+};
+
+static char *
+db_path(const char *name)
+{
+    return g_build_filename(mmdb_dir, name, NULL);
+}
+
+static mmdb_reader_t *
+open_db(const char *name)
+{
+    char *path = db_path(name);
+    char *err = NULL;
+    mmdb_reader_t *reader = mmdb_reader_open(path, &err);
+
+    if (!reader) {
+        g_test_message("%s: %s", path, err);
+    }
+    g_assert_nonnull(reader);
+    g_assert_null(err);
+    g_free(path);
+    return reader;
+}
+
+static void
+check_string(const mmdb_reader_t *reader, uint32_t entry, const char * const *path, const char *expected)
+{
+    mmdb_value_t value;
+
+    g_assert_true(mmdb_reader_get_value(reader, entry, path, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_STRING);
+    g_assert_cmpuint(value.str_len, ==, strlen(expected));
+    g_assert_true(memcmp(value.str, expected, value.str_len) == 0);
+}
+
+static void
+check_uint(const mmdb_reader_t *reader, uint32_t entry, const char * const *path, uint64_t expected)
+{
+    mmdb_value_t value;
+
+    g_assert_true(mmdb_reader_get_value(reader, entry, path, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_UINT);
+    g_assert_cmpuint(value.uint, ==, expected);
+}
+
+static void
+check_double(const mmdb_reader_t *reader, uint32_t entry, const char * const *path, double expected)
+{
+    mmdb_value_t value;
+
+    g_assert_true(mmdb_reader_get_value(reader, entry, path, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_DOUBLE);
+    g_assert_cmpfloat_with_epsilon(value.dbl, expected, 1e-6);
+}
+
+static bool
+lookup_ipv4(const mmdb_reader_t *reader, const char *addr_str, uint32_t *entry)
+{
+    ws_in4_addr addr;
+
+    g_assert_true(ws_inet_pton4(addr_str, &addr));
+    return mmdb_reader_lookup_ipv4(reader, &addr, entry);
+}
+
+static bool
+lookup_ipv6(const mmdb_reader_t *reader, const char *addr_str, uint32_t *entry)
+{
+    ws_in6_addr addr;
+
+    g_assert_true(ws_inet_pton6(addr_str, &addr));
+    return mmdb_reader_lookup_ipv6(reader, &addr, entry);
+}
+
+static void
+check_se_record(const mmdb_reader_t *reader, uint32_t entry)
+{
+    static const char *iso_code[] = { "country", "iso_code", NULL };
+    /* Reached through a 1-byte pointer. */
+    static const char *country[] = { "country", "names", "en", NULL };
+    static const char *city[] = { "city", "names", "en", NULL };
+    static const char *latitude[] = { "location", "latitude", NULL };
+    static const char *longitude[] = { "location", "longitude", NULL };
+    static const char *accuracy[] = { "location", "accuracy_radius", NULL };
+    static const char *asn[] = { "autonomous_system_number", NULL };
+    /* Reached through a 4-byte pointer. */
+    static const char *as_org[] = { "autonomous_system_organization", NULL };
+    static const char *test_int[] = { "test", "int", NULL };
+    static const char *test_flag[] = { "test", "flag", NULL };
+    static const char *test_big[] = { "test", "big", NULL };
+    static const char *test_list[] = { "test", "list", NULL };
+    static const char *missing[] = { "country", "confidence", NULL };
+    static const char *not_a_map[] = { "country", "iso_code", "en", NULL };
+    mmdb_value_t value;
+
+    check_string(reader, entry, iso_code, "SE");
+    check_string(reader, entry, country, "Sweden");
+    check_string(reader, entry, city, "Stockholm");
+    check_double(reader, entry, latitude, 59.3293);
+    check_double(reader, entry, longitude, 18.0686);
+    check_uint(reader, entry, accuracy, 50);
+    check_uint(reader, entry, asn, 64512);
+    check_string(reader, entry, as_org, "Example AS");
+
+    g_assert_true(mmdb_reader_get_value(reader, entry, test_int, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_INT);
+    g_assert_cmpint(value.sint, ==, -5);
+
+    g_assert_true(mmdb_reader_get_value(reader, entry, test_flag, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_BOOLEAN);
+    g_assert_cmpuint(value.uint, ==, 1);
+
+    check_uint(reader, entry, test_big, UINT64_C(1) << 40);
+
+    /* Arrays are found but have no scalar value. */
+    g_assert_true(mmdb_reader_get_value(reader, entry, test_list, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_NONE);
+
+    g_assert_false(mmdb_reader_get_value(reader, entry, missing, &value));
+    g_assert_false(mmdb_reader_get_value(reader, entry, not_a_map, &value));
+}
+
+static void
+check_de_record(const mmdb_reader_t *reader, uint32_t entry)
+{
+    static const char *iso_code[] = { "country", "iso_code", NULL };
+    static const char *country[] = { "country", "names", "en", NULL };
+    static const char *city[] = { "city", "names", "en", NULL };
+    /* Floats. */
+    static const char *latitude[] = { "location", "latitude", NULL };
+    static const char *longitude[] = { "location", "longitude", NULL };
+    static const char *asn[] = { "autonomous_system_number", NULL };
+    /* Reached through a 2-byte pointer. */
+    static const char *as_org[] = { "autonomous_system_organization", NULL };
+    mmdb_value_t value;
+
+    check_string(reader, entry, iso_code, "DE");
+    check_string(reader, entry, country, "Germany");
+    check_double(reader, entry, latitude, 52.5);
+    check_double(reader, entry, longitude, 13.25);
+    check_uint(reader, entry, asn, 64513);
+    check_string(reader, entry, as_org, "Example AS");
+    g_assert_false(mmdb_reader_get_value(reader, entry, city, &value));
+}
+
+static void
+test_lookup(const void *data)
+{
+    const char *name = (const char *)data;
+    mmdb_reader_t *reader = open_db(name);
+    bool is_ipv6 = strstr(name, "ipv6") != NULL;
+    uint32_t entry;
+
+    g_assert_cmpstr(mmdb_reader_database_type(reader), ==, "Wireshark-Test");
+
+    g_assert_true(lookup_ipv4(reader, "1.2.3.0", &entry));
+    check_se_record(reader, entry);
+    g_assert_true(lookup_ipv4(reader, "1.2.3.255", &entry));
+    check_se_record(reader, entry);
+    g_assert_false(lookup_ipv4(reader, "1.2.4.0", &entry));
+    g_assert_false(lookup_ipv4(reader, "0.0.0.0", &entry));
+    g_assert_false(lookup_ipv4(reader, "255.255.255.255", &entry));
+
+    if (is_ipv6) {
+        g_assert_true(lookup_ipv6(reader, "2001:db8::1", &entry));
+        check_de_record(reader, entry);
+        g_assert_true(lookup_ipv6(reader, "2001:db8:ffff:ffff:ffff:ffff:ffff:ffff", &entry));
+        check_de_record(reader, entry);
+        /* IPv4 addresses live at ::a.b.c.d in IPv6 databases. */
+        g_assert_true(lookup_ipv6(reader, "::1.2.3.4", &entry));
+        check_se_record(reader, entry);
+        g_assert_false(lookup_ipv6(reader, "2001:db9::", &entry));
+        g_assert_false(lookup_ipv6(reader, "::", &entry));
+    } else {
+        g_assert_false(lookup_ipv6(reader, "2001:db8::1", &entry));
+    }
+
+    mmdb_reader_close(reader);
+}
+
+static void
+test_open_errors(void)
+{
+    char *path = db_path("does-not-exist.mmdb");
+    char *err = NULL;
+
+    g_assert_null(mmdb_reader_open(path, &err));
+    g_assert_nonnull(err);
+    g_free(err);
+    g_free(path);
+
+    /* The error message is optional. */
+    path = db_path("make-test-mmdb.py");
+    g_assert_null(mmdb_reader_open(path, NULL));
+    g_free(path);
+
+    mmdb_reader_close(NULL);
+}
+
+static char *
+write_tmp(const uint8_t *contents, size_t len)
+{
+    GError *err = NULL;
+    char *tmp_path = NULL;
+    int fd = g_file_open_tmp("mmdb_reader_test_XXXXXX.mmdb", &tmp_path, &err);
+
+    g_assert_no_error(err);
+    g_close(fd, NULL);
+    g_assert_true(g_file_set_contents(tmp_path, (const char *)contents, (gssize)len, &err));
+    g_assert_no_error(err);
+    return tmp_path;
+}
+
+/*
+ * Look up everything we know about in a damaged database. We can't say
+ * what the results are, only that reading them stays inside the file.
+ */
+static void
+exercise_reader(const mmdb_reader_t *reader)
+{
+    static const char *paths[][4] = {
+        { "country", "iso_code", NULL },
+        { "country", "names", "en", NULL },
+        { "city", "names", "en", NULL },
+        { "location", "latitude", NULL },
+        { "location", "accuracy_radius", NULL },
+        { "autonomous_system_number", NULL },
+        { "autonomous_system_organization", NULL },
+        { "test", "big", NULL },
+        { "test", "list", NULL },
+    };
+    static const char *addrs[] = { "1.2.3.4", "2001:db8::1", "::1.2.3.4", "10.0.0.1", "ffff::1" };
+    mmdb_value_t value;
+    uint32_t entry;
+    volatile char last;
+
+    (void)mmdb_reader_database_type(reader);
+    for (size_t i = 0; i < G_N_ELEMENTS(addrs); i++) {
+        bool found = strchr(addrs[i], ':') ?
+            lookup_ipv6(reader, addrs[i], &entry) :
+            lookup_ipv4(reader, addrs[i], &entry);
+        if (!found) {
+            continue;
+        }
+        for (size_t j = 0; j < G_N_ELEMENTS(paths); j++) {
+            if (mmdb_reader_get_value(reader, entry, paths[j], &value) &&
+                    value.type == MMDB_VALUE_STRING && value.str_len > 0) {
+                /* Touch the last byte so that ASan catches overruns. */
+                last = value.str[value.str_len - 1];
+                (void)last;
+            }
+        }
+    }
+}
+
+static void
+test_truncated(const void *data)
+{
+    const char *name = (const char *)data;
+    char *path = db_path(name);
+    char *contents;
+    size_t len;
+    size_t metadata_pos = 0;
+    GError *err = NULL;
+
+    g_assert_true(g_file_get_contents(path, &contents, &len, &err));
+    g_assert_no_error(err);
+    for (size_t i = len - MMDB_MARKER_LEN; i > 0; i--) {
+        if (memcmp(contents + i, MMDB_MARKER, MMDB_MARKER_LEN) == 0) {
+            metadata_pos = i + MMDB_MARKER_LEN;
+            break;
+        }
+    }
+    g_assert_cmpuint(metadata_pos, >, 0);
+
+    /*
+     * Cutting the file anywhere before its metadata removes the marker, so
+     * open must fail. Cutting the metadata may leave the fields we need,
+     * in which case the reader has to cope with the rest being gone.
+     */
+    for (size_t cut = 0; cut < len; cut++) {
+        char *tmp_path = write_tmp((const uint8_t *)contents, cut);
+        char *open_err = NULL;
+        mmdb_reader_t *reader = mmdb_reader_open(tmp_path, &open_err);
+
+        if (cut <= metadata_pos) {
+            g_assert_null(reader);
+        }
+        if (reader) {
+            exercise_reader(reader);
+            mmdb_reader_close(reader);
+        } else {
+            g_assert_nonnull(open_err);
+        }
+        g_free(open_err);
+        g_remove(tmp_path);
+        g_free(tmp_path);
+    }
+
+    g_free(contents);
+    g_free(path);
+}
+
+static void
+test_corrupt(const void *data)
+{
+    const char *name = (const char *)data;
+    char *path = db_path(name);
+    uint8_t *contents;
+    uint8_t *damaged;
+    size_t len;
+    GError *err = NULL;
+    GRand *rand = g_rand_new_with_seed(20241018);
+
+    g_assert_true(g_file_get_contents(path, (char **)&contents, &len, &err));
+    g_assert_no_error(err);
+    damaged = (uint8_t *)g_malloc(len);
+
+    for (unsigned iter = 0; iter < 500; iter++) {
+        unsigned flips = g_rand_int_range(rand, 1, 9);
+        char *tmp_path;
+        mmdb_reader_t *reader;
+
+        memcpy(damaged, contents, len);
+        for (unsigned i = 0; i < flips; i++) {
+            damaged[g_rand_int_range(rand, 0, (int32_t)len)] = (uint8_t)g_rand_int(rand);
+        }
+
+        tmp_path = write_tmp(damaged, len);
+        reader = mmdb_reader_open(tmp_path, NULL);
+        if (reader) {
+            exercise_reader(reader);
+            mmdb_reader_close(reader);
+        }
+        g_remove(tmp_path);
+        g_free(tmp_path);
+    }
+
+    g_rand_free(rand);
+    g_free(damaged);
+    g_free(contents);
+    g_free(path);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    ws_log_init("mmdb_reader_test", NULL);
+
+    g_test_init(&argc, &argv, NULL);
+
+    if (argc != 2) {
+        g_printerr("Usage: %s <directory containing the test .mmdb files>\n", argv[0]);
+        return 1;
+    }
+    mmdb_dir = argv[1];
+
+    g_test_add_func("/mmdb_reader/open_errors", test_open_errors);
+    for (size_t i = 0; i < G_N_ELEMENTS(databases); i++) {
+        char *test_path;
+
+        test_path = g_strdup_printf("/mmdb_reader/lookup/%s", databases[i]);
+        g_test_add_data_func(test_path, databases[i], test_lookup);
+        g_free(test_path);
+        test_path = g_strdup_printf("/mmdb_reader/truncated/%s", databases[i]);
+        g_test_add_data_func(test_path, databases[i], test_truncated);
+        g_free(test_path);
+        test_path = g_strdup_printf("/mmdb_reader/corrupt/%s", databases[i]);
+        g_test_add_data_func(test_path, databases[i], test_corrupt);
+        g_free(test_path);
+    }
+
+    ret = g_test_run();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -33,6 +33,7 @@
 #include <epan/wmem_scopes.h>
 
 #include <epan/column-info.h>
+#include <epan/dissector_profile.h>
 #include <epan/exceptions.h>
 #include <epan/reassemble.h>
 #include <epan/stream.h>
@@ -82,9 +83,18 @@ struct data_source {
  *
  * "protocol" is the protocol associated with the dissector table. Used
  * for determining dependencies.
+ *
+ * "dense_entries" is, for a uint table with 8-bit or 16-bit values that
+ * has been looked up often enough, an array indexed by value with the
+ * same entries as "hash_table", kept in step with it; "dense_max" is the
+ * largest value it can hold, or 0 if the table can't have one, and
+ * "lookups" counts the lookups made before it was built.
  */
 struct dissector_table {
 	GHashTable	*hash_table;
+	dtbl_entry_t	**dense_entries;
+	uint32_t	dense_max;
+	unsigned	lookups;
 	GSList		*dissector_handles;
 	const char	*ui_name;
 	ftenum_t	type;
@@ -161,6 +171,8 @@ struct heur_dissector_list {
 	const char	*ui_name;
 	protocol_t	*protocol;
 	GSList		*dissectors;
+	uint64_t	calls;		/* dissector_try_heuristic() calls */
+	uint64_t	hits;		/* calls where a dissector matched */
 };
 
 static GHashTable *heur_dissector_lists;
@@ -193,6 +205,7 @@ destroy_dissector_table(void *data)
 	struct dissector_table *table = (struct dissector_table *)data;
 
 	g_hash_table_destroy(table->hash_table);
+	g_free(table->dense_entries);
 	g_slist_free(table->dissector_handles);
 	g_slice_free(struct dissector_table, data);
 }
@@ -843,6 +856,47 @@ remove_last_layer(packet_info *pinfo, bool reduce_count)
  * from "packet did not match this protocol".  See issues #12366 and
  * #12368.
  */
+static int
+call_dissector_func(dissector_handle_t handle, tvbuff_t *tvb,
+		    packet_info *pinfo, proto_tree *tree, void *data)
+{
+	switch (handle->dissector_type) {
+
+	case DISSECTOR_TYPE_SIMPLE:
+		return (handle->dissector_func.dissector_type_simple)(tvb, pinfo, tree, data);
+
+	case DISSECTOR_TYPE_CALLBACK:
+		return (handle->dissector_func.dissector_type_callback)(tvb, pinfo, tree, data, handle->dissector_data);
+
+	default:
+		ws_assert_not_reached();
+	}
+}
+
+/*
+ * Call a dissector and charge its time and allocations to its protocol.
+ * The frame must be left even if an exception unwinds through us,
+ * otherwise the time of everything that follows would be charged to it.
+ */
+static int
+call_dissector_func_profiled(dissector_handle_t handle, tvbuff_t *tvb,
+			     packet_info *pinfo, proto_tree *tree, void *data)
+{
+	dissector_profile_frame_t frame;
+	volatile int len = 0;
+
+	dissector_profile_enter(&frame, pinfo, proto_get_id(handle->protocol));
+	TRY {
+		len = call_dissector_func(handle, tvb, pinfo, tree, data);
+	}
+	FINALLY {
+		dissector_profile_leave(&frame, pinfo);
+	}
+	ENDTRY;
+
+	return len;
+}
+
 static int
 call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 			      packet_info *pinfo, proto_tree *tree, void *data)
@@ -857,19 +911,11 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 			proto_get_protocol_short_name(handle->protocol);
 	}
 
-	switch (handle->dissector_type) {
-
-	case DISSECTOR_TYPE_SIMPLE:
-		len = (handle->dissector_func.dissector_type_simple)(tvb, pinfo, tree, data);
-		break;
-
-	case DISSECTOR_TYPE_CALLBACK:
-		len = (handle->dissector_func.dissector_type_callback)(tvb, pinfo, tree, data, handle->dissector_data);
-		break;
+	if (G_UNLIKELY(dissector_profile_active) && handle->protocol != NULL)
+		len = call_dissector_func_profiled(handle, tvb, pinfo, tree, data);
+	else
+		len = call_dissector_func(handle, tvb, pinfo, tree, data);
 
-	default:
-		ws_assert_not_reached();
-	}
 	pinfo->current_proto = saved_proto;
 
 	return len;
@@ -1130,10 +1176,66 @@ find_dissector_table(const char *name)
 	return dissector_table;
 }
 
+/*
+ * Tables such as "ethertype", "tcp.port" and "udp.port" are looked up
+ * several times for every packet. Once a table with 8-bit or 16-bit
+ * values has been looked up this often, index its entries by value too.
+ */
+#define DENSE_DTBL_LOOKUPS	1000
+
+static void
+build_dense_uint_dtbl(dissector_table_t sub_dissectors)
+{
+	GHashTableIter iter;
+	void *key, *value;
+
+	g_free(sub_dissectors->dense_entries);
+	sub_dissectors->dense_entries = g_new0(dtbl_entry_t *, sub_dissectors->dense_max + 1);
+
+	g_hash_table_iter_init(&iter, sub_dissectors->hash_table);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		uint32_t pattern = GPOINTER_TO_UINT(key);
+
+		/* Nothing stops a value too large for the table being added. */
+		if (pattern <= sub_dissectors->dense_max)
+			sub_dissectors->dense_entries[pattern] = (dtbl_entry_t *)value;
+	}
+}
+
+/* Insert or remove an entry in a uint dissector table. */
+static void
+insert_uint_dtbl_entry(dissector_table_t sub_dissectors, const uint32_t pattern,
+		       dtbl_entry_t *dtbl_entry)
+{
+	g_hash_table_insert(sub_dissectors->hash_table,
+			     GUINT_TO_POINTER(pattern), (void *)dtbl_entry);
+	if (sub_dissectors->dense_entries != NULL && pattern <= sub_dissectors->dense_max)
+		sub_dissectors->dense_entries[pattern] = dtbl_entry;
+}
+
+static void
+remove_uint_dtbl_entry(dissector_table_t sub_dissectors, const uint32_t pattern)
+{
+	g_hash_table_remove(sub_dissectors->hash_table,
+			    GUINT_TO_POINTER(pattern));
+	if (sub_dissectors->dense_entries != NULL && pattern <= sub_dissectors->dense_max)
+		sub_dissectors->dense_entries[pattern] = NULL;
+}
+
 /* Find an entry in a uint dissector table. */
 static dtbl_entry_t *
 find_uint_dtbl_entry(dissector_table_t sub_dissectors, const uint32_t pattern)
 {
+	if (sub_dissectors->dense_entries != NULL) {
+		if (pattern <= sub_dissectors->dense_max)
+			return sub_dissectors->dense_entries[pattern];
+	} else if (sub_dissectors->dense_max != 0 &&
+		   ++sub_dissectors->lookups >= DENSE_DTBL_LOOKUPS) {
+		build_dense_uint_dtbl(sub_dissectors);
+		if (pattern <= sub_dissectors->dense_max)
+			return sub_dissectors->dense_entries[pattern];
+	}
+
 	switch (sub_dissectors->type) {
 
 	case FT_UINT8:
@@ -1240,8 +1342,7 @@ dissector_add_uint(const char *name, const uint32_t pattern, dissector_handle_t
 	dtbl_entry->initial = dtbl_entry->current;
 
 	/* do the table insertion */
-	g_hash_table_insert(sub_dissectors->hash_table,
-			     GUINT_TO_POINTER(pattern), (void *)dtbl_entry);
+	insert_uint_dtbl_entry(sub_dissectors, pattern, dtbl_entry);
 
 	/*
 	 * Now, if this table supports "Decode As", add this handle
@@ -1396,8 +1497,7 @@ dissector_delete_uint(const char *name, const uint32_t pattern,
 		/*
 		 * Found - remove it.
 		 */
-		g_hash_table_remove(sub_dissectors->hash_table,
-				    GUINT_TO_POINTER(pattern));
+		remove_uint_dtbl_entry(sub_dissectors, pattern);
 	}
 }
 
@@ -1468,7 +1568,9 @@ void dissector_delete_all(const char *name, dissector_handle_t handle)
 	dissector_table_t sub_dissectors = find_dissector_table(name);
 	ws_assert (sub_dissectors);
 
-	g_hash_table_foreach_remove (sub_dissectors->hash_table, dissector_delete_all_check, handle);
+	if (g_hash_table_foreach_remove (sub_dissectors->hash_table, dissector_delete_all_check, handle) &&
+	    sub_dissectors->dense_entries != NULL)
+		build_dense_uint_dtbl(sub_dissectors);
 }
 
 static void
@@ -1477,7 +1579,9 @@ dissector_delete_from_table(gpointer key _U_, gpointer value, gpointer user_data
 	dissector_table_t sub_dissectors = (dissector_table_t) value;
 	ws_assert (sub_dissectors);
 
-	g_hash_table_foreach_remove(sub_dissectors->hash_table, dissector_delete_all_check, user_data);
+	if (g_hash_table_foreach_remove(sub_dissectors->hash_table, dissector_delete_all_check, user_data) &&
+	    sub_dissectors->dense_entries != NULL)
+		build_dense_uint_dtbl(sub_dissectors);
 	sub_dissectors->dissector_handles = g_slist_remove(sub_dissectors->dissector_handles, user_data);
 }
 
@@ -1509,8 +1613,7 @@ dissector_change_uint(const char *name, const uint32_t pattern, dissector_handle
 		 * to decode it, just remove the entry to save memory.
 		 */
 		if (handle == NULL && dtbl_entry->initial == NULL) {
-			g_hash_table_remove(sub_dissectors->hash_table,
-					    GUINT_TO_POINTER(pattern));
+			remove_uint_dtbl_entry(sub_dissectors, pattern);
 			return;
 		}
 		dtbl_entry->current = handle;
@@ -1530,8 +1633,7 @@ dissector_change_uint(const char *name, const uint32_t pattern, dissector_handle
 	dtbl_entry->current = handle;
 
 	/* do the table insertion */
-	g_hash_table_insert(sub_dissectors->hash_table,
-			     GUINT_TO_POINTER(pattern), (void *)dtbl_entry);
+	insert_uint_dtbl_entry(sub_dissectors, pattern, dtbl_entry);
 }
 
 /* Reset an entry in a uint dissector table to its initial value. */
@@ -1558,8 +1660,7 @@ dissector_reset_uint(const char *name, const uint32_t pattern)
 	if (dtbl_entry->initial != NULL) {
 		dtbl_entry->current = dtbl_entry->initial;
 	} else {
-		g_hash_table_remove(sub_dissectors->hash_table,
-				    GUINT_TO_POINTER(pattern));
+		remove_uint_dtbl_entry(sub_dissectors, pattern);
 	}
 }
 
@@ -2730,6 +2831,9 @@ register_dissector_table(const char *name, const char *ui_name, const int proto,
 	/* Create and register the dissector table for this name; returns */
 	/* a pointer to the dissector table. */
 	sub_dissectors = g_slice_new(struct dissector_table);
+	sub_dissectors->dense_entries = NULL;
+	sub_dissectors->dense_max = 0;
+	sub_dissectors->lookups = 0;
 	switch (type) {
 
 	case FT_UINT8:
@@ -2745,6 +2849,10 @@ register_dissector_table(const char *name, const char *ui_name, const int proto,
 							       g_direct_equal,
 							       NULL,
 							       &g_free);
+		if (type == FT_UINT8)
+			sub_dissectors->dense_max = UINT8_MAX;
+		else if (type == FT_UINT16)
+			sub_dissectors->dense_max = UINT16_MAX;
 		break;
 
 	case FT_STRING:
@@ -2803,6 +2911,9 @@ dissector_table_t register_custom_dissector_table(const char *name,
 	/* Create and register the dissector table for this name; returns */
 	/* a pointer to the dissector table. */
 	sub_dissectors = g_slice_new(struct dissector_table);
+	sub_dissectors->dense_entries = NULL;
+	sub_dissectors->dense_max = 0;
+	sub_dissectors->lookups = 0;
 	sub_dissectors->hash_func = hash_func;
 	sub_dissectors->hash_table = g_hash_table_new_full(hash_func,
 							       key_equal_func,
@@ -2971,6 +3082,13 @@ heur_dissector_add(const char *name, heur_dissector_t dissector, const char *dis
 	hdtbl_entry->list_name = g_strdup(name);
 	hdtbl_entry->enabled   = (enable == HEURISTIC_ENABLE);
 	hdtbl_entry->enabled_by_default = (enable == HEURISTIC_ENABLE);
+	hdtbl_entry->min_length = 0;
+	hdtbl_entry->magic_offset = 0;
+	hdtbl_entry->magic_length = 0;
+	hdtbl_entry->magic = NULL;
+	hdtbl_entry->tries = 0;
+	hdtbl_entry->hits = 0;
+	hdtbl_entry->screened = 0;
 
 	/* do the table insertion */
 	g_hash_table_insert(heuristic_short_names, (void *)hdtbl_entry->short_name, hdtbl_entry);
@@ -3025,6 +3143,90 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 	}
 }
 
+void
+heur_dissector_set_prescreen(const char *short_name, unsigned min_length,
+			     unsigned magic_offset, const uint8_t *magic, unsigned magic_length)
+{
+	heur_dtbl_entry_t *hdtbl_entry = find_heur_dissector_by_unique_short_name(short_name);
+
+	if (hdtbl_entry == NULL) {
+		fprintf(stderr, "OOPS: heuristic dissector \"%s\" doesn't exist\n",
+		    short_name);
+		if (wireshark_abort_on_dissector_bug)
+			abort();
+		return;
+	}
+
+	hdtbl_entry->min_length = min_length;
+	hdtbl_entry->magic_offset = magic_offset;
+	hdtbl_entry->magic_length = magic ? magic_length : 0;
+	hdtbl_entry->magic = magic_length ? magic : NULL;
+}
+
+/*
+ * Returns true if the entry's pre-screen rules out this tvb. Magic bytes
+ * that weren't captured don't rule it out; the dissector decides.
+ */
+static bool
+heur_prescreen_rejects(const heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb)
+{
+	if (tvb_reported_length(tvb) < hdtbl_entry->min_length)
+		return true;
+
+	if (hdtbl_entry->magic != NULL &&
+	    tvb_bytes_exist(tvb, hdtbl_entry->magic_offset, hdtbl_entry->magic_length) &&
+	    tvb_memeql(tvb, hdtbl_entry->magic_offset, hdtbl_entry->magic, hdtbl_entry->magic_length) != 0)
+		return true;
+
+	return false;
+}
+
+/*
+ * Move a matched entry up to just before the first entry with fewer hits.
+ * Entries with as many hits stay ahead of it, so a list with stable hit
+ * counts doesn't change order from one packet to the next.
+ */
+static void
+heur_list_promote(heur_dissector_list_t sub_dissectors, GSList *entry)
+{
+	uint64_t hits = ((heur_dtbl_entry_t *)entry->data)->hits;
+	GSList **link;
+
+	sub_dissectors->dissectors = g_slist_remove_link(sub_dissectors->dissectors, entry);
+	for (link = &sub_dissectors->dissectors; *link != NULL; link = &(*link)->next) {
+		if (((heur_dtbl_entry_t *)(*link)->data)->hits < hits)
+			break;
+	}
+	entry->next = *link;
+	*link = entry;
+}
+
+/*
+ * Call a heuristic dissector, profiling it like call_dissector_func_profiled()
+ * if dissector profiling is on.
+ */
+static bool
+call_heur_dissector_func(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+			 packet_info *pinfo, proto_tree *tree, void *data)
+{
+	dissector_profile_frame_t frame;
+	volatile bool accepted = false;
+
+	if (G_LIKELY(!dissector_profile_active) || hdtbl_entry->protocol == NULL)
+		return (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+
+	dissector_profile_enter(&frame, pinfo, proto_get_id(hdtbl_entry->protocol));
+	TRY {
+		accepted = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+	}
+	FINALLY {
+		dissector_profile_leave(&frame, pinfo);
+	}
+	ENDTRY;
+
+	return accepted;
+}
+
 bool
 dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **heur_dtbl_entry, void *data)
@@ -3065,6 +3267,8 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 
 	DISSECTOR_ASSERT(saved_layers_len < prefs.gui_max_tree_depth);
 
+	sub_dissectors->calls++;
+
 	for (entry = sub_dissectors->dissectors; entry != NULL;
 	    entry = g_slist_next(entry)) {
 		/* XXX - why set this now and above? */
@@ -3079,6 +3283,12 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			continue;
 		}
 
+		if (heur_prescreen_rejects(hdtbl_entry, tvb)) {
+			hdtbl_entry->screened++;
+			prev_entry = entry;
+			continue;
+		}
+
 		if (hdtbl_entry->protocol != NULL) {
 			proto_id = proto_get_id(hdtbl_entry->protocol);
 			/* do NOT change this behavior - wslua uses the protocol short name set here in order
@@ -3096,7 +3306,8 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 		pinfo->heur_list_name = hdtbl_entry->list_name;
 
 		saved_desegment_len = pinfo->desegment_len;
-		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+		hdtbl_entry->tries++;
+		len = call_heur_dissector_func(hdtbl_entry, tvb, pinfo, tree, data);
 		consumed_none = len == 0 || (pinfo->desegment_len != saved_desegment_len && pinfo->desegment_offset == 0);
 		if (hdtbl_entry->protocol != NULL &&
 			(consumed_none || (tree && saved_tree_count == tree->tree_data->count))) {
@@ -3121,11 +3332,26 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			}
 
 			*heur_dtbl_entry = hdtbl_entry;
+			hdtbl_entry->hits++;
+			sub_dissectors->hits++;
 
-			/* Bubble the matched entry to the top for faster search next time. */
+			/* Reorder the list for faster search next time. */
 			if (prev_entry != NULL) {
-				sub_dissectors->dissectors = g_slist_remove_link(sub_dissectors->dissectors, entry);
-				sub_dissectors->dissectors = g_slist_concat(entry, sub_dissectors->dissectors);
+				switch (prefs.heur_dissector_order) {
+
+				case HEUR_ORDER_MOVE_TO_FRONT:
+					sub_dissectors->dissectors = g_slist_remove_link(sub_dissectors->dissectors, entry);
+					sub_dissectors->dissectors = g_slist_concat(entry, sub_dissectors->dissectors);
+					break;
+
+				case HEUR_ORDER_HITS:
+					if (((heur_dtbl_entry_t *)prev_entry->data)->hits < hdtbl_entry->hits)
+						heur_list_promote(sub_dissectors, entry);
+					break;
+
+				case HEUR_ORDER_FIXED:
+					break;
+				}
 			}
 			status = true;
 			break;
@@ -3234,7 +3460,7 @@ dissector_all_heur_tables_foreach_table (DATFunc_heur_table func,
 	info.caller_func = func;
 	if (compare_key_func != NULL)
 	{
-		list = g_hash_table_get_keys(dissector_tables);
+		list = g_hash_table_get_keys(heur_dissector_lists);
 		list = g_list_sort(list, compare_key_func);
 		g_list_foreach(list, dissector_all_heur_tables_foreach_list_func, &info);
 		g_list_free(list);
@@ -3292,6 +3518,8 @@ register_heur_dissector_list_with_description(const char *name, const char *ui_n
 	sub_dissectors->protocol  = (proto == -1) ? NULL : find_protocol_by_id(proto);
 	sub_dissectors->ui_name = ui_name;
 	sub_dissectors->dissectors = NULL;	/* initially empty */
+	sub_dissectors->calls = 0;
+	sub_dissectors->hits = 0;
 	g_hash_table_insert(heur_dissector_lists, (void *)name,
 			    (void *) sub_dissectors);
 	return sub_dissectors;
@@ -3320,6 +3548,13 @@ heur_dissector_list_get_description(heur_dissector_list_t list)
 	return list ? list->ui_name : NULL;
 }
 
+void
+heur_dissector_list_get_stats(heur_dissector_list_t list, uint64_t *calls, uint64_t *hits)
+{
+	*calls = list ? list->calls : 0;
+	*hits = list ? list->hits : 0;
+}
+
 /*
  * Register dissectors by name; used if one dissector always calls a
  * particular dissector, or if it bases the decision of which dissector
@@ -3742,7 +3977,7 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 	pinfo->heur_list_name = heur_dtbl_entry->list_name;
 
 	/* call the dissector, in case of failure call data handle (might happen with exported PDUs) */
-	if (!(*heur_dtbl_entry->dissector)(tvb, pinfo, tree, data)) {
+	if (!call_heur_dissector_func(heur_dtbl_entry, tvb, pinfo, tree, data)) {
 		/*
 		 * We added a protocol layer above. The dissector
 		 * didn't accept the packet or it didn't add any
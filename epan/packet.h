@@ -468,6 +468,15 @@ typedef struct heur_dtbl_entry {
 	char *short_name;     /* string used for "internal" use to uniquely identify heuristic */
 	bool enabled;
 	bool enabled_by_default;
+	/* Optional pre-screen, see heur_dissector_set_prescreen() */
+	unsigned min_length;
+	unsigned magic_offset;
+	unsigned magic_length;
+	const uint8_t *magic;
+	/* Statistics, updated by dissector_try_heuristic() */
+	uint64_t tries;     /* times the dissector was called */
+	uint64_t hits;      /* times it accepted the packet */
+	uint64_t screened;  /* times the pre-screen skipped it */
 } heur_dtbl_entry_t;
 
 /** A protocol uses this function to register a heuristic sub-dissector list.
@@ -485,6 +494,15 @@ WS_DLL_PUBLIC heur_dissector_list_t register_heur_dissector_list_with_descriptio
  */
 WS_DLL_PUBLIC const char *heur_dissector_list_get_description(heur_dissector_list_t list);
 
+/** Get the number of times a heuristic sub-dissector list was tried and
+ *  the number of times one of its dissectors accepted the packet.
+ *
+ * @param list the dissector list
+ * @param calls set to the number of dissector_try_heuristic() calls
+ * @param hits set to the number of those calls that returned true
+ */
+WS_DLL_PUBLIC void heur_dissector_list_get_stats(heur_dissector_list_t list, uint64_t *calls, uint64_t *hits);
+
 /** A protocol uses this function to register a heuristic sub-dissector list.
  *  Call this in the parent dissectors proto_register function.
  *
@@ -578,6 +596,21 @@ WS_DLL_PUBLIC void heur_dissector_add(const char *name, heur_dissector_t dissect
  */
 WS_DLL_PUBLIC void heur_dissector_delete(const char *name, heur_dissector_t dissector, const int proto);
 
+/** Give a heuristic sub-dissector a cheap pre-screen that dissector_try_heuristic()
+ *  checks before calling it. The dissector is skipped if the reported length is
+ *  less than min_length, or if the magic bytes are captured and don't match.
+ *  The pre-screen must not reject anything the dissector itself would accept.
+ *  Call this in the proto_handoff function after heur_dissector_add().
+ *
+ * @param short_name the internal name given to heur_dissector_add(), e.g. "rtps_udp"
+ * @param min_length the minimum reported length of the tvb, or 0
+ * @param magic_offset the offset of the magic bytes
+ * @param magic the magic bytes, or NULL. Must stay valid, e.g. static data.
+ * @param magic_length the number of magic bytes
+ */
+WS_DLL_PUBLIC void heur_dissector_set_prescreen(const char *short_name, unsigned min_length,
+    unsigned magic_offset, const uint8_t *magic, unsigned magic_length);
+
 /** Register a new dissector. */
 WS_DLL_PUBLIC dissector_handle_t register_dissector(const char *name, dissector_t dissector, const int proto);
 
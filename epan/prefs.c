@@ -221,6 +221,13 @@ static const enum_val_t gui_packet_list_elide_mode[] = {
     {NULL, NULL, -1}
 };
 
+static const enum_val_t heur_dissector_order_options[] = {
+    {"MOVE_TO_FRONT", "Last match first", HEUR_ORDER_MOVE_TO_FRONT},
+    {"HITS", "Most matches first", HEUR_ORDER_HITS},
+    {"FIXED", "Fixed", HEUR_ORDER_FIXED},
+    {NULL, NULL, -1}
+};
+
 /** Struct to hold preference data */
 struct preference {
     const char *name;                /**< name of preference */
@@ -3976,6 +3983,14 @@ prefs_register_modules(void)
             "without menu path (only the part of the name after last '/' character.)",
             &prefs.st_sort_showfullname);
 
+    prefs_register_uint_preference(stats_module, "st_topk_max_items",
+            "Maximum items in high cardinality stats_tree nodes",
+            "Limits the number of items kept under stats_tree nodes whose values are "
+            "unbounded, such as DNS query names or HTTP hosts. Once the limit is reached "
+            "a new item replaces the least frequent one, whose count it inherits. "
+            "0 keeps all items.",
+            10, &prefs.st_topk_max_items);
+
     /* Protocols */
     protocols_module = prefs_register_module(NULL, "protocols", "Protocols",
                                              "Protocols", "ChCustPreferencesSection.html#ChCustPrefsProtocolsSection", NULL, true);
@@ -4017,6 +4032,14 @@ prefs_register_modules(void)
             "of cache entries to maintain. A 0 means no limit.",
             10, &prefs.ignore_dup_frames_cache_entries);
 
+    prefs_register_enum_preference(protocols_module, "heuristic_dissector_order",
+                                   "Heuristic dissector order",
+                                   "The order in which heuristic dissectors are tried. "
+                                   "\"Last match first\" moves a dissector to the front of its list when it matches. "
+                                   "\"Most matches first\" keeps each list sorted by the number of matches, so "
+                                   "one stray match doesn't change the order. \"Fixed\" never reorders the lists.",
+                                   (int *)&prefs.heur_dissector_order, heur_dissector_order_options, false);
+
 
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
@@ -4453,12 +4476,14 @@ pre_init_prefs(void)
     prefs.st_sort_defcolflag = ST_SORT_COL_COUNT;
     prefs.st_sort_defdescending = true;
     prefs.st_sort_showfullname = false;
+    prefs.st_topk_max_items = 1000;
 
     /* protocols */
     prefs.display_hidden_proto_items = false;
     prefs.display_byte_fields_with_spaces = false;
     prefs.ignore_dup_frames = false;
     prefs.ignore_dup_frames_cache_entries = 10000;
+    prefs.heur_dissector_order = HEUR_ORDER_MOVE_TO_FRONT;
 
     /* set the default values for the io graph dialog */
     prefs.gui_io_graph_automatic_update = true;
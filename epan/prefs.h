@@ -144,6 +144,15 @@ typedef enum {
     UPDATE_CHANNEL_STABLE
 } software_update_channel_e;
 
+/*
+ * Order in which heuristic dissectors are tried.
+ */
+typedef enum {
+    HEUR_ORDER_MOVE_TO_FRONT,   /* Last dissector that matched first */
+    HEUR_ORDER_HITS,            /* Most matches first, ties keep their order */
+    HEUR_ORDER_FIXED            /* Never reorder */
+} heur_order_e;
+
 typedef struct _e_prefs {
   GList       *col_list;
   int          num_cols;
@@ -220,6 +229,7 @@ typedef struct _e_prefs {
   bool         incomplete_dissectors_check_debug;
   bool         strict_conversation_tracking_heuristics;
   int          conversation_deinterlacing_key;
+  heur_order_e heur_dissector_order;
   bool         ignore_dup_frames;
   unsigned     ignore_dup_frames_cache_entries;
   bool         filter_expressions_old;  /* true if old filter expressions preferences were loaded. */
@@ -256,6 +266,7 @@ typedef struct _e_prefs {
   int          st_sort_defcolflag;
   bool         st_sort_defdescending;
   bool         st_sort_showfullname;
+  unsigned     st_topk_max_items;
   bool         extcap_save_on_start;
 } e_prefs;
 
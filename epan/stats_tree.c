@@ -111,6 +111,7 @@ free_stat_node(stat_node *node)
     }
 
     if (node->hash) g_hash_table_destroy(node->hash);
+    if (node->topk_heap) g_ptr_array_free(node->topk_heap, true);
 
     while (node->bh) {
         bucket = node->bh;
@@ -135,6 +136,7 @@ stats_tree_free(stats_tree *st)
     g_free(st->filter);
     g_hash_table_destroy(st->names);
     g_ptr_array_free(st->parents,true);
+    g_array_free(st->free_ids,true);
     g_free(st->display_name);
 
     for (child = st->root.children; child; child = next ) {
@@ -249,6 +251,7 @@ stats_tree_reinit(void *p)
     if (st->parents->len>1) {
         g_ptr_array_remove_range(st->parents, 1, st->parents->len-1);
     }
+    g_array_set_size(st->free_ids, 0);
 
     /* Do not update st_flags for the tree (sorting) - leave as was */
     st->num_columns = N_COLUMNS;
@@ -351,6 +354,7 @@ stats_tree_new(stats_tree_cfg *cfg, tree_pres *pr, const char *filter)
 
     st->names = g_hash_table_new(g_str_hash,g_str_equal);
     st->parents = g_ptr_array_new();
+    st->free_ids = g_array_new(false, false, sizeof(int));
     st->filter = g_strdup(filter);
 
     st->start = -1.0;
@@ -437,6 +441,7 @@ stats_tree_get_cfg_list(void)
 
 struct _stats_tree_pres_cbs {
     void (*setup_node_pr)(stat_node*);
+    void (*free_node_pr)(stat_node*);
     void (*free_tree_pr)(stats_tree*);
 };
 
@@ -447,6 +452,7 @@ setup_tree_presentation(void *k _U_, void *v, void *p)
     struct _stats_tree_pres_cbs *d = (struct _stats_tree_pres_cbs *)p;
 
     cfg->setup_node_pr = d->setup_node_pr;
+    cfg->free_node_pr = d->free_node_pr;
     cfg->free_tree_pr = d->free_tree_pr;
 
 }
@@ -454,12 +460,14 @@ setup_tree_presentation(void *k _U_, void *v, void *p)
 extern void
 stats_tree_presentation(void (*registry_iterator)(void *,void *,void *),
             void (*setup_node_pr)(stat_node*),
+            void (*free_node_pr)(stat_node*),
             void (*free_tree_pr)(stats_tree*),
             void *data)
 {
     static struct _stats_tree_pres_cbs d;
 
     d.setup_node_pr = setup_node_pr;
+    d.free_node_pr = free_node_pr;
     d.free_tree_pr = free_tree_pr;
 
     if (registry) g_hash_table_foreach(registry,setup_tree_presentation,&d);
@@ -470,6 +478,155 @@ stats_tree_presentation(void (*registry_iterator)(void *,void *,void *),
 }
 
 
+/*
+ * Top-K nodes keep their children in a min-heap ordered by counter.
+ * Once the node has topk_max children a new value takes over the child
+ * with the smallest counter, starting from that counter (the Space-Saving
+ * algorithm): the heaviest values stay in the tree and a value's count is
+ * never under-estimated. A child taken over loses its own children, and
+ * children with a hash get the same limit on their children.
+ */
+static bool
+topk_member(const stat_node *node)
+{
+    GPtrArray *heap = node->parent ? node->parent->topk_heap : NULL;
+
+    return heap && node->topk_pos < heap->len &&
+           g_ptr_array_index(heap, node->topk_pos) == node;
+}
+
+static void
+topk_swap(GPtrArray *heap, unsigned a, unsigned b)
+{
+    stat_node *node_a = (stat_node *)g_ptr_array_index(heap, a);
+    stat_node *node_b = (stat_node *)g_ptr_array_index(heap, b);
+
+    g_ptr_array_index(heap, a) = node_b;
+    node_b->topk_pos = a;
+    g_ptr_array_index(heap, b) = node_a;
+    node_a->topk_pos = b;
+}
+
+#define TOPK_COUNTER(heap, pos) (((stat_node *)g_ptr_array_index((heap), (pos)))->counter)
+
+/* restore the heap order after node's counter changed */
+static void
+topk_fix(stat_node *node)
+{
+    GPtrArray *heap = node->parent->topk_heap;
+    unsigned pos = node->topk_pos;
+
+    while (pos > 0 && TOPK_COUNTER(heap, (pos - 1) / 2) > node->counter) {
+        topk_swap(heap, pos, (pos - 1) / 2);
+        pos = (pos - 1) / 2;
+    }
+
+    for (;;) {
+        unsigned smallest = pos;
+        unsigned child = 2 * pos + 1;
+
+        if (child < heap->len && TOPK_COUNTER(heap, child) < TOPK_COUNTER(heap, smallest))
+            smallest = child;
+        if (child + 1 < heap->len && TOPK_COUNTER(heap, child + 1) < TOPK_COUNTER(heap, smallest))
+            smallest = child + 1;
+        if (smallest == pos)
+            break;
+        topk_swap(heap, pos, smallest);
+        pos = smallest;
+    }
+}
+
+/* gives node an id in st->parents, reusing the id of a node dropped from
+   a top-K node if there is one, and registers it in the root namespace */
+static void
+register_parent_node(stats_tree *st, stat_node *node)
+{
+    g_hash_table_replace(st->names, node->name, node);
+
+    if (st->free_ids->len > 0) {
+        node->id = g_array_index(st->free_ids, int, st->free_ids->len - 1);
+        g_array_set_size(st->free_ids, st->free_ids->len - 1);
+        g_ptr_array_index(st->parents, node->id) = node;
+    } else {
+        g_ptr_array_add(st->parents, node);
+        node->id = st->parents->len - 1;
+    }
+}
+
+/* releases the ids of a node about to be freed and of its children */
+static void
+// NOLINTNEXTLINE(misc-no-recursion)
+unregister_stat_node(stats_tree *st, stat_node *node)
+{
+    stat_node *child;
+
+    for (child = node->children; child; child = child->next)
+        // Recursion is limited by proto.c checks
+        unregister_stat_node(st, child);
+
+    if (node->id < 0)
+        return;
+
+    if (g_hash_table_lookup(st->names, node->name) == node)
+        g_hash_table_remove(st->names, node->name);
+    g_ptr_array_index(st->parents, node->id) = NULL;
+    g_array_append_val(st->free_ids, node->id);
+    node->id = -1;
+}
+
+static void
+topk_init(stat_node *node, unsigned topk_max)
+{
+    node->topk_max = topk_max;
+    node->topk_heap = g_ptr_array_new();
+}
+
+/* hands the least counted child of a full top-K node over to name */
+static stat_node *
+topk_recycle(stat_node *parent, const char *name, bool with_hash)
+{
+    stats_tree *st = parent->st;
+    stat_node *node = (stat_node *)g_ptr_array_index(parent->topk_heap, 0);
+    int min_count = node->counter;
+    stat_node *child;
+    stat_node *next;
+
+    /* the children counted the old value, drop them */
+    for (child = node->children; child; child = next) {
+        next = child->next;
+        unregister_stat_node(st, child);
+        if (child->pr && st->cfg->free_node_pr)
+            st->cfg->free_node_pr(child);
+        free_stat_node(child);
+    }
+    node->children = NULL;
+    if (node->hash)
+        g_hash_table_remove_all(node->hash);
+    if (node->topk_heap)
+        g_ptr_array_set_size(node->topk_heap, 0);
+
+    g_hash_table_remove(parent->hash, node->name);
+    if (node->id >= 0 && g_hash_table_lookup(st->names, node->name) == node)
+        g_hash_table_remove(st->names, node->name);
+    g_free(node->name);
+    node->name = g_strdup(name);
+    g_hash_table_insert(parent->hash, node->name, node);
+
+    if (node->id >= 0) {
+        g_hash_table_replace(st->names, node->name, node);
+    } else if (with_hash) {
+        /* a leaf taken over by a value that is going to have children */
+        node->hash = g_hash_table_new(g_str_hash,g_str_equal);
+        register_parent_node(st, node);
+        topk_init(node, parent->topk_max);
+    }
+
+    reset_stat_node(node);
+    node->counter = min_count;
+
+    return node;
+}
+
 /* creates a stat_tree node
 *    name: the name of the stats_tree node
 *    parent_name: the name of the ALREADY REGISTERED parent
@@ -507,13 +664,7 @@ new_stat_node(stats_tree *st, const char *name, int parent_id, stat_node_datatyp
     node->hash = with_hash ? g_hash_table_new(g_str_hash,g_str_equal) : NULL;
 
     if (as_parent_node) {
-        g_hash_table_insert(st->names,
-                            node->name,
-                            node);
-
-        g_ptr_array_add(st->parents,node);
-
-        node->id = st->parents->len - 1;
+        register_parent_node(st, node);
     } else {
         node->id = -1;
     }
@@ -543,6 +694,17 @@ new_stat_node(stats_tree *st, const char *name, int parent_id, stat_node_datatyp
         g_hash_table_replace(node->parent->hash,node->name,node);
     }
 
+    if (node->parent->topk_heap) {
+        if (datatype == STAT_DT_INT) {
+            /* a new child starts with the smallest counter */
+            node->topk_pos = node->parent->topk_heap->len;
+            g_ptr_array_add(node->parent->topk_heap, node);
+            topk_fix(node);
+        }
+        if (with_hash)
+            topk_init(node, node->parent->topk_max);
+    }
+
     if (st->cfg->setup_node_pr) {
         st->cfg->setup_node_pr(node);
     } else {
@@ -659,32 +821,10 @@ update_burst_calc(stat_node *node, int value)
     }
 }
 
-/*
- * Increases by delta the counter of the node whose name is given
- * if the node does not exist yet it's created (with counter=1)
- * using parent_name as parent node.
- * with_hash=true to indicate that the created node will have a parent
- */
-int
-stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name,
-              int parent_id, bool with_hash, int value)
+/* applies mode and value to an existing node */
+static void
+manip_node_int(manip_node_mode mode, stat_node *node, int value)
 {
-    stat_node *node = NULL;
-    stat_node *parent = NULL;
-
-    ws_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
-
-    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
-
-    if( parent->hash ) {
-        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
-    } else {
-        node = (stat_node *)g_hash_table_lookup(st->names,name);
-    }
-
-    if ( node == NULL )
-        node = new_stat_node(st,name,parent_id,STAT_DT_INT,with_hash,with_hash);
-
     switch (mode) {
         case MN_INCREASE:
             node->counter += value;
@@ -715,39 +855,61 @@ stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name
             break;
     }
 
-    if (node)
-        return node->id;
-    else
-        return -1;
+    if (topk_member(node))
+        topk_fix(node);
 }
 
 /*
-* Increases by delta the counter of the node whose name is given
-* if the node does not exist yet it's created (with counter=1)
-* using parent_name as parent node.
-* with_hash=true to indicate that the created node will have a parent
-*/
+ * Increases by delta the counter of the node whose name is given
+ * if the node does not exist yet it's created (with counter=1)
+ * using parent_name as parent node.
+ * with_hash=true to indicate that the created node will have a parent
+ */
 int
-stats_tree_manip_node_float(manip_node_mode mode, stats_tree *st, const char *name,
-    int parent_id, bool with_hash, float value)
+stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, const char *name,
+              int parent_id, bool with_hash, int value)
 {
     stat_node *node = NULL;
     stat_node *parent = NULL;
 
-    ws_assert(parent_id >= 0 && parent_id < (int)st->parents->len);
+    ws_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
 
-    parent = (stat_node *)g_ptr_array_index(st->parents, parent_id);
+    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
 
-    if (parent->hash) {
-        node = (stat_node *)g_hash_table_lookup(parent->hash, name);
+    if( parent->hash ) {
+        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
+    } else {
+        node = (stat_node *)g_hash_table_lookup(st->names,name);
     }
-    else {
-        node = (stat_node *)g_hash_table_lookup(st->names, name);
+
+    if ( node == NULL ) {
+        if (parent->topk_heap && parent->topk_heap->len >= parent->topk_max)
+            node = topk_recycle(parent, name, with_hash);
+        else
+            node = new_stat_node(st,name,parent_id,STAT_DT_INT,with_hash,with_hash);
     }
 
-    if (node == NULL)
-        node = new_stat_node(st, name, parent_id, STAT_DT_FLOAT, with_hash, with_hash);
+    manip_node_int(mode, node, value);
+
+    return node->id;
+}
+
+int
+stats_tree_manip_node_int_by_id(manip_node_mode mode, stats_tree *st, int node_id, int value)
+{
+    stat_node *node;
+
+    ws_assert( node_id >= 0 && node_id < (int) st->parents->len );
 
+    node = (stat_node *)g_ptr_array_index(st->parents,node_id);
+    manip_node_int(mode, node, value);
+
+    return node->id;
+}
+
+static void
+manip_node_float(manip_node_mode mode, stat_node *node, float value)
+{
     switch (mode) {
     case MN_AVERAGE:
         node->counter++;
@@ -768,11 +930,51 @@ stats_tree_manip_node_float(manip_node_mode mode, stats_tree *st, const char *na
         ws_assert_not_reached();
         break;
     }
+}
 
-    if (node)
-        return node->id;
-    else
-        return -1;
+/*
+* Increases by delta the counter of the node whose name is given
+* if the node does not exist yet it's created (with counter=1)
+* using parent_name as parent node.
+* with_hash=true to indicate that the created node will have a parent
+*/
+int
+stats_tree_manip_node_float(manip_node_mode mode, stats_tree *st, const char *name,
+    int parent_id, bool with_hash, float value)
+{
+    stat_node *node = NULL;
+    stat_node *parent = NULL;
+
+    ws_assert(parent_id >= 0 && parent_id < (int)st->parents->len);
+
+    parent = (stat_node *)g_ptr_array_index(st->parents, parent_id);
+
+    if (parent->hash) {
+        node = (stat_node *)g_hash_table_lookup(parent->hash, name);
+    }
+    else {
+        node = (stat_node *)g_hash_table_lookup(st->names, name);
+    }
+
+    if (node == NULL)
+        node = new_stat_node(st, name, parent_id, STAT_DT_FLOAT, with_hash, with_hash);
+
+    manip_node_float(mode, node, value);
+
+    return node->id;
+}
+
+int
+stats_tree_manip_node_float_by_id(manip_node_mode mode, stats_tree *st, int node_id, float value)
+{
+    stat_node *node;
+
+    ws_assert(node_id >= 0 && node_id < (int)st->parents->len);
+
+    node = (stat_node *)g_ptr_array_index(st->parents, node_id);
+    manip_node_float(mode, node, value);
+
+    return node->id;
 }
 
 extern char*
@@ -996,6 +1198,23 @@ stats_tree_create_pivot(stats_tree *st, const char *name, int parent_id)
         return 0;
 }
 
+extern int
+stats_tree_create_node_topk(stats_tree *st, const char *name, int parent_id)
+{
+    stat_node *node = new_stat_node(st,name,parent_id,STAT_DT_INT,true,true);
+
+    if (prefs.st_topk_max_items > 0 && !node->topk_heap)
+        topk_init(node, prefs.st_topk_max_items);
+
+    return node->id;
+}
+
+extern int
+stats_tree_create_pivot_topk(stats_tree *st, const char *name, int parent_id)
+{
+    return stats_tree_create_node_topk(st, name, parent_id);
+}
+
 extern int
 stats_tree_create_pivot_by_pname(stats_tree *st, const char *name,
                  const char *parent_name)
@@ -173,6 +173,22 @@ WS_DLL_PUBLIC int stats_tree_create_pivot(stats_tree *st,
                                           const char *name,
                                           int parent_id);
 
+/* creates a node with a hash that keeps only the (statistics.st_topk_max_items
+   preference) most frequent values as children, for values with a high
+   cardinality such as host names or addresses. A new value takes over the
+   least frequent child, whose own children are dropped; children created
+   with a hash get the same limit. Counts of values that replaced a less
+   frequent one are upper bounds; the node's own count is exact. The id of
+   a child is only valid until the next child is added to the node. */
+WS_DLL_PUBLIC int stats_tree_create_node_topk(stats_tree *st,
+                                              const char *name,
+                                              int parent_id);
+
+/* creates a pivot with the same limit on its values */
+WS_DLL_PUBLIC int stats_tree_create_pivot_topk(stats_tree *st,
+                                               const char *name,
+                                               int parent_id);
+
 WS_DLL_PUBLIC int stats_tree_create_pivot_by_pname(stats_tree *st,
                                                    const char *name,
                                                    const char *parent_name);
@@ -212,6 +228,20 @@ WS_DLL_PUBLIC int stats_tree_manip_node_float(manip_node_mode mode,
                                         bool with_children,
                                         float value);
 
+/*
+ * Same as above for a node created in the init callback, using the id
+ * returned when creating it instead of looking the node up by name.
+ */
+WS_DLL_PUBLIC int stats_tree_manip_node_int_by_id(manip_node_mode mode,
+                                        stats_tree *st,
+                                        int node_id,
+                                        int value);
+
+WS_DLL_PUBLIC int stats_tree_manip_node_float_by_id(manip_node_mode mode,
+                                        stats_tree *st,
+                                        int node_id,
+                                        float value);
+
 #define increase_stat_node(st,name,parent_id,with_children,value)       \
     (stats_tree_manip_node_int(MN_INCREASE,(st),(name),(parent_id),(with_children),(value)))
 
@@ -249,6 +279,21 @@ WS_DLL_PUBLIC int stats_tree_manip_node_float(manip_node_mode mode,
 #define stat_node_clear_flags(st,name,parent_id,with_children,flags)    \
     (stats_tree_manip_node_int(MN_CLEAR_FLAGS,(st),(name),(parent_id),(with_children),flags))
 
+#define increase_stat_node_by_id(st,node_id,value)                      \
+    (stats_tree_manip_node_int_by_id(MN_INCREASE,(st),(node_id),(value)))
+
+#define tick_stat_node_by_id(st,node_id)                                \
+    (stats_tree_manip_node_int_by_id(MN_INCREASE,(st),(node_id),1))
+
+#define avg_stat_node_add_value_int_by_id(st,node_id,value)             \
+    (stats_tree_manip_node_int_by_id(MN_AVERAGE,(st),(node_id),(value)))
+
+#define avg_stat_node_add_value_float_by_id(st,node_id,value)           \
+    (stats_tree_manip_node_float_by_id(MN_AVERAGE,(st),(node_id),(value)))
+
+#define stat_node_set_flags_by_id(st,node_id,flags)                     \
+    (stats_tree_manip_node_int_by_id(MN_SET_FLAGS,(st),(node_id),(flags)))
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
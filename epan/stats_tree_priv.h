@@ -95,6 +95,13 @@ struct _stat_node {
 	/** used to check if value is within range */
 	range_pair_t		*rng;
 
+	/** top-K nodes: at most topk_max children, kept in a
+	 *  min-heap by counter so the smallest can be replaced */
+	GPtrArray		*topk_heap;
+	unsigned		topk_max;
+	/** position in the parent's topk_heap */
+	unsigned		topk_pos;
+
 	/** node presentation data */
 	st_node_pres		*pr;
 };
@@ -123,6 +130,9 @@ struct _stats_tree {
    /** used for quicker lookups of parent nodes */
 	GPtrArray		*parents;
 
+	/** ids in parents of nodes dropped from top-K nodes, to be reused */
+	GArray			*free_ids;
+
 	/**
 	 *  tree representation
 	 * 	to be defined (if needed) by the implementations
@@ -158,6 +168,9 @@ struct _stats_tree_cfg {
 	/** last to be called at node creation */
 	void (*setup_node_pr)(stat_node*);
 
+	/** called before a top-K node drops a node and its children */
+	void (*free_node_pr)(stat_node*);
+
 	/**
 	 * tree presentation callbacks
 	 */
@@ -174,6 +187,7 @@ struct _stats_tree_cfg {
 /* guess what, this is it! */
 WS_DLL_PUBLIC void stats_tree_presentation(void (*registry_iterator)(void *,void *,void *),
 				    void (*setup_node_pr)(stat_node*),
+				    void (*free_node_pr)(stat_node*),
 				    void (*free_tree_pr)(stats_tree*),
 				    void *data);
 
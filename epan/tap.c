@@ -708,6 +708,28 @@ tap_listeners_require_dissection(void)
 
 }
 
+const char *
+tap_listeners_common_dfilter(void)
+{
+	tap_listener_t *tl;
+	const char *fstring = NULL;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->flags & TL_IS_DISSECTOR_HELPER)
+			continue;
+
+		if(!tl->code || tl->failed)
+			return NULL;
+
+		if(fstring && strcmp(fstring, tl->fstring) != 0)
+			return NULL;
+
+		fstring = tl->fstring;
+	}
+
+	return fstring;
+}
+
 /*
  * Return true if we have one or more tap listeners that require the columns,
  * false otherwise.
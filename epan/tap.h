@@ -260,6 +260,14 @@ WS_DLL_PUBLIC bool have_tap_listener(int tap_id);
 /** Return true if we have any tap listeners with filters, false otherwise. */
 WS_DLL_PUBLIC bool have_filtering_tap_listeners(void);
 
+/**
+ * Return the display filter string shared by every tap listener that
+ * requires dissection, or NULL if there are none, or if any of them has
+ * no filter or a different one. Callers can then skip frames the filter
+ * can't match.
+ */
+WS_DLL_PUBLIC const char *tap_listeners_common_dfilter(void);
+
 /** If any tap listeners have a filter with references to the currently
  * selected frame in the GUI (edt->tree), update them.
  */
@@ -8,9 +8,38 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "strutil.h"
+#include "follow.h"
+#include "epan.h"
+#include "packet.h"
+#include "address_pool.h"
+#include "prefs.h"
+#include <wiretap/wtap.h>
+#include <wsutil/filesystem.h>
+#include <wsutil/time_util.h>
 #include <wsutil/utf8_entities.h>
 
+static const char *test_progname;
+
+static bool epan_initialized;
+
+/* Tests that need registered protocols share one initialization. */
+static void
+test_epan_init(void)
+{
+    char *err;
+
+    if (epan_initialized)
+        return;
+    err = configuration_init(test_progname, NULL);
+    g_free(err);
+    wtap_init(false);
+    g_assert_true(epan_init(NULL, NULL, false));
+    epan_initialized = true;
+}
+
 /*
  * FIXME: LABEL_LENGTH includes the nul byte terminator.
  * This is confusing but matches ITEM_LABEL_LENGTH.
@@ -74,20 +103,390 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+static void check_follow_store(size_t memory_limit)
+{
+    follow_store_t *store = follow_store_new(memory_limit);
+    const follow_store_record_t *record;
+    const uint8_t *data;
+    uint8_t buf[3000];
+    unsigned i, j, len;
+
+    g_assert_cmpuint(follow_store_count(NULL), ==, 0);
+
+    /* Records of growing length, some larger than a chunk. */
+    for (i = 0; i < 200; i++) {
+        len = (i * 97) % sizeof(buf);
+        memset(buf, i, len);
+        follow_store_append(store, i % 2, i + 1, NULL, buf, len);
+    }
+    g_assert_cmpuint(follow_store_count(store), ==, 200);
+
+    /* Read back in reverse to exercise random access. */
+    for (i = 200; i-- > 0; ) {
+        record = follow_store_get_record(store, i);
+        g_assert_cmpuint(record->packet_num, ==, i + 1);
+        g_assert_true(record->is_server == (i % 2));
+        g_assert_cmpuint(record->len, ==, (i * 97) % sizeof(buf));
+        data = follow_store_get_data(store, i);
+        g_assert_nonnull(data);
+        for (j = 0; j < record->len; j++)
+            g_assert_cmpuint(data[j], ==, (uint8_t)i);
+    }
+
+    follow_store_free(store);
+}
+
+void test_follow_store(void)
+{
+    check_follow_store(0);
+}
+
+void test_follow_store_spill(void)
+{
+    /* Most of the data goes to the temporary file. */
+    check_follow_store(16 * 1024);
+}
+
+void test_address_pool(void)
+{
+    address_pool_t *pool = address_pool_new();
+    uint32_t ip1 = 0x0a000001, ip2 = 0x0a000002, ip3 = 0x0a000003;
+    address a1, a1_copy, a2, a3;
+    uint32_t id1, id2, id3;
+
+    set_address(&a1, AT_IPv4, 4, &ip1);
+    copy_address(&a1_copy, &a1);
+    set_address(&a2, AT_IPv4, 4, &ip2);
+    set_address(&a3, AT_IPv4, 4, &ip3);
+
+    id1 = address_pool_intern(pool, &a1);
+    id2 = address_pool_intern(pool, &a2);
+    g_assert_cmpuint(id1, !=, id2);
+    /* Equal addresses share an id, wherever their data lives. */
+    g_assert_cmpuint(address_pool_intern(pool, &a1_copy), ==, id1);
+    g_assert_cmpuint(address_pool_count(pool), ==, 2);
+
+    g_assert_cmpuint(address_pool_lookup(pool, &a2), ==, id2);
+    g_assert_cmpuint(address_pool_lookup(pool, &a3), ==, ADDRESS_POOL_NO_ID);
+    g_assert_true(addresses_equal(address_pool_get(pool, id1), &a1));
+    g_assert_true(address_pool_get(pool, id1)->data != a1.data);
+
+    /* Ids are given out in order. */
+    id3 = address_pool_intern(pool, &a3);
+    g_assert_cmpuint(id1, ==, 0);
+    g_assert_cmpuint(id2, ==, 1);
+    g_assert_cmpuint(id3, ==, 2);
+    g_assert_true(addresses_equal(address_pool_get(pool, id3), &a3));
+    g_assert_true(addresses_equal(address_pool_get(pool, id1), &a1));
+    g_assert_cmpuint(address_pool_count(pool), ==, 3);
+
+    free_address(&a1_copy);
+    address_pool_free(pool);
+}
+
+/*
+ * Heuristic dissectors that accept a packet starting with their letter.
+ * They check the length themselves, as a pre-screen needn't be set.
+ */
+static unsigned heur_test_tries[6];
+
+#define HEUR_TEST_DISSECTOR(name, idx, letter) \
+static bool \
+name(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *tree _U_, void *data _U_) \
+{ \
+    heur_test_tries[idx]++; \
+    return tvb_captured_length(tvb) > 0 && tvb_get_uint8(tvb, 0) == (letter); \
+}
+
+HEUR_TEST_DISSECTOR(heur_test_a, 0, 'A')
+HEUR_TEST_DISSECTOR(heur_test_b, 1, 'B')
+HEUR_TEST_DISSECTOR(heur_test_c, 2, 'C')
+HEUR_TEST_DISSECTOR(heur_test_d, 3, 'D')
+HEUR_TEST_DISSECTOR(heur_test_e, 4, 'E')
+HEUR_TEST_DISSECTOR(heur_test_f, 5, 'F')
+
+static heur_dtbl_entry_t *
+heur_test_try(heur_dissector_list_t list, const char *bytes, unsigned captured, unsigned reported)
+{
+    static packet_info pinfo;
+    heur_dtbl_entry_t *hdtbl_entry = NULL;
+    tvbuff_t *tvb;
+
+    pinfo.pool = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+    pinfo.layers = wmem_list_new(pinfo.pool);
+    pinfo.proto_layers = NULL;
+    tvb = tvb_new_real_data((const uint8_t *)bytes, captured, reported);
+    if (!dissector_try_heuristic(list, tvb, &pinfo, NULL, &hdtbl_entry, NULL))
+        hdtbl_entry = NULL;
+    tvb_free(tvb);
+    wmem_destroy_allocator(pinfo.pool);
+    return hdtbl_entry;
+}
+
+static void
+heur_test_append_name(const char *table_name _U_, heur_dtbl_entry_t *entry, void *user_data)
+{
+    GString *order = (GString *)user_data;
+
+    if (order->len > 0)
+        g_string_append_c(order, ',');
+    g_string_append(order, entry->short_name);
+}
+
+static void
+heur_test_assert_order(const char *list_name, const char *expected)
+{
+    GString *order = g_string_new(NULL);
+
+    heur_dissector_table_foreach(list_name, heur_test_append_name, order);
+    g_assert_cmpstr(order->str, ==, expected);
+    g_string_free(order, TRUE);
+}
+
+static void test_heur_prescreen(void)
+{
+    static const uint8_t magic_c[] = { 'C' };
+    heur_dissector_list_t list;
+    heur_dtbl_entry_t *entry_c;
+    uint64_t calls, hits;
+
+    test_epan_init();
+    memset(heur_test_tries, 0, sizeof(heur_test_tries));
+    list = register_heur_dissector_list_with_description("test.prescreen", "Pre-screen test", -1);
+    /* Entries are prepended, so C is tried first. */
+    heur_dissector_add("test.prescreen", heur_test_a, "A", "test_prescreen_a", -1, HEURISTIC_ENABLE);
+    heur_dissector_add("test.prescreen", heur_test_b, "B", "test_prescreen_b", -1, HEURISTIC_ENABLE);
+    heur_dissector_add("test.prescreen", heur_test_c, "C", "test_prescreen_c", -1, HEURISTIC_ENABLE);
+    heur_dissector_set_prescreen("test_prescreen_c", 2, 0, magic_c, sizeof(magic_c));
+    entry_c = find_heur_dissector_by_unique_short_name("test_prescreen_c");
+    g_assert_nonnull(entry_c);
+
+    /* Wrong magic: C isn't called. */
+    g_assert_true(heur_test_try(list, "AA", 2, 2) == find_heur_dissector_by_unique_short_name("test_prescreen_a"));
+    g_assert_cmpuint(heur_test_tries[2], ==, 0);
+    g_assert_cmpuint(heur_test_tries[1], ==, 1);
+    g_assert_cmpuint(heur_test_tries[0], ==, 1);
+    g_assert_cmpuint(entry_c->screened, ==, 1);
+
+    /* Too short, even with the right magic. */
+    g_assert_null(heur_test_try(list, "C", 1, 1));
+    g_assert_cmpuint(heur_test_tries[2], ==, 0);
+    g_assert_cmpuint(entry_c->screened, ==, 2);
+
+    /* Magic bytes that weren't captured don't rule C out. */
+    g_assert_null(heur_test_try(list, "", 0, 2));
+    g_assert_cmpuint(heur_test_tries[2], ==, 1);
+
+    g_assert_true(heur_test_try(list, "CC", 2, 2) == entry_c);
+    g_assert_cmpuint(heur_test_tries[2], ==, 2);
+    g_assert_cmpuint(entry_c->tries, ==, 2);
+    g_assert_cmpuint(entry_c->hits, ==, 1);
+    g_assert_cmpuint(entry_c->screened, ==, 2);
+
+    heur_dissector_list_get_stats(list, &calls, &hits);
+    g_assert_cmpuint(calls, ==, 4);
+    g_assert_cmpuint(hits, ==, 2);
+}
+
+static void test_heur_order(void)
+{
+    heur_order_e saved_order = prefs.heur_dissector_order;
+    heur_dissector_list_t list;
+
+    test_epan_init();
+    list = register_heur_dissector_list_with_description("test.order", "Order test", -1);
+    heur_dissector_add("test.order", heur_test_d, "D", "test_order_d", -1, HEURISTIC_ENABLE);
+    heur_dissector_add("test.order", heur_test_e, "E", "test_order_e", -1, HEURISTIC_ENABLE);
+    heur_dissector_add("test.order", heur_test_f, "F", "test_order_f", -1, HEURISTIC_ENABLE);
+    heur_test_assert_order("test.order", "test_order_f,test_order_e,test_order_d");
+
+    /* Most matches first; ties keep their order. */
+    prefs.heur_dissector_order = HEUR_ORDER_HITS;
+    g_assert_nonnull(heur_test_try(list, "D", 1, 1));
+    heur_test_assert_order("test.order", "test_order_d,test_order_f,test_order_e");
+    g_assert_nonnull(heur_test_try(list, "E", 1, 1));
+    heur_test_assert_order("test.order", "test_order_d,test_order_e,test_order_f");
+    g_assert_nonnull(heur_test_try(list, "E", 1, 1));
+    heur_test_assert_order("test.order", "test_order_e,test_order_d,test_order_f");
+    /* D catching up with E doesn't pass it. */
+    g_assert_nonnull(heur_test_try(list, "D", 1, 1));
+    heur_test_assert_order("test.order", "test_order_e,test_order_d,test_order_f");
+    /* A miss changes nothing. */
+    g_assert_null(heur_test_try(list, "X", 1, 1));
+    heur_test_assert_order("test.order", "test_order_e,test_order_d,test_order_f");
+
+    /* Last match first. */
+    prefs.heur_dissector_order = HEUR_ORDER_MOVE_TO_FRONT;
+    g_assert_nonnull(heur_test_try(list, "F", 1, 1));
+    heur_test_assert_order("test.order", "test_order_f,test_order_e,test_order_d");
+
+    /* Fixed. */
+    prefs.heur_dissector_order = HEUR_ORDER_FIXED;
+    g_assert_nonnull(heur_test_try(list, "D", 1, 1));
+    heur_test_assert_order("test.order", "test_order_f,test_order_e,test_order_d");
+
+    prefs.heur_dissector_order = saved_order;
+}
+
+/* Enough lookups for a table to be indexed by value; see DENSE_DTBL_LOOKUPS */
+#define DENSE_LOOKUPS 1000
+
+static void test_dissector_table_dense(void)
+{
+    dissector_table_t udp_port, test_table;
+    dissector_handle_t dns_handle, arp_handle;
+
+    test_epan_init();
+    udp_port = find_dissector_table("udp.port");
+    g_assert_nonnull(udp_port);
+    dns_handle = dissector_get_uint_handle(udp_port, 53);
+    g_assert_nonnull(dns_handle);
+    arp_handle = dissector_get_uint_handle(find_dissector_table("ethertype"), 0x0806);
+    g_assert_nonnull(arp_handle);
+
+    for (int n = 0; n < DENSE_LOOKUPS; n++)
+        dissector_get_uint_handle(udp_port, 53);
+
+    /* Decode As changes must be seen at once. */
+    dissector_change_uint("udp.port", 53, NULL);
+    g_assert_null(dissector_get_uint_handle(udp_port, 53));
+    dissector_reset_uint("udp.port", 53);
+    g_assert_true(dissector_get_uint_handle(udp_port, 53) == dns_handle);
+    g_assert_null(dissector_get_uint_handle(udp_port, 51812));
+    dissector_change_uint("udp.port", 51812, dns_handle);
+    g_assert_true(dissector_get_uint_handle(udp_port, 51812) == dns_handle);
+    dissector_reset_uint("udp.port", 51812);
+    g_assert_null(dissector_get_uint_handle(udp_port, 51812));
+
+    /* dissector_delete_all() rebuilds the index. */
+    test_table = register_dissector_table("test.dense", "Dense index test", -1, FT_UINT16, BASE_DEC);
+    dissector_add_uint("test.dense", 1, arp_handle);
+    dissector_add_uint("test.dense", 53, dns_handle);
+    dissector_add_uint("test.dense", 5353, dns_handle);
+    for (int n = 0; n < DENSE_LOOKUPS; n++)
+        dissector_get_uint_handle(test_table, 53);
+    g_assert_true(dissector_get_uint_handle(test_table, 5353) == dns_handle);
+
+    dissector_delete_all("test.dense", dns_handle);
+    g_assert_null(dissector_get_uint_handle(test_table, 53));
+    g_assert_null(dissector_get_uint_handle(test_table, 5353));
+    g_assert_true(dissector_get_uint_handle(test_table, 1) == arp_handle);
+
+    dissector_add_uint("test.dense", 53, dns_handle);
+    g_assert_true(dissector_get_uint_handle(test_table, 53) == dns_handle);
+    dissector_delete_uint("test.dense", 1, arp_handle);
+    g_assert_null(dissector_get_uint_handle(test_table, 1));
+}
+
+#define RESOURCE_USAGE_START get_resource_usage(&start_utime, &start_stime)
+
+#define RESOURCE_USAGE_END \
+    get_resource_usage(&end_utime, &end_stime); \
+    utime_ms = (end_utime - start_utime) * 1000.0; \
+    stime_ms = (end_stime - start_stime) * 1000.0
+
+static void
+copy_dtbl_entry(const char *table_name _U_, ftenum_t selector_type _U_,
+    void *key, void *value, void *user_data)
+{
+    g_hash_table_insert((GHashTable *)user_data, key, value);
+}
+
+static void test_dissector_table_lookup_perf(void)
+{
+#define DTBL_LOOP_COUNT (1000 * 1000)
+    /*
+     * The lookups made for a mix of DNS, QUIC, SIP and VXLAN over UDP and
+     * ARP: each UDP packet tries the lower and then the higher port.
+     */
+    static const struct {
+        const char *table;
+        uint32_t value;
+    } lookups[] = {
+        { "ethertype", 0x0800 }, { "ip.proto", 17 }, { "udp.port", 53 },   { "udp.port", 51812 },
+        { "ethertype", 0x86dd }, { "ip.proto", 17 }, { "udp.port", 443 },  { "udp.port", 49822 },
+        { "ethertype", 0x0800 }, { "ip.proto", 17 }, { "udp.port", 5060 }, { "udp.port", 5060 },
+        { "ethertype", 0x0800 }, { "ip.proto", 17 }, { "udp.port", 4789 }, { "udp.port", 33012 },
+        { "ethertype", 0x0806 },
+    };
+    dissector_table_t tables[G_N_ELEMENTS(lookups)];
+    GHashTable *copies[G_N_ELEMENTS(lookups)];
+    unsigned found = 0, found_copy = 0;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    test_epan_init();
+
+    for (size_t i = 0; i < G_N_ELEMENTS(lookups); i++) {
+        tables[i] = find_dissector_table(lookups[i].table);
+        g_assert_nonnull(tables[i]);
+        copies[i] = g_hash_table_new(g_direct_hash, g_direct_equal);
+        dissector_table_foreach(lookups[i].table, copy_dtbl_entry, copies[i]);
+    }
+
+    /* Enough lookups for the tables to be indexed by value */
+    for (int n = 0; n < DENSE_LOOKUPS; n++) {
+        for (size_t i = 0; i < G_N_ELEMENTS(lookups); i++)
+            dissector_get_uint_handle(tables[i], lookups[i].value);
+    }
+
+    RESOURCE_USAGE_START;
+    for (int n = 0; n < DTBL_LOOP_COUNT; n++) {
+        for (size_t i = 0; i < G_N_ELEMENTS(lookups); i++) {
+            if (dissector_get_uint_handle(tables[i], lookups[i].value) != NULL)
+                found++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "dissector_get_uint_handle(): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (int n = 0; n < DTBL_LOOP_COUNT; n++) {
+        for (size_t i = 0; i < G_N_ELEMENTS(lookups); i++) {
+            if (g_hash_table_lookup(copies[i], GUINT_TO_POINTER(lookups[i].value)) != NULL)
+                found_copy++;
+        }
+    }
+    RESOURCE_USAGE_END;
+    g_test_message("GHashTable: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    g_assert_cmpuint(found, ==, found_copy);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(lookups); i++)
+        g_hash_table_destroy(copies[i]);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
 
     ws_log_init("test_proto", NULL);
 
+    test_progname = argv[0];
+
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
+    g_test_add_func("/follow/store", test_follow_store);
+    g_test_add_func("/follow/store_spill", test_follow_store_spill);
+    g_test_add_func("/address_pool/intern", test_address_pool);
+    g_test_add_func("/packet/heur_prescreen", test_heur_prescreen);
+    g_test_add_func("/packet/heur_order", test_heur_order);
+    g_test_add_func("/packet/dissector_table_dense", test_dissector_table_dense);
+
+    if (g_test_perf()) {
+        g_test_add_func("/packet/dissector_table_lookup_perf", test_dissector_table_lookup_perf);
+    }
 
     ret = g_test_run();
 
+    if (epan_initialized) {
+        epan_cleanup();
+        wtap_cleanup();
+    }
+
     return ret;
 }
 
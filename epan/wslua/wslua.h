@@ -263,6 +263,7 @@ struct _wslua_treeitem {
 struct _wslua_header_field_info {
     char *name;
     header_field_info *hfi;
+    unsigned cache_index; /* Position in the per-packet cache of field values */
 };
 
 struct _wslua_field_info {
@@ -504,6 +504,39 @@ WSLUA_CLASS_DEFINE(Field,FAIL_ON_NULL("Field"));
 static GPtrArray* wanted_fields;
 static dfilter_t* wslua_dfilter;
 
+/* The Field extractors whose field was found, set up by lua_prime_all_fields()
+ * once wanted_fields is gone. The position of a Field in this array is its
+ * index in the packet cache below; the slot is cleared if it's collected. */
+static GPtrArray* extractors;
+
+/*
+ * The values of the extractors for the current dissection. Each extractor's
+ * entry is filled in by its first call, and again when its finfo arrays have
+ * grown since, e.g. when a Lua dissector called another dissector in
+ * between. The cache starts over when a different tree or pool is in use,
+ * e.g. while the selected packet's dissection is kept and others run, and
+ * when its pool is freed.
+ */
+typedef struct {
+    unsigned generation;        /* field_cache.generation when filled in */
+    unsigned count;             /* Number of values when filled in */
+} field_cache_entry_t;
+
+typedef struct {
+    wmem_allocator_t *pool;     /* pinfo->pool of the dissection */
+    unsigned pool_cb_id;        /* Our callback on pool */
+    const tree_data_t *tree_data;
+    unsigned generation;        /* Bumped when the cache starts over */
+    GArray *entries;            /* field_cache_entry_t, by Field cache_index */
+} field_cache_t;
+
+static field_cache_t field_cache;
+
+/* Registry reference to a table holding, for each extractor by cache_index,
+ * an array of the FieldInfo objects pushed for its cached values, so that
+ * calling an extractor again in the same packet doesn't create new ones. */
+static int field_cache_values_ref = LUA_NOREF;
+
 /* We use a fake dfilter for Lua field extractors, so that
  * epan_dissect_run() will populate the fields.  This won't happen
  * if the passed-in edt->tree is NULL, which it will be if the
@@ -552,6 +585,19 @@ void lua_prime_all_fields(proto_tree* tree _U_) {
         fake_tap = true;
     }
 
+    if (extractors != NULL) {
+        g_ptr_array_unref(extractors);
+    }
+    extractors = g_ptr_array_new();
+    for(i=0; i < wanted_fields->len; i++) {
+        Field f = (Field)g_ptr_array_index(wanted_fields,i);
+
+        if (f->hfi) {
+            f->cache_index = extractors->len;
+            g_ptr_array_add(extractors, f);
+        }
+    }
+
     g_ptr_array_free(wanted_fields,true);
     wanted_fields = NULL;
 
@@ -685,13 +731,120 @@ static int Field_get_type(lua_State* L) {
     return 1;
 }
 
+static bool field_cache_end(wmem_allocator_t *allocator, wmem_cb_event_t event _U_,
+        void *user_data _U_) {
+    /* The cache may have moved on to another pool since. */
+    if (field_cache.pool == allocator) {
+        field_cache.pool = NULL;
+        field_cache.tree_data = NULL;
+    }
+
+    /* keep invoking this callback later? */
+    return false;
+}
+
+/* Starts the cache over for the dissection using pool and tree_data. */
+static void field_cache_reset(lua_State* L, wmem_allocator_t* pool, const tree_data_t* tree_data) {
+    if (field_cache.pool != pool) {
+        /* The old pool is still alive, or its callback would have run. */
+        if (field_cache.pool) {
+            wmem_unregister_callback(field_cache.pool, field_cache.pool_cb_id);
+        }
+        field_cache.pool_cb_id = wmem_register_callback(pool, field_cache_end, NULL);
+    }
+    field_cache.pool = pool;
+    field_cache.tree_data = tree_data;
+    field_cache.generation++;
+
+    /* The FieldInfo objects pushed so far were for another dissection. */
+    lua_newtable(L);
+    if (field_cache_values_ref == LUA_NOREF) {
+        field_cache_values_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    } else {
+        lua_rawseti(L, LUA_REGISTRYINDEX, field_cache_values_ref);
+    }
+}
+
+/* The number of values of a field, which only grows during a dissection. */
+static unsigned field_count_values(proto_tree* tree, header_field_info* in) {
+    unsigned count = 0;
+
+    while (in) {
+        GPtrArray* found = proto_get_finfo_ptr_array(tree, in->id);
+        if (found) {
+            count += found->len;
+        }
+        in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
+    }
+    return count;
+}
+
+/* Pushes the values (see `FieldInfo`) of a field and returns how many. */
+static int push_field_values(lua_State* L, Field f) {
+    proto_tree* tree = lua_tree->tree;
+    field_cache_entry_t* entry;
+    header_field_info* in;
+    unsigned count, i;
+    int values, field_values;
+
+    if (!tree) {
+        return 0;
+    }
+
+    if (field_cache.pool != lua_pinfo->pool || field_cache.tree_data != PTREE_DATA(tree)) {
+        field_cache_reset(L, lua_pinfo->pool, PTREE_DATA(tree));
+    }
+
+    if (!field_cache.entries) {
+        field_cache.entries = g_array_new(false, true, sizeof(field_cache_entry_t));
+    }
+    if (f->cache_index >= field_cache.entries->len) {
+        g_array_set_size(field_cache.entries, f->cache_index + 1);
+    }
+    entry = &g_array_index(field_cache.entries, field_cache_entry_t, f->cache_index);
+    count = field_count_values(tree, f->hfi);
+    luaL_checkstack(L, count + 2, "too many field values");
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, field_cache_values_ref);
+    values = lua_gettop(L);
+    if (entry->generation != field_cache.generation || entry->count != count) {
+        /* Not cached yet, or the tree has grown since. */
+        lua_createtable(L, count, 0);
+        field_values = lua_gettop(L);
+        i = 0;
+        for (in = f->hfi; in; in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL) {
+            GPtrArray* found = proto_get_finfo_ptr_array(tree, in->id);
+            if (!found) {
+                continue;
+            }
+            for (unsigned j = 0; j < found->len; j++) {
+                push_FieldInfo(L, (field_info*)g_ptr_array_index(found,j));
+                lua_rawseti(L, field_values, ++i);
+            }
+        }
+        lua_pushvalue(L, field_values);
+        lua_rawseti(L, values, f->cache_index + 1);
+        entry->generation = field_cache.generation;
+        entry->count = count;
+    } else {
+        lua_rawgeti(L, values, f->cache_index + 1);
+        field_values = lua_gettop(L);
+    }
+
+    for (i = 1; i <= count; i++) {
+        lua_rawgeti(L, field_values, i);
+    }
+    lua_remove(L, field_values);
+    lua_remove(L, values);
+
+    return count;
+}
+
 WSLUA_METAMETHOD Field__call (lua_State* L) {
     /* Obtain all values (see `FieldInfo`) for this field. */
     Field f = checkField(L,1);
-    header_field_info* in = f->hfi;
-    int items_found = 0;
 
-    if (! in) {
+    if (! f->hfi) {
         luaL_error(L,"invalid field");
         return 0;
     }
@@ -701,19 +854,49 @@ WSLUA_METAMETHOD Field__call (lua_State* L) {
         return 0;
     }
 
-    while (in) {
-        GPtrArray* found = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
-        unsigned i;
-        if (found) {
-            for (i=0; i<found->len; i++) {
-                push_FieldInfo(L, (field_info *) g_ptr_array_index(found,i));
-                items_found++;
-            }
+    WSLUA_RETURN(push_field_values(L, f)); /* All the values of this field */
+}
+
+WSLUA_CONSTRUCTOR Field_values(lua_State* L) {
+    /* Obtain the values of several fields at once. This is quicker than
+       calling each `Field` in turn when a script needs many of them per packet.
+
+       ===== Example
+
+       [source,lua]
+       ----
+       local ip_src, ip_dst, tcp_len = Field.values(f_ip_src, f_ip_dst, f_tcp_len)
+       if #tcp_len > 0 then
+           print(tostring(ip_src[1]), tostring(ip_dst[1]), tcp_len[1].value)
+       end
+       ----
+       */
+    int n_fields = lua_gettop(L);
+    int i, j, n_values, values;
+
+    for (i = 1; i <= n_fields; i++) {
+        if (! checkField(L,i)->hfi) {
+            luaL_argerror(L,i,"invalid field");
+            return 0;
         }
-        in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
     }
 
-    WSLUA_RETURN(items_found); /* All the values of this field */
+    if (! lua_pinfo ) {
+        WSLUA_ERROR(Field_values,"Fields cannot be used outside dissectors or taps");
+        return 0;
+    }
+
+    for (i = 1; i <= n_fields; i++) {
+        n_values = push_field_values(L, toField(L,i));
+        lua_createtable(L, n_values, 0);
+        lua_insert(L, -(n_values + 1));
+        values = lua_gettop(L) - n_values;
+        for (j = n_values; j >= 1; j--) {
+            lua_rawseti(L, values, j);
+        }
+    }
+
+    WSLUA_RETURN(n_fields); /* One array table of values (see `FieldInfo`) for each field, in the order of the arguments. Tables of absent fields are empty. */
 }
 
 WSLUA_METAMETHOD Field__tostring(lua_State* L) {
@@ -738,6 +921,9 @@ static int Field__gc(lua_State* L) {
     // remove the pointer to avoid a use-after-free.
     if (wanted_fields) {
         g_ptr_array_remove_fast(wanted_fields, f);
+    } else if (extractors && f->hfi && f->cache_index < extractors->len &&
+            g_ptr_array_index(extractors, f->cache_index) == f) {
+        g_ptr_array_index(extractors, f->cache_index) = NULL;
     }
 
     g_free(f->name);
@@ -755,6 +941,7 @@ WSLUA_ATTRIBUTES Field_attributes[] = {
 WSLUA_METHODS Field_methods[] = {
     WSLUA_CLASS_FNREG(Field,new),
     WSLUA_CLASS_FNREG(Field,list),
+    WSLUA_CLASS_FNREG(Field,values),
     { NULL, NULL }
 };
 
@@ -770,6 +957,21 @@ int Field_register(lua_State* L) {
         g_ptr_array_unref(wanted_fields);
     }
     wanted_fields = g_ptr_array_new();
+    if (extractors != NULL) {
+        g_ptr_array_unref(extractors);
+        extractors = NULL;
+    }
+    /* The cached values and their references belong to the old Lua state. */
+    if (field_cache.pool != NULL) {
+        wmem_unregister_callback(field_cache.pool, field_cache.pool_cb_id);
+        field_cache.pool = NULL;
+    }
+    field_cache.tree_data = NULL;
+    if (field_cache.entries != NULL) {
+        g_array_free(field_cache.entries, true);
+        field_cache.entries = NULL;
+    }
+    field_cache_values_ref = LUA_NOREF;
 
     WSLUA_REGISTER_CLASS_WITH_ATTRS(Field);
     if (outstanding_FieldInfo != NULL) {
@@ -34,6 +34,7 @@
 #include <epan/column.h>
 #include <epan/packet.h>
 #include <epan/column-utils.h>
+#include <epan/conversation.h>
 #include <epan/expert.h>
 #include <epan/prefs.h>
 #include <epan/dfilter/dfilter.h>
@@ -1217,6 +1218,54 @@ cf_set_rfcode(capture_file *cf, dfilter_t *rfcode)
     cf->rfcode = rfcode;
 }
 
+/*
+ * Update the cumulative bytes and the first and last displayed frames
+ * after deciding whether a frame passes the display filter.
+ */
+static void
+update_displayed_frames(capture_file *cf, frame_data *fdata)
+{
+    if (fdata->passed_dfilter || fdata->ref_time)
+    {
+        frame_data_set_after_dissect(fdata, &cf->cum_bytes);
+        /* The only way we use prev_dis is to get the time stamp of
+         * the previous displayed frame, so ignore it if it doesn't
+         * have a time stamp, because we're presumably interested in
+         * the timestamp of the previously displayed frame with a
+         * time. XXX: What if in the future we want to use the previously
+         * displayed frame for something else, too?
+         */
+        if (fdata->has_ts) {
+            cf->provider.prev_dis = fdata;
+        }
+
+        /* If we haven't yet seen the first frame, this is it. */
+        if (cf->first_displayed == 0)
+            cf->first_displayed = fdata->num;
+
+        /* This is the last frame we've seen so far. */
+        cf->last_displayed = fdata->num;
+    }
+}
+
+/*
+ * Like add_packet_to_packet_list(), for a frame that we know won't pass
+ * the display filter without dissecting it.
+ */
+static void
+skip_packet_in_packet_list(frame_data *fdata, capture_file *cf)
+{
+    frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+            &cf->provider.ref, cf->provider.prev_dis);
+    cf->provider.prev_cap = fdata;
+
+    fdata->passed_dfilter = 0;
+    if (fdata->ref_time)
+        cf->displayed_count++;
+
+    update_displayed_frames(cf, fdata);
+}
+
 static void
 add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
         epan_dissect_t *edt, dfilter_t *dfcode, column_info *cinfo,
@@ -1274,27 +1323,7 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
         packet_list_append(cinfo, fdata);
     }
 
-    if (fdata->passed_dfilter || fdata->ref_time)
-    {
-        frame_data_set_after_dissect(fdata, &cf->cum_bytes);
-        /* The only way we use prev_dis is to get the time stamp of
-         * the previous displayed frame, so ignore it if it doesn't
-         * have a time stamp, because we're presumably interested in
-         * the timestamp of the previously displayed frame with a
-         * time. XXX: What if in the future we want to use the previously
-         * displayed frame for something else, too?
-         */
-        if (fdata->has_ts) {
-            cf->provider.prev_dis = fdata;
-        }
-
-        /* If we haven't yet seen the first frame, this is it. */
-        if (cf->first_displayed == 0)
-            cf->first_displayed = fdata->num;
-
-        /* This is the last frame we've seen so far. */
-        cf->last_displayed = fdata->num;
-    }
+    update_displayed_frames(cf, fdata);
 
     epan_dissect_reset(edt);
 }
@@ -1691,6 +1720,9 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
     bool        compiled _U_;
     uint32_t    frames_count;
     rescan_type queued_rescan_type = RESCAN_NONE;
+    conversation_frame_iter_t frame_iter;
+    bool        use_frame_index;
+    uint32_t    next_indexed_frame = 0;
 
     if (cf->state == FILE_CLOSED || cf->state == FILE_READ_PENDING) {
         return;
@@ -1858,6 +1890,17 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
 
     epan_dissect_init(&edt, cf->epan, create_proto_tree, false);
 
+    /*
+     * If the filter only tests a stream index, e.g. "tcp.stream eq 3", the
+     * frames it can match were recorded during the first pass and we only
+     * have to dissect those (and any frame not yet dissected).
+     */
+    use_frame_index = !redissect && cf->state == FILE_READ_DONE && cf->dfcode != NULL &&
+        !tap_listeners_require_dissection() &&
+        conversation_index_filter_frames(cf->dfilter, &frame_iter);
+    if (use_frame_index && !conversation_frame_iter_next(&frame_iter, &next_indexed_frame))
+        next_indexed_frame = 0;
+
     if (redissect) {
         /*
          * Decryption secrets and name resolution blocks are read while
@@ -1945,9 +1988,6 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
         /* Frame dependencies from the previous dissection/filtering are no longer valid. */
         fdata->dependent_of_displayed = 0;
 
-        if (!cf_read_record(cf, fdata, &rec, &buf))
-            break; /* error reading the frame */
-
         /* If the previous frame is displayed, and we haven't yet seen the
            selected frame, remember that frame - it's the closest one we've
            yet seen before the selected frame. */
@@ -1956,9 +1996,21 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
             preceding_frame = prev_frame;
         }
 
-        add_packet_to_packet_list(fdata, cf, &edt, cf->dfcode,
-                cinfo, &rec, &buf,
-                add_to_packet_list);
+        if (use_frame_index && fdata->num != next_indexed_frame && fdata->visited) {
+            /* Not in the stream; the filter can't match it. */
+            skip_packet_in_packet_list(fdata, cf);
+        } else {
+            if (use_frame_index && fdata->num == next_indexed_frame &&
+                    !conversation_frame_iter_next(&frame_iter, &next_indexed_frame))
+                next_indexed_frame = 0;
+
+            if (!cf_read_record(cf, fdata, &rec, &buf))
+                break; /* error reading the frame */
+
+            add_packet_to_packet_list(fdata, cf, &edt, cf->dfcode,
+                    cinfo, &rec, &buf,
+                    add_to_packet_list);
+        }
 
         /* If this frame is displayed, and this is the first frame we've
            seen displayed after the selected frame, remember this frame -
@@ -2352,6 +2404,60 @@ retap_packet(capture_file *cf, frame_data *fdata, wtap_rec *rec, Buffer *buf,
     return true;
 }
 
+/*
+ * Retap only the frames a stream index filter can match, see
+ * conversation_index_filter_frames(), and any frame that hasn't been
+ * dissected yet.
+ */
+static psp_return_t
+retap_indexed_packets(capture_file *cf, conversation_frame_iter_t *frame_iter,
+        retap_callback_args_t *args)
+{
+    uint32_t         framenum;
+    uint32_t         next_frame;
+    frame_data      *fdata;
+    wtap_rec         rec;
+    Buffer           buf;
+    psp_return_t     ret = PSP_FINISHED;
+
+    if (cf->read_lock) {
+        ws_warning("Failing due to nested retap_indexed_packets(\"%s\") call!", cf->filename);
+        return PSP_FAILED;
+    }
+    cf->read_lock = true;
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+
+    if (!conversation_frame_iter_next(frame_iter, &next_frame))
+        next_frame = 0;
+
+    for (framenum = 1; framenum <= cf->count; framenum++) {
+        fdata = frame_data_sequence_find(cf->provider.frames, framenum);
+
+        if (framenum == next_frame) {
+            if (!conversation_frame_iter_next(frame_iter, &next_frame))
+                next_frame = 0;
+        } else if (fdata->visited) {
+            continue;
+        }
+
+        if (!cf_read_record(cf, fdata, &rec, &buf)) {
+            ret = PSP_FAILED;
+            break;
+        }
+        retap_packet(cf, fdata, &rec, &buf, args);
+        wtap_rec_reset(&rec);
+    }
+
+    cf->read_lock = false;
+
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+
+    return ret;
+}
+
 cf_read_status_t
 cf_retap_packets(capture_file *cf)
 {
@@ -2361,6 +2467,8 @@ cf_retap_packets(capture_file *cf)
     bool                  filtering_tap_listeners;
     unsigned              tap_flags;
     psp_return_t          ret;
+    const char           *tap_dfilter;
+    conversation_frame_iter_t frame_iter;
 
     /* Presumably the user closed the capture file. */
     if (cf == NULL) {
@@ -2449,9 +2557,16 @@ cf_retap_packets(capture_file *cf)
         range.process = range_process_user_range;
     }
 
-    ret = process_specified_records(cf, &range, "Recalculating statistics on",
-            "all packets", true, retap_packet,
-            &callback_args, true);
+    /* Following a stream only needs the frames of that stream. */
+    tap_dfilter = tap_listeners_common_dfilter();
+    if (cf->state == FILE_READ_DONE && tap_dfilter != NULL &&
+            conversation_index_filter_frames(tap_dfilter, &frame_iter)) {
+        ret = retap_indexed_packets(cf, &frame_iter, &callback_args);
+    } else {
+        ret = process_specified_records(cf, &range, "Recalculating statistics on",
+                "all packets", true, retap_packet,
+                &callback_args, true);
+    }
 
     packet_range_cleanup(&range);
     epan_dissect_cleanup(&callback_args.edt);
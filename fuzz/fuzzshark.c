@@ -28,6 +28,13 @@
 #include <wsutil/report_message.h>
 #include <wsutil/wslog.h>
 #include <wsutil/version_info.h>
+#ifdef FUZZ_BENCH
+#include <wsutil/glib-compat.h>
+#include <wsutil/json_dumper.h>
+#include <wsutil/strtoi.h>
+#include <wsutil/time_util.h>
+#include <wsutil/ws_getopt.h>
+#endif
 
 #include <wiretap/wtap.h>
 
@@ -39,6 +46,9 @@
 #include <epan/print.h>
 #include <epan/epan_dissect.h>
 #include <epan/disabled_protos.h>
+#ifdef FUZZ_BENCH
+#include <epan/dissector_profile.h>
+#endif
 
 #ifdef HAVE_PLUGINS
 #include <wsutil/plugins.h>
@@ -73,6 +83,7 @@ fuzzshark_cmdarg_err_cont(const char *msg_format, va_list ap)
 	fprintf(stderr, "\n");
 }
 
+#ifndef FUZZ_BENCH
 static int
 fuzzshark_pref_set(const char *name, const char *value)
 {
@@ -88,6 +99,7 @@ fuzzshark_pref_set(const char *name, const char *value)
 
 	return (ret == PREFS_SET_OK);
 }
+#endif
 
 static const nstime_t *
 fuzzshark_get_frame_ts(struct packet_provider_data *prov _U_, uint32_t frame_num _U_)
@@ -137,6 +149,7 @@ get_dissector_handle(const char *table, const char *target)
 	return fuzz_handle;
 }
 
+#ifndef FUZZ_BENCH
 static void
 fuzz_prefs_apply(void)
 {
@@ -149,9 +162,10 @@ fuzz_prefs_apply(void)
 	/* Notify all registered modules that have had any of their preferences changed. */
 	prefs_apply_all();
 }
+#endif
 
 static int
-fuzz_init(int argc _U_, char **argv)
+fuzz_init(int *argc, char **argv)
 {
 	char                *configuration_init_error;
 
@@ -191,6 +205,8 @@ fuzz_init(int argc _U_, char **argv)
 #if !defined(FUZZ_DISSECTOR_TABLE) && !defined(FUZZ_DISSECTOR_TARGET)
 	const char *fuzz_table = getenv("FUZZSHARK_TABLE");
 
+	/* Without a target, the benchmark runs the full frame path. */
+#ifndef FUZZ_BENCH
 	if (!fuzz_table && !fuzz_target) {
 		fprintf(stderr,
 "Missing environment variables!\n"
@@ -220,6 +236,7 @@ fuzz_init(int argc _U_, char **argv)
 			argv[0], argv[0]);
 		return 1;
 	}
+#endif
 #endif
 
 	dissector_handle_t fuzz_handle = NULL;
@@ -234,8 +251,11 @@ fuzz_init(int argc _U_, char **argv)
 	g_setenv("XDG_CONFIG_HOME", "/not/existing/directory", 0); /* g_get_user_config_dir() */
 	g_setenv("XDG_DATA_HOME", "/not/existing/directory", 0);   /* g_get_user_data_dir() */
 
+#ifndef FUZZ_BENCH
+	/* The benchmark measures the allocators that are really used. */
 	g_setenv("WIRESHARK_DEBUG_WMEM_OVERRIDE", "simple", 0);
 	g_setenv("G_SLICE", "always-malloc", 0);
+#endif
 
 	cmdarg_err_init(fuzzshark_cmdarg_err, fuzzshark_cmdarg_err_cont);
 
@@ -243,7 +263,7 @@ fuzz_init(int argc _U_, char **argv)
 	ws_log_init("fuzzshark", vcmdarg_err);
 
 	/* Early logging command-line initialization. */
-	ws_log_parse_args(&argc, argv, vcmdarg_err, LOG_ARGS_NOEXIT);
+	ws_log_parse_args(argc, argv, vcmdarg_err, LOG_ARGS_NOEXIT);
 
 	ws_noisy("Finished log init and parsing command line log arguments");
 
@@ -315,7 +335,13 @@ fuzz_init(int argc _U_, char **argv)
 		}
 	}
 
+#ifndef FUZZ_BENCH
 	fuzz_prefs_apply();
+#else
+	/* The benchmark leaves defragmentation and reassembly on, so that
+	 * it measures what tshark and Wireshark would do. */
+	prefs_apply_all();
+#endif
 
 	/* Build the column format array */
 	build_column_format_array(&fuzz_cinfo, prefs_p->num_cols, true);
@@ -330,6 +356,20 @@ fuzz_init(int argc _U_, char **argv)
 	fprintf(stderr, "oss-fuzzshark: configured for dissector: %s\n", fuzz_target);
 	fuzz_handle = get_dissector_handle(NULL, fuzz_target);
 
+#elif defined(FUZZ_BENCH)
+	if (fuzz_target) {
+		if (fuzz_table) {
+			fprintf(stderr, "oss-fuzzshark: requested dissector: %s in table %s\n", fuzz_target, fuzz_table);
+		} else {
+			fprintf(stderr, "oss-fuzzshark: requested dissector: %s\n", fuzz_target);
+		}
+		fuzz_handle = get_dissector_handle(fuzz_table, fuzz_target);
+		g_assert(fuzz_handle != NULL && "Requested dissector is not found!");
+		register_postdissector(fuzz_handle);
+	} else {
+		fprintf(stderr, "oss-fuzzshark: running the full frame path\n");
+	}
+
 #else
 # define FUZZ_EPAN 3
 	if (fuzz_table) {
@@ -355,34 +395,373 @@ clean_exit:
 	return ret;
 }
 
-#ifdef FUZZ_EPAN
-int
-LLVMFuzzerTestOneInput(const uint8_t *buf, size_t real_len)
+/*
+ * Dissect one input. Without a packet header, the input is handed to the
+ * requested dissector only: there is no dissector for its encapsulation,
+ * so the frame dissector leaves it to the postdissector.
+ */
+static void
+fuzzshark_dissect(const uint8_t *buf, uint32_t len, const wtap_packet_header *phdr)
 {
 	static uint32_t framenum = 0;
 	epan_dissect_t *edt = fuzz_edt;
 
-	uint32_t len = (uint32_t) real_len;
-
 	wtap_rec rec;
 	frame_data fdlocal;
 
 	memset(&rec, 0, sizeof(rec));
 
 	rec.rec_type = REC_TYPE_PACKET;
-	rec.rec_header.packet_header.caplen = len;
-	rec.rec_header.packet_header.len = len;
+	if (phdr != NULL) {
+		rec.rec_header.packet_header = *phdr;
+	} else {
+		rec.rec_header.packet_header.caplen = len;
+		rec.rec_header.packet_header.len = len;
 
-	/* whdr.pkt_encap = WTAP_ENCAP_ETHERNET; */
-	rec.rec_header.packet_header.pkt_encap = INT16_MAX;
+		/* whdr.pkt_encap = WTAP_ENCAP_ETHERNET; */
+		rec.rec_header.packet_header.pkt_encap = INT16_MAX;
+	}
 	rec.presence_flags = WTAP_HAS_TS | WTAP_HAS_CAP_LEN; /* most common flags... */
 
 	frame_data_init(&fdlocal, ++framenum, &rec, /* offset */ 0, /* cum_bytes */ 0);
 	/* frame_data_set_before_dissect() not needed */
-	epan_dissect_run(edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &rec, tvb_new_real_data(buf, len, len), &fdlocal, NULL /* &fuzz_cinfo */);
+	epan_dissect_run(edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &rec,
+	    tvb_new_real_data(buf, len, rec.rec_header.packet_header.len), &fdlocal, NULL /* &fuzz_cinfo */);
 	frame_data_destroy(&fdlocal);
 
 	epan_dissect_reset(edt);
+}
+
+#ifdef FUZZ_BENCH
+/*
+ * Benchmark mode: replay a corpus or capture files through the requested
+ * dissector, or through the full frame path if none was requested, and
+ * report the throughput as JSON.
+ */
+
+typedef struct {
+	uint8_t *data;
+	uint32_t len;
+	bool has_header;		/* from a capture file, with its encapsulation */
+	wtap_packet_header header;
+} bench_input_t;
+
+static void
+bench_add_input(GArray *inputs, const uint8_t *data, uint32_t len, const wtap_packet_header *phdr)
+{
+	bench_input_t input;
+
+	memset(&input, 0, sizeof(input));
+	input.data = (uint8_t *) g_memdup2(data, len);
+	input.len = len;
+	if (phdr != NULL) {
+		input.has_header = true;
+		input.header = *phdr;
+	}
+	g_array_append_val(inputs, input);
+}
+
+static int
+bench_compare_names(const void *a, const void *b)
+{
+	return strcmp(*(const char * const *) a, *(const char * const *) b);
+}
+
+/* Every regular file in a corpus directory is one input, in name order. */
+static bool
+bench_read_corpus(GArray *inputs, const char *dirname)
+{
+	GDir *dir;
+	GError *error = NULL;
+	GPtrArray *names;
+	const char *name;
+	bool ok = true;
+
+	dir = g_dir_open(dirname, 0, &error);
+	if (dir == NULL) {
+		cmdarg_err("%s", error->message);
+		g_error_free(error);
+		return false;
+	}
+
+	names = g_ptr_array_new_with_free_func(g_free);
+	while ((name = g_dir_read_name(dir)) != NULL)
+		g_ptr_array_add(names, g_build_filename(dirname, name, NULL));
+	g_dir_close(dir);
+	g_ptr_array_sort(names, bench_compare_names);
+
+	for (unsigned i = 0; i < names->len; i++) {
+		const char *path = (const char *) g_ptr_array_index(names, i);
+		char *contents;
+		size_t length;
+
+		if (!g_file_test(path, G_FILE_TEST_IS_REGULAR))
+			continue;
+		if (!g_file_get_contents(path, &contents, &length, &error)) {
+			cmdarg_err("%s", error->message);
+			g_error_free(error);
+			ok = false;
+			break;
+		}
+		bench_add_input(inputs, (const uint8_t *) contents, (uint32_t) length, NULL);
+		g_free(contents);
+	}
+
+	g_ptr_array_free(names, true);
+	return ok;
+}
+
+/*
+ * Without a requested dissector the packets of a capture file keep their
+ * encapsulation; with one, their data is handed to it like a corpus input.
+ */
+static bool
+bench_read_capture(GArray *inputs, const char *filename, bool full_frame)
+{
+	wtap *wth;
+	wtap_rec rec;
+	Buffer buf;
+	int64_t data_offset;
+	int err;
+	char *err_info = NULL;
+
+	wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, false);
+	if (wth == NULL) {
+		cfile_open_failure_message(filename, err, err_info);
+		return false;
+	}
+
+	wtap_rec_init(&rec);
+	ws_buffer_init(&buf, 1514);
+
+	while (wtap_read(wth, &rec, &buf, &err, &err_info, &data_offset)) {
+		if (rec.rec_type == REC_TYPE_PACKET) {
+			bench_add_input(inputs, ws_buffer_start_ptr(&buf),
+			    rec.rec_header.packet_header.caplen,
+			    full_frame ? &rec.rec_header.packet_header : NULL);
+		}
+		wtap_rec_reset(&rec);
+	}
+
+	wtap_rec_cleanup(&rec);
+	ws_buffer_free(&buf);
+	wtap_close(wth);
+
+	if (err != 0) {
+		cfile_read_failure_message(filename, err, err_info);
+		return false;
+	}
+	return true;
+}
+
+static void
+bench_free_inputs(GArray *inputs)
+{
+	for (unsigned i = 0; i < inputs->len; i++)
+		g_free(g_array_index(inputs, bench_input_t, i).data);
+	g_array_free(inputs, true);
+}
+
+/* Each pass starts from a new session, as if a new file were opened. */
+static uint64_t
+bench_run_pass(GArray *inputs)
+{
+	uint64_t start, elapsed_ns;
+
+	epan_dissect_free(fuzz_edt);
+	epan_free(fuzz_epan);
+	fuzz_epan = fuzzshark_epan_new();
+	fuzz_edt = epan_dissect_new(fuzz_epan, true, false);
+
+	start = ws_clock_get_monotonic_ns();
+	for (unsigned i = 0; i < inputs->len; i++) {
+		bench_input_t *input = &g_array_index(inputs, bench_input_t, i);
+
+		fuzzshark_dissect(input->data, input->len, input->has_header ? &input->header : NULL);
+	}
+	elapsed_ns = ws_clock_get_monotonic_ns() - start;
+
+	return elapsed_ns;
+}
+
+/*
+ * The overall figures come from the timed passes. The per-protocol ones and
+ * the wmem usage come from a separate pass over profile_packets inputs,
+ * as profiling slows dissection down.
+ */
+static void
+bench_print_results(const char *target, const char *table, uint32_t iterations,
+    uint64_t packets, uint64_t elapsed_ns, uint64_t profile_packets)
+{
+	json_dumper dumper = {
+		.output_file = stdout,
+		.flags = JSON_DUMPER_FLAGS_PRETTY_PRINT,
+	};
+	GArray *stats = dissector_profile_get_stats();
+	uint64_t wmem_bytes = 0;
+
+	for (unsigned i = 0; i < stats->len; i++)
+		wmem_bytes += g_array_index(stats, dissector_profile_stats_t, i).exclusive_bytes;
+
+	json_dumper_begin_object(&dumper);
+	json_dumper_set_member_name(&dumper, "target");
+	json_dumper_value_string(&dumper, target);
+	json_dumper_set_member_name(&dumper, "table");
+	json_dumper_value_string(&dumper, table);
+	json_dumper_set_member_name(&dumper, "iterations");
+	json_dumper_value_anyf(&dumper, "%u", iterations);
+	json_dumper_set_member_name(&dumper, "packets");
+	json_dumper_value_anyf(&dumper, "%" PRIu64, packets);
+	json_dumper_set_member_name(&dumper, "elapsed_ns");
+	json_dumper_value_anyf(&dumper, "%" PRIu64, elapsed_ns);
+	json_dumper_set_member_name(&dumper, "packets_per_second");
+	json_dumper_value_double(&dumper, elapsed_ns ? packets * 1e9 / elapsed_ns : 0.0);
+	json_dumper_set_member_name(&dumper, "ns_per_packet");
+	json_dumper_value_double(&dumper, packets ? (double) elapsed_ns / packets : 0.0);
+	json_dumper_set_member_name(&dumper, "wmem_bytes_per_packet");
+	json_dumper_value_double(&dumper, profile_packets ? (double) wmem_bytes / profile_packets : 0.0);
+
+	json_dumper_set_member_name(&dumper, "dissectors");
+	json_dumper_begin_array(&dumper);
+	for (unsigned i = 0; i < stats->len; i++) {
+		dissector_profile_stats_t *entry = &g_array_index(stats, dissector_profile_stats_t, i);
+
+		json_dumper_begin_object(&dumper);
+		json_dumper_set_member_name(&dumper, "protocol");
+		json_dumper_value_string(&dumper, proto_get_protocol_filter_name(entry->proto_id));
+		json_dumper_set_member_name(&dumper, "calls");
+		json_dumper_value_anyf(&dumper, "%" PRIu64, entry->calls);
+		json_dumper_set_member_name(&dumper, "exclusive_ns");
+		json_dumper_value_anyf(&dumper, "%" PRIu64, entry->exclusive_ns);
+		json_dumper_set_member_name(&dumper, "inclusive_ns");
+		json_dumper_value_anyf(&dumper, "%" PRIu64, entry->inclusive_ns);
+		json_dumper_set_member_name(&dumper, "packets_per_second");
+		json_dumper_value_double(&dumper, entry->exclusive_ns ? entry->calls * 1e9 / entry->exclusive_ns : 0.0);
+		json_dumper_set_member_name(&dumper, "ns_per_packet");
+		json_dumper_value_double(&dumper, (double) entry->exclusive_ns / profile_packets);
+		json_dumper_set_member_name(&dumper, "wmem_bytes_per_packet");
+		json_dumper_value_double(&dumper, (double) entry->exclusive_bytes / profile_packets);
+		json_dumper_end_object(&dumper);
+	}
+	json_dumper_end_array(&dumper);
+	json_dumper_end_object(&dumper);
+	json_dumper_finish(&dumper);
+
+	g_array_free(stats, true);
+}
+
+static void
+bench_print_usage(FILE *output, const char *progname)
+{
+	fprintf(output,
+"Usage: %s [-n <iterations>] <corpus directory|capture file> ...\n"
+"\n"
+"  -n <iterations>          number of timed passes over the inputs (default 10)\n"
+"\n"
+"Every file in a corpus directory is one input for the dissector selected\n"
+"with FUZZSHARK_TARGET and FUZZSHARK_TABLE, as for fuzzshark. Packets of\n"
+"capture files are handed to that dissector too or, if no dissector is\n"
+"selected, dissected from the frame up with their encapsulation.\n"
+"\n"
+"After one untimed pass, the inputs are dissected <iterations> times and\n"
+"the throughput is written as JSON. A last pass with the dissector profiler\n"
+"on adds the throughput and wmem usage of each protocol; the profiler isn't\n"
+"running while the overall throughput is measured.\n"
+"\n"
+"Unlike fuzzshark, defragmentation and TCP reassembly aren't turned off;\n"
+"they keep their default settings, or those of the preferences file.\n",
+	    progname);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const char *target = getenv("FUZZSHARK_TARGET");
+	const char *table = getenv("FUZZSHARK_TABLE");
+	uint32_t iterations = 10;
+	uint64_t elapsed_ns = 0;
+	GArray *inputs;
+	int opt;
+	int ret;
+
+	ret = fuzz_init(&argc, argv);
+	if (ret != 0)
+		return ret;
+
+	while ((opt = ws_getopt(argc, argv, "hn:")) != -1) {
+		switch (opt) {
+		case 'h':
+			bench_print_usage(stdout, argv[0]);
+			return EXIT_SUCCESS;
+		case 'n':
+			if (!ws_strtou32(ws_optarg, NULL, &iterations) || iterations == 0) {
+				cmdarg_err("\"%s\" isn't a valid number of iterations", ws_optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		default:
+			bench_print_usage(stderr, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (ws_optind >= argc) {
+		bench_print_usage(stderr, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	inputs = g_array_new(false, false, sizeof(bench_input_t));
+	for (int i = ws_optind; i < argc; i++) {
+		bool ok;
+
+		if (g_file_test(argv[i], G_FILE_TEST_IS_DIR)) {
+			if (target == NULL) {
+				cmdarg_err("A corpus directory needs a dissector from FUZZSHARK_TARGET");
+				ok = false;
+			} else {
+				ok = bench_read_corpus(inputs, argv[i]);
+			}
+		} else {
+			ok = bench_read_capture(inputs, argv[i], target == NULL);
+		}
+		if (!ok) {
+			bench_free_inputs(inputs);
+			return EXIT_FAILURE;
+		}
+	}
+	if (inputs->len == 0) {
+		cmdarg_err("No inputs to dissect");
+		bench_free_inputs(inputs);
+		return EXIT_FAILURE;
+	}
+
+	/* Warm up caches and lazily registered state before measuring. */
+	bench_run_pass(inputs);
+
+	for (unsigned i = 0; i < iterations; i++)
+		elapsed_ns += bench_run_pass(inputs);
+
+	dissector_profile_reset();
+	dissector_profile_enable(true);
+	bench_run_pass(inputs);
+	dissector_profile_enable(false);
+
+	bench_print_results(target, table, iterations, (uint64_t) inputs->len * iterations, elapsed_ns,
+	    inputs->len);
+
+	bench_free_inputs(inputs);
+	epan_dissect_free(fuzz_edt);
+	epan_free(fuzz_epan);
+	epan_cleanup();
+	wtap_cleanup();
+	free_progdirs();
+	return EXIT_SUCCESS;
+}
+
+#elif defined(FUZZ_EPAN)
+int
+LLVMFuzzerTestOneInput(const uint8_t *buf, size_t real_len)
+{
+	fuzzshark_dissect(buf, (uint32_t) real_len, NULL);
 	return 0;
 }
 
@@ -390,17 +769,19 @@ LLVMFuzzerTestOneInput(const uint8_t *buf, size_t real_len)
 # error "Missing fuzz target."
 #endif
 
+#ifndef FUZZ_BENCH
 int
 LLVMFuzzerInitialize(int *argc, char ***argv)
 {
 	int ret;
 
-	ret = fuzz_init(*argc, *argv);
+	ret = fuzz_init(argc, *argv);
 	if (ret != 0)
 		exit(ret);
 
 	return 0;
 }
+#endif
 
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
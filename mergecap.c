@@ -45,6 +45,7 @@
 #include <wiretap/merge.h>
 
 #include "ui/failure_message.h"
+#include "ui/util.h"
 
 /*
  * Show the usage
@@ -64,6 +65,12 @@ print_usage(FILE *output)
     fprintf(output, "                    an empty \"-F\" option will list the file types.\n");
     fprintf(output, "  -I <IDB merge mode> set the merge mode for Interface Description Blocks; default is 'all'.\n");
     fprintf(output, "                    an empty \"-I\" option will list the merge modes.\n");
+    fprintf(output, "  --compress <type> compress the output file using the type compression format.\n");
+    fprintf(output, "                    an empty \"--compress\" option will list the compression types.\n");
+    fprintf(output, "  --compress-level <level> set the compression level; default depends on the\n");
+    fprintf(output, "                    compression type.\n");
+    fprintf(output, "  --compress-threads <n> compress using <n> worker threads, if supported by\n");
+    fprintf(output, "                    the compression type (zstd).\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -h, --help        display this help and exit.\n");
@@ -198,9 +205,15 @@ main(int argc, char *argv[])
         cfile_close_failure_message
     };
     int                 opt;
+#define LONGOPT_COMPRESS            LONGOPT_BASE_APPLICATION+1
+#define LONGOPT_COMPRESS_LEVEL      LONGOPT_BASE_APPLICATION+2
+#define LONGOPT_COMPRESS_THREADS    LONGOPT_BASE_APPLICATION+3
     static const struct ws_option long_options[] = {
         {"help", ws_no_argument, NULL, 'h'},
         {"version", ws_no_argument, NULL, 'v'},
+        {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"compress-level", ws_required_argument, NULL, LONGOPT_COMPRESS_LEVEL},
+        {"compress-threads", ws_required_argument, NULL, LONGOPT_COMPRESS_THREADS},
         {0, 0, 0, 0 }
     };
     bool                do_append          = false;
@@ -211,6 +224,9 @@ main(int argc, char *argv[])
     char               *out_filename       = NULL;
     bool                status             = true;
     idb_merge_mode      mode               = IDB_MERGE_MODE_MAX;
+    wtap_compression_type compression_type = WTAP_UNCOMPRESSED;
+    int                 compression_level  = 0;
+    int                 compression_threads = 0;
     merge_progress_callback_t cb;
 
     cmdarg_err_init(mergecap_cmdarg_err, mergecap_cmdarg_err_cont);
@@ -291,6 +307,26 @@ main(int argc, char *argv[])
                 snaplen = get_nonzero_guint32(ws_optarg, "snapshot length");
                 break;
 
+            case LONGOPT_COMPRESS:
+                compression_type = wtap_name_to_compression_type(ws_optarg);
+                if (compression_type == WTAP_UNKNOWN_COMPRESSION ||
+                    !wtap_can_write_compression_type(compression_type)) {
+                    cmdarg_err("\"%s\" isn't a valid output compression mode",
+                               ws_optarg);
+                    list_output_compression_types("mergecap", stderr);
+                    status = false;
+                    goto clean_exit;
+                }
+                break;
+
+            case LONGOPT_COMPRESS_LEVEL:
+                compression_level = get_int(ws_optarg, "compression level");
+                break;
+
+            case LONGOPT_COMPRESS_THREADS:
+                compression_threads = get_natural_int(ws_optarg, "number of compression threads");
+                break;
+
             case 'V':
                 verbose = true;
                 break;
@@ -312,6 +348,9 @@ main(int argc, char *argv[])
                     case'I':
                         list_idb_merge_modes();
                         break;
+                    case LONGOPT_COMPRESS:
+                        list_output_compression_types("mergecap", stderr);
+                        break;
                     default:
                         print_usage(stderr);
                 }
@@ -343,6 +382,24 @@ main(int argc, char *argv[])
         return 1;
     }
 
+    if (compression_level != 0) {
+        int min_level, max_level;
+
+        if (!wtap_compression_type_level_range(compression_type, &min_level, &max_level)) {
+            cmdarg_err("A compression level can't be set with compression type \"%s\"",
+                       wtap_compression_type_name(compression_type));
+            status = false;
+            goto clean_exit;
+        }
+        if (compression_level < min_level || compression_level > max_level) {
+            cmdarg_err("The specified compression level %d isn't between %d and %d for compression type \"%s\"",
+                       compression_level, min_level, max_level,
+                       wtap_compression_type_name(compression_type));
+            status = false;
+            goto clean_exit;
+        }
+    }
+
     /*
      * Setting IDB merge mode must use a file format that supports
      * (and thus requires) interface ID and information blocks.
@@ -366,13 +423,15 @@ main(int argc, char *argv[])
                 (const char *const *) &argv[ws_optind],
                 in_file_count, do_append, mode, snaplen,
                 get_appname_and_version(),
-                verbose ? &cb : NULL);
+                verbose ? &cb : NULL, compression_type,
+                compression_level, compression_threads);
     } else {
         /* merge the files to the outfile */
         status = merge_files(out_filename, file_type,
                 (const char *const *) &argv[ws_optind], in_file_count,
                 do_append, mode, snaplen, get_appname_and_version(),
-                verbose ? &cb : NULL);
+                verbose ? &cb : NULL, compression_type,
+                compression_level, compression_threads);
     }
 
 clean_exit:
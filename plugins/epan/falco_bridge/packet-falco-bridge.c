@@ -777,23 +777,15 @@ tap_packet_status
 fd_tap_listener(void *tapdata, packet_info *pinfo,
                       epan_dissect_t *edt _U_, const void *data, tap_flags_t flags _U_)
 {
-    follow_record_t *follow_record;
     follow_info_t *follow_info = (follow_info_t *)tapdata;
     fd_follow_tap_info *tap_info = (fd_follow_tap_info *)data;
     bool is_server;
 
     is_server = tap_info->is_write;
 
-    follow_record = g_new0(follow_record_t, 1);
-    follow_record->is_server = is_server;
-    follow_record->packet_num = pinfo->fd->num;
-    follow_record->abs_ts = pinfo->fd->abs_ts;
-    follow_record->data = g_byte_array_append(g_byte_array_new(),
-                                              tap_info->data,
-                                              tap_info->datalen);
-
-    follow_info->bytes_written[is_server] += follow_record->data->len;
-    follow_info->payload = g_list_prepend(follow_info->payload, follow_record);
+    follow_info->bytes_written[is_server] += tap_info->datalen;
+    follow_info_add_payload(follow_info, is_server, pinfo->fd->num, &pinfo->fd->abs_ts,
+                            tap_info->data, tap_info->datalen);
 
     return TAP_PACKET_DONT_REDRAW;
 }
@@ -40,6 +40,7 @@
 #include <epan/disabled_protos.h>
 #include <epan/prefs.h>
 #include <epan/column.h>
+#include <epan/conversation.h>
 #include <epan/print.h>
 #include <epan/addr_resolv.h>
 #include "ui/util.h"
@@ -556,6 +557,11 @@ sharkd_retap(void)
     epan_dissect_t edt;
     column_info   *cinfo;
 
+    const char *tap_dfilter;
+    conversation_frame_iter_t frame_iter;
+    bool use_frame_index;
+    uint32_t next_indexed_frame = 0;
+
     /* Get the union of the flags for all tap listeners. */
     tap_flags = union_of_tap_listener_flags();
 
@@ -579,9 +585,24 @@ sharkd_retap(void)
 
     reset_tap_listeners();
 
+    /* If the taps only want one stream (e.g. follow), skip the other frames. */
+    tap_dfilter = tap_listeners_common_dfilter();
+    use_frame_index = tap_dfilter && conversation_index_filter_frames(tap_dfilter, &frame_iter);
+    if (use_frame_index && !conversation_frame_iter_next(&frame_iter, &next_indexed_frame))
+        next_indexed_frame = 0;
+
     for (framenum = 1; framenum <= cfile.count; framenum++) {
         fdata = sharkd_get_frame(framenum);
 
+        if (use_frame_index) {
+            if (framenum == next_indexed_frame) {
+                if (!conversation_frame_iter_next(&frame_iter, &next_indexed_frame))
+                    next_indexed_frame = 0;
+            } else if (fdata->visited) {
+                continue;
+            }
+        }
+
         if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
             break;
 
@@ -621,6 +642,10 @@ sharkd_filter(const char *dftext, uint8_t **result)
 
     epan_dissect_t edt;
 
+    conversation_frame_iter_t frame_iter;
+    bool use_frame_index;
+    uint32_t next_indexed_frame = 0;
+
     if (!dfilter_compile(dftext, &dfcode, NULL)) {
         return -1;
     }
@@ -640,6 +665,14 @@ sharkd_filter(const char *dftext, uint8_t **result)
     passed_bits = 0;
     result_bits = (uint8_t *) g_malloc(2 + (frames_count / 8));
 
+    /*
+     * For "tcp.stream eq N" and the like only the frames recorded for
+     * that stream during the first pass can match.
+     */
+    use_frame_index = conversation_index_filter_frames(dftext, &frame_iter);
+    if (use_frame_index && !conversation_frame_iter_next(&frame_iter, &next_indexed_frame))
+        next_indexed_frame = 0;
+
     for (framenum = 1; framenum <= frames_count; framenum++) {
         frame_data *fdata = sharkd_get_frame(framenum);
 
@@ -648,6 +681,15 @@ sharkd_filter(const char *dftext, uint8_t **result)
             passed_bits = 0;
         }
 
+        if (use_frame_index) {
+            if (framenum == next_indexed_frame) {
+                if (!conversation_frame_iter_next(&frame_iter, &next_indexed_frame))
+                    next_indexed_frame = 0;
+            } else if (fdata->visited) {
+                continue;
+            }
+        }
+
         if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
             break;
 
@@ -687,6 +729,117 @@ sharkd_filter(const char *dftext, uint8_t **result)
     return framenum;
 }
 
+/*
+ * Does the work of sharkd_retap(), sharkd_filter() and a frames listing in
+ * a single pass. The tap listeners see every frame. The frames that pass
+ * the filter are passed to frame_cb, and the ones for which columns_cb
+ * returns a column_info get their columns filled in and colorized.
+ *
+ * The filter is either the result of an earlier sharkd_filter() in
+ * filtered, or dfcode, whose result is returned in result like
+ * sharkd_filter() does. With neither, all frames pass. The caller has to
+ * draw the taps.
+ */
+int
+sharkd_retap_frames(dfilter_t *dfcode, const uint8_t *filtered, uint8_t **result,
+        sharkd_frame_columns_func_t columns_cb, sharkd_frame_func_t frame_cb, void *data)
+{
+    uint32_t framenum, prev_dis_num = 0;
+    frame_data *fdata;
+    Buffer buf;
+    wtap_rec rec;
+    int err;
+    char *err_info = NULL;
+
+    uint8_t *result_bits = NULL;
+
+    unsigned      tap_flags;
+    bool          create_proto_tree;
+    epan_dissect_t edt;
+
+    if (filtered)
+        dfcode = NULL;
+
+    if (dfcode && result)
+        result_bits = (uint8_t *) g_malloc0(2 + (cfile.count / 8));
+
+    tap_flags = union_of_tap_listener_flags();
+
+    /* The columns or colors of a frame can need a tree as well. */
+    create_proto_tree =
+        (dfcode != NULL || columns_cb != NULL ||
+         have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE));
+
+    wtap_rec_init(&rec);
+    ws_buffer_init(&buf, 1514);
+    epan_dissect_init(&edt, cfile.epan, create_proto_tree, false);
+
+    reset_tap_listeners();
+
+    for (framenum = 1; framenum <= cfile.count; framenum++) {
+        uint32_t frame_ref_num = (framenum != 1) ? 1 : 0;
+        column_info *cinfo = NULL;
+        bool passed;
+
+        fdata = sharkd_get_frame(framenum);
+
+        passed = !filtered || (filtered[framenum / 8] & (1 << (framenum % 8)));
+
+        if (passed && columns_cb)
+            cinfo = columns_cb(fdata, prev_dis_num, &frame_ref_num, data);
+
+        if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info)) {
+            g_free(err_info);
+            break;
+        }
+
+        if (dfcode)
+            epan_dissect_prime_with_dfilter(&edt, dfcode);
+
+        if (cinfo) {
+            col_custom_prime_edt(&edt, cinfo);
+            if (fdata->color_filter == NULL) {
+                color_filters_prime_edt(&edt);
+                fdata->need_colorize = 1;
+            }
+        }
+
+        fdata->ref_time = (framenum == frame_ref_num);
+        fdata->frame_ref_num = frame_ref_num;
+        fdata->prev_dis_num = prev_dis_num;
+        epan_dissect_run_with_taps(&edt, cfile.cd_t, &rec,
+                frame_tvbuff_new_buffer(&cfile.provider, fdata, &buf),
+                fdata, cinfo);
+
+        if (dfcode)
+            passed = dfilter_apply_edt(dfcode, &edt);
+
+        if (passed) {
+            if (result_bits)
+                result_bits[framenum / 8] |= 1 << (framenum % 8);
+
+            /* The columns were filled in on the chance that it passes. */
+            if (cinfo)
+                epan_dissect_fill_in_columns(&edt, false, true/* fill_fd_columns */);
+
+            frame_cb(&edt, cinfo, data);
+            prev_dis_num = framenum;
+        }
+
+        wtap_rec_reset(&rec);
+        epan_dissect_reset(&edt);
+    }
+
+    wtap_rec_cleanup(&rec);
+    ws_buffer_free(&buf);
+    epan_dissect_cleanup(&edt);
+
+    if (result)
+        *result = result_bits;
+
+    return framenum;
+}
+
 /*
  * Get the modified block if available, nothing otherwise.
  * Must be cloned if changes desired.
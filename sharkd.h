@@ -27,12 +27,16 @@
 #define SHARKD_MODE_GOLD_DAEMON        4
 
 typedef void (*sharkd_dissect_func_t)(epan_dissect_t *edt, proto_tree *tree, struct epan_column_info *cinfo, const GSList *data_src, void *data);
+typedef column_info *(*sharkd_frame_columns_func_t)(frame_data *fdata, uint32_t prev_dis_num, uint32_t *frame_ref_num, void *data);
+typedef void (*sharkd_frame_func_t)(epan_dissect_t *edt, column_info *cinfo, void *data);
 
 /* sharkd.c */
 cf_status_t sharkd_cf_open(const char *fname, unsigned int type, bool is_tempfile, int *err);
 int sharkd_load_cap_file(void);
 int sharkd_retap(void);
 int sharkd_filter(const char *dftext, uint8_t **result);
+int sharkd_retap_frames(dfilter_t *dfcode, const uint8_t *filtered, uint8_t **result,
+                        sharkd_frame_columns_func_t columns_cb, sharkd_frame_func_t frame_cb, void *data);
 frame_data *sharkd_get_frame(uint32_t framenum);
 enum dissect_request_status {
   DISSECT_REQUEST_SUCCESS,
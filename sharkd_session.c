@@ -29,6 +29,7 @@
 #include <file.h>
 #include <epan/epan_dissect.h>
 #include <epan/exceptions.h>
+#include <epan/dissector_profile.h>
 #include <epan/color_filters.h>
 #include <epan/prefs.h>
 #include <epan/prefs-int.h>
@@ -86,6 +87,46 @@ struct sharkd_filter_item
 
 static GHashTable *filter_table;
 
+/*
+ * Column text produced by "frames" requests, kept so that paging back and
+ * forth through a capture does not redissect every frame.  Column text
+ * depends on the frame, on the frames used for the delta/reference time
+ * columns and on the set of requested columns, so all of them are part of
+ * the key.  The cache is bounded in bytes; the least recently used entries
+ * are evicted first.
+ */
+#define SHARKD_COLUMN_CACHE_MAX_BYTES (32 * 1024 * 1024)
+
+struct sharkd_column_cache_key
+{
+    uint32_t framenum;
+    uint32_t ref_frame;
+    uint32_t prev_dis_num;
+    const char *columns; /* entry of column_signatures, NULL for the profile columns */
+};
+
+struct sharkd_column_cache_entry
+{
+    struct sharkd_column_cache_key key;
+    int num_cols;
+    size_t size;
+    char *text; /* num_cols NUL-terminated strings stored back to back */
+    GList *link; /* in column_cache_order */
+};
+
+static GHashTable *column_cache;
+static GQueue column_cache_order = G_QUEUE_INIT; /* least recently used first */
+static size_t column_cache_size;
+
+/*
+ * Column sets requested with column0...columnXX, most recently used first.
+ * Cache keys point at these strings; the text cached for a column set is
+ * dropped along with it when it falls off the end.
+ */
+#define SHARKD_COLUMN_SIGNATURES_MAX 64
+
+static GQueue column_signatures = G_QUEUE_INIT;
+
 static int mode;
 static uint32_t rpcid;
 
@@ -373,6 +414,7 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
 
         // Valid methods
         {"method",     "analyse",        1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"method",     "batch",          1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "bye",            1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "check",          1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "complete",       1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
@@ -385,12 +427,36 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"method",     "intervals",      1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "iograph",        1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "load",           1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"method",     "profile",        1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "setcomment",     1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "setconf",        1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "status",         1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "tap",            1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
 
         // Parameters and their method context
+        {"batch",      "filter",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "frames",         2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
+        {"batch",      "column*",        2, JSMN_UNDEFINED,    SHARKD_JSON_ANY,      SHARKD_OPTIONAL},
+        {"batch",      "skip",           2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
+        {"batch",      "limit",          2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
+        {"batch",      "refs",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "interval",       2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
+        {"batch",      "tap0",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap1",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap2",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap3",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap4",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap5",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap6",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap7",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap8",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap9",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap10",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap11",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap12",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap13",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap14",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"batch",      "tap15",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"check",      "field",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"check",      "filter",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"complete",   "field",          2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
@@ -400,6 +466,8 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"follow",     "follow",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
         {"follow",     "filter",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
         {"follow",     "sub_stream",     2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
+        {"follow",     "skip",           2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
+        {"follow",     "limit",          2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
         {"frame",      "frame",          2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_MANDATORY},
         {"frame",      "proto",          2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
         {"frame",      "ref_frame",      2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
@@ -439,6 +507,8 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"iograph",    "filter8",        2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"iograph",    "filter9",        2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"load",       "file",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
+        {"profile",    "enable",         2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
+        {"profile",    "reset",          2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
         {"setcomment", "frame",          2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_MANDATORY},
         {"setcomment", "comment",        2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"setconf",    "name",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
@@ -754,6 +824,131 @@ sharkd_session_filter_data(const char *filter)
     return l;
 }
 
+static unsigned
+sharkd_column_cache_hash(const void *k)
+{
+    const struct sharkd_column_cache_key *key = (const struct sharkd_column_cache_key *) k;
+    unsigned h = key->framenum;
+
+    h = h * 31 + key->ref_frame;
+    h = h * 31 + key->prev_dis_num;
+    h = h * 31 + g_direct_hash(key->columns);
+    return h;
+}
+
+static gboolean
+sharkd_column_cache_equal(const void *a, const void *b)
+{
+    const struct sharkd_column_cache_key *ka = (const struct sharkd_column_cache_key *) a;
+    const struct sharkd_column_cache_key *kb = (const struct sharkd_column_cache_key *) b;
+
+    /* there's one copy of each column set, so comparing the pointers is enough */
+    return ka->framenum == kb->framenum &&
+           ka->ref_frame == kb->ref_frame &&
+           ka->prev_dis_num == kb->prev_dis_num &&
+           ka->columns == kb->columns;
+}
+
+static void
+sharkd_column_cache_entry_free(void *data)
+{
+    struct sharkd_column_cache_entry *entry = (struct sharkd_column_cache_entry *) data;
+
+    g_free(entry->text);
+    g_free(entry);
+}
+
+/*
+ * Drop all cached column text.  Needs to be called whenever something that
+ * column text depends on changes: the capture file, preferences (which
+ * include the column definitions and name resolution), or frame comments.
+ */
+static void
+sharkd_column_cache_clear(void)
+{
+    g_hash_table_remove_all(column_cache);
+    g_queue_clear(&column_cache_order);
+    column_cache_size = 0;
+}
+
+/* Drop the column text cached for a column set. */
+static void
+sharkd_column_cache_drop_columns(const char *columns)
+{
+    GList *link = column_cache_order.head;
+
+    while (link != NULL)
+    {
+        struct sharkd_column_cache_entry *entry = (struct sharkd_column_cache_entry *) link->data;
+        GList *next = link->next;
+
+        if (entry->key.columns == columns)
+        {
+            g_queue_delete_link(&column_cache_order, link);
+            column_cache_size -= entry->size;
+            g_hash_table_remove(column_cache, &entry->key);
+        }
+        link = next;
+    }
+}
+
+static const struct sharkd_column_cache_entry *
+sharkd_column_cache_lookup(const struct sharkd_column_cache_key *key)
+{
+    struct sharkd_column_cache_entry *entry;
+
+    entry = (struct sharkd_column_cache_entry *) g_hash_table_lookup(column_cache, key);
+    if (entry != NULL && entry->link != column_cache_order.tail)
+    {
+        g_queue_unlink(&column_cache_order, entry->link);
+        g_queue_push_tail_link(&column_cache_order, entry->link);
+    }
+    return entry;
+}
+
+static void
+sharkd_column_cache_insert(const struct sharkd_column_cache_key *key, const column_info *cinfo)
+{
+    struct sharkd_column_cache_entry *entry;
+    size_t len = 0;
+    char *p;
+
+    for (int col = 0; col < cinfo->num_cols; ++col)
+        len += strlen(get_column_text(cinfo, col)) + 1;
+
+    if (sizeof(*entry) + len > SHARKD_COLUMN_CACHE_MAX_BYTES)
+        return;
+
+    entry = g_new(struct sharkd_column_cache_entry, 1);
+    entry->key = *key;
+    entry->num_cols = cinfo->num_cols;
+    entry->size = sizeof(*entry) + len;
+    entry->text = p = (char *) g_malloc(len ? len : 1);
+
+    for (int col = 0; col < cinfo->num_cols; ++col)
+    {
+        const char *text = get_column_text(cinfo, col);
+        size_t text_len = strlen(text) + 1;
+
+        memcpy(p, text, text_len);
+        p += text_len;
+    }
+
+    while (column_cache_size + entry->size > SHARKD_COLUMN_CACHE_MAX_BYTES)
+    {
+        struct sharkd_column_cache_entry *oldest;
+
+        oldest = (struct sharkd_column_cache_entry *) g_queue_pop_head(&column_cache_order);
+        column_cache_size -= oldest->size;
+        g_hash_table_remove(column_cache, &oldest->key);
+    }
+
+    g_hash_table_insert(column_cache, &entry->key, entry);
+    g_queue_push_tail(&column_cache_order, entry);
+    entry->link = column_cache_order.tail;
+    column_cache_size += entry->size;
+}
+
 static bool
 sharkd_rtp_match_init(rtpstream_id_t *id, const char *init_str)
 {
@@ -1178,6 +1373,8 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
     fprintf(stderr, "load: filename=%s\n", tok_file);
 
+    sharkd_column_cache_clear();
+
     if (sharkd_cf_open(tok_file, WTAP_TYPE_AUTO, false, &err) != CF_OK)
     {
         sharkd_json_error(
@@ -1288,6 +1485,72 @@ sharkd_session_process_status(void)
     sharkd_json_result_epilogue();
 }
 
+/**
+ * sharkd_session_process_profile()
+ *
+ * Process profile request, the CPU time and wmem allocations of each
+ * protocol's dissectors while profiling was enabled
+ *
+ * Input:
+ *   (o) enable - true to start profiling the dissectors, false to stop
+ *   (o) reset  - true to clear the figures gathered so far
+ *
+ * The figures are returned before the request's changes are applied, so
+ * a single request can collect the figures and start a new profile.
+ *
+ * Output object with attributes:
+ *   (m) enabled   - true if profiling is enabled after this request
+ *   (m) total_ns  - time spent in the profiled dissectors
+ *   (m) protocols - array of objects, largest exclusive time first, with attributes:
+ *                  'proto'      - protocol filter name
+ *                  'calls'      - number of dissector calls
+ *                  'excl_ns'    - time spent in the protocol's dissectors themselves
+ *                  'incl_ns'    - time including the dissectors they called
+ *                  'excl_bytes' - wmem bytes allocated by the protocol's dissectors themselves
+ *                  'incl_bytes' - wmem bytes including the dissectors they called
+ */
+static void
+sharkd_session_process_profile(char *buf, const jsmntok_t *tokens, int count)
+{
+    const char *tok_enable = json_find_attr(buf, tokens, count, "enable");
+    const char *tok_reset = json_find_attr(buf, tokens, count, "reset");
+    GArray *stats = dissector_profile_get_stats();
+    uint64_t total_ns = 0;
+
+    if (tok_reset && !strcmp(tok_reset, "true"))
+        dissector_profile_reset();
+    if (tok_enable)
+        dissector_profile_enable(!strcmp(tok_enable, "true"));
+
+    for (unsigned i = 0; i < stats->len; i++)
+        total_ns += g_array_index(stats, dissector_profile_stats_t, i).exclusive_ns;
+
+    sharkd_json_result_prologue(rpcid);
+
+    sharkd_json_value_anyf("enabled", dissector_profile_enabled() ? "true" : "false");
+    sharkd_json_value_anyf("total_ns", "%" PRIu64, total_ns);
+
+    sharkd_json_array_open("protocols");
+    for (unsigned i = 0; i < stats->len; i++)
+    {
+        dissector_profile_stats_t *entry = &g_array_index(stats, dissector_profile_stats_t, i);
+
+        sharkd_json_object_open(NULL);
+        sharkd_json_value_string("proto", proto_get_protocol_filter_name(entry->proto_id));
+        sharkd_json_value_anyf("calls", "%" PRIu64, entry->calls);
+        sharkd_json_value_anyf("excl_ns", "%" PRIu64, entry->exclusive_ns);
+        sharkd_json_value_anyf("incl_ns", "%" PRIu64, entry->inclusive_ns);
+        sharkd_json_value_anyf("excl_bytes", "%" PRIu64, entry->exclusive_bytes);
+        sharkd_json_value_anyf("incl_bytes", "%" PRIu64, entry->inclusive_bytes);
+        sharkd_json_object_close();
+    }
+    sharkd_json_array_close();
+
+    sharkd_json_result_epilogue();
+
+    g_array_free(stats, true);
+}
+
 struct sharkd_analyse_data
 {
     GHashTable *protocols_set;
@@ -1476,26 +1739,67 @@ sharkd_session_create_columns(column_info *cinfo, const char *buf, const jsmntok
     return cinfo;
 }
 
-static void
-sharkd_session_process_frames_cb(epan_dissect_t *edt, proto_tree *tree _U_,
-        struct epan_column_info *cinfo, const GSList *data_src _U_, void *data _U_)
+/*
+ * Returns a string identifying the columns requested with column0...columnXX,
+ * or NULL if the profile columns are used. Requests for the same columns get
+ * the same pointer, which stays valid until SHARKD_COLUMN_SIGNATURES_MAX
+ * other column sets have been requested.
+ * Has to be called before sharkd_session_create_columns(), which modifies
+ * the request buffer.
+ */
+static const char *
+sharkd_session_columns_signature(const char *buf, const jsmntok_t *tokens, int count)
 {
-    packet_info *pi = &edt->pi;
-    frame_data *fdata = pi->fd;
-    wtap_block_t pkt_block = NULL;
-    unsigned int i;
-    char *comment = NULL;
+    GString *signature = NULL;
+    GList *link;
 
-    json_dumper_begin_object(&dumper);
+    for (int i = 0; i < 32; i++)
+    {
+        const char *tok_column;
+        char tok_column_name[64];
 
-    sharkd_json_array_open("c");
-    for (int col = 0; col < cinfo->num_cols; ++col)
+        snprintf(tok_column_name, sizeof(tok_column_name), "column%d", i);
+        tok_column = json_find_attr(buf, tokens, count, tok_column_name);
+        if (tok_column == NULL)
+            break;
+
+        if (signature == NULL)
+            signature = g_string_new(tok_column);
+        else
+            g_string_append_printf(signature, "\x1f%s", tok_column);
+    }
+
+    if (signature == NULL)
+        return NULL;
+
+    link = g_queue_find_custom(&column_signatures, signature->str, (GCompareFunc) strcmp);
+    if (link != NULL)
     {
-        sharkd_json_value_string(NULL, get_column_text(cinfo, col));
+        g_string_free(signature, TRUE);
+        g_queue_unlink(&column_signatures, link);
+        g_queue_push_head_link(&column_signatures, link);
+        return (const char *) link->data;
     }
-    sharkd_json_array_close();
 
-    sharkd_json_value_anyf("num", "%u", pi->num);
+    if (column_signatures.length >= SHARKD_COLUMN_SIGNATURES_MAX)
+    {
+        char *oldest = (char *) g_queue_pop_tail(&column_signatures);
+
+        sharkd_column_cache_drop_columns(oldest);
+        g_free(oldest);
+    }
+    g_queue_push_head(&column_signatures, g_string_free(signature, FALSE));
+    return (const char *) column_signatures.head->data;
+}
+
+static void
+sharkd_session_process_frames_attrs(frame_data *fdata)
+{
+    wtap_block_t pkt_block = NULL;
+    unsigned int i;
+    char *comment = NULL;
+
+    sharkd_json_value_anyf("num", "%u", fdata->num);
 
     /*
      * Get the block for this record, if it has one.
@@ -1530,9 +1834,83 @@ sharkd_session_process_frames_cb(epan_dissect_t *edt, proto_tree *tree _U_,
     }
 
     wtap_block_unref(pkt_block);
+}
+
+static void
+sharkd_session_process_frames_cb(epan_dissect_t *edt, proto_tree *tree _U_,
+        struct epan_column_info *cinfo, const GSList *data_src _U_, void *data)
+{
+    const struct sharkd_column_cache_key *key = (const struct sharkd_column_cache_key *) data;
+
+    json_dumper_begin_object(&dumper);
+
+    sharkd_json_array_open("c");
+    for (int col = 0; col < cinfo->num_cols; ++col)
+    {
+        sharkd_json_value_string(NULL, get_column_text(cinfo, col));
+    }
+    sharkd_json_array_close();
+
+    sharkd_session_process_frames_attrs(edt->pi.fd);
+
+    json_dumper_end_object(&dumper);
+
+    sharkd_column_cache_insert(key, cinfo);
+}
+
+static void
+sharkd_session_process_frames_cached(frame_data *fdata, const struct sharkd_column_cache_entry *entry)
+{
+    const char *text = entry->text;
+
+    json_dumper_begin_object(&dumper);
+
+    sharkd_json_array_open("c");
+    for (int col = 0; col < entry->num_cols; ++col)
+    {
+        sharkd_json_value_string(NULL, text);
+        text += strlen(text) + 1;
+    }
+    sharkd_json_array_close();
+
+    sharkd_session_process_frames_attrs(fdata);
+
     json_dumper_end_object(&dumper);
 }
 
+/*
+ * Advance through the sorted, comma separated list of time reference frames
+ * of a frames request to the current reference frame for framenum.
+ */
+static void
+sharkd_session_frames_refs(const char **tok_refs, uint32_t framenum, uint32_t *current_ref_frame, uint32_t *next_ref_frame)
+{
+    if (framenum >= *next_ref_frame)
+    {
+        *current_ref_frame = *next_ref_frame;
+
+        if (**tok_refs != ',')
+            *next_ref_frame = UINT32_MAX;
+
+        while (**tok_refs == ',' && framenum >= *next_ref_frame)
+        {
+            *current_ref_frame = *next_ref_frame;
+
+            if (!ws_strtou32(*tok_refs + 1, tok_refs, next_ref_frame))
+            {
+                fprintf(stderr, "sharkd_session_process_frames() wrong format for refs: %s\n", *tok_refs);
+                break;
+            }
+        }
+
+        if (**tok_refs == '\0' && framenum >= *next_ref_frame)
+        {
+            *current_ref_frame = *next_ref_frame;
+            *next_ref_frame = UINT32_MAX;
+        }
+    }
+}
+
 /**
  * sharkd_session_process_frames()
  *
@@ -1576,9 +1954,11 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
     Buffer rec_buf;   /* Record data */
     column_info *cinfo = &cfile.cinfo;
     column_info user_cinfo;
+    const char *columns_signature = NULL;
 
     if (tok_column)
     {
+        columns_signature = sharkd_session_columns_signature(buf, tokens, count);
         memset(&user_cinfo, 0, sizeof(user_cinfo));
         cinfo = sharkd_session_create_columns(&user_cinfo, buf, tokens, count);
         if (!cinfo)
@@ -1637,6 +2017,8 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
     {
         frame_data *fdata;
         uint32_t ref_frame = (framenum != 1) ? 1 : 0;
+        struct sharkd_column_cache_key cache_key;
+        const struct sharkd_column_cache_entry *cache_entry;
         enum dissect_request_status status;
         int err;
         char *err_info;
@@ -1653,42 +2035,34 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 
         if (tok_refs)
         {
-            if (framenum >= next_ref_frame)
-            {
-                current_ref_frame = next_ref_frame;
-
-                if (*tok_refs != ',')
-                    next_ref_frame = UINT32_MAX;
-
-                while (*tok_refs == ',' && framenum >= next_ref_frame)
-                {
-                    current_ref_frame = next_ref_frame;
-
-                    if (!ws_strtou32(tok_refs + 1, &tok_refs, &next_ref_frame))
-                    {
-                        fprintf(stderr, "sharkd_session_process_frames() wrong format for refs: %s\n", tok_refs);
-                        break;
-                    }
-                }
-
-                if (*tok_refs == '\0' && framenum >= next_ref_frame)
-                {
-                    current_ref_frame = next_ref_frame;
-                    next_ref_frame = UINT32_MAX;
-                }
-            }
+            sharkd_session_frames_refs(&tok_refs, framenum, &current_ref_frame, &next_ref_frame);
 
             if (current_ref_frame)
                 ref_frame = current_ref_frame;
         }
 
         fdata = sharkd_get_frame(framenum);
-        status = sharkd_dissect_request(framenum,
-                ref_frame, prev_dis_num,
-                &rec, &rec_buf, cinfo,
-                (fdata->color_filter == NULL) ? SHARKD_DISSECT_FLAG_COLOR : SHARKD_DISSECT_FLAG_NULL,
-                &sharkd_session_process_frames_cb, NULL,
-                &err, &err_info);
+
+        cache_key.framenum = framenum;
+        cache_key.ref_frame = ref_frame;
+        cache_key.prev_dis_num = prev_dis_num;
+        cache_key.columns = columns_signature;
+
+        cache_entry = sharkd_column_cache_lookup(&cache_key);
+        if (cache_entry)
+        {
+            sharkd_session_process_frames_cached(fdata, cache_entry);
+            status = DISSECT_REQUEST_SUCCESS;
+        }
+        else
+        {
+            status = sharkd_dissect_request(framenum,
+                    ref_frame, prev_dis_num,
+                    &rec, &rec_buf, cinfo,
+                    (fdata->color_filter == NULL) ? SHARKD_DISSECT_FLAG_COLOR : SHARKD_DISSECT_FLAG_NULL,
+                    &sharkd_session_process_frames_cb, &cache_key,
+                    &err, &err_info);
+        }
         switch (status) {
 
             case DISSECT_REQUEST_SUCCESS:
@@ -3407,45 +3781,20 @@ sharkd_session_eo_register_tap_listener(register_eo_t *eo, const char *tap_type,
     return register_tap_listener(get_eo_tap_listener_name(eo), eo_object, tap_filter, 0, NULL, get_eo_packet_func(eo), tap_draw, NULL);
 }
 
-/**
- * sharkd_session_process_tap()
- *
- * Process tap request
- *
- * Input:
- *   (m) tap0         - First tap request
- *   (o) tap1...tap15 - Other tap requests
- *
- * Output object with attributes:
- *   (m) taps  - array of object with attributes:
- *                  (m) tap  - tap name
- *                  (m) type - tap output type
- *                  ...
- *                  for type:stats see sharkd_session_process_tap_stats_cb()
- *                  for type:nstat see sharkd_session_process_tap_nstat_cb()
- *                  for type:conv see sharkd_session_process_tap_conv_cb()
- *                  for type:host see sharkd_session_process_tap_conv_cb()
- *                  for type:rtp-streams see sharkd_session_process_tap_rtp_cb()
- *                  for type:rtp-analyse see sharkd_session_process_tap_rtp_analyse_cb()
- *                  for type:eo see sharkd_session_process_tap_eo_cb()
- *                  for type:expert see sharkd_session_process_tap_expert_cb()
- *                  for type:rtd see sharkd_session_process_tap_rtd_cb()
- *                  for type:srt see sharkd_session_process_tap_srt_cb()
- *                  for type:flow see sharkd_session_process_tap_flow_cb()
+/*
+ * Register the tap listeners for the tap0...tap15 parameters of a request.
  *
- *   (m) err   - error code
+ * The registered taps are stored in taps_data and taps_free, which must have
+ * room for 16 entries, and counted in taps_count, also when registering one
+ * of them fails. Returns false after reporting an error.
  */
-static void
-sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
+static bool
+sharkd_session_register_taps(char *buf, const jsmntok_t *tokens, int count, const char *tap_filter,
+        rtpstream_tapinfo_t *rtp_tapinfo, void **taps_data, GFreeFunc *taps_free, int *taps_count)
 {
-    void *taps_data[16];
-    GFreeFunc taps_free[16];
-    int taps_count = 0;
     int i;
-    const char *tap_filter = json_find_attr(buf, tokens, count, "filter");
 
-    rtpstream_tapinfo_t rtp_tapinfo =
-    { NULL, NULL, NULL, NULL, 0, NULL, NULL, 0, TAP_ANALYSE, NULL, NULL, NULL, false, false};
+    *taps_count = 0;
 
     for (i = 0; i < 16; i++)
     {
@@ -3472,7 +3821,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         rpcid, -11001, NULL,
                         "sharkd_session_process_tap() stat %s not found", tok_tap + 5
                         );
-                return;
+                return false;
             }
 
             st = stats_tree_new(cfg, NULL, tap_filter);
@@ -3512,7 +3861,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         rpcid, -11002, NULL,
                         "sharkd_session_process_tap() seq analysis %s not found", tok_tap + 5
                         );
-                return;
+                return false;
             }
 
             graph_analysis = sequence_analysis_info_new();
@@ -3546,7 +3895,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                             rpcid, -11003, NULL,
                             "sharkd_session_process_tap() conv %s not found", tok_tap + 5
                             );
-                    return;
+                    return false;
                 }
             }
             else if (!strncmp(tok_tap, "endpt:", 6))
@@ -3559,7 +3908,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                             rpcid, -11004, NULL,
                             "sharkd_session_process_tap() endpt %s not found", tok_tap + 6
                             );
-                    return;
+                    return false;
                 }
             }
             else
@@ -3568,7 +3917,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         rpcid, -11005, NULL,
                         "sharkd_session_process_tap() conv/endpt(?): %s not found", tok_tap
                         );
-                return;
+                return false;
             }
 
             ct_tapname = proto_get_protocol_filter_name(get_conversation_proto_id(ct));
@@ -3597,7 +3946,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         rpcid, -11006, NULL,
                         "sharkd_session_process_tap() nstat=%s not found", tok_tap + 6
                         );
-                return;
+                return false;
             }
 
             stat_tap->stat_tap_init_cb(stat_tap);
@@ -3623,7 +3972,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         rpcid, -11007, NULL,
                         "sharkd_session_process_tap() rtd=%s not found", tok_tap + 4
                         );
-                return;
+                return false;
             }
 
             rtd_table_get_filter(rtd, "", &tap_filter, &err);
@@ -3634,7 +3983,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         "sharkd_session_process_tap() rtd=%s err=%s", tok_tap + 4, err
                         );
                 g_free(err);
-                return;
+                return false;
             }
 
             rtd_data = g_new0(rtd_data_t, 1);
@@ -3658,7 +4007,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         rpcid, -11009, NULL,
                         "sharkd_session_process_tap() srt=%s not found", tok_tap + 4
                         );
-                return;
+                return false;
             }
 
             srt_table_get_filter(srt, "", &tap_filter, &err);
@@ -3669,7 +4018,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         "sharkd_session_process_tap() srt=%s err=%s", tok_tap + 4, err
                         );
                 g_free(err);
-                return;
+                return false;
             }
 
             srt_data = g_new0(srt_data_t, 1);
@@ -3692,7 +4041,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                         rpcid, -11011, NULL,
                         "sharkd_session_process_tap() eo=%s not found", tok_tap + 3
                         );
-                return;
+                return false;
             }
 
             tap_error = sharkd_session_eo_register_tap_listener(eo, tok_tap, tap_filter, sharkd_session_process_tap_eo_cb, &tap_data, &tap_free);
@@ -3701,9 +4050,9 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
         }
         else if (!strcmp(tok_tap, "rtp-streams"))
         {
-            tap_error = register_tap_listener("rtp", &rtp_tapinfo, tap_filter, 0, rtpstream_reset_cb, rtpstream_packet_cb, sharkd_session_process_tap_rtp_cb, NULL);
+            tap_error = register_tap_listener("rtp", rtp_tapinfo, tap_filter, 0, rtpstream_reset_cb, rtpstream_packet_cb, sharkd_session_process_tap_rtp_cb, NULL);
 
-            tap_data = &rtp_tapinfo;
+            tap_data = rtp_tapinfo;
             tap_free = rtpstream_reset_cb;
         }
         else if (!strncmp(tok_tap, "rtp-analyse:", 12))
@@ -3791,14 +4140,14 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                                 rpcid, -11014, NULL,
                                 "sharkd_session_process_tap() voip-convs=%s invalid 'convs' parameter", tok_tap
                         );
-                        return;
+                        return false;
                     }
                     if (min > max || min >= VOIP_CONV_MAX || max >= VOIP_CONV_MAX) {
                         sharkd_json_error(
                                 rpcid, -11012, NULL,
                                 "sharkd_session_process_tap() voip-convs=%s invalid 'convs' number range", tok_tap
                         );
-                        return;
+                        return false;
                     }
                     for(; min <= max; min++) {
                         voip_conv_sel[min / VOIP_CONV_BITS] |= 1 << (min % VOIP_CONV_BITS);
@@ -3852,7 +4201,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                                 rpcid, -11015, NULL,
                                 "sharkd_session_process_tap() hosts=%s invalid 'protos' parameter", tok_tap
                         );
-                        return;
+                        return false;
                     }
                     proto_count++;
                 }
@@ -3875,7 +4224,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                     rpcid, -11012, NULL,
                     "sharkd_session_process_tap() %s not recognized", tok_tap
                     );
-            return;
+            return false;
         }
 
         if (tap_error)
@@ -3887,12 +4236,73 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             g_string_free(tap_error, TRUE);
             if (tap_free)
                 tap_free(tap_data);
-            return;
+            return false;
         }
 
-        taps_data[taps_count] = tap_data;
-        taps_free[taps_count] = tap_free;
-        taps_count++;
+        taps_data[*taps_count] = tap_data;
+        taps_free[*taps_count] = tap_free;
+        (*taps_count)++;
+    }
+
+    return true;
+}
+
+static void
+sharkd_session_remove_taps(void **taps_data, GFreeFunc *taps_free, int taps_count)
+{
+    for (int i = 0; i < taps_count; i++)
+    {
+        if (taps_data[i])
+            remove_tap_listener(taps_data[i]);
+
+        if (taps_free[i])
+            taps_free[i](taps_data[i]);
+    }
+}
+
+/**
+ * sharkd_session_process_tap()
+ *
+ * Process tap request
+ *
+ * Input:
+ *   (m) tap0         - First tap request
+ *   (o) tap1...tap15 - Other tap requests
+ *
+ * Output object with attributes:
+ *   (m) taps  - array of object with attributes:
+ *                  (m) tap  - tap name
+ *                  (m) type - tap output type
+ *                  ...
+ *                  for type:stats see sharkd_session_process_tap_stats_cb()
+ *                  for type:nstat see sharkd_session_process_tap_nstat_cb()
+ *                  for type:conv see sharkd_session_process_tap_conv_cb()
+ *                  for type:host see sharkd_session_process_tap_conv_cb()
+ *                  for type:rtp-streams see sharkd_session_process_tap_rtp_cb()
+ *                  for type:rtp-analyse see sharkd_session_process_tap_rtp_analyse_cb()
+ *                  for type:eo see sharkd_session_process_tap_eo_cb()
+ *                  for type:expert see sharkd_session_process_tap_expert_cb()
+ *                  for type:rtd see sharkd_session_process_tap_rtd_cb()
+ *                  for type:srt see sharkd_session_process_tap_srt_cb()
+ *                  for type:flow see sharkd_session_process_tap_flow_cb()
+ *
+ *   (m) err   - error code
+ */
+static void
+sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
+{
+    void *taps_data[16];
+    GFreeFunc taps_free[16];
+    int taps_count = 0;
+    const char *tap_filter = json_find_attr(buf, tokens, count, "filter");
+
+    rtpstream_tapinfo_t rtp_tapinfo =
+    { NULL, NULL, NULL, NULL, 0, NULL, NULL, 0, TAP_ANALYSE, NULL, NULL, NULL, false, false};
+
+    if (!sharkd_session_register_taps(buf, tokens, count, tap_filter, &rtp_tapinfo, taps_data, taps_free, &taps_count))
+    {
+        sharkd_session_remove_taps(taps_data, taps_free, taps_count);
+        return;
     }
 
     fprintf(stderr, "sharkd_session_process_tap() count=%d\n", taps_count);
@@ -3911,14 +4321,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
     sharkd_json_array_close();
     sharkd_json_result_epilogue();
 
-    for (i = 0; i < taps_count; i++)
-    {
-        if (taps_data[i])
-            remove_tap_listener(taps_data[i]);
-
-        if (taps_free[i])
-            taps_free[i](taps_data[i]);
-    }
+    sharkd_session_remove_taps(taps_data, taps_free, taps_count);
 }
 
 /**
@@ -3931,6 +4334,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
  *   (m) filter     - filter request (e.g. tcp.stream == 1)
  *   (m) stream     - stream index number
  *   (o) sub_stream - follow sub-stream index number (e.g. for HTTP/2 and QUIC streams)
+ *   (o) skip=N     - skip N payloads
+ *   (o) limit=N    - show only N payloads
  *
  * Output object with attributes:
  *
@@ -3941,6 +4346,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
  *   (m) chost  - client host
  *   (m) cport  - client port
  *   (m) cbytes - client send bytes count
+ *   (o) npayloads - total number of payloads, also when not all are shown
  *   (o) payloads - array of object with attributes:
  *                  (o) s - set if server sent, else client
  *                  (m) n - packet number
@@ -3952,6 +4358,8 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
     const char *tok_follow = json_find_attr(buf, tokens, count, "follow");
     const char *tok_filter = json_find_attr(buf, tokens, count, "filter");
     const char *tok_sub_stream = json_find_attr(buf, tokens, count, "sub_stream");
+    const char *tok_skip = json_find_attr(buf, tokens, count, "skip");
+    const char *tok_limit = json_find_attr(buf, tokens, count, "limit");
 
     register_follow_t *follower;
     GString *tap_error;
@@ -3959,6 +4367,8 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
     follow_info_t *follow_info;
     const char *host;
     char *port;
+    uint32_t skip = 0;
+    uint32_t limit = 0;
 
     follower = get_follow_by_name(tok_follow);
     if (!follower)
@@ -3976,6 +4386,18 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
         ws_strtou64(tok_sub_stream, NULL, &substream_id);
     }
 
+    if (tok_skip)
+    {
+        if (!ws_strtou32(tok_skip, NULL, &skip))
+            return;
+    }
+
+    if (tok_limit)
+    {
+        if (!ws_strtou32(tok_limit, NULL, &limit))
+            return;
+    }
+
     /* follow_reset_stream ? */
     follow_info = g_new0(follow_info_t, 1);
     follow_info->substream_id = substream_id;
@@ -4019,18 +4441,28 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
 
     if (follow_info->payload)
     {
-        follow_record_t *follow_record;
-        GList *cur;
+        const follow_store_record_t *follow_record;
+        const uint8_t *data;
+        unsigned npayloads = follow_store_count(follow_info->payload);
+
+        if (tok_skip || tok_limit)
+            sharkd_json_value_anyf("npayloads", "%u", npayloads);
 
         sharkd_json_array_open("payloads");
-        for (cur = g_list_last(follow_info->payload); cur; cur = g_list_previous(cur))
+        for (unsigned i = skip; i < npayloads; i++)
         {
-            follow_record = (follow_record_t *) cur->data;
+            if (limit && i - skip >= limit)
+                break;
+
+            follow_record = follow_store_get_record(follow_info->payload, i);
+            data = follow_store_get_data(follow_info->payload, i);
+            if (!data)
+                break;
 
             json_dumper_begin_object(&dumper);
 
             sharkd_json_value_anyf("n", "%u", follow_record->packet_num);
-            sharkd_json_value_base64("d", follow_record->data->data, follow_record->data->len);
+            sharkd_json_value_base64("d", data, follow_record->len);
 
             if (follow_record->is_server)
                 sharkd_json_value_anyf("s", "%d", 1);
@@ -4769,6 +5201,291 @@ sharkd_session_process_intervals(char *buf, const jsmntok_t *tokens, int count)
     sharkd_json_result_epilogue();
 }
 
+struct sharkd_batch_interval
+{
+    int64_t idx;
+    unsigned int frames;
+    uint64_t bytes;
+};
+
+struct sharkd_batch_req
+{
+    /* frames */
+    bool frames;
+    column_info *cinfo;
+    const char *columns_signature;
+    const char *tok_refs;
+    uint32_t current_ref_frame;
+    uint32_t next_ref_frame;
+    uint32_t skip;
+    uint32_t limit;
+    bool page_done;
+    uint32_t page_frame;  /* frame to list if it passes the filter, 0 if none */
+    struct sharkd_column_cache_key cache_key;
+    const struct sharkd_column_cache_entry *cache_entry;
+
+    /* intervals */
+    bool intervals;
+    uint32_t interval_ms;
+    nstime_t start_ts;
+    GArray *interval_list; /* struct sharkd_batch_interval */
+    struct sharkd_batch_interval st;
+    int64_t max_idx;
+    unsigned int total_frames;
+    uint64_t total_bytes;
+};
+
+static column_info *
+sharkd_session_batch_columns_cb(frame_data *fdata, uint32_t prev_dis_num, uint32_t *frame_ref_num, void *data)
+{
+    struct sharkd_batch_req *req = (struct sharkd_batch_req *) data;
+
+    req->page_frame = 0;
+
+    if (req->page_done || req->skip)
+        return NULL;
+
+    if (req->tok_refs)
+    {
+        sharkd_session_frames_refs(&req->tok_refs, fdata->num, &req->current_ref_frame, &req->next_ref_frame);
+
+        if (req->current_ref_frame)
+            *frame_ref_num = req->current_ref_frame;
+    }
+
+    req->page_frame = fdata->num;
+
+    req->cache_key.framenum = fdata->num;
+    req->cache_key.ref_frame = *frame_ref_num;
+    req->cache_key.prev_dis_num = prev_dis_num;
+    req->cache_key.columns = req->columns_signature;
+
+    /* The frame is dissected for the taps anyway, but the columns are known. */
+    req->cache_entry = sharkd_column_cache_lookup(&req->cache_key);
+    if (req->cache_entry)
+        return NULL;
+
+    return req->cinfo;
+}
+
+static void
+sharkd_session_batch_frame_cb(epan_dissect_t *edt, column_info *cinfo, void *data)
+{
+    struct sharkd_batch_req *req = (struct sharkd_batch_req *) data;
+    frame_data *fdata = edt->pi.fd;
+
+    if (req->intervals)
+    {
+        int64_t msec_rel;
+        int64_t new_idx;
+
+        msec_rel = (fdata->abs_ts.secs - req->start_ts.secs) * (int64_t) 1000 + (fdata->abs_ts.nsecs - req->start_ts.nsecs) / 1000000;
+        new_idx  = msec_rel / req->interval_ms;
+
+        if (req->st.idx != new_idx)
+        {
+            if (req->st.frames != 0)
+                g_array_append_val(req->interval_list, req->st);
+
+            req->st.idx = new_idx;
+            if (new_idx > req->max_idx)
+                req->max_idx = new_idx;
+
+            req->st.frames = 0;
+            req->st.bytes  = 0;
+        }
+
+        req->st.frames += 1;
+        req->st.bytes  += fdata->pkt_len;
+
+        req->total_frames += 1;
+        req->total_bytes  += fdata->pkt_len;
+    }
+
+    if (!req->frames || req->page_done)
+        return;
+
+    if (req->skip)
+    {
+        req->skip--;
+        return;
+    }
+
+    if (fdata->num != req->page_frame)
+        return;
+
+    if (req->cache_entry)
+        sharkd_session_process_frames_cached(fdata, req->cache_entry);
+    else if (cinfo)
+        sharkd_session_process_frames_cb(edt, NULL, cinfo, NULL, &req->cache_key);
+
+    if (req->limit && --req->limit == 0)
+        req->page_done = true;
+}
+
+/**
+ * sharkd_session_process_batch()
+ *
+ * Process batch request - answer frames, tap and intervals requests with a single pass over the frames.
+ *
+ * Input:
+ *   (o) filter - filter to be used for the frames, taps and intervals
+ *   (o) frames - list frames, like the frames request, using:
+ *   (o)   column0...columnXX, skip, limit, refs - see sharkd_session_process_frames()
+ *   (o) tap0...tap15 - tap requests, see sharkd_session_process_tap()
+ *   (o) interval - generate intervals with interval time in ms, see sharkd_session_process_intervals()
+ *
+ * Output object with attributes, for the parts which were requested:
+ *   (o) frames    - array of frames, as the result of a frames request
+ *   (o) taps      - array of taps, as in the result of a tap request
+ *   (o) intervals - object with intervals, last, frames and bytes, as the result of an intervals request
+ */
+static void
+sharkd_session_process_batch(char *buf, const jsmntok_t *tokens, int count)
+{
+    const char *tok_filter   = json_find_attr(buf, tokens, count, "filter");
+    const char *tok_frames   = json_find_attr(buf, tokens, count, "frames");
+    const char *tok_column   = json_find_attr(buf, tokens, count, "column0");
+    const char *tok_skip     = json_find_attr(buf, tokens, count, "skip");
+    const char *tok_limit    = json_find_attr(buf, tokens, count, "limit");
+    const char *tok_interval = json_find_attr(buf, tokens, count, "interval");
+
+    struct sharkd_batch_req req;
+    column_info user_cinfo;
+
+    struct sharkd_filter_item *filter_item = NULL;
+    dfilter_t *dfcode = NULL;
+    uint8_t *filtered = NULL;
+
+    void *taps_data[16];
+    GFreeFunc taps_free[16];
+    int taps_count = 0;
+
+    rtpstream_tapinfo_t rtp_tapinfo =
+    { NULL, NULL, NULL, NULL, 0, NULL, NULL, 0, TAP_ANALYSE, NULL, NULL, NULL, false, false};
+
+    memset(&req, 0, sizeof(req));
+    req.frames = (tok_frames != NULL && !strcmp(tok_frames, "true"));
+    req.intervals = (tok_interval != NULL);
+    req.cinfo = &cfile.cinfo;
+    req.next_ref_frame = UINT32_MAX;
+    req.interval_ms = 1000;
+
+    if (req.frames)
+    {
+        if (tok_column)
+        {
+            req.columns_signature = sharkd_session_columns_signature(buf, tokens, count);
+            memset(&user_cinfo, 0, sizeof(user_cinfo));
+            req.cinfo = sharkd_session_create_columns(&user_cinfo, buf, tokens, count);
+            if (!req.cinfo)
+            {
+                sharkd_json_error(
+                        rpcid, -14001, NULL,
+                        "Column definition invalid - note column 6 requires a custom definition"
+                        );
+                return;
+            }
+        }
+
+        if (tok_skip)
+            ws_strtou32(tok_skip, NULL, &req.skip);  // already validated
+
+        if (tok_limit)
+            ws_strtou32(tok_limit, NULL, &req.limit);  // already validated
+
+        req.tok_refs = json_find_attr(buf, tokens, count, "refs");
+        if (req.tok_refs && !ws_strtou32(req.tok_refs, &req.tok_refs, &req.next_ref_frame))
+            req.tok_refs = NULL;
+    }
+
+    if (req.intervals)
+    {
+        ws_strtou32(tok_interval, NULL, &req.interval_ms);  // already validated
+
+        if (cfile.count >= 1)
+            req.start_ts = sharkd_get_frame(1)->abs_ts;
+        req.interval_list = g_array_new(false, false, sizeof(struct sharkd_batch_interval));
+    }
+
+    /* A filter which was used before doesn't need to be applied again. */
+    if (tok_filter)
+    {
+        filter_item = (struct sharkd_filter_item *) g_hash_table_lookup(filter_table, tok_filter);
+        if (!filter_item && !dfilter_compile(tok_filter, &dfcode, NULL))
+        {
+            sharkd_json_error(
+                    rpcid, -14002, NULL,
+                    "Filter expression invalid"
+                    );
+            goto out;
+        }
+    }
+
+    if (!sharkd_session_register_taps(buf, tokens, count, tok_filter, &rtp_tapinfo, taps_data, taps_free, &taps_count))
+        goto out;
+
+    sharkd_json_result_prologue(rpcid);
+
+    if (req.frames)
+        sharkd_json_array_open("frames");
+
+    sharkd_retap_frames(dfcode, filter_item ? filter_item->filtered : NULL, &filtered,
+            req.frames ? sharkd_session_batch_columns_cb : NULL, sharkd_session_batch_frame_cb, &req);
+
+    if (req.frames)
+        sharkd_json_array_close();
+
+    if (tok_filter && !filter_item)
+    {
+        filter_item = g_new(struct sharkd_filter_item, 1);
+        filter_item->filtered = filtered;
+
+        g_hash_table_insert(filter_table, g_strdup(tok_filter), filter_item);
+    }
+
+    if (taps_count > 0)
+    {
+        sharkd_json_array_open("taps");
+        draw_tap_listeners(true);
+        sharkd_json_array_close();
+    }
+
+    if (req.intervals)
+    {
+        if (req.st.frames != 0)
+            g_array_append_val(req.interval_list, req.st);
+
+        sharkd_json_object_open("intervals");
+        sharkd_json_array_open("intervals");
+        for (unsigned i = 0; i < req.interval_list->len; i++)
+        {
+            const struct sharkd_batch_interval *st = &g_array_index(req.interval_list, struct sharkd_batch_interval, i);
+
+            sharkd_json_value_anyf(NULL, "[%" PRId64 ",%u,%" PRIu64 "]", st->idx, st->frames, st->bytes);
+        }
+        sharkd_json_array_close();
+
+        sharkd_json_value_anyf("last", "%" PRId64, req.max_idx);
+        sharkd_json_value_anyf("frames", "%u", req.total_frames);
+        sharkd_json_value_anyf("bytes", "%" PRIu64, req.total_bytes);
+        sharkd_json_object_close();
+    }
+
+    sharkd_json_result_epilogue();
+
+out:
+    sharkd_session_remove_taps(taps_data, taps_free, taps_count);
+
+    dfilter_free(dfcode);
+
+    if (req.interval_list)
+        g_array_free(req.interval_list, true);
+
+    if (req.cinfo && req.cinfo != &cfile.cinfo)
+        col_cleanup(req.cinfo);
+}
+
 /**
  * sharkd_session_process_frame()
  *
@@ -5207,6 +5924,8 @@ sharkd_session_process_setcomment(char *buf, const jsmntok_t *tokens, int count)
     else
     {
         sharkd_set_modified_block(fdata, pkt_block);
+        /* the comment might be shown in a custom column */
+        sharkd_column_cache_clear();
         sharkd_json_simple_ok(rpcid);
     }
 }
@@ -5258,6 +5977,7 @@ sharkd_session_process_setconf(char *buf, const jsmntok_t *tokens, int count)
     switch (ret)
     {
         case PREFS_SET_OK:
+            sharkd_column_cache_clear();
             sharkd_json_simple_ok(rpcid);
             break;
 
@@ -5919,6 +6639,8 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
             sharkd_session_process_load(buf, tokens, count);
         else if (!strcmp(tok_method, "status"))
             sharkd_session_process_status();
+        else if (!strcmp(tok_method, "profile"))
+            sharkd_session_process_profile(buf, tokens, count);
         else if (!strcmp(tok_method, "analyse"))
             sharkd_session_process_analyse();
         else if (!strcmp(tok_method, "info"))
@@ -5937,6 +6659,8 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
             sharkd_session_process_iograph(buf, tokens, count);
         else if (!strcmp(tok_method, "intervals"))
             sharkd_session_process_intervals(buf, tokens, count);
+        else if (!strcmp(tok_method, "batch"))
+            sharkd_session_process_batch(buf, tokens, count);
         else if (!strcmp(tok_method, "frame"))
             sharkd_session_process_frame(buf, tokens, count);
         else if (!strcmp(tok_method, "setcomment"))
@@ -5976,6 +6700,7 @@ sharkd_session_main(int mode_setting)
     dumper.output_file = stdout;
 
     filter_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, sharkd_session_filter_free);
+    column_cache = g_hash_table_new_full(sharkd_column_cache_hash, sharkd_column_cache_equal, NULL, sharkd_column_cache_entry_free);
 
 #ifdef HAVE_MAXMINDDB
     /* mmdbresolve was stopped before fork(), force starting it */
@@ -6026,6 +6751,8 @@ sharkd_session_main(int mode_setting)
     }
 
     g_hash_table_destroy(filter_table);
+    sharkd_column_cache_clear();
+    g_hash_table_destroy(column_cache);
     g_free(tokens);
 
     return 0;
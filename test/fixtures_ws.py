@@ -183,6 +183,7 @@ def features(cmd_tshark, make_env):
         have_pkcs11='and PKCS #11 support' in tshark_v,
         have_brotli='with brotli' in tshark_v,
         have_zstd='with Zstandard' in tshark_v,
+        have_lz4='with LZ4' in tshark_v,
         have_plugins='binary plugins supported' in tshark_v,
     )
 
@@ -197,6 +198,7 @@ def dirs():
         config_dir=os.path.join(this_dir, 'config'),
         key_dir=os.path.join(this_dir, 'keys'),
         lua_dir=os.path.join(this_dir, 'lua'),
+        mmdb_dir=os.path.join(this_dir, 'mmdb'),
         protobuf_lang_files_dir=os.path.join(this_dir, 'protobuf_lang_files'),
         tools_dir=os.path.join(this_dir, '..', 'tools'),
         dfilter_dir=os.path.join(this_dir, 'suite_dfilter'),
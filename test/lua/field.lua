@@ -9,8 +9,8 @@ local OTHER = "other"
 local n_frames = 1
 testlib.init({
     [FRAME] = n_frames,
-    [PER_FRAME] = n_frames*43,
-    [OTHER] = 16,
+    [PER_FRAME] = n_frames*48,
+    [OTHER] = 17,
 })
 
 ------------- helper funcs ------------
@@ -62,6 +62,7 @@ local f_udp_srcport = Field.new("udp.srcport")
 local f_udp_dstport = Field.new("udp.dstport")
 local f_dhcp_hw    = Field.new("dhcp.hw.mac_addr")
 local f_dhcp_opt   = Field.new("dhcp.option.type")
+local f_tcp_port   = Field.new("tcp.port")
 
 testlib.test(OTHER,"Field__tostring-1", tostring(f_frame_proto) == "frame.protocols")
 
@@ -79,6 +80,7 @@ testlib.test(OTHER,"Field.type-5", f_dhcp_opt.type == ftypes.UINT8)
 
 -- make sure can't create a FieldInfo outside tap
 testlib.test(OTHER,"Field__call-1",not pcall(makeFieldInfo,f_eth_src))
+testlib.test(OTHER,"Field.values-1",not pcall(Field.values,f_eth_src))
 
 local tap = Listener.new()
 
@@ -157,6 +159,17 @@ function tap.packet(pinfo,tvb)
     testlib.test(PER_FRAME,"FieldInfo.len-1", fi_eth_src.len == 6)
     testlib.test(PER_FRAME,"FieldInfo.len-2",not pcall(setFieldInfo,fi_eth_src,"len",6))
 
+    testlib.testing(FRAME,"Field.values")
+
+    local ip_src, eth_addrs, tcp_ports = Field.values(f_ip_src, f_eth_mac, f_tcp_port)
+    testlib.test(PER_FRAME,"Field.values-2", #ip_src == 1 and ip_src[1] == f_ip_src())
+    testlib.test(PER_FRAME,"Field.values-3", #eth_addrs == 2 and eth_addrs[2] == select(2, f_eth_mac()))
+    testlib.test(PER_FRAME,"Field.values-4", #tcp_ports == 0)
+    testlib.test(PER_FRAME,"Field.values-5",not pcall(Field.values,f_ip_src,"ip.dst"))
+
+    -- the values of a packet are only looked up and wrapped once
+    testlib.test(PER_FRAME,"Field__call-3", rawequal(f_udp_srcport(), finfo_udp_srcport))
+
     testlib.pass(FRAME)
 end
 
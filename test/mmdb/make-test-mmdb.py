@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Writes the MaxMind DB files used by mmdb_reader_test.
+
+The files follow https://maxmind.github.io/MaxMind-DB/ and are small enough
+to check by hand. Each one has two records, one with 1 and 4-byte data
+pointers and one with 2-byte pointers, which needs a data section of over
+2048 bytes:
+
+  1.2.3.0/24       SE, Stockholm
+  2001:db8::/32    DE (IPv6 databases only)
+
+Run it from this directory.
+'''
+
+import ipaddress
+import struct
+
+TYPE_POINTER = 1
+TYPE_STRING = 2
+TYPE_DOUBLE = 3
+TYPE_UINT16 = 5
+TYPE_UINT32 = 6
+TYPE_MAP = 7
+TYPE_INT32 = 8
+TYPE_UINT64 = 9
+TYPE_ARRAY = 11
+TYPE_BOOLEAN = 14
+TYPE_FLOAT = 15
+
+
+def ctrl(type_, size):
+    if size < 29:
+        size_bits, size_bytes = size, b''
+    elif size < 285:
+        size_bits, size_bytes = 29, bytes([size - 29])
+    elif size < 65821:
+        size_bits, size_bytes = 30, struct.pack('>H', size - 285)
+    else:
+        size_bits, size_bytes = 31, struct.pack('>I', size - 65821)[1:]
+    if type_ <= TYPE_MAP:
+        return bytes([type_ << 5 | size_bits]) + size_bytes
+    return bytes([size_bits, type_ - 7]) + size_bytes
+
+
+def string(s):
+    data = s.encode('utf-8')
+    return ctrl(TYPE_STRING, len(data)) + data
+
+
+def uint(type_, value):
+    data = value.to_bytes((value.bit_length() + 7) // 8, 'big')
+    return ctrl(type_, len(data)) + data
+
+
+def int32(value):
+    return ctrl(TYPE_INT32, 4) + struct.pack('>i', value)
+
+
+def double(value):
+    return ctrl(TYPE_DOUBLE, 8) + struct.pack('>d', value)
+
+
+def float32(value):
+    return ctrl(TYPE_FLOAT, 4) + struct.pack('>f', value)
+
+
+def boolean(value):
+    return ctrl(TYPE_BOOLEAN, int(value))
+
+
+def pointer(offset, size):
+    if size == 1:
+        assert offset < 2048
+        return bytes([TYPE_POINTER << 5 | (offset >> 8)]) + bytes([offset & 0xff])
+    if size == 2:
+        value = offset - 2048
+        assert 0 <= value < 1 << 19
+        return bytes([TYPE_POINTER << 5 | 1 << 3 | (value >> 16)]) + struct.pack('>H', value & 0xffff)
+    assert size == 4
+    return bytes([TYPE_POINTER << 5 | 3 << 3]) + struct.pack('>I', offset)
+
+
+def map_(pairs):
+    out = ctrl(TYPE_MAP, len(pairs))
+    for key, value in pairs:
+        out += string(key) + value
+    return out
+
+
+def array(values):
+    return ctrl(TYPE_ARRAY, len(values)) + b''.join(values)
+
+
+def se_record(sweden_offset, org_offset):
+    return map_([
+        ('country', map_([
+            ('iso_code', string('SE')),
+            ('names', map_([('en', pointer(sweden_offset, 1))])),
+        ])),
+        ('city', map_([('names', map_([('en', string('Stockholm'))]))])),
+        ('location', map_([
+            ('latitude', double(59.3293)),
+            ('longitude', double(18.0686)),
+            ('accuracy_radius', uint(TYPE_UINT16, 50)),
+        ])),
+        ('autonomous_system_number', uint(TYPE_UINT32, 64512)),
+        ('autonomous_system_organization', pointer(org_offset, 4)),
+        ('test', map_([
+            ('int', int32(-5)),
+            ('flag', boolean(True)),
+            ('big', uint(TYPE_UINT64, 1 << 40)),
+            ('list', array([string('a'), string('b')])),
+        ])),
+    ])
+
+
+def de_record(org_offset):
+    return map_([
+        ('country', map_([
+            ('iso_code', string('DE')),
+            ('names', map_([('en', string('Germany'))])),
+        ])),
+        ('location', map_([
+            ('latitude', float32(52.5)),
+            ('longitude', float32(13.25)),
+        ])),
+        ('autonomous_system_number', uint(TYPE_UINT32, 64513)),
+        ('autonomous_system_organization', pointer(org_offset, 2)),
+    ])
+
+
+def data_section():
+    '''Returns the data section and the offsets of the SE and DE records.'''
+    sweden_offset = 0
+    data = string('Sweden')
+    # Push what follows past 2048 so that the DE record needs a 2-byte
+    # pointer to reach the organization string.
+    data += string('x' * 2100)
+    se_offset = len(data)
+    # A 4-byte pointer is the same length whatever it points to.
+    org_offset = se_offset + len(se_record(sweden_offset, 0))
+    data += se_record(sweden_offset, org_offset)
+    data += string('Example AS')
+    de_offset = len(data)
+    data += de_record(org_offset)
+    return data, se_offset, de_offset
+
+
+def prefix_bits(network, ip_version):
+    net = ipaddress.ip_network(network)
+    if ip_version == 6 and net.version == 4:
+        net = ipaddress.ip_network('::%s/%d' % (net.network_address, 96 + net.prefixlen))
+    bits = bin(int(net.network_address))[2:].zfill(net.max_prefixlen)
+    return bits[:net.prefixlen]
+
+
+def search_tree(prefixes, ip_version):
+    '''Returns the node list; children are node numbers, ('data', offset) or None.'''
+    nodes = [[None, None]]
+    for network, offset in prefixes:
+        node = 0
+        bits = prefix_bits(network, ip_version)
+        for i, bit in enumerate(bits):
+            bit = int(bit)
+            if i == len(bits) - 1:
+                nodes[node][bit] = ('data', offset)
+            else:
+                if nodes[node][bit] is None:
+                    nodes.append([None, None])
+                    nodes[node][bit] = len(nodes) - 1
+                node = nodes[node][bit]
+    return nodes
+
+
+def record_value(child, node_count):
+    if child is None:
+        return node_count
+    if isinstance(child, tuple):
+        return node_count + 16 + child[1]
+    return child
+
+
+def encode_node(left, right, record_size):
+    if record_size == 24:
+        return left.to_bytes(3, 'big') + right.to_bytes(3, 'big')
+    if record_size == 28:
+        middle = (left >> 24) << 4 | (right >> 24)
+        return (left & 0xffffff).to_bytes(3, 'big') + bytes([middle]) + (right & 0xffffff).to_bytes(3, 'big')
+    return left.to_bytes(4, 'big') + right.to_bytes(4, 'big')
+
+
+def write_db(path, record_size, ip_version):
+    data, se_offset, de_offset = data_section()
+    prefixes = [('1.2.3.0/24', se_offset)]
+    if ip_version == 6:
+        prefixes.append(('2001:db8::/32', de_offset))
+    nodes = search_tree(prefixes, ip_version)
+    node_count = len(nodes)
+
+    tree = b''.join(encode_node(record_value(l, node_count), record_value(r, node_count), record_size)
+                    for l, r in nodes)
+    metadata = map_([
+        ('node_count', uint(TYPE_UINT32, node_count)),
+        ('record_size', uint(TYPE_UINT16, record_size)),
+        ('ip_version', uint(TYPE_UINT16, ip_version)),
+        ('database_type', string('Wireshark-Test')),
+        ('languages', array([string('en')])),
+        ('binary_format_major_version', uint(TYPE_UINT16, 2)),
+        ('binary_format_minor_version', uint(TYPE_UINT16, 0)),
+        ('build_epoch', uint(TYPE_UINT64, 1700000000)),
+        ('description', map_([('en', string('Wireshark test database'))])),
+    ])
+    with open(path, 'wb') as f:
+        f.write(tree + bytes(16) + data + b'\xab\xcd\xefMaxMind.com' + metadata)
+
+
+if __name__ == '__main__':
+    write_db('test-ipv6-24.mmdb', 24, 6)
+    write_db('test-ipv6-28.mmdb', 28, 6)
+    write_db('test-ipv4-32.mmdb', 32, 4)
@@ -11,6 +11,7 @@
 import glob
 import hashlib
 import os
+import re
 import socket
 import subprocess
 import subprocesstest
@@ -552,6 +553,115 @@ class TestDumpcapCapture:
         check_capture_snapshot_len(self, cmd=cmd_dumpcap, env=base_env)
 
 
+class TestDumpcapThreads:
+    def test_dumpcap_threads_multiple_pipes(self, cmd_dumpcap, cmd_tshark, cmd_capinfos, capture_file, result_file, base_env):
+        '''Capture from several pipes with a queue and writer thread per interface'''
+        if sys.platform == 'win32':
+            pytest.skip('Test requires OS fifo support.')
+        if sysconfig.get_platform().startswith('mingw'):
+            pytest.skip('FIXME Pipes are broken with the MSYS2 shell')
+        n_pipes = 3
+        testout_file = result_file(testout_pcapng)
+        fifo_files = []
+        fifo_procs = []
+        for n in range(n_pipes):
+            fifo_file = result_file('dumpcap_threads_{}.fifo'.format(n))
+            try:
+                os.unlink(fifo_file)
+            except Exception: pass
+            os.mkfifo(fifo_file)
+            fifo_files.append(fifo_file)
+            fifo_procs.append(subprocess.Popen(('{0} > {1}'.format(cat_dhcp_command('cat100'), fifo_file)), shell=True))
+
+        capture_cmd_args = ['-t', '-w', testout_file, '-a', 'duration:{}'.format(capture_duration * 2)]
+        for fifo_file in fifo_files:
+            capture_cmd_args += ['-i', fifo_file]
+        subprocesstest.check_run(capture_command(cmd_dumpcap, *capture_cmd_args), env=base_env)
+        for fifo_proc in fifo_procs: fifo_proc.kill()
+
+        # cat100 writes the 4 packets of dhcp.pcap 25 times.
+        check_packet_count(cmd_capinfos, 100 * n_pipes, testout_file)
+
+        def message_types(cap_file, *args):
+            tshark_proc = subprocesstest.check_run((cmd_tshark, '-r', cap_file,
+                '-T', 'fields', '-e', 'frame.interface_id', '-e', 'dhcp.option.dhcp') + args,
+                capture_output=True, env=base_env)
+            return [line.split('\t') for line in tshark_proc.stdout.splitlines()]
+
+        dhcp_types = [msg_type for _, msg_type in message_types(capture_file('dhcp.pcap'))]
+        per_interface = {}
+        for interface_id, msg_type in message_types(testout_file):
+            per_interface.setdefault(interface_id, []).append(msg_type)
+        # Interleaving between interfaces depends on timing, but each
+        # interface's packets must be written in the order they arrived.
+        assert len(per_interface) == n_pipes
+        for msg_types in per_interface.values():
+            assert msg_types == dhcp_types * 25
+
+
+def parse_packet_drops(stderr):
+    '''Return received, dumpcap dropped and flushed counts from dumpcap's drop report'''
+    m = re.search(r"^Packets received/dropped on interface '.*': (\d+)/\d+ \(pcap:\d+/dumpcap:(\d+)/flushed:(\d+)/", stderr, re.MULTILINE)
+    assert m is not None, stderr
+    return tuple(int(count) for count in m.groups())
+
+
+class TestDumpcapBatch:
+    def test_dumpcap_batch_size_autostop_pipe(self, cmd_dumpcap, cmd_capinfos, result_file, base_env):
+        '''Packets left in the last batch after -c are reported, not lost'''
+        if sysconfig.get_platform().startswith('mingw'):
+            pytest.skip('FIXME Pipes are broken with the MSYS2 shell')
+        testout_file = result_file(testout_pcap)
+        capture_cmd = ' '.join((
+            '"{}"'.format(cmd_dumpcap),
+            '-t', '--batch-size', '16',
+            '-i', '-',
+            '-w', testout_file,
+            '-c', '10',
+        ))
+        capture_proc = subprocesstest.check_run(cat_dhcp_command('cat100') + ' | ' + capture_cmd,
+            shell=True, capture_output=True, env=base_env)
+        check_packet_count(cmd_capinfos, 10, testout_file)
+        received, dropped, flushed = parse_packet_drops(capture_proc.stderr)
+        # The reader queues packets past the tenth before the writer stops;
+        # every one of them must be counted as dropped or flushed.
+        assert received >= 10
+        assert dropped + flushed >= received - 10
+
+    def test_dumpcap_batch_size_autostop_interface(self, capture_interface, cmd_dumpcap, cmd_capinfos, result_file, base_env):
+        '''A batch read from an interface stops writing at -c'''
+        testout_file = result_file(testout_pcap)
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        stopped = threading.Event()
+        def send_bursts():
+            # Bursts, so that one read returns more than one packet.
+            while not stopped.wait(.1):
+                for _ in range(50):
+                    sock.sendto(b'Wireshark test\n', ('127.0.0.1', 9))
+        sender = threading.Thread(target=send_bursts, daemon=True)
+        sender.start()
+        try:
+            capture_proc = subprocesstest.check_run(capture_command(cmd_dumpcap,
+                '-i', capture_interface,
+                '-p',
+                '--batch-size', '64',
+                '-w', testout_file,
+                '-c', '10',
+                '-a', 'duration:{}'.format(capture_duration),
+                '-f', 'udp port 9',
+            ), capture_output=True, env=base_env)
+        finally:
+            stopped.set()
+            sender.join()
+            sock.close()
+        check_packet_count(cmd_capinfos, 10, testout_file)
+        # Without -t, only written packets count as received; the rest of
+        # the last batch is counted as flushed.
+        received, dropped, flushed = parse_packet_drops(capture_proc.stderr)
+        assert received == 10
+        assert dropped == 0
+
+
 class TestDumpcapAutostop:
     # duration, filesize, packets, files
     def test_dumpcap_autostop_filesize(self, check_dumpcap_autostop_stdin, base_env):
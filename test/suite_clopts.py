@@ -9,6 +9,8 @@
 '''Command line option tests'''
 
 import json
+import re
+import struct
 import sys
 import os.path
 import subprocess
@@ -314,6 +316,103 @@ class TestTsharkZExpert:
         assert not grep_output(proc.stdout, 'Chats')
 
 
+class TestTsharkZDissectorProfile:
+    def test_tshark_z_dissector_profile(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'dissector-profile',
+            '-r', capture_file('dhcp.pcap')), capture_output=True, env=test_env)
+        assert grep_output(proc.stdout, 'Dissector Profile')
+        # Every packet goes through the frame and DHCP dissectors once.
+        assert re.search(r'^frame\s+4\s', proc.stdout, re.MULTILINE)
+        assert re.search(r'^dhcp\s+4\s', proc.stdout, re.MULTILINE)
+
+    def test_tshark_z_dissector_profile_invalid(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'dissector-profile,garbage',
+            '-r', capture_file('dhcp.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode != 0
+
+
+class TestTsharkZStatsTree:
+    @staticmethod
+    def pivot_children(output, pivot_name):
+        '''Return the count of a stats_tree node and the counts of its children.'''
+        pivot_count = None
+        pivot_indent = None
+        child_indent = None
+        children = {}
+        for line in output.splitlines():
+            m = re.match(r'^(\s*)(.*?)\s+(\d+)\s', line)
+            if not m:
+                continue
+            indent, name, count = len(m.group(1)), m.group(2), int(m.group(3))
+            if pivot_indent is None:
+                if name == pivot_name:
+                    pivot_indent = indent
+                    pivot_count = count
+            elif indent > pivot_indent:
+                if child_indent is None:
+                    child_indent = indent
+                if indent == child_indent:
+                    children[name] = count
+            else:
+                break
+        return pivot_count, children
+
+    @staticmethod
+    def write_http_requests(path, hosts):
+        '''Write a pcap with one HTTP request per host, each to its own server.'''
+        with open(path, 'wb') as f:
+            f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+            for n, host in enumerate(hosts):
+                payload = 'GET / HTTP/1.1\r\nHost: {}\r\n\r\n'.format(host).encode()
+                tcp = struct.pack('!HHIIBBHHH', 10000 + n, 80, 1, 1, 5 << 4, 0x18, 65535, 0, 0)
+                ip = struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(tcp) + len(payload),
+                    n, 0, 64, 6, 0, bytes((10, 0, 0, 1)), bytes((10, 1, n // 256, n % 256)))
+                frame = bytes(6) + bytes((0, 0, 0, 0, 0, 1)) + b'\x08\x00' + ip + tcp + payload
+                f.write(struct.pack('<IIII', n + 1, 0, len(frame), len(frame)))
+                f.write(frame)
+
+    def test_tshark_z_dns_tree_topk(self, cmd_tshark, capture_file, test_env):
+        def dns_tree(topk):
+            proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'dns,tree',
+                '-o', 'dns.enable_qname_stats:TRUE',
+                '-o', 'statistics.st_topk_max_items:{}'.format(topk),
+                '-r', capture_file('dns+icmp.pcapng.gz')), capture_output=True, env=test_env)
+            return self.pivot_children(proc.stdout, 'Query Name')
+
+        all_count, all_names = dns_tree(0)
+        assert all_count > 0
+        assert sum(all_names.values()) == all_count
+        # With room for a single name, every new name takes over the
+        # previous one along with its count.
+        top_count, top_names = dns_tree(1)
+        assert top_count == all_count
+        assert list(top_names.values()) == [all_count]
+
+    def test_tshark_z_http_host_topk(self, cmd_tshark, result_file, test_env):
+        hosts = ['host{}.example'.format(n) for n in range(12)]
+        pcap_file = result_file('http-hosts.pcap')
+        self.write_http_requests(pcap_file, hosts)
+
+        def http_tree(tree, node_name, topk):
+            proc = subprocesstest.run((cmd_tshark, '-q', '-z', tree + ',tree',
+                '-o', 'statistics.st_topk_max_items:{}'.format(topk),
+                '-r', pcap_file), capture_output=True, env=test_env)
+            return self.pivot_children(proc.stdout, node_name)
+
+        for tree, node_name in (('http_req', 'HTTP Requests by HTTP Host'),
+                                ('http_srv', 'HTTP Requests by HTTP Host'),
+                                ('http_srv', 'HTTP Requests by Server Address')):
+            all_count, all_children = http_tree(tree, node_name, 0)
+            assert all_count == len(hosts)
+            assert len(all_children) == len(hosts)
+            # More distinct values than the limit: the node keeps at most
+            # 4 children, and their counts still add up to the node's count.
+            top_count, top_children = http_tree(tree, node_name, 4)
+            assert top_count == len(hosts)
+            assert len(top_children) == 4
+            assert sum(top_children.values()) == len(hosts)
+
+
 class TestTsharkExtcap:
     # dumpcap dependency has been added to run this test only with capture support
     def test_tshark_extcap_interfaces(self, cmd_tshark, cmd_dumpcap, test_env, home_path):
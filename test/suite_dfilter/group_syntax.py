@@ -3,6 +3,7 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 
 import pytest
+import re
 from suite_dfilter.dfiltertest import *
 
 
@@ -526,3 +527,31 @@ class TestDfilterTFSValueString:
         error = 'expected "True" or "False", not "Unset"'
         dfilter = 'frame.ignored == "Unset"'
         checkDFilterFail(dfilter, error)
+
+class TestDfilterBench:
+    trace_file = "http.pcap"
+
+    def test_bench_filters_file(self, cmd_dftest, capture_file, dfilter_env, tmp_path):
+        filters = tmp_path / 'filters.txt'
+        filters.write_text('# Comment\nhttp\n\nip.proto == 17\n')
+        proc = subprocesstest.check_run((cmd_dftest,
+                '--bench={}'.format(capture_file(self.trace_file)),
+                '--filters={}'.format(filters),
+                '--opcodes',
+                '--', 'tcp.port == 80'),
+                capture_output=True, universal_newlines=True, env=dfilter_env)
+        assert 'Packets: 1,' in proc.stdout
+        assert re.search(r'^\s+1\s.*\stcp\.port == 80$', proc.stdout, re.MULTILINE)
+        assert re.search(r'^\s+1\s.*\shttp$', proc.stdout, re.MULTILINE)
+        assert re.search(r'^\s+0\s.*\sip\.proto == 17$', proc.stdout, re.MULTILINE)
+        assert re.search(r'^READ_TREE\s+\d+', proc.stdout, re.MULTILINE)
+
+    def test_bench_bad_filter(self, cmd_dftest, capture_file, dfilter_env, tmp_path):
+        filters = tmp_path / 'filters.txt'
+        filters.write_text('http\nip.proto ==\n')
+        proc = subprocesstest.run((cmd_dftest,
+                '--bench={}'.format(capture_file(self.trace_file)),
+                '--filters={}'.format(filters)),
+                capture_output=True, universal_newlines=True, env=dfilter_env)
+        assert proc.returncode == 4
+        assert 'in filter: ip.proto ==' in proc.stderr
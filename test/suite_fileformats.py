@@ -8,7 +8,10 @@
 #
 '''File format conversion tests'''
 
+import hashlib
+import json
 import os.path
+import struct
 from subprocesstest import count_output
 import subprocess
 import pytest
@@ -262,3 +265,124 @@ class TestFileFormatMime:
                 '-e', 'pcapng.block.length_trailer',
             ), encoding='utf-8', env=test_env)
         assert proc_stdout.strip() == '480\t128,88,132,132\t128,88,132,132'
+
+
+class TestFileFormatCompression:
+    magic = {
+        'gzip': b'\x1f\x8b',
+        'zstd': b'\x28\xb5\x2f\xfd',
+        'lz4': b'\x04\x22\x4d\x18',
+    }
+
+    @pytest.mark.parametrize('compression', ['gzip', 'zstd', 'lz4'])
+    def test_compressed_write_roundtrip(self, compression, cmd_editcap, cmd_tshark, capture_file, result_file, fileformats_baseline_str, features, test_env):
+        '''Write a compressed file with editcap and read it back'''
+        if compression == 'zstd' and not features.have_zstd:
+            pytest.skip('Requires Zstandard')
+        if compression == 'lz4' and not features.have_lz4:
+            pytest.skip('Requires LZ4')
+        outfile = result_file('dhcp-compressed.pcapng')
+        subprocess.check_call((cmd_editcap,
+                '--compress', compression,
+                capture_file('dhcp.pcap'), outfile,
+            ), env=test_env)
+        with open(outfile, 'rb') as f:
+            assert f.read(len(self.magic[compression])) == self.magic[compression]
+        capture_stdout = subprocess.check_output((cmd_tshark,
+                '-r', outfile,
+                '-Tfields',
+                '-e', 'frame.number', '-e', 'frame.time_epoch', '-e', 'frame.time_delta',
+            ), encoding='utf-8', env=test_env)
+        assert capture_stdout == fileformats_baseline_str
+
+    @pytest.mark.parametrize('compression', ['zstd', 'lz4'])
+    def test_compressed_random_access(self, compression, cmd_editcap, cmd_tshark, result_file, features, test_env):
+        '''Frames in a multi-frame compressed file are found when seeking'''
+        if compression == 'zstd' and not features.have_zstd:
+            pytest.skip('Requires Zstandard')
+        if compression == 'lz4' and not features.have_lz4:
+            pytest.skip('Requires LZ4')
+        # 7000 packets with 1000 byte incompressible payloads: about 7 MB,
+        # which the writer splits into two 4 MiB compression frames.
+        n_packets = 7000
+        plain = result_file('random-access.pcap')
+        with open(plain, 'wb') as f:
+            f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 147))
+            digest = b''
+            for i in range(n_packets):
+                payload = b''
+                while len(payload) < 1000:
+                    digest = hashlib.sha256(digest + i.to_bytes(4, 'little')).digest()
+                    payload += digest
+                payload = payload[:1000]
+                f.write(struct.pack('<IIII', 1700000000 + i, 0, len(payload), len(payload)))
+                f.write(payload)
+        compressed = result_file('random-access.pcap.' + compression)
+        subprocess.check_call((cmd_editcap,
+                '-F', 'pcap', '--compress', compression,
+                plain, compressed,
+            ), env=test_env)
+        assert os.path.getsize(compressed) > 4 * 1024 * 1024
+        outputs = []
+        for path in (plain, compressed):
+            outputs.append(subprocess.check_output((cmd_tshark,
+                    '-r', path, '-2',
+                    '-o', 'frame.generate_md5_hash:TRUE',
+                    '-Y', 'frame.number >= 4500 || frame.number == 10',
+                    '-Tfields', '-e', 'frame.number', '-e', 'frame.md5_hash',
+                ), encoding='utf-8', env=test_env))
+        assert count_output(outputs[0]) == n_packets - 4500 + 2
+        assert outputs[1] == outputs[0]
+
+    def test_compressed_write_bad_type(self, cmd_editcap, capture_file, result_file, test_env):
+        '''An unknown compression type is rejected'''
+        proc = subprocess.run((cmd_editcap,
+                '--compress', 'bogus',
+                capture_file('dhcp.pcap'), result_file('dhcp-bogus.pcapng'),
+            ), capture_output=True, encoding='utf-8', env=test_env)
+        assert proc.returncode != 0
+        assert 'isn\'t a valid output compression mode' in proc.stderr
+
+
+class TestFileFormatCapinfos:
+    capture_files = ('dhcp.pcap', 'dhcp.pcapng', 'dns+icmp.pcapng.gz', 'empty.pcap')
+
+    def test_capinfos_hashes(self, cmd_capinfos, capture_file, test_env):
+        '''Hashes computed while reading match those of the whole file'''
+        for name in self.capture_files:
+            path = capture_file(name)
+            with open(path, 'rb') as f:
+                data = f.read()
+            proc_stdout = subprocess.check_output((cmd_capinfos, '-T', '-r', '-H', path),
+                encoding='utf-8', env=test_env)
+            fields = proc_stdout.rstrip('\n').split('\t')
+            assert fields[1:3] == [hashlib.sha256(data).hexdigest(), hashlib.sha1(data).hexdigest()]
+
+    def test_capinfos_jobs_json(self, cmd_capinfos, capture_file, test_env):
+        '''Files read in parallel are reported in command line order'''
+        paths = [capture_file(name) for name in self.capture_files] * 3
+        sequential = subprocess.check_output([cmd_capinfos, '-J'] + paths,
+            encoding='utf-8', env=test_env)
+        parallel = subprocess.check_output([cmd_capinfos, '-J', '-j', '4'] + paths,
+            encoding='utf-8', env=test_env)
+        assert parallel == sequential
+        reports = [json.loads(line) for line in parallel.splitlines()]
+        assert [report['file'] for report in reports] == paths
+        assert reports[0]['packets'] == 4
+        assert reports[0]['file_type'] == 'pcap'
+
+
+class TestFileFormatEditcapJobs:
+    @pytest.mark.parametrize('capture', ['dhcp.pcap', 'many_interfaces.pcapng.1', 'dtls12-aes128ccm8-dsb.pcapng', 'dns+icmp.pcapng.gz'])
+    def test_editcap_jobs_same_output(self, capture, cmd_editcap, capture_file, result_file, test_env):
+        '''Reading in a separate thread doesn't change the output'''
+        outputs = []
+        for jobs in ('1', '4'):
+            outfile = result_file(f'editcap-jobs-{jobs}.pcapng')
+            subprocess.check_call((cmd_editcap,
+                    '-j', jobs, '-t', '1.5', '-s', '64', '-C', '4',
+                    capture_file(capture), outfile,
+                ), env=test_env)
+            with open(outfile, 'rb') as f:
+                outputs.append(f.read())
+        assert outputs[0] == outputs[1]
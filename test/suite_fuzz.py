@@ -0,0 +1,94 @@
+#
+# Wireshark tests
+# By Gerald Combs <gerald@wireshark.org>
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''fuzzshark_bench tests'''
+
+import json
+import os
+import subprocess
+import sys
+import pytest
+
+
+# A DNS query for www.wireshark.org, type A.
+dns_query = bytes.fromhex(
+    '12340100000100000000000003777777097769726573686172'
+    '6b036f72670000010001'
+)
+
+summary_keys = {
+    'target', 'table', 'iterations', 'packets', 'elapsed_ns',
+    'packets_per_second', 'ns_per_packet', 'wmem_bytes_per_packet',
+    'dissectors',
+}
+
+dissector_keys = {
+    'protocol', 'calls', 'exclusive_ns', 'inclusive_ns',
+    'packets_per_second', 'ns_per_packet', 'wmem_bytes_per_packet',
+}
+
+
+@pytest.fixture(scope='session')
+def cmd_fuzzshark_bench(program_path):
+    # Only built with -DBUILD_fuzzshark=ON and without a fuzzing engine.
+    dotexe = '.exe' if sys.platform.startswith('win32') else ''
+    path = os.path.abspath(os.path.join(program_path, 'fuzzshark_bench' + dotexe))
+    if not os.access(path, os.X_OK):
+        pytest.skip('fuzzshark_bench is not available')
+    return path
+
+
+def check_results(output, iterations, inputs):
+    results = json.loads(output)
+    assert set(results) == summary_keys
+    assert results['iterations'] == iterations
+    assert results['packets'] == iterations * inputs
+    assert results['elapsed_ns'] > 0
+    assert results['packets_per_second'] > 0
+    assert results['dissectors']
+    for dissector in results['dissectors']:
+        assert set(dissector) == dissector_keys
+        assert dissector['calls'] > 0
+    return results
+
+
+class TestFuzzsharkBench:
+    def test_bench_capture(self, cmd_fuzzshark_bench, capture_file, base_env):
+        '''Full frame path over the packets of a capture file'''
+        env = dict(base_env)
+        env.pop('FUZZSHARK_TARGET', None)
+        env.pop('FUZZSHARK_TABLE', None)
+        output = subprocess.check_output((cmd_fuzzshark_bench,
+            '-n', '2',
+            capture_file('dhcp.pcap'),
+        ), encoding='utf-8', env=env)
+        results = check_results(output, 2, 4)
+        assert results['target'] is None
+        protocols = {dissector['protocol'] for dissector in results['dissectors']}
+        assert 'dhcp' in protocols
+
+    def test_bench_corpus(self, cmd_fuzzshark_bench, base_env, tmp_path):
+        '''One dissector over the files of a corpus directory'''
+        corpus = tmp_path / 'corpus'
+        corpus.mkdir()
+        (corpus / 'query').write_bytes(dns_query)
+        (corpus / 'truncated').write_bytes(dns_query[:7])
+        env = dict(base_env, FUZZSHARK_TARGET='dns')
+        env.pop('FUZZSHARK_TABLE', None)
+        output = subprocess.check_output((cmd_fuzzshark_bench,
+            '-n', '3',
+            str(corpus),
+        ), encoding='utf-8', env=env)
+        results = check_results(output, 3, 2)
+        assert results['target'] == 'dns'
+        protocols = {dissector['protocol'] for dissector in results['dissectors']}
+        assert 'dns' in protocols
+
+    def test_bench_no_inputs(self, cmd_fuzzshark_bench, base_env):
+        '''Missing arguments are an error'''
+        proc = subprocess.run((cmd_fuzzshark_bench,), env=base_env,
+            stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        assert proc.returncode != 0
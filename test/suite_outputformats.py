@@ -90,3 +90,24 @@ class TestOutputFormats:
         ''' Check that the option -j works with -Tek.'''
         check_outputformat("ek", extra_args=['-j', 'dhcp'], expected="dhcp-filter.ek",
             multiline=True, env=base_env)
+
+
+class TestColorFilters:
+    def test_colorfilters_first_match(self, cmd_tshark, capture_file, conf_path, base_env):
+        '''Checks that the first matching coloring rule is used, including
+        rules that are skipped because their fields are absent.'''
+        rules = (
+            ('TCP', 'tcp'),
+            ('Not UDP', '!udp'),
+            ('Either', 'tcp.port == 67 || dhcp.option.dhcp == 3'),
+            ('Discover', 'count(tcp.port) == 0 && dhcp.option.dhcp == 1'),
+            ('Offer', 'udp.srcport == 67 && !(dhcp.option.dhcp == 5)'),
+            ('UDP', 'udp'),
+        )
+        with open(os.path.join(conf_path, 'colorfilters'), 'w') as f:
+            for name, text in rules:
+                f.write('@{}@{}@[65535,65535,65535][0,0,0]\n'.format(name, text))
+        tshark_proc = subprocess.run((cmd_tshark, '-r', capture_file('dhcp.pcap'),
+                                      '--color', '-T', 'fields', '-e', 'frame.coloring_rule.name'),
+                                      check=True, capture_output=True, encoding='utf-8', env=base_env)
+        assert tshark_proc.stdout.split('\n')[:4] == ['Discover', 'Offer', 'Either', 'UDP']
@@ -237,6 +237,60 @@ class TestSharkd:
             },
         ))
 
+    def test_sharkd_req_frames_cached(self, check_sharkd_session, capture_file):
+        # The second and third requests are answered from the column cache,
+        # which must not mix up column sets or delta times.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('logistics_multicast.pcapng')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"frames","params":{"filter":"frame.number==1||frame.number==800","column0":"frame.time_relative:1","column1":"frame.time_delta_displayed:1"}},
+            {"jsonrpc":"2.0", "id":3, "method":"frames","params":{"filter":"frame.number==1||frame.number==800","column0":"frame.time_relative:1","column1":"frame.time_delta_displayed:1"}},
+            {"jsonrpc":"2.0", "id":4, "method":"frames","params":{"filter":"frame.number==1||frame.number==800","column0":"frame.time_delta_displayed:1"}},
+            {"jsonrpc":"2.0", "id":5, "method":"frames","params":{"filter":"frame.number==800","column0":"frame.time_relative:1","column1":"frame.time_delta_displayed:1"}},
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,"result":
+                [
+                    {"c":["0.000000000","0.000000000"],"num":1,"bg":"feffd0","fg":"12272e"},
+                    {"c":["191.872111000","191.872111000"],"num":800,"bg":"feffd0","fg":"12272e"},
+                ],
+            },
+            {"jsonrpc":"2.0","id":3,"result":
+                [
+                    {"c":["0.000000000","0.000000000"],"num":1,"bg":"feffd0","fg":"12272e"},
+                    {"c":["191.872111000","191.872111000"],"num":800,"bg":"feffd0","fg":"12272e"},
+                ],
+            },
+            {"jsonrpc":"2.0","id":4,"result":
+                [
+                    {"c":["0.000000000"],"num":1,"bg":"feffd0","fg":"12272e"},
+                    {"c":["191.872111000"],"num":800,"bg":"feffd0","fg":"12272e"},
+                ],
+            },
+            {"jsonrpc":"2.0","id":5,"result":
+                [
+                    {"c":["191.872111000","0.000000000"],"num":800,"bg":"feffd0","fg":"12272e"},
+                ],
+            },
+        ))
+
+    def test_sharkd_req_frames_stream_index(self, run_sharkd_session, capture_file):
+        # "tcp.stream eq N" is answered from the conversation frame index;
+        # the same filter with an extra term goes through every frame.
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('tls12-dsb.pcapng')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"frames","params":{"filter":"tcp.stream eq 1"}},
+            {"jsonrpc":"2.0", "id":3, "method":"frames","params":{"filter":"tcp.stream eq 1 || frame.number == 0"}},
+        )])
+        assert len(outputs) == 3
+        indexed = [frame["num"] for frame in outputs[1]["result"]]
+        scanned = [frame["num"] for frame in outputs[2]["result"]]
+        assert indexed
+        assert indexed == scanned
+
     def test_sharkd_req_frames_comments(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -1202,6 +1256,31 @@ class TestSharkd:
              },
         ))
 
+    def test_sharkd_req_follow_http2_paged(self, check_sharkd_session, capture_file, features):
+        if not features.have_nghttp2:
+            pytest.skip('Requires nghttp2.')
+
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('quic-with-secrets.pcapng')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"follow",
+             "params":{"follow": "HTTP2", "filter": "tcp.stream eq 0 and http2.streamid eq 1", "sub_stream": 1,
+                       "skip": 1, "limit": 1}
+             },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,
+             "result":{
+                 "shost": "2606:4700:10::6816:826", "sport": "443", "sbytes": 656,
+                 "chost": "2001:db8:1::1", "cport": "57098", "cbytes": 109643,
+                 "npayloads": 3,
+                 "payloads": [
+                     {"n": 19, "s": 1, "d": MatchRegExp(r'^.*7IG1hPTg2NDAwCgo.*$')},
+                 ]}
+             },
+        ))
+
     def test_sharkd_req_iograph_bad(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -1297,6 +1376,80 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":4,"result":{"intervals":[[0,2,656]],"last":0,"frames":2,"bytes":656}},
         ))
 
+    def test_sharkd_req_batch(self, run_sharkd_session, capture_file):
+        # A batch request gives the same results as the separate requests.
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('dhcp.pcap')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"batch",
+             "params":{"filter": "frame.number >= 2", "frames": True, "skip": 1, "limit": 2,
+                       "tap0": "phs", "tap1": "conv:UDP", "interval": 1}
+             },
+            {"jsonrpc":"2.0", "id":3, "method":"frames",
+             "params":{"filter": "frame.number >= 2", "skip": 1, "limit": 2}
+             },
+            {"jsonrpc":"2.0", "id":4, "method":"tap",
+             "params":{"filter": "frame.number >= 2", "tap0": "phs", "tap1": "conv:UDP"}
+             },
+            {"jsonrpc":"2.0", "id":5, "method":"intervals",
+             "params":{"filter": "frame.number >= 2", "interval": 1}
+             },
+            {"jsonrpc":"2.0", "id":6, "method":"batch",
+             "params":{"filter": "garbage filter", "frames": True}
+             },
+        )])
+        assert len(outputs) == 6
+        batch = outputs[1]["result"]
+        assert [frame["num"] for frame in batch["frames"]] == [3, 4]
+        assert batch["frames"] == outputs[2]["result"]
+        assert batch["taps"] == outputs[3]["result"]["taps"]
+        assert batch["intervals"] == outputs[4]["result"]
+        assert outputs[5] == {"jsonrpc":"2.0","id":6,"error":{"code":-14002,"message":"Filter expression invalid"}}
+
+    def test_sharkd_req_batch_no_frames(self, run_sharkd_session, capture_file):
+        # "frames": false leaves the frame list out, like omitting it.
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('dhcp.pcap')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"batch",
+             "params":{"frames": False, "interval": 1}
+             },
+            {"jsonrpc":"2.0", "id":3, "method":"batch",
+             "params":{"interval": 1}
+             },
+        )])
+        assert len(outputs) == 3
+        assert "frames" not in outputs[1]["result"]
+        assert outputs[1]["result"] == outputs[2]["result"]
+
+    def test_sharkd_req_profile(self, run_sharkd_session, capture_file):
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('dhcp.pcap')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"profile",
+             "params":{"enable": True, "reset": True}
+             },
+            {"jsonrpc":"2.0", "id":3, "method":"frame",
+             "params":{"frame": 2, "proto": True}
+             },
+            {"jsonrpc":"2.0", "id":4, "method":"profile",
+             "params":{"enable": False}
+             },
+        )])
+        assert len(outputs) == 4
+        assert outputs[1]["result"] == {"enabled": True, "total_ns": 0, "protocols": []}
+        profile = outputs[3]["result"]
+        assert profile["enabled"] is False
+        protocols = {p["proto"]: p for p in profile["protocols"]}
+        assert protocols["frame"]["calls"] == 1
+        assert protocols["dhcp"]["calls"] == 1
+        assert protocols["frame"]["incl_ns"] >= protocols["dhcp"]["incl_ns"]
+        assert protocols["frame"]["incl_bytes"] >= protocols["frame"]["excl_bytes"]
+        assert profile["total_ns"] == sum(p["excl_ns"] for p in profile["protocols"])
+
     def test_sharkd_req_frame_basic(self, check_sharkd_session, capture_file):
         # XXX add more tests for other options (ref_frame, prev_frame, columns, color, bytes, hidden)
         check_sharkd_session((
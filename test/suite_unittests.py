@@ -19,6 +19,10 @@ class TestUnitTests:
         '''exntest'''
         subprocess.check_call(program('exntest'), env=base_env)
 
+    def test_unit_mmdb_reader_test(self, program, base_env, dirs):
+        '''mmdb_reader_test'''
+        subprocess.check_call((program('mmdb_reader_test'), dirs.mmdb_dir), env=base_env)
+
     def test_unit_oids_test(self, program, base_env):
         '''oids_test'''
         subprocess.check_call(program('oids_test'), env=base_env)
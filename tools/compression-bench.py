@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+# Compare the compressed file writers.
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Compare the throughput and ratio of the compressed file writers.
+
+Each capture file is rewritten with editcap --compress for every
+compression type (and the levels given with --level), then read back with
+capinfos.  The best of --repeat runs is reported for both directions, in
+MB of uncompressed data per second, together with the compression ratio.
+The "none" row is the cost of copying the file without compression.
+'''
+
+import argparse
+import os.path
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def best_time(args, repeat):
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        subprocess.run(args, stdout=subprocess.DEVNULL, check=True)
+        elapsed = time.perf_counter() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+
+def available_types(editcap_path):
+    # editcap lists the types it can write when given an unknown one.
+    cp = subprocess.run([editcap_path, '--compress', 'list'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, encoding='utf-8')
+    return [line.strip() for line in cp.stdout.splitlines()[1:] if line.startswith('   ')]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compressed file writer benchmark')
+    parser.add_argument('-p', '--program-path', default=os.path.curdir, help='Path to editcap and capinfos.')
+    parser.add_argument('-n', '--repeat', type=int, default=3, help='Number of runs of each step (default 3).')
+    parser.add_argument('-l', '--level', action='append', default=[], metavar='TYPE:LEVEL',
+        help='Also run TYPE at compression level LEVEL, e.g. zstd:-5 or lz4:9. Can be repeated.')
+    parser.add_argument('-j', '--threads', type=int, default=0, help='Compression threads for zstd.')
+    parser.add_argument('capture_files', nargs='+', metavar='capture file')
+    args = parser.parse_args()
+
+    editcap_path = os.path.join(args.program_path, 'editcap')
+    capinfos_path = os.path.join(args.program_path, 'capinfos')
+    for path in (editcap_path, capinfos_path):
+        if not os.path.isfile(path):
+            print('{} not found\n'.format(path))
+            parser.print_usage()
+            sys.exit(1)
+
+    runs = [('none', None)] + [(compression, None) for compression in available_types(editcap_path)]
+    for type_level in args.level:
+        compression, _, level = type_level.partition(':')
+        runs.append((compression, level))
+
+    tmp_dir = tempfile.mkdtemp(prefix='wireshark-compression-bench-')
+    try:
+        for capture_file in args.capture_files:
+            # Start from an uncompressed copy so that reading the input
+            # costs the same for every run.
+            plain_file = os.path.join(tmp_dir, 'input.pcapng')
+            subprocess.run([editcap_path, capture_file, plain_file], check=True)
+            plain_size = os.path.getsize(plain_file)
+            mbytes = plain_size / 1000000
+
+            print('{} ({:.1f} MB uncompressed)'.format(capture_file, mbytes))
+            print('{:<6} {:>6} {:>8} {:>12} {:>12}'.format('type', 'level', 'ratio', 'write MB/s', 'read MB/s'))
+            for compression, level in runs:
+                out_file = os.path.join(tmp_dir, 'output')
+                write_args = [editcap_path, '--compress', compression]
+                if level is not None:
+                    write_args += ['--compress-level', level]
+                if args.threads > 0 and compression == 'zstd':
+                    write_args += ['--compress-threads', str(args.threads)]
+                write_time = best_time(write_args + [plain_file, out_file], args.repeat)
+                read_time = best_time([capinfos_path, '-c', out_file], args.repeat)
+                ratio = plain_size / os.path.getsize(out_file)
+                print('{:<6} {:>6} {:>8.2f} {:>12.1f} {:>12.1f}'.format(compression,
+                    level if level is not None else '-', ratio, mbytes / write_time, mbytes / read_time))
+                os.remove(out_file)
+            os.remove(plain_file)
+            print()
+    finally:
+        shutil.rmtree(tmp_dir)
+
+
+if __name__ == '__main__':
+    main()
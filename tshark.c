@@ -143,6 +143,9 @@
 #define LONGOPT_HEXDUMP                 LONGOPT_BASE_APPLICATION+7
 #define LONGOPT_SELECTED_FRAME          LONGOPT_BASE_APPLICATION+8
 #define LONGOPT_PRINT_TIMERS            LONGOPT_BASE_APPLICATION+9
+#define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+10
+#define LONGOPT_COMPRESS_LEVEL          LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_COMPRESS_THREADS        LONGOPT_BASE_APPLICATION+12
 
 capture_file cfile;
 
@@ -190,6 +193,11 @@ static print_stream_t *print_stream;
 
 static char *output_file_name;
 
+/* Compression for the file written with -w when reading a capture file */
+static wtap_compression_type output_compression_type = WTAP_UNCOMPRESSED;
+static int output_compression_level;
+static int output_compression_threads;
+
 static output_fields_t* output_fields;
 
 static bool no_duplicate_keys;
@@ -227,6 +235,8 @@ static void capture_input_new_packets(capture_session *cap_session,
         int to_read);
 static void capture_input_drops(capture_session *cap_session, uint32_t dropped,
         const char* interface_name);
+static void capture_input_queue_stats(capture_session *cap_session, uint32_t full_drops,
+        uint32_t max_packets, uint64_t max_bytes, const char* interface_name);
 static void capture_input_error(capture_session *cap_session,
         char *error_msg, char *secondary_error_msg);
 static void capture_input_cfilter_error(capture_session *cap_session,
@@ -516,6 +526,12 @@ print_usage(FILE *output)
     fprintf(output, "  -C <config profile>      start with specified configuration profile\n");
     fprintf(output, "  -F <output file type>    set the output file type; default is pcapng.\n");
     fprintf(output, "                           an empty \"-F\" option will list the file types\n");
+    fprintf(output, "  --compress <type>        compress the output file (when reading a capture\n");
+    fprintf(output, "                           file) using the type compression format; an empty\n");
+    fprintf(output, "                           \"--compress\" option will list the types\n");
+    fprintf(output, "  --compress-level <level> set the output compression level\n");
+    fprintf(output, "  --compress-threads <n>   compress using <n> worker threads, if supported\n");
+    fprintf(output, "                           by the compression type (zstd)\n");
     fprintf(output, "  -V                       add output of packet tree        (Packet Details)\n");
     fprintf(output, "  -O <protocols>           Only show packet details of these protocols, comma\n");
     fprintf(output, "                           separated\n");
@@ -959,6 +975,9 @@ main(int argc, char *argv[])
         {"hexdump", ws_required_argument, NULL, LONGOPT_HEXDUMP},
         {"selected-frame", ws_required_argument, NULL, LONGOPT_SELECTED_FRAME},
         {"print-timers", ws_no_argument, NULL, LONGOPT_PRINT_TIMERS},
+        {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"compress-level", ws_required_argument, NULL, LONGOPT_COMPRESS_LEVEL},
+        {"compress-threads", ws_required_argument, NULL, LONGOPT_COMPRESS_THREADS},
         {0, 0, 0, 0}
     };
     bool                 arg_error = false;
@@ -1203,7 +1222,7 @@ main(int argc, char *argv[])
     capture_opts_init(&global_capture_opts, capture_opts_get_interface_list);
     capture_session_init(&global_capture_session, &cfile,
             capture_input_new_file, capture_input_new_packets,
-            capture_input_drops, capture_input_error,
+            capture_input_drops, capture_input_queue_stats, capture_input_error,
             capture_input_cfilter_error, capture_input_closed);
 #endif
 
@@ -1874,12 +1893,32 @@ main(int argc, char *argv[])
             case LONGOPT_PRINT_TIMERS:
                 opt_print_timers = true;
                 break;
+            case LONGOPT_COMPRESS:
+                output_compression_type = wtap_name_to_compression_type(ws_optarg);
+                if (output_compression_type == WTAP_UNKNOWN_COMPRESSION ||
+                    !wtap_can_write_compression_type(output_compression_type)) {
+                    cmdarg_err("\"%s\" isn't a valid output compression mode",
+                                ws_optarg);
+                    list_output_compression_types("tshark", stderr);
+                    exit_status = WS_EXIT_INVALID_OPTION;
+                    goto clean_exit;
+                }
+                break;
+            case LONGOPT_COMPRESS_LEVEL:
+                output_compression_level = get_int(ws_optarg, "compression level");
+                break;
+            case LONGOPT_COMPRESS_THREADS:
+                output_compression_threads = get_natural_int(ws_optarg, "number of compression threads");
+                break;
             default:
             case '?':        /* Bad flag - print usage message */
                 switch(ws_optopt) {
                     case 'F':
                         list_capture_types();
                         break;
+                    case LONGOPT_COMPRESS:
+                        list_output_compression_types("tshark", stderr);
+                        break;
                     default:
                         print_usage(stderr);
                 }
@@ -2044,6 +2083,24 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (output_compression_level != 0) {
+        int min_level, max_level;
+
+        if (!wtap_compression_type_level_range(output_compression_type, &min_level, &max_level)) {
+            cmdarg_err("A compression level can't be set with compression type \"%s\"",
+                    wtap_compression_type_name(output_compression_type));
+            exit_status = WS_EXIT_INVALID_OPTION;
+            goto clean_exit;
+        }
+        if (output_compression_level < min_level || output_compression_level > max_level) {
+            cmdarg_err("The specified compression level %d isn't between %d and %d for compression type \"%s\"",
+                    output_compression_level, min_level, max_level,
+                    wtap_compression_type_name(output_compression_type));
+            exit_status = WS_EXIT_INVALID_OPTION;
+            goto clean_exit;
+        }
+    }
+
 #ifdef HAVE_LIBPCAP
     if (caps_queries) {
         /* We're supposed to list the link-layer/timestamp types for an interface;
@@ -2136,6 +2193,12 @@ main(int argc, char *argv[])
             if (global_capture_opts.saving_to_file) {
                 /* They specified a "-w" flag, so we'll be saving to a capture file. */
 
+                if (output_compression_type != WTAP_UNCOMPRESSED) {
+                    cmdarg_err("--compress can only be used when reading a capture file.");
+                    exit_status = WS_EXIT_INVALID_OPTION;
+                    goto clean_exit;
+                }
+
                 /* When capturing, we only support writing pcap or pcapng format. */
                 if (out_file_type == wtap_pcapng_file_type_subtype()) {
                     use_pcapng = true;
@@ -3200,6 +3263,24 @@ capture_input_drops(capture_session *cap_session _U_, uint32_t dropped, const ch
     }
 }
 
+/* capture child reported how its packet queue for an interface was used */
+static void
+capture_input_queue_stats(capture_session *cap_session _U_, uint32_t full_drops,
+        uint32_t max_packets, uint64_t max_bytes, const char* interface_name)
+{
+    if (interface_name == NULL) {
+        interface_name = "unknown interface";
+    }
+    /* Only worth the user's attention if the queue was too small. */
+    if (full_drops != 0) {
+        fprintf(stderr, "%u packet%s dropped from %s because its queue was full (max depth %u packets/%" PRIu64 " bytes)\n",
+                full_drops, plurality(full_drops, "", "s"), interface_name, max_packets, max_bytes);
+    } else {
+        ws_info("Queue of interface '%s': max depth %u packets/%" PRIu64 " bytes",
+                interface_name, max_packets, max_bytes);
+    }
+}
+
 
 /*
  * Capture child closed its side of the pipe, report any error and
@@ -3950,6 +4031,8 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
     if (save_file != NULL) {
         /* Set up to write to the capture file. */
         wtap_dump_params_init_no_idbs(&params, cf->provider.wth);
+        params.compression_level = output_compression_level;
+        params.compression_threads = output_compression_threads;
 
         /* If we don't have an application name add TShark */
         if (wtap_block_get_string_option_value(g_array_index(params.shb_hdrs, wtap_block_t, 0), OPT_SHB_USERAPPL, &shb_user_appl) != WTAP_OPTTYPE_SUCCESS) {
@@ -3967,10 +4050,10 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
         ws_debug("tshark: writing format type %d, to %s", out_file_type, save_file);
         if (strcmp(save_file, "-") == 0) {
             /* Write to the standard output. */
-            pdh = wtap_dump_open_stdout(out_file_type, WTAP_UNCOMPRESSED, &params,
+            pdh = wtap_dump_open_stdout(out_file_type, output_compression_type, &params,
                     &err, &err_info);
         } else {
-            pdh = wtap_dump_open(save_file, out_file_type, WTAP_UNCOMPRESSED, &params,
+            pdh = wtap_dump_open(save_file, out_file_type, output_compression_type, &params,
                     &err, &err_info);
         }
 
@@ -605,6 +605,18 @@ capture_input_drops(capture_session *cap_session, uint32_t dropped, const char*
 }
 
 
+/* Capture child told us how its packet queue for an interface was used.
+ * The packets dropped because it was full are already in the drop count.
+ */
+static void
+capture_input_queue_stats(capture_session *cap_session _U_, uint32_t full_drops,
+                          uint32_t max_packets, uint64_t max_bytes, const char* interface_name)
+{
+    ws_info("Queue of interface %s: max depth %u packets/%" PRIu64 " bytes, dropped when full: %u",
+            interface_name ? interface_name : "(unknown)", max_packets, max_bytes, full_drops);
+}
+
+
 /* Capture child told us that an error has occurred while starting/running
    the capture.
    The buffer we're handed has *two* null-terminated strings in it - a
@@ -1109,7 +1121,7 @@ capture_input_init(capture_session *cap_session, capture_file *cf)
 {
     capture_session_init(cap_session, cf,
                          capture_input_new_file, capture_input_new_packets,
-                         capture_input_drops, capture_input_error,
+                         capture_input_drops, capture_input_queue_stats, capture_input_error,
                          capture_input_cfilter_error, capture_input_closed);
 }
 #endif /* HAVE_LIBPCAP */
@@ -0,0 +1,157 @@
+/* tap-dissector-profile.c
+ * Report the CPU time and allocations of each protocol's dissectors
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/dissector_profile.h>
+
+#include <wsutil/cmdarg_err.h>
+
+void register_tap_listener_dissector_profile(void);
+
+/* Listeners are told apart by their tap data; we don't need any. */
+static int dissector_profile_tapdata;
+
+static void
+heur_entry_draw(const char *table_name _U_, heur_dtbl_entry_t *entry, void *user_data _U_)
+{
+    if (entry->tries == 0 && entry->screened == 0) {
+        return;
+    }
+    printf("  %-22s %12s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+           entry->short_name, "", entry->tries, entry->hits, entry->screened);
+}
+
+static void
+heur_list_draw(const char *table_name, heur_dissector_list_t list, void *user_data _U_)
+{
+    uint64_t calls, hits;
+
+    heur_dissector_list_get_stats(list, &calls, &hits);
+    if (calls == 0) {
+        return;
+    }
+    printf("%-24s %12" PRIu64 " %12s %12" PRIu64 "\n", table_name, calls, "", hits);
+    heur_dissector_table_foreach(table_name, heur_entry_draw, NULL);
+}
+
+static void
+dissector_profile_draw(void *tapdata _U_)
+{
+    GArray *stats = dissector_profile_get_stats();
+    dissector_profile_stats_t *entry;
+    uint64_t total_ns = 0;
+
+    for (unsigned i = 0; i < stats->len; i++) {
+        total_ns += g_array_index(stats, dissector_profile_stats_t, i).exclusive_ns;
+    }
+
+    printf("\n");
+    printf("=========================================================================================================\n");
+    printf("Dissector Profile\n");
+    printf("Total time in dissectors: %.3f ms\n", total_ns / 1e6);
+    printf("Sorted by exclusive time. Inclusive figures add the dissectors each one called.\n\n");
+    printf("%-24s %12s %12s %7s %12s %9s %14s %14s\n",
+           "Protocol", "Calls", "Excl ms", "Excl %", "Incl ms", "ns/call", "Excl bytes", "Incl bytes");
+    for (unsigned i = 0; i < stats->len; i++) {
+        entry = &g_array_index(stats, dissector_profile_stats_t, i);
+        printf("%-24s %12" PRIu64 " %12.3f %6.2f%% %12.3f %9" PRIu64 " %14" PRIu64 " %14" PRIu64 "\n",
+               proto_get_protocol_filter_name(entry->proto_id),
+               entry->calls,
+               entry->exclusive_ns / 1e6,
+               total_ns ? 100.0 * entry->exclusive_ns / total_ns : 0.0,
+               entry->inclusive_ns / 1e6,
+               entry->exclusive_ns / entry->calls,
+               entry->exclusive_bytes,
+               entry->inclusive_bytes);
+    }
+
+    /*
+     * How well the heuristic lists are doing: dissectors near the front of
+     * a list that rarely match, or that the pre-screen could skip, cost
+     * every packet that ends up at one further down.
+     */
+    printf("\nHeuristic dissector lists, in trial order. Screened dissectors were skipped by their pre-screen.\n\n");
+    printf("%-24s %12s %12s %12s %12s\n", "List", "Calls", "Tries", "Hits", "Screened");
+    printf("  %-22s\n", "Dissector");
+    dissector_all_heur_tables_foreach_table(heur_list_draw, NULL, (GCompareFunc)strcmp);
+    printf("=========================================================================================================\n");
+
+    g_array_free(stats, true);
+}
+
+static void
+dissector_profile_finish(void *tapdata _U_)
+{
+    dissector_profile_enable(false);
+}
+
+static void
+dissector_profile_init(const char *opt_arg, void *userdata _U_)
+{
+    GString *error_string;
+
+    if (strcmp(opt_arg, "dissector-profile") != 0) {
+        cmdarg_err("invalid \"-z dissector-profile\" argument");
+        exit(1);
+    }
+
+    /*
+     * The listener only asks for the report at the end; the figures are
+     * gathered by packet.c for every dissector call.
+     */
+    error_string = register_tap_listener("frame", &dissector_profile_tapdata, NULL, TL_REQUIRES_NOTHING,
+                                         NULL, NULL, dissector_profile_draw,
+                                         dissector_profile_finish);
+    if (error_string) {
+        cmdarg_err("Couldn't register dissector-profile tap: %s",
+                   error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+
+    dissector_profile_reset();
+    dissector_profile_enable(true);
+}
+
+static stat_tap_ui dissector_profile_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "dissector-profile",
+    dissector_profile_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_dissector_profile(void)
+{
+    register_stat_tap_ui(&dissector_profile_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
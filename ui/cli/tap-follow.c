@@ -117,7 +117,7 @@ follow_free(follow_info_t *follow_info)
 static const char       bin2hex[] = {'0', '1', '2', '3', '4', '5', '6', '7',
                                      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
 
-static void follow_print_hex(const char *prefixp, uint32_t offset, void *datap, int len)
+static void follow_print_hex(const char *prefixp, uint32_t offset, const void *datap, int len)
 {
   int           ii;
   int           jj;
@@ -141,7 +141,7 @@ static void follow_print_hex(const char *prefixp, uint32_t offset, void *datap,
       kk = ASCII_START;
     }
 
-    val = ((uint8_t *)datap)[ii];
+    val = ((const uint8_t *)datap)[ii];
 
     line[jj++] = bin2hex[val >> 4];
     line[jj++] = bin2hex[val & 0xf];
@@ -183,9 +183,9 @@ static void follow_draw(void *contextp)
   uint32_t          ii, jj;
   char              *buffer;
   wmem_strbuf_t     *strbuf;
-  GList             *cur;
-  follow_record_t   *follow_record;
-  unsigned          chunk;
+  const follow_store_record_t *follow_record;
+  const uint8_t     *data;
+  unsigned          count, chunk;
   char              *b64encoded;
   const uint32_t    base64_raw_len = 57; /* Encodes to 76 bytes, common in RFCs */
 
@@ -224,23 +224,28 @@ static void follow_draw(void *contextp)
       break;
   }
 
-  for (cur = g_list_last(follow_info->payload), chunk = 1;
-       cur != NULL;
-       cur = g_list_previous(cur), chunk++)
+  count = follow_store_count(follow_info->payload);
+  for (chunk = 1; chunk <= count && chunk <= cli_follow_info->chunkMax; chunk++)
   {
-    follow_record = (follow_record_t *)cur->data;
+    follow_record = follow_store_get_record(follow_info->payload, chunk - 1);
     if (!follow_record->is_server) {
       global_pos = &global_client_pos;
     } else {
       global_pos = &global_server_pos;
     }
 
-    /* ignore chunks not in range */
-    if ((chunk < cli_follow_info->chunkMin) || (chunk > cli_follow_info->chunkMax)) {
-      (*global_pos) += follow_record->data->len;
+    /* ignore chunks not in range, without reading their data */
+    if (chunk < cli_follow_info->chunkMin) {
+      (*global_pos) += follow_record->len;
       continue;
     }
 
+    data = follow_store_get_data(follow_info->payload, chunk - 1);
+    if (data == NULL) {
+      fprintf(stderr, "tshark: follow - could not read the data of frame %u\n", follow_record->packet_num);
+      break;
+    }
+
     /* Print start of line */
     switch (cli_follow_info->show_type)
     {
@@ -251,7 +256,7 @@ static void follow_draw(void *contextp)
 
     case SHOW_ASCII:
     case SHOW_EBCDIC:
-      printf("%s%u\n", follow_record->is_server ? "\t" : "", follow_record->data->len);
+      printf("%s%u\n", follow_record->is_server ? "\t" : "", follow_record->len);
       break;
 
     case SHOW_RAW:
@@ -269,17 +274,17 @@ static void follow_draw(void *contextp)
     switch (cli_follow_info->show_type)
     {
     case SHOW_HEXDUMP:
-      follow_print_hex(follow_record->is_server ? "\t" : "", *global_pos, follow_record->data->data, follow_record->data->len);
-      (*global_pos) += follow_record->data->len;
+      follow_print_hex(follow_record->is_server ? "\t" : "", *global_pos, data, follow_record->len);
+      (*global_pos) += follow_record->len;
       break;
 
     case SHOW_ASCII:
     case SHOW_EBCDIC:
-      buffer = (char *)g_malloc(follow_record->data->len+2);
+      buffer = (char *)g_malloc(follow_record->len+2);
 
-      for (ii = 0; ii < follow_record->data->len; ii++)
+      for (ii = 0; ii < follow_record->len; ii++)
       {
-        switch (follow_record->data->data[ii])
+        switch (data[ii])
         {
         // XXX: qt/follow_stream_dialog.c sanitize_buffer() also passes
         // tabs ('\t') through. Should we do that here too?
@@ -289,10 +294,10 @@ static void follow_draw(void *contextp)
         // Unix line endings, including on Windows.)
         case '\r':
         case '\n':
-          buffer[ii] = follow_record->data->data[ii];
+          buffer[ii] = data[ii];
           break;
         default:
-          buffer[ii] = g_ascii_isprint(follow_record->data->data[ii]) ? follow_record->data->data[ii] : '.';
+          buffer[ii] = g_ascii_isprint(data[ii]) ? data[ii] : '.';
           break;
         }
       }
@@ -313,7 +318,7 @@ static void follow_draw(void *contextp)
       // REPLACEMENT CHARACTER, and not handling valid UTF-8 sequences
       // which are split between unreassembled frames), except for the
       // end of line terminator issue as above.
-      strbuf = ws_utf8_make_valid_strbuf(NULL, follow_record->data->data, follow_record->data->len);
+      strbuf = ws_utf8_make_valid_strbuf(NULL, data, follow_record->len);
       printf("%s%zu\n", follow_record->is_server ? "\t" : "", wmem_strbuf_get_len(strbuf));
       fwrite(wmem_strbuf_get_str(strbuf), 1, wmem_strbuf_get_len(strbuf), stdout);
       wmem_strbuf_destroy(strbuf);
@@ -321,12 +326,12 @@ static void follow_draw(void *contextp)
       break;
 
     case SHOW_RAW:
-      buffer = (char *)g_malloc((follow_record->data->len*2)+2);
+      buffer = (char *)g_malloc((follow_record->len*2)+2);
 
-      for (ii = 0, jj = 0; ii < follow_record->data->len; ii++)
+      for (ii = 0, jj = 0; ii < follow_record->len; ii++)
       {
-        buffer[jj++] = bin2hex[follow_record->data->data[ii] >> 4];
-        buffer[jj++] = bin2hex[follow_record->data->data[ii] & 0xf];
+        buffer[jj++] = bin2hex[data[ii] >> 4];
+        buffer[jj++] = bin2hex[data[ii] & 0xf];
       }
 
       buffer[jj++] = '\n';
@@ -341,11 +346,11 @@ static void follow_draw(void *contextp)
       printf("    timestamp: %.9f\n", nstime_to_sec(&follow_record->abs_ts));
       printf("    data: !!binary |\n");
       ii = 0;
-      while (ii < follow_record->data->len) {
-          uint32_t len = ii + base64_raw_len < follow_record->data->len
+      while (ii < follow_record->len) {
+          uint32_t len = ii + base64_raw_len < follow_record->len
                 ? base64_raw_len
-                : follow_record->data->len - ii;
-          b64encoded = g_base64_encode(&follow_record->data->data[ii], len);
+                : follow_record->len - ii;
+          b64encoded = g_base64_encode(&data[ii], len);
           printf("      %s\n", b64encoded);
           g_free(b64encoded);
           ii += len;
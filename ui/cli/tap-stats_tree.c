@@ -131,7 +131,7 @@ free_tree_presentation(stats_tree *st)
 void
 register_tap_listener_stats_tree_stat(void)
 {
-	stats_tree_presentation(register_stats_tree_tap, NULL,
+	stats_tree_presentation(register_stats_tree_tap, NULL, NULL,
                 free_tree_presentation, NULL);
 }
 
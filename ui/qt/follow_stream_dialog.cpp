@@ -1183,8 +1183,9 @@ void FollowStreamDialog::readFollowStream()
     uint32_t global_client_pos = 0, global_server_pos = 0;
     uint32_t *global_pos;
     bool skip;
-    GList* cur;
-    follow_record_t *follow_record;
+    const follow_store_record_t *follow_record;
+    const uint8_t *data;
+    unsigned count;
     QElapsedTimer elapsed_timer;
     QByteArray buffer;
 
@@ -1194,10 +1195,11 @@ void FollowStreamDialog::readFollowStream()
     isReadRunning = true;
     loop_break_mutex.unlock();
 
-    for (cur = g_list_last(follow_info_.payload); cur; cur = g_list_previous(cur)) {
+    count = follow_store_count(follow_info_.payload);
+    for (unsigned i = 0; i < count; i++) {
         if (dialogClosed() || !isReadRunning) break;
 
-        follow_record = (follow_record_t *)cur->data;
+        follow_record = follow_store_get_record(follow_info_.payload, i);
         skip = false;
         if (!follow_record->is_server) {
             global_pos = &global_client_pos;
@@ -1212,13 +1214,19 @@ void FollowStreamDialog::readFollowStream()
         }
 
         if (!skip) {
+            // Records of large streams are read back from a temporary file
+            // one at a time, so only the ones that are shown are read.
+            data = follow_store_get_data(follow_info_.payload, i);
+            if (!data) {
+                break;
+            }
             // This will only detach / deep copy if the buffer data is
             // modified. Try to avoid doing that as much as possible
             // (and avoid new memory allocations that have to be freed).
-            buffer.setRawData((char*)follow_record->data->data, follow_record->data->len);
+            buffer.setRawData((const char*)data, follow_record->len);
             showBuffer(
                     buffer,
-                    follow_record->data->len,
+                    follow_record->len,
                     follow_record->is_server,
                     follow_record->packet_num,
                     follow_record->abs_ts,
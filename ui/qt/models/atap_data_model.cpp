@@ -38,6 +38,7 @@ ATapDataModel::ATapDataModel(dataModelType type, int protoId, QString filter, QO
 {
     hash_.conv_array = nullptr;
     hash_.hashtable = nullptr;
+    hash_.addresses = nullptr;
     hash_.user_data = this;
 
     storage_ = nullptr;
@@ -99,6 +99,13 @@ void StatsTreeDialog::setupNode(stat_node* node)
     }
 }
 
+// Removes the items of a node and its children, which are about to be freed
+void StatsTreeDialog::freeNode(stat_node* node)
+{
+    delete (QTreeWidgetItem *) node->pr;
+    node->pr = NULL;
+}
+
 void StatsTreeDialog::fillTree()
 {
     if (!st_cfg_ || file_closed_) return;
@@ -200,6 +207,7 @@ register_tap_listener_qt_stats_tree_stat(void)
 {
     stats_tree_presentation(NULL,
                 StatsTreeDialog::setupNode,
+                StatsTreeDialog::freeNode,
                 NULL, NULL);
 }
 
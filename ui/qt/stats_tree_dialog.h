@@ -28,6 +28,7 @@ public:
     explicit StatsTreeDialog(QWidget &parent, CaptureFile &cf, const char *cfg_abbr);
     ~StatsTreeDialog();
     static void setupNode(stat_node* node);
+    static void freeNode(stat_node* node);
 
 private:
     struct _tree_cfg_pres cfg_pr_;
@@ -30,6 +30,8 @@
 
 #include <wsutil/filesystem.h>
 
+#include <wiretap/wtap.h>
+
 #include "ui/util.h"
 
 /*
@@ -412,3 +414,19 @@ get_open_dialog_initial_dir(void)
     }
     return initial_dir;
 }
+
+void
+list_output_compression_types(const char *progname, FILE *stream)
+{
+    GSList *output_compression_types;
+
+    fprintf(stream, "%s: The available output compression type(s) for the \"--compress\" flag are:\n", progname);
+    output_compression_types = wtap_get_all_output_compression_type_names_list();
+    for (GSList *compression_type = output_compression_types;
+        compression_type != NULL;
+        compression_type = g_slist_next(compression_type)) {
+            fprintf(stream, "   %s\n", (const char *)compression_type->data);
+        }
+
+    g_slist_free(output_compression_types);
+}
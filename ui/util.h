@@ -12,6 +12,8 @@
 #ifndef __UTIL_H__
 #define __UTIL_H__
 
+#include <stdio.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -62,6 +64,14 @@ extern void set_last_open_dir(const char *dirname);
  */
 extern const char *get_open_dialog_initial_dir(void);
 
+/** Print the compression types that can be given to "--compress",
+ * one per line, after a heading naming the program.
+ *
+ * @param progname the program name used in the heading
+ * @param stream where to print the list
+ */
+extern void list_output_compression_types(const char *progname, FILE *stream);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -2125,7 +2125,7 @@ wtap_dump_can_open(int file_type_subtype)
  * Return whether we know how to write a compressed file of the specified
  * file type.
  */
-#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
+#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG) || defined (HAVE_ZSTD) || defined (USE_LZ4)
 bool
 wtap_dump_can_compress(int file_type_subtype)
 {
@@ -2208,7 +2208,8 @@ wtap_dump_init_dumper(int file_type_subtype, wtap_compression_type compression_t
 	 * already written.
 	 */
 	if (compression_type != WTAP_UNCOMPRESSED &&
-	    !wtap_dump_can_compress(file_type_subtype)) {
+	    (!wtap_dump_can_compress(file_type_subtype) ||
+	     !wtap_can_write_compression_type(compression_type))) {
 		*err = WTAP_ERR_COMPRESSION_NOT_SUPPORTED;
 		return NULL;
 	}
@@ -2224,6 +2225,8 @@ wtap_dump_init_dumper(int file_type_subtype, wtap_compression_type compression_t
 	wdh->snaplen = params->snaplen;
 	wdh->file_encap = params->encap;
 	wdh->compression_type = compression_type;
+	wdh->compression_level = params->compression_level;
+	wdh->compression_threads = params->compression_threads;
 	wdh->wslua_data = NULL;
 	wdh->shb_iface_to_global = params->shb_iface_to_global;
 	wdh->interface_data = g_array_new(false, false, sizeof(wtap_block_t));
@@ -2530,6 +2533,22 @@ wtap_dump_flush(wtap_dumper *wdh, int *err)
 			return false;
 		}
 	} else
+#endif
+#ifdef HAVE_ZSTD
+	if (wdh->compression_type == WTAP_ZSTD_COMPRESSED) {
+		if (zstdwfile_flush((ZSTDWFILE_T)wdh->fh) == -1) {
+			*err = zstdwfile_geterr((ZSTDWFILE_T)wdh->fh);
+			return false;
+		}
+	} else
+#endif
+#ifdef USE_LZ4
+	if (wdh->compression_type == WTAP_LZ4_COMPRESSED) {
+		if (lz4wfile_flush((LZ4WFILE_T)wdh->fh) == -1) {
+			*err = lz4wfile_geterr((LZ4WFILE_T)wdh->fh);
+			return false;
+		}
+	} else
 #endif
 	{
 		if (fflush((FILE *)wdh->fh) == EOF) {
@@ -2657,42 +2676,50 @@ wtap_dump_discard_sysdig_meta_events(wtap_dumper *wdh)
 }
 
 /* internally open a file for writing (compressed or not) */
-#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
 static WFILE_T
 wtap_dump_file_open(wtap_dumper *wdh, const char *filename)
 {
-	if (wdh->compression_type == WTAP_GZIP_COMPRESSED) {
+	switch (wdh->compression_type) {
+#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
+	case WTAP_GZIP_COMPRESSED:
 		return gzwfile_open(filename);
-	} else {
+#endif
+#ifdef HAVE_ZSTD
+	case WTAP_ZSTD_COMPRESSED:
+		return zstdwfile_open(filename, wdh->compression_level,
+		    wdh->compression_threads);
+#endif
+#ifdef USE_LZ4
+	case WTAP_LZ4_COMPRESSED:
+		return lz4wfile_open(filename, wdh->compression_level);
+#endif
+	default:
 		return ws_fopen(filename, "wb");
 	}
 }
-#else
-static WFILE_T
-wtap_dump_file_open(wtap_dumper *wdh _U_, const char *filename)
-{
-	return ws_fopen(filename, "wb");
-}
-#endif
 
 /* internally open a file for writing (compressed or not) */
-#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
 static WFILE_T
 wtap_dump_file_fdopen(wtap_dumper *wdh, int fd)
 {
-	if (wdh->compression_type == WTAP_GZIP_COMPRESSED) {
+	switch (wdh->compression_type) {
+#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
+	case WTAP_GZIP_COMPRESSED:
 		return gzwfile_fdopen(fd);
-	} else {
+#endif
+#ifdef HAVE_ZSTD
+	case WTAP_ZSTD_COMPRESSED:
+		return zstdwfile_fdopen(fd, wdh->compression_level,
+		    wdh->compression_threads);
+#endif
+#ifdef USE_LZ4
+	case WTAP_LZ4_COMPRESSED:
+		return lz4wfile_fdopen(fd, wdh->compression_level);
+#endif
+	default:
 		return ws_fdopen(fd, "wb");
 	}
 }
-#else
-static WFILE_T
-wtap_dump_file_fdopen(wtap_dumper *wdh _U_, int fd)
-{
-	return ws_fdopen(fd, "wb");
-}
-#endif
 
 /* internally writing raw bytes (compressed or not). Updates wdh->bytes_dumped on success */
 bool
@@ -2711,6 +2738,30 @@ wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err
 			return false;
 		}
 	} else
+#endif
+#ifdef HAVE_ZSTD
+	if (wdh->compression_type == WTAP_ZSTD_COMPRESSED) {
+		nwritten = zstdwfile_write((ZSTDWFILE_T)wdh->fh, buf, (unsigned int) bufsize);
+		/*
+		 * zstdwfile_write() returns 0 on error.
+		 */
+		if (nwritten == 0) {
+			*err = zstdwfile_geterr((ZSTDWFILE_T)wdh->fh);
+			return false;
+		}
+	} else
+#endif
+#ifdef USE_LZ4
+	if (wdh->compression_type == WTAP_LZ4_COMPRESSED) {
+		nwritten = lz4wfile_write((LZ4WFILE_T)wdh->fh, buf, (unsigned int) bufsize);
+		/*
+		 * lz4wfile_write() returns 0 on error.
+		 */
+		if (nwritten == 0) {
+			*err = lz4wfile_geterr((LZ4WFILE_T)wdh->fh);
+			return false;
+		}
+	} else
 #endif
 	{
 		errno = WTAP_ERR_CANT_WRITE;
@@ -2739,6 +2790,16 @@ wtap_dump_file_close(wtap_dumper *wdh)
 	if (wdh->compression_type == WTAP_GZIP_COMPRESSED)
 		return gzwfile_close((GZWFILE_T)wdh->fh);
 	else
+#endif
+#ifdef HAVE_ZSTD
+	if (wdh->compression_type == WTAP_ZSTD_COMPRESSED)
+		return zstdwfile_close((ZSTDWFILE_T)wdh->fh);
+	else
+#endif
+#ifdef USE_LZ4
+	if (wdh->compression_type == WTAP_LZ4_COMPRESSED)
+		return lz4wfile_close((LZ4WFILE_T)wdh->fh);
+	else
 #endif
 		return fclose((FILE *)wdh->fh);
 }
@@ -2746,7 +2807,7 @@ wtap_dump_file_close(wtap_dumper *wdh)
 int64_t
 wtap_dump_file_seek(wtap_dumper *wdh, int64_t offset, int whence, int *err)
 {
-#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
+#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG) || defined (HAVE_ZSTD) || defined (USE_LZ4)
 	if (wdh->compression_type != WTAP_UNCOMPRESSED) {
 		*err = WTAP_ERR_CANT_SEEK_COMPRESSED;
 		return -1;
@@ -2767,7 +2828,7 @@ int64_t
 wtap_dump_file_tell(wtap_dumper *wdh, int *err)
 {
 	int64_t rval;
-#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
+#if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG) || defined (HAVE_ZSTD) || defined (USE_LZ4)
 	if (wdh->compression_type != WTAP_UNCOMPRESSED) {
 		*err = WTAP_ERR_CANT_SEEK_COMPRESSED;
 		return -1;
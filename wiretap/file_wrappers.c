@@ -44,33 +44,45 @@ typedef zng_stream zlib_stream;
 #include <zstd.h>
 #endif /* HAVE_ZSTD */
 
-#ifdef HAVE_LZ4
+/* USE_LZ4 is defined in file_wrappers.h */
+#ifdef USE_LZ4
 #include <lz4.h>
-
-#if LZ4_VERSION_NUMBER >= 10703
-#define USE_LZ4
 #include <lz4frame.h>
-#endif /* LZ4_VERSION_NUMBER >= 10703 */
-#endif /* HAVE_LZ4 */
+#include <lz4hc.h>
+
+#ifndef LZ4HC_CLEVEL_MAX
+/* lz4 1.7.x named it differently. */
+#define LZ4HC_CLEVEL_MAX LZ4HC_MAX_CLEVEL
+#endif
+
+/*
+ * lz4 clamps acceleration factors to LZ4_ACCELERATION_MAX, which is
+ * private to lz4.c; this is its value there since lz4 1.9.3.  Older
+ * versions don't cap the factor, so higher ones just aren't any faster.
+ */
+#define WTAP_LZ4_ACCELERATION_MAX 65537
+#endif /* USE_LZ4 */
 
 /*
- * List of compression types supported.
+ * List of compression types supported.  We can write every type that we
+ * can read.
  */
 static struct compression_type {
     wtap_compression_type  type;
     const char            *extension;
     const char            *description;
+    const char            *name;
 } compression_types[] = {
 #ifdef USE_ZLIB_OR_ZLIBNG
-    { WTAP_GZIP_COMPRESSED, "gz", "gzip compressed" },
+    { WTAP_GZIP_COMPRESSED, "gz", "gzip compressed", "gzip" },
 #endif /* USE_ZLIB_OR_ZLIBNG */
 #ifdef HAVE_ZSTD
-    { WTAP_ZSTD_COMPRESSED, "zst", "zstd compressed" },
+    { WTAP_ZSTD_COMPRESSED, "zst", "zstd compressed", "zstd" },
 #endif /* HAVE_ZSTD */
 #ifdef USE_LZ4
-    { WTAP_LZ4_COMPRESSED, "lz4", "lz4 compressed" },
+    { WTAP_LZ4_COMPRESSED, "lz4", "lz4 compressed", "lz4" },
 #endif /* USE_LZ4 */
-    { WTAP_UNCOMPRESSED, NULL, NULL }
+    { WTAP_UNCOMPRESSED, NULL, NULL, "none" }
 };
 
 static wtap_compression_type file_get_compression_type(FILE_T stream);
@@ -117,6 +129,92 @@ wtap_get_all_compression_type_extensions_list(void)
 	return extensions;
 }
 
+const char *
+wtap_compression_type_name(wtap_compression_type compression_type)
+{
+	/* This includes the "none" entry for WTAP_UNCOMPRESSED. */
+	for (struct compression_type *p = compression_types; ; p++) {
+		if (p->type == compression_type)
+			return p->name;
+		if (p->type == WTAP_UNCOMPRESSED)
+			break;
+	}
+	return NULL;
+}
+
+wtap_compression_type
+wtap_name_to_compression_type(const char *name)
+{
+	for (struct compression_type *p = compression_types; ; p++) {
+		if (g_ascii_strcasecmp(name, p->name) == 0)
+			return p->type;
+		if (p->type == WTAP_UNCOMPRESSED)
+			break;
+	}
+	return WTAP_UNKNOWN_COMPRESSION;
+}
+
+bool
+wtap_can_write_compression_type(wtap_compression_type compression_type)
+{
+	for (struct compression_type *p = compression_types; ; p++) {
+		if (p->type == compression_type)
+			return true;
+		if (p->type == WTAP_UNCOMPRESSED)
+			break;
+	}
+	return false;
+}
+
+bool
+wtap_compression_type_level_range(wtap_compression_type compression_type,
+    int *min_level, int *max_level)
+{
+	switch (compression_type) {
+
+#ifdef HAVE_ZSTD
+	case WTAP_ZSTD_COMPRESSED:
+		/* Negative levels trade ratio for speed. */
+#if ZSTD_VERSION_NUMBER >= 10400
+		*min_level = ZSTD_minCLevel();
+#else /* ZSTD_VERSION_NUMBER >= 10400 */
+		*min_level = 1;
+#endif /* ZSTD_VERSION_NUMBER >= 10400 */
+		*max_level = ZSTD_maxCLevel();
+		return true;
+#endif /* HAVE_ZSTD */
+
+#ifdef USE_LZ4
+	case WTAP_LZ4_COMPRESSED:
+		/*
+		 * Negative levels are LZ4 "fast acceleration" factors; 3 and
+		 * above use LZ4 HC.
+		 */
+		*min_level = -WTAP_LZ4_ACCELERATION_MAX;
+		*max_level = LZ4HC_CLEVEL_MAX;
+		return true;
+#endif /* USE_LZ4 */
+
+	default:
+		/* The gzip writer always uses zlib's default level. */
+		return false;
+	}
+}
+
+GSList *
+wtap_get_all_output_compression_type_names_list(void)
+{
+	GSList *names;
+
+	names = NULL;	/* empty list, to start with */
+
+	for (struct compression_type *p = compression_types;
+	    p->type != WTAP_UNCOMPRESSED; p++)
+		names = g_slist_prepend(names, (void *)p->name);
+
+	return names;
+}
+
 /* #define GZBUFSIZE 8192 */
 #define GZBUFSIZE 4096
 
@@ -204,6 +302,10 @@ struct wtap_reader {
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+
+    /* observer of the raw data read from the file */
+    wtap_raw_read_callback_t raw_read_cb;
+    void *raw_read_cb_data;
 };
 
 /* Current read offset within a buffer. */
@@ -275,6 +377,8 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
     }
     if (ret == 0)
         state->eof = true;
+    else if (state->raw_read_cb)
+        state->raw_read_cb(read_ptr, (size_t)ret, state->raw_pos, state->raw_read_cb_data);
     state->raw_pos += ret;
     buf->avail += (unsigned)ret;
     return 0;
@@ -292,6 +396,27 @@ fill_in_buffer(FILE_T state)
     return 0;
 }
 
+/*
+ * Make sure at least n bytes are available in the input buffer, unless
+ * we hit EOF first.  Unlike fill_in_buffer(), this can be called when
+ * the input buffer isn't empty; any unconsumed data is moved to the
+ * beginning of the buffer first, so that buf_read() appends to it
+ * rather than discarding it.
+ */
+static int
+fill_in_buffer_min(FILE_T state, unsigned n)
+{
+    while (state->in.avail < n && !state->eof) {
+        if (state->in.next != state->in.buf) {
+            memmove(state->in.buf, state->in.next, state->in.avail);
+            state->in.next = state->in.buf;
+        }
+        if (fill_in_buffer(state) == -1)
+            return -1;
+    }
+    return 0;
+}
+
 #define ZLIB_WINSIZE 32768
 
 struct fast_seek_point {
@@ -365,6 +490,52 @@ fast_seek_header(FILE_T file, int64_t in_pos, int64_t out_pos,
     }
 }
 
+#if defined(HAVE_ZSTD) || defined(USE_LZ4)
+/*
+ * Add a fast seek point at the beginning of a zstd or lz4 frame.
+ *
+ * Frames are decompressed independently of each other, so all we need
+ * to restart decompression at a frame is its offset in the file and
+ * the corresponding offset in the uncompressed data; no dictionary or
+ * window has to be saved, so we don't allocate space for one.
+ *
+ * As with zlib, we only add a point if it's at least SPAN bytes past
+ * the previous one, so that files written as many small frames don't
+ * end up with an enormous seek table.
+ */
+static void
+fast_seek_frame_add(FILE_T file, int64_t in_pos, int64_t out_pos,
+                    compression_t compression)
+{
+    struct fast_seek_point *item = NULL;
+
+    if (file->fast_seek->len != 0)
+        item = (struct fast_seek_point *)file->fast_seek->pdata[file->fast_seek->len - 1];
+
+    if (!item || item->out + SPAN < out_pos) {
+        struct fast_seek_point *val = (struct fast_seek_point *)g_malloc(offsetof(struct fast_seek_point, data));
+        val->in = in_pos;
+        val->out = out_pos;
+        val->compression = compression;
+
+        g_ptr_array_add(file->fast_seek, val);
+    }
+}
+#endif /* HAVE_ZSTD || USE_LZ4 */
+
+/*
+ * Is this the magic number of a skippable frame?  Both the zstd and
+ * lz4 frame formats define skippable frames with magic numbers
+ * 0x184D2A50 through 0x184D2A5F, which can be used to hold metadata
+ * such as a seek table; their decompressors silently skip them.
+ */
+static bool
+is_skippable_frame_magic(const uint8_t *magic)
+{
+    return (magic[0] & 0xf0) == 0x50 && magic[1] == 0x2a
+        && magic[2] == 0x4d && magic[3] == 0x18;
+}
+
 static void
 fast_seek_reset(
 #ifdef HAVE_ZLIB
@@ -925,13 +1096,32 @@ zstd_fill_out_buffer(FILE_T state)
 static int
 check_for_zstd_compression(FILE_T state)
 {
+    bool skippable;
+
+    /*
+     * We might be at a frame boundary in the middle of the input
+     * buffer, so make sure we have the entire magic number.
+     */
+    if (fill_in_buffer_min(state, 4) == -1)
+        return -1;
+    if (state->in.avail < 4)
+        return 0;
+
+    /*
+     * A skippable frame following a Zstandard frame is part of the
+     * Zstandard stream (e.g., a seek table); hand it to the
+     * decompressor, which will skip it.
+     */
+    skippable = state->last_compression == ZSTD &&
+        is_skippable_frame_magic(state->in.next);
+
     /*
      * Look for the Zstandard header, and, if we find it, return
      * success if we support Zstandard and an error if we don't.
      */
-    if (state->in.avail >= 4
-        && state->in.buf[0] == 0x28 && state->in.buf[1] == 0xb5
-        && state->in.buf[2] == 0x2f && state->in.buf[3] == 0xfd) {
+    if (skippable
+        || (state->in.next[0] == 0x28 && state->in.next[1] == 0xb5
+            && state->in.next[2] == 0x2f && state->in.next[3] == 0xfd)) {
 #ifdef HAVE_ZSTD
         const size_t ret = ZSTD_initDStream(state->zstd_dctx);
         if (ZSTD_isError(ret)) {
@@ -940,6 +1130,13 @@ check_for_zstd_compression(FILE_T state)
             return -1;
         }
 
+        /*
+         * Each frame can be decompressed on its own, so remember
+         * where it starts.
+         */
+        if (state->fast_seek && !skippable)
+            fast_seek_frame_add(state, state->raw_pos - state->in.avail, state->pos, ZSTD);
+
         state->compression = ZSTD;
         state->is_compressed = true;
         return 1;
@@ -999,13 +1196,31 @@ lz4_fill_out_buffer(FILE_T state)
 static int
 check_for_lz4_compression(FILE_T state)
 {
+    bool skippable;
+
+    /*
+     * We might be at a frame boundary in the middle of the input
+     * buffer, so make sure we have the entire magic number.
+     */
+    if (fill_in_buffer_min(state, 4) == -1)
+        return -1;
+    if (state->in.avail < 4)
+        return 0;
+
+    /*
+     * As with Zstandard, a skippable frame following an lz4 frame
+     * is handed to the decompressor, which will skip it.
+     */
+    skippable = state->last_compression == LZ4 &&
+        is_skippable_frame_magic(state->in.next);
+
     /*
      * Look for the lz4 header, and, if we find it, return success
      * if we support lz4 and an error if we don't.
      */
-    if (state->in.avail >= 4
-        && state->in.buf[0] == 0x04 && state->in.buf[1] == 0x22
-        && state->in.buf[2] == 0x4d && state->in.buf[3] == 0x18) {
+    if (skippable
+        || (state->in.next[0] == 0x04 && state->in.next[1] == 0x22
+            && state->in.next[2] == 0x4d && state->in.next[3] == 0x18)) {
 #ifdef USE_LZ4
 #if LZ4_VERSION_NUMBER >= 10800
         LZ4F_resetDecompressionContext(state->lz4_dctx);
@@ -1018,6 +1233,9 @@ check_for_lz4_compression(FILE_T state)
             return -1;
         }
 #endif /* LZ4_VERSION_NUMBER >= 10800 */
+        if (state->fast_seek && !skippable)
+            fast_seek_frame_add(state, state->raw_pos - state->in.avail, state->pos, LZ4);
+
         state->compression = LZ4;
         state->is_compressed = true;
         return 1;
@@ -1463,6 +1681,13 @@ file_set_random_access(FILE_T stream, bool random_flag _U_, GPtrArray *seek)
     stream->fast_seek = seek;
 }
 
+void
+file_set_raw_read_cb(FILE_T stream, wtap_raw_read_callback_t cb, void *user_data)
+{
+    stream->raw_read_cb = cb;
+    stream->raw_read_cb_data = user_data;
+}
+
 int64_t
 file_seek(FILE_T file, int64_t offset, int whence, int *err)
 {
@@ -1598,6 +1823,10 @@ file_seek(FILE_T file, int64_t offset, int whence, int *err)
             off2 = here->out;
         } else
 #endif /* USE_ZLIB_OR_ZLIBNG */
+        if (here->compression == ZSTD || here->compression == LZ4) {
+            off = here->in;
+            off2 = here->out;
+        } else
         {
             off2 = (file->pos + offset);
             off = here->in + (off2 - here->out);
@@ -1648,6 +1877,14 @@ file_seek(FILE_T file, int64_t offset, int whence, int *err)
             file->compression = ZLIB;
         } else
 #endif /* USE_ZLIB_OR_ZLIBNG */
+        if (here->compression == ZSTD || here->compression == LZ4) {
+            /*
+             * We're at the beginning of a frame; have the frame header
+             * checked again, which resets the decompression context.
+             */
+            file->compression = UNKNOWN;
+            file->last_compression = here->compression;
+        } else
             file->compression = here->compression;
 
         offset = (file->pos + offset) - off2;
@@ -2400,6 +2637,513 @@ gzwfile_geterr(GZWFILE_T state)
 }
 #endif /* USE_ZLIB_OR_ZLIBNG */
 
+#if defined(HAVE_ZSTD) || defined(USE_LZ4)
+/*
+ * zstd and lz4 compressed files are written as a sequence of
+ * independently-decompressible frames, each holding at most
+ * WRITER_FRAME_SIZE bytes of uncompressed data, so that a reader
+ * can start decompressing at any frame boundary rather than at
+ * the beginning of the file.  The frames are large enough that
+ * the effect on the compression ratio is negligible.
+ */
+#define WRITER_FRAME_SIZE (4 * 1048576)
+
+/* Write out len bytes of compressed data.  Return -1, and set *err,
+   on failure; return 0 on success. */
+static int
+wfile_write_out(int fd, const void *buf, size_t len, int *err)
+{
+    ssize_t got;
+
+    if (len == 0)
+        return 0;
+    got = ws_write(fd, buf, (unsigned int)len);
+    if (got < 0) {
+        *err = errno;
+        return -1;
+    }
+    if ((size_t)got != len) {
+        *err = WTAP_ERR_SHORT_WRITE;
+        return -1;
+    }
+    return 0;
+}
+#endif /* HAVE_ZSTD || USE_LZ4 */
+
+#ifdef HAVE_ZSTD
+/*
+ * After the last frame, we write a seek table in the format used by
+ * the zstd "seekable" library (contrib/seekable_format in the zstd
+ * source), i.e. a skippable frame listing the compressed and
+ * uncompressed size of each frame.  Decompressors that don't know
+ * about it just skip it.
+ *
+ * Our own reader is one of them: it doesn't load the table when the
+ * file is opened, it finds frame starts as it reads through the file
+ * (see fast_seek_frame_add()).  The table is there for tools built on
+ * the seekable library.
+ */
+#define ZSTD_SEEKTABLE_SKIPPABLE_MAGIC 0x184D2A5E
+#define ZSTD_SEEKTABLE_FOOTER_MAGIC    0x8F92EAB1
+
+struct zstd_seek_entry {
+    uint32_t compressed_size;
+    uint32_t decompressed_size;
+};
+
+/* internal zstd file state data structure for writing */
+struct zstd_writer {
+    int fd;                 /* file descriptor */
+    int level;              /* compression level */
+    ZSTD_CCtx *cctx;        /* compression context */
+    unsigned char *out;     /* output buffer */
+    size_t out_size;        /* output buffer size */
+    size_t frame_in;        /* uncompressed bytes in the current frame */
+    size_t frame_out;       /* compressed bytes written for the current frame */
+    GArray *seek_table;     /* struct zstd_seek_entry for each finished frame */
+    int err;                /* error code */
+    const char *err_info;   /* additional error information string for some errors */
+};
+
+ZSTDWFILE_T
+zstdwfile_open(const char *path, int level, int threads)
+{
+    int fd;
+    ZSTDWFILE_T state;
+    int save_errno;
+
+    fd = ws_open(path, O_BINARY|O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    if (fd == -1)
+        return NULL;
+    state = zstdwfile_fdopen(fd, level, threads);
+    if (state == NULL) {
+        save_errno = errno;
+        ws_close(fd);
+        errno = save_errno;
+    }
+    return state;
+}
+
+ZSTDWFILE_T
+zstdwfile_fdopen(int fd, int level, int threads)
+{
+    ZSTDWFILE_T state;
+
+    /* allocate zstd_writer structure to return */
+    state = g_try_new0(struct zstd_writer, 1);
+    if (state == NULL)
+        return NULL;
+    state->fd = fd;
+    state->level = level;   /* 0 means "the library's default" */
+
+    state->cctx = ZSTD_createCCtx();
+    state->out_size = ZSTD_CStreamOutSize();
+    state->out = (unsigned char *)g_try_malloc(state->out_size);
+    if (state->cctx == NULL || state->out == NULL) {
+        ZSTD_freeCCtx(state->cctx);
+        g_free(state->out);
+        g_free(state);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+#if ZSTD_VERSION_NUMBER >= 10400
+    /*
+     * Hand compression off to worker threads if asked to.  This
+     * fails if the library was built without multithreading support,
+     * in which case we just compress in this thread.
+     */
+    if (threads > 0)
+        (void)ZSTD_CCtx_setParameter(state->cctx, ZSTD_c_nbWorkers, threads);
+#else /* ZSTD_VERSION_NUMBER >= 10400 */
+    (void)threads;
+#endif /* ZSTD_VERSION_NUMBER >= 10400 */
+    ZSTD_initCStream(state->cctx, state->level);
+
+    state->seek_table = g_array_new(false, false, sizeof(struct zstd_seek_entry));
+    state->err = 0;
+    state->err_info = NULL;
+    return state;
+}
+
+/* Write out whatever the compressor has put into the output buffer. */
+static int
+zstdw_write_out(ZSTDWFILE_T state, ZSTD_outBuffer *output)
+{
+    if (wfile_write_out(state->fd, output->dst, output->pos, &state->err) == -1)
+        return -1;
+    state->frame_out += output->pos;
+    output->pos = 0;
+    return 0;
+}
+
+static int
+zstdw_check(ZSTDWFILE_T state, size_t ret)
+{
+    if (ZSTD_isError(ret)) {
+        state->err = WTAP_ERR_INTERNAL;
+        state->err_info = ZSTD_getErrorName(ret);
+        return -1;
+    }
+    return 0;
+}
+
+/* Finish the current frame, note it in the seek table, and start a
+   new one.  Return -1, and set state->err, on failure; return 0 on
+   success. */
+static int
+zstdw_end_frame(ZSTDWFILE_T state)
+{
+    ZSTD_outBuffer output = {state->out, state->out_size, 0};
+    struct zstd_seek_entry entry;
+    size_t remaining;
+
+    do {
+        remaining = ZSTD_endStream(state->cctx, &output);
+        if (zstdw_check(state, remaining) == -1)
+            return -1;
+        if (zstdw_write_out(state, &output) == -1)
+            return -1;
+    } while (remaining != 0);
+
+    entry.compressed_size = (uint32_t)state->frame_out;
+    entry.decompressed_size = (uint32_t)state->frame_in;
+    g_array_append_val(state->seek_table, entry);
+    state->frame_in = 0;
+    state->frame_out = 0;
+
+    /* Start the next frame with the same parameters. */
+    return zstdw_check(state, ZSTD_initCStream(state->cctx, state->level));
+}
+
+/* Write out len bytes from buf.  Return 0, and set state->err, on
+   failure or on an attempt to write 0 bytes (in which case state->err
+   is 0); return the number of bytes written on success. */
+unsigned
+zstdwfile_write(ZSTDWFILE_T state, const void *buf, unsigned len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    unsigned left = len;
+
+    /* check that there's no error */
+    if (state->err != 0)
+        return 0;
+
+    while (left != 0) {
+        size_t n = WRITER_FRAME_SIZE - state->frame_in;
+        ZSTD_inBuffer input;
+
+        if (n > left)
+            n = left;
+        input.src = p;
+        input.size = n;
+        input.pos = 0;
+        while (input.pos < input.size) {
+            ZSTD_outBuffer output = {state->out, state->out_size, 0};
+
+            if (zstdw_check(state, ZSTD_compressStream(state->cctx, &output, &input)) == -1)
+                return 0;
+            if (zstdw_write_out(state, &output) == -1)
+                return 0;
+        }
+        state->frame_in += n;
+        p += n;
+        left -= (unsigned)n;
+
+        if (state->frame_in == WRITER_FRAME_SIZE && zstdw_end_frame(state) == -1)
+            return 0;
+    }
+    return len;
+}
+
+/* Flush out what we've written so far.  Returns -1, and sets state->err,
+   on failure; returns 0 on success. */
+int
+zstdwfile_flush(ZSTDWFILE_T state)
+{
+    ZSTD_outBuffer output = {state->out, state->out_size, 0};
+    size_t remaining;
+
+    /* check that there's no error */
+    if (state->err != 0)
+        return -1;
+
+    do {
+        remaining = ZSTD_flushStream(state->cctx, &output);
+        if (zstdw_check(state, remaining) == -1)
+            return -1;
+        if (zstdw_write_out(state, &output) == -1)
+            return -1;
+    } while (remaining != 0);
+    return 0;
+}
+
+/* Write the seek table, in a skippable frame, after the last frame. */
+static int
+zstdw_write_seek_table(ZSTDWFILE_T state)
+{
+    GByteArray *table = g_byte_array_new();
+    uint32_t num_frames = state->seek_table->len;
+    uint32_t val;
+    uint8_t descriptor = 0;     /* no per-frame checksums */
+    int ret;
+
+    val = GUINT32_TO_LE(ZSTD_SEEKTABLE_SKIPPABLE_MAGIC);
+    g_byte_array_append(table, (uint8_t *)&val, 4);
+    val = GUINT32_TO_LE(num_frames * 8 + 9);
+    g_byte_array_append(table, (uint8_t *)&val, 4);
+    for (unsigned i = 0; i < num_frames; i++) {
+        struct zstd_seek_entry *entry = &g_array_index(state->seek_table, struct zstd_seek_entry, i);
+
+        val = GUINT32_TO_LE(entry->compressed_size);
+        g_byte_array_append(table, (uint8_t *)&val, 4);
+        val = GUINT32_TO_LE(entry->decompressed_size);
+        g_byte_array_append(table, (uint8_t *)&val, 4);
+    }
+    val = GUINT32_TO_LE(num_frames);
+    g_byte_array_append(table, (uint8_t *)&val, 4);
+    g_byte_array_append(table, &descriptor, 1);
+    val = GUINT32_TO_LE(ZSTD_SEEKTABLE_FOOTER_MAGIC);
+    g_byte_array_append(table, (uint8_t *)&val, 4);
+
+    ret = wfile_write_out(state->fd, table->data, table->len, &state->err);
+    g_byte_array_free(table, true);
+    return ret;
+}
+
+/* Flush out all data written, and close the file.  Returns a Wiretap
+   error on failure; returns 0 on success. */
+int
+zstdwfile_close(ZSTDWFILE_T state)
+{
+    int ret = 0;
+
+    /* finish the last frame (or write an empty one, so that an empty
+       file is still a valid zstd file), and append the seek table */
+    if (state->err == 0 &&
+        (state->frame_in != 0 || state->seek_table->len == 0))
+        (void)zstdw_end_frame(state);
+    if (state->err == 0)
+        (void)zstdw_write_seek_table(state);
+    ret = state->err;
+    ZSTD_freeCCtx(state->cctx);
+    g_free(state->out);
+    g_array_free(state->seek_table, true);
+    if (ws_close(state->fd) == -1 && ret == 0)
+        ret = errno;
+    g_free(state);
+    return ret;
+}
+
+int
+zstdwfile_geterr(ZSTDWFILE_T state)
+{
+    return state->err;
+}
+#endif /* HAVE_ZSTD */
+
+#ifdef USE_LZ4
+#ifndef LZ4F_HEADER_SIZE_MAX
+#define LZ4F_HEADER_SIZE_MAX 19
+#endif /* LZ4F_HEADER_SIZE_MAX */
+
+/* Largest chunk of input handed to LZ4F_compressUpdate() at once */
+#define LZ4_WRITE_CHUNK 65536
+
+/* internal lz4 file state data structure for writing */
+struct lz4_writer {
+    int fd;                 /* file descriptor */
+    LZ4F_cctx *cctx;        /* compression context */
+    LZ4F_preferences_t prefs; /* frame parameters and compression level */
+    unsigned char *out;     /* output buffer */
+    size_t out_size;        /* output buffer size */
+    bool in_frame;          /* true if a frame has been started */
+    bool wrote_frame;       /* true if at least one frame has been started */
+    size_t frame_in;        /* uncompressed bytes in the current frame */
+    int err;                /* error code */
+    const char *err_info;   /* additional error information string for some errors */
+};
+
+LZ4WFILE_T
+lz4wfile_open(const char *path, int level)
+{
+    int fd;
+    LZ4WFILE_T state;
+    int save_errno;
+
+    fd = ws_open(path, O_BINARY|O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    if (fd == -1)
+        return NULL;
+    state = lz4wfile_fdopen(fd, level);
+    if (state == NULL) {
+        save_errno = errno;
+        ws_close(fd);
+        errno = save_errno;
+    }
+    return state;
+}
+
+LZ4WFILE_T
+lz4wfile_fdopen(int fd, int level)
+{
+    LZ4WFILE_T state;
+
+    /* allocate lz4_writer structure to return */
+    state = g_try_new0(struct lz4_writer, 1);
+    if (state == NULL)
+        return NULL;
+    state->fd = fd;
+
+    /* 0 means "fast" compression; anything above LZ4HC_CLEVEL_MIN uses HC */
+    state->prefs.compressionLevel = level;
+    state->prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+
+    if (LZ4F_isError(LZ4F_createCompressionContext(&state->cctx, LZ4F_VERSION))) {
+        g_free(state);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    /* big enough for a frame header, one chunk, and the frame end */
+    state->out_size = LZ4F_HEADER_SIZE_MAX + LZ4F_compressBound(LZ4_WRITE_CHUNK, &state->prefs);
+    state->out = (unsigned char *)g_try_malloc(state->out_size);
+    if (state->out == NULL) {
+        LZ4F_freeCompressionContext(state->cctx);
+        g_free(state);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return state;
+}
+
+static int
+lz4w_check(LZ4WFILE_T state, size_t ret)
+{
+    if (LZ4F_isError(ret)) {
+        state->err = WTAP_ERR_INTERNAL;
+        state->err_info = LZ4F_getErrorName(ret);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+lz4w_begin_frame(LZ4WFILE_T state)
+{
+    size_t ret;
+
+    ret = LZ4F_compressBegin(state->cctx, state->out, state->out_size, &state->prefs);
+    if (lz4w_check(state, ret) == -1)
+        return -1;
+    if (wfile_write_out(state->fd, state->out, ret, &state->err) == -1)
+        return -1;
+    state->in_frame = true;
+    state->wrote_frame = true;
+    state->frame_in = 0;
+    return 0;
+}
+
+static int
+lz4w_end_frame(LZ4WFILE_T state)
+{
+    size_t ret;
+
+    ret = LZ4F_compressEnd(state->cctx, state->out, state->out_size, NULL);
+    if (lz4w_check(state, ret) == -1)
+        return -1;
+    if (wfile_write_out(state->fd, state->out, ret, &state->err) == -1)
+        return -1;
+    state->in_frame = false;
+    return 0;
+}
+
+/* Write out len bytes from buf.  Return 0, and set state->err, on
+   failure or on an attempt to write 0 bytes (in which case state->err
+   is 0); return the number of bytes written on success. */
+unsigned
+lz4wfile_write(LZ4WFILE_T state, const void *buf, unsigned len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    unsigned left = len;
+
+    /* check that there's no error */
+    if (state->err != 0)
+        return 0;
+
+    while (left != 0) {
+        size_t n, ret;
+
+        if (!state->in_frame && lz4w_begin_frame(state) == -1)
+            return 0;
+
+        n = WRITER_FRAME_SIZE - state->frame_in;
+        if (n > LZ4_WRITE_CHUNK)
+            n = LZ4_WRITE_CHUNK;
+        if (n > left)
+            n = left;
+        ret = LZ4F_compressUpdate(state->cctx, state->out, state->out_size, p, n, NULL);
+        if (lz4w_check(state, ret) == -1)
+            return 0;
+        if (wfile_write_out(state->fd, state->out, ret, &state->err) == -1)
+            return 0;
+        state->frame_in += n;
+        p += n;
+        left -= (unsigned)n;
+
+        if (state->frame_in == WRITER_FRAME_SIZE && lz4w_end_frame(state) == -1)
+            return 0;
+    }
+    return len;
+}
+
+/* Flush out what we've written so far.  Returns -1, and sets state->err,
+   on failure; returns 0 on success. */
+int
+lz4wfile_flush(LZ4WFILE_T state)
+{
+    size_t ret;
+
+    /* check that there's no error */
+    if (state->err != 0)
+        return -1;
+    if (!state->in_frame)
+        return 0;
+
+    ret = LZ4F_flush(state->cctx, state->out, state->out_size, NULL);
+    if (lz4w_check(state, ret) == -1)
+        return -1;
+    return wfile_write_out(state->fd, state->out, ret, &state->err);
+}
+
+/* Flush out all data written, and close the file.  Returns a Wiretap
+   error on failure; returns 0 on success. */
+int
+lz4wfile_close(LZ4WFILE_T state)
+{
+    int ret;
+
+    /* finish the last frame, writing an empty one if we wrote nothing,
+       so that an empty file is still a valid lz4 file */
+    if (state->err == 0 && !state->wrote_frame)
+        (void)lz4w_begin_frame(state);
+    if (state->err == 0 && state->in_frame)
+        (void)lz4w_end_frame(state);
+    ret = state->err;
+    LZ4F_freeCompressionContext(state->cctx);
+    g_free(state->out);
+    if (ws_close(state->fd) == -1 && ret == 0)
+        ret = errno;
+    g_free(state);
+    return ret;
+}
+
+int
+lz4wfile_geterr(LZ4WFILE_T state)
+{
+    return state->err;
+}
+#endif /* USE_LZ4 */
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
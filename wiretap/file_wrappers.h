@@ -13,9 +13,18 @@
 #include "wtap.h"
 #include <wsutil/file_util.h>
 
+/*
+ * lz4 files are read and written with the frame API of lz4 1.7.3 and
+ * later; FindLZ4.cmake sets HAVE_LZ4_FRAME_API for those versions.
+ */
+#if defined(HAVE_LZ4) && defined(HAVE_LZ4_FRAME_API)
+#define USE_LZ4
+#endif /* HAVE_LZ4 && HAVE_LZ4_FRAME_API */
+
 extern FILE_T file_open(const char *path);
 extern FILE_T file_fdopen(int fildes);
 extern void file_set_random_access(FILE_T stream, bool random_flag, GPtrArray *seek);
+extern void file_set_raw_read_cb(FILE_T stream, wtap_raw_read_callback_t cb, void *user_data);
 WS_DLL_PUBLIC int64_t file_seek(FILE_T stream, int64_t offset, int whence, int *err);
 WS_DLL_PUBLIC int64_t file_tell(FILE_T stream);
 extern int64_t file_tell_raw(FILE_T stream);
@@ -44,4 +53,26 @@ extern int gzwfile_close(GZWFILE_T state);
 extern int gzwfile_geterr(GZWFILE_T state);
 #endif /* HAVE_ZLIB */
 
+#ifdef HAVE_ZSTD
+typedef struct zstd_writer *ZSTDWFILE_T;
+
+extern ZSTDWFILE_T zstdwfile_open(const char *path, int level, int threads);
+extern ZSTDWFILE_T zstdwfile_fdopen(int fd, int level, int threads);
+extern unsigned zstdwfile_write(ZSTDWFILE_T state, const void *buf, unsigned len);
+extern int zstdwfile_flush(ZSTDWFILE_T state);
+extern int zstdwfile_close(ZSTDWFILE_T state);
+extern int zstdwfile_geterr(ZSTDWFILE_T state);
+#endif /* HAVE_ZSTD */
+
+#ifdef USE_LZ4
+typedef struct lz4_writer *LZ4WFILE_T;
+
+extern LZ4WFILE_T lz4wfile_open(const char *path, int level);
+extern LZ4WFILE_T lz4wfile_fdopen(int fd, int level);
+extern unsigned lz4wfile_write(LZ4WFILE_T state, const void *buf, unsigned len);
+extern int lz4wfile_flush(LZ4WFILE_T state);
+extern int lz4wfile_close(LZ4WFILE_T state);
+extern int lz4wfile_geterr(LZ4WFILE_T state);
+#endif /* USE_LZ4 */
+
 #endif /* __FILE_H__ */
@@ -545,6 +545,7 @@ static ws_enum_t const all_enums[] = {
     ENUM(WTAP_TSPREC_USEC),
     ENUM(WTAP_TYPE_AUTO),
     ENUM(WTAP_UNCOMPRESSED),
+    ENUM(WTAP_UNKNOWN_COMPRESSION),
     ENUM(WTAP_ZSTD_COMPRESSED),
     { NULL, 0 },
 };
@@ -1254,7 +1254,9 @@ merge_files_common(const char* out_filename, /* filename in normal output mode,
                    const int file_type, const char *const *in_filenames,
                    const unsigned in_file_count, const bool do_append,
                    idb_merge_mode mode, unsigned snaplen,
-                   const char *app_name, merge_progress_callback_t* cb)
+                   const char *app_name, merge_progress_callback_t* cb,
+                   wtap_compression_type compression_type,
+                   int compression_level, int compression_threads)
 {
     merge_in_file_t    *in_files = NULL;
     int                 frame_type = WTAP_ENCAP_PER_PACKET;
@@ -1328,6 +1330,8 @@ merge_files_common(const char* out_filename, /* filename in normal output mode,
         wtap_dump_params params = WTAP_DUMP_PARAMS_INIT;
         params.encap = frame_type;
         params.snaplen = snaplen;
+        params.compression_level = compression_level;
+        params.compression_threads = compression_threads;
         /*
          * Does this file type support identifying the interfaces on
          * which packets arrive?
@@ -1378,13 +1382,13 @@ merge_files_common(const char* out_filename, /* filename in normal output mode,
             }
         } else if (out_filenamep) {
             pdh = wtap_dump_open_tempfile(out_filename, out_filenamep, pfx, file_type,
-                                          WTAP_UNCOMPRESSED, &params, &err,
+                                          compression_type, &params, &err,
                                           &err_info);
         } else if (out_filename) {
-            pdh = wtap_dump_open(out_filename, file_type, WTAP_UNCOMPRESSED,
+            pdh = wtap_dump_open(out_filename, file_type, compression_type,
                                  &params, &err, &err_info);
         } else {
-            pdh = wtap_dump_open_stdout(file_type, WTAP_UNCOMPRESSED, &params,
+            pdh = wtap_dump_open_stdout(file_type, compression_type, &params,
                                         &err, &err_info);
         }
         if (pdh == NULL) {
@@ -1476,7 +1480,8 @@ merge_files_common(const char* out_filename, /* filename in normal output mode,
         // We recurse here, but we're limited by MAX_MERGE_FILES
         status = merge_files_common(out_filename, out_filenamep, pfx,
                     file_type, (const char**)temp_files->pdata,
-                    temp_files->len, do_append, mode, snaplen, app_name, cb);
+                    temp_files->len, do_append, mode, snaplen, app_name, cb,
+                    compression_type, compression_level, compression_threads);
         /* If that failed, it has already reported an error */
         g_ptr_array_free(temp_files, true);
     }
@@ -1493,7 +1498,9 @@ bool
 merge_files(const char* out_filename, const int file_type,
             const char *const *in_filenames, const unsigned in_file_count,
             const bool do_append, const idb_merge_mode mode,
-            unsigned snaplen, const char *app_name, merge_progress_callback_t* cb)
+            unsigned snaplen, const char *app_name, merge_progress_callback_t* cb,
+            const wtap_compression_type compression_type,
+            const int compression_level, const int compression_threads)
 {
     ws_assert(out_filename != NULL);
     ws_assert(in_file_count > 0);
@@ -1514,7 +1521,9 @@ merge_files(const char* out_filename, const int file_type,
 
     return merge_files_common(out_filename, NULL, NULL,
                               file_type, in_filenames, in_file_count,
-                              do_append, mode, snaplen, app_name, cb);
+                              do_append, mode, snaplen, app_name, cb,
+                              compression_type, compression_level,
+                              compression_threads);
 }
 
 /*
@@ -1536,7 +1545,8 @@ merge_files_to_tempfile(const char *tmpdir, char **out_filenamep, const char *pf
 
     return merge_files_common(tmpdir, out_filenamep, pfx,
                               file_type, in_filenames, in_file_count,
-                              do_append, mode, snaplen, app_name, cb);
+                              do_append, mode, snaplen, app_name, cb,
+                              WTAP_UNCOMPRESSED, 0, 0);
 }
 
 /*
@@ -1548,11 +1558,15 @@ bool
 merge_files_to_stdout(const int file_type, const char *const *in_filenames,
                       const unsigned in_file_count, const bool do_append,
                       const idb_merge_mode mode, unsigned snaplen,
-                      const char *app_name, merge_progress_callback_t* cb)
+                      const char *app_name, merge_progress_callback_t* cb,
+                      const wtap_compression_type compression_type,
+                      const int compression_level, const int compression_threads)
 {
     return merge_files_common(NULL, NULL, NULL,
                               file_type, in_filenames, in_file_count,
-                              do_append, mode, snaplen, app_name, cb);
+                              do_append, mode, snaplen, app_name, cb,
+                              compression_type, compression_level,
+                              compression_threads);
 }
 
 /*
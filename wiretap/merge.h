@@ -110,13 +110,18 @@ typedef struct {
  * @param snaplen The snaplen to limit it to, or 0 to leave as it is in the files
  * @param app_name The application name performing the merge, used in SHB info
  * @param cb The callback information to use during execution
+ * @param compression_type The compression type to use for the output file
+ * @param compression_level The compression level, or 0 for the default
+ * @param compression_threads The number of compression worker threads, or 0
  * @return true on success, false on failure
  */
 WS_DLL_PUBLIC bool
 merge_files(const char* out_filename, const int file_type,
             const char *const *in_filenames, const unsigned in_file_count,
             const bool do_append, const idb_merge_mode mode,
-            unsigned snaplen, const char *app_name, merge_progress_callback_t* cb);
+            unsigned snaplen, const char *app_name, merge_progress_callback_t* cb,
+            const wtap_compression_type compression_type,
+            const int compression_level, const int compression_threads);
 
 /** Merge the given input files to a temporary file
  *
@@ -151,13 +156,18 @@ merge_files_to_tempfile(const char *tmpdir, char **out_filenamep, const char *pf
  * @param snaplen The snaplen to limit it to, or 0 to leave as it is in the files
  * @param app_name The application name performing the merge, used in SHB info
  * @param cb The callback information to use during execution
+ * @param compression_type The compression type to use for the output
+ * @param compression_level The compression level, or 0 for the default
+ * @param compression_threads The number of compression worker threads, or 0
  * @return true on success, false on failure
  */
 WS_DLL_PUBLIC bool
 merge_files_to_stdout(const int file_type, const char *const *in_filenames,
                       const unsigned in_file_count, const bool do_append,
                       const idb_merge_mode mode, unsigned snaplen,
-                      const char *app_name, merge_progress_callback_t* cb);
+                      const char *app_name, merge_progress_callback_t* cb,
+                      const wtap_compression_type compression_type,
+                      const int compression_level, const int compression_threads);
 
 #ifdef __cplusplus
 }
@@ -105,6 +105,8 @@ struct wtap_dumper {
                                               * encapsulation types
                                               */
     wtap_compression_type   compression_type;
+    int                     compression_level;
+    int                     compression_threads;
     bool                    needs_reload;    /* true if the file requires re-loading after saving with wtap */
     int64_t                 bytes_dumped;
 
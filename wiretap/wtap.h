@@ -1544,6 +1544,8 @@ typedef struct wtap_dump_params {
                                                  This array may grow since the dumper was opened and will subsequently
                                                  be written before newer packets are written in wtap_dump. */
     bool        dont_copy_idbs;             /**< XXX - don't copy IDBs; this should eventually always be the case. */
+    int         compression_level;          /**< Compression level if writing a compressed file, or 0 for the default */
+    int         compression_threads;        /**< Number of worker threads to compress with, if supported (zstd), or 0 to compress in the calling thread */
 } wtap_dump_params;
 
 /* Zero-initializer for wtap_dump_params. */
@@ -1892,6 +1894,18 @@ typedef void (*wtap_new_secrets_callback_t)(uint32_t secrets_type, const void *s
 WS_DLL_PUBLIC
 void wtap_set_cb_new_secrets(wtap *wth, wtap_new_secrets_callback_t add_new_secrets);
 
+/**
+ * Set callback function to observe the raw (still compressed, if the file
+ * is compressed) data as it is read from the file by the sequential
+ * reader, e.g. to hash a file without reading it twice. offset is the
+ * position of the data in the file. Data read before the callback is set,
+ * e.g. while the file type is being determined, and data read by the
+ * random-access reader is not reported.
+ */
+typedef void (*wtap_raw_read_callback_t)(const uint8_t *data, size_t len, int64_t offset, void *user_data);
+WS_DLL_PUBLIC
+void wtap_set_cb_raw_read(wtap *wth, wtap_raw_read_callback_t cb, void *user_data);
+
 /** Read the next record in the file, filling in *phdr and *buf.
  *
  * @wth a wtap * returned by a call that opened a file for reading.
@@ -1950,7 +1964,8 @@ typedef enum {
     WTAP_UNCOMPRESSED,
     WTAP_GZIP_COMPRESSED,
     WTAP_ZSTD_COMPRESSED,
-    WTAP_LZ4_COMPRESSED
+    WTAP_LZ4_COMPRESSED,
+    WTAP_UNKNOWN_COMPRESSION
 } wtap_compression_type;
 
 WS_DLL_PUBLIC
@@ -1962,6 +1977,47 @@ const char *wtap_compression_type_extension(wtap_compression_type compression_ty
 WS_DLL_PUBLIC
 GSList *wtap_get_all_compression_type_extensions_list(void);
 
+/**
+ * Return the short name ("gzip", "zstd", "lz4", or "none") of a
+ * compression type, as used on command lines, or NULL if it's not
+ * supported.
+ */
+WS_DLL_PUBLIC
+const char *wtap_compression_type_name(wtap_compression_type compression_type);
+
+/**
+ * Look up a compression type by its short name.
+ *
+ * @return The compression type, or WTAP_UNKNOWN_COMPRESSION if there's
+ * no supported compression type with that name.
+ */
+WS_DLL_PUBLIC
+wtap_compression_type wtap_name_to_compression_type(const char *name);
+
+/** Return true if we can write files with that type of compression. */
+WS_DLL_PUBLIC
+bool wtap_can_write_compression_type(wtap_compression_type compression_type);
+
+/**
+ * Get the range of compression levels accepted when writing files with
+ * that type of compression.  Level 0 always selects the default level
+ * and is accepted even when it's outside the range.
+ *
+ * @return true and set *min_level and *max_level if the level can be
+ * set, false if it can't.
+ */
+WS_DLL_PUBLIC
+bool wtap_compression_type_level_range(wtap_compression_type compression_type,
+    int *min_level, int *max_level);
+
+/**
+ * Return a list of the short names of all the compression types we can
+ * use when writing, not including "none".  The strings are static; free
+ * the list with g_slist_free().
+ */
+WS_DLL_PUBLIC
+GSList *wtap_get_all_output_compression_type_names_list(void);
+
 /*** get various information snippets about the current file ***/
 
 /** Return an approximation of the amount of data we've read sequentially
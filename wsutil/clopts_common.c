@@ -18,6 +18,28 @@
 #include <wsutil/strtoi.h>
 #include <wsutil/cmdarg_err.h>
 
+int
+get_int(const char *string, const char *name)
+{
+    int32_t number;
+
+    if (!ws_strtoi32(string, NULL, &number)) {
+        if (errno == EINVAL) {
+            cmdarg_err("The specified %s \"%s\" isn't a decimal number", name, string);
+            exit(1);
+        }
+        if (number < 0) {
+            cmdarg_err("The specified %s \"%s\" is too small (less than %d)",
+                    name, string, number);
+            exit(1);
+        }
+        cmdarg_err("The specified %s \"%s\" is too large (greater than %d)",
+                name, string, number);
+        exit(1);
+    }
+    return (int)number;
+}
+
 int
 get_natural_int(const char *string, const char *name)
 {
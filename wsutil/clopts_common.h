@@ -40,6 +40,9 @@ extern "C" {
 #define OPTSTRING_READ_CAPTURE_COMMON \
     "r:"
 
+WS_DLL_PUBLIC int
+get_int(const char *string, const char *name);
+
 WS_DLL_PUBLIC int
 get_natural_int(const char *string, const char *name);
 
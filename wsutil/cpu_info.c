@@ -476,6 +476,8 @@ get_cpu_info(GString *str)
      */
     if (ws_cpuid_sse42())
         g_string_append(str, " (with SSE4.2)");
+    if (ws_cpuid_avx2())
+        g_string_append(str, " (with AVX2)");
 }
 
 /*
@@ -17,6 +17,16 @@
 
 #include <wsutil/crc32.h>
 
+#include <string.h>
+
+#include "crc32_int.h"
+
+/* The CRC extension is optional in ARMv8.0, so only use it if the target has it */
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define HAVE_ARM_CRC32C
+#endif
+
 #ifdef HAVE_ZLIBNG
 #include <zlib-ng.h>
 #else
@@ -373,19 +383,28 @@ crc32_ccitt_table_lookup (unsigned char pos)
 	return crc32_ccitt_table[pos];
 }
 
-uint32_t
-crc32c_calculate(const void *buf, int len, uint32_t crc)
+#ifdef HAVE_ARM_CRC32C
+static uint32_t
+crc32c_arm_calculate_no_swap(const void *buf, int len, uint32_t crc)
 {
 	const uint8_t *p = (const uint8_t *)buf;
-	crc = CRC32C_SWAP(crc);
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
+
+	while (len >= 8) {
+		uint64_t data;
+
+		memcpy(&data, p, sizeof(data));
+		crc = __crc32cd(crc, data);
+		p += 8;
+		len -= 8;
 	}
-	return CRC32C_SWAP(crc);
-}
+	while (len-- > 0)
+		crc = __crc32cb(crc, *p++);
 
-uint32_t
-crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
+	return crc;
+}
+#else
+static uint32_t
+crc32c_table_calculate_no_swap(const void *buf, int len, uint32_t crc)
 {
 	const uint8_t *p = (const uint8_t *)buf;
 	while (len-- > 0) {
@@ -394,6 +413,44 @@ crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
 
 	return crc;
 }
+#endif
+
+#ifdef HAVE_SSE4_2
+/*
+ * 0 until the first call checks the CPU, then 1 if SSE 4.2 can't be used
+ * and 2 if it can.
+ */
+static gsize crc32c_sse42_state;
+
+static inline bool
+crc32c_use_sse42(void)
+{
+	if (g_once_init_enter(&crc32c_sse42_state))
+		g_once_init_leave(&crc32c_sse42_state, crc32c_sse42_available() ? 2 : 1);
+	return crc32c_sse42_state == 2;
+}
+#endif
+
+uint32_t
+crc32c_calculate(const void *buf, int len, uint32_t crc)
+{
+	crc = crc32c_calculate_no_swap(buf, len, CRC32C_SWAP(crc));
+	return CRC32C_SWAP(crc);
+}
+
+uint32_t
+crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
+{
+#ifdef HAVE_ARM_CRC32C
+	return crc32c_arm_calculate_no_swap(buf, len, crc);
+#else
+#ifdef HAVE_SSE4_2
+	if (crc32c_use_sse42())
+		return crc32c_sse42_calculate_no_swap(buf, len, crc);
+#endif
+	return crc32c_table_calculate_no_swap(buf, len, crc);
+#endif
+}
 
 uint32_t
 crc32_ccitt(const uint8_t *buf, unsigned len)
@@ -9,6 +9,7 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 #include <wsutil/utf8_entities.h>
 #include <wsutil/time_util.h>
@@ -836,6 +837,277 @@ static void test_getopt_opterr1(void)
     g_test_trap_assert_stderr("/bin/ls: unrecognized option: z\n");
 }
 
+#include "ws_mempbrk.h"
+
+static const uint8_t *
+mempbrk_reference(const uint8_t *haystack, size_t haystacklen, const char *needles)
+{
+    for (size_t i = 0; i < haystacklen; i++) {
+        if (haystack[i] != '\0' && strchr(needles, haystack[i]))
+            return haystack + i;
+    }
+    return NULL;
+}
+
+static void test_mempbrk(void)
+{
+    /* Cover the vector kernels (up to 4 needles) and the fallbacks. */
+    static const char *needle_sets[] = {
+        "\r\n", "\r\n\"", " \r\n", "\xff", "<>&;", "abcdefgh",
+    };
+    uint8_t buf[200];
+    ws_mempbrk_pattern pattern;
+    unsigned char found;
+
+    for (size_t set = 0; set < G_N_ELEMENTS(needle_sets); set++) {
+        const char *needles = needle_sets[set];
+        size_t num_needles = strlen(needles);
+
+        ws_mempbrk_compile(&pattern, needles);
+
+        for (size_t start = 0; start < 4; start++) {
+            for (size_t len = 0; len + start <= sizeof(buf); len++) {
+                uint8_t *haystack = buf + start;
+                /* no match, a match at the front, middle and end */
+                size_t positions[] = { SIZE_MAX, 0, len / 2, len ? len - 1 : 0 };
+
+                for (size_t p = 0; p < G_N_ELEMENTS(positions); p++) {
+                    const uint8_t *expected, *result;
+
+                    memset(buf, 'x', sizeof(buf));
+                    if (positions[p] < len) {
+                        haystack[positions[p]] = needles[(len + p) % num_needles];
+                        /* a later match must not be reported */
+                        if (positions[p] + 1 < len)
+                            haystack[len - 1] = needles[0];
+                    }
+
+                    found = 0;
+                    expected = mempbrk_reference(haystack, len, needles);
+                    result = ws_mempbrk_exec(haystack, len, &pattern, &found);
+                    g_assert_true(result == expected);
+                    if (expected)
+                        g_assert_cmpuint(found, ==, *expected);
+                }
+            }
+        }
+    }
+}
+
+static void test_mempbrk_perf(void)
+{
+#define MEMPBRK_LOOP_COUNT (200 * 1000)
+    uint8_t buf[1500];
+    ws_mempbrk_pattern pattern;
+    const uint8_t *result = NULL;
+    int i;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    /* A long header line, as seen in HTTP, SIP or SMTP, ending in CRLF */
+    for (i = 0; i < (int) sizeof(buf); i++)
+        buf[i] = "abcdefghijklmnopqrstuvwxyz0123456789 :;,/="[i % 42];
+    buf[sizeof(buf) - 2] = '\r';
+    buf[sizeof(buf) - 1] = '\n';
+
+    ws_mempbrk_compile(&pattern, "\r\n");
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MEMPBRK_LOOP_COUNT; i++) {
+        result = ws_mempbrk_exec(buf, sizeof(buf), &pattern, NULL);
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(result == buf + sizeof(buf) - 2);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "ws_mempbrk_exec(): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MEMPBRK_LOOP_COUNT; i++) {
+        result = mempbrk_reference(buf, sizeof(buf), "\r\n");
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(result == buf + sizeof(buf) - 2);
+    g_test_message("byte at a time: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+}
+
+#include "crc32.h"
+
+static uint32_t
+crc32c_reference(const uint8_t *buf, size_t len, uint32_t crc)
+{
+    for (size_t i = 0; i < len; i++)
+        crc = (crc >> 8) ^ crc32c_table_lookup((crc ^ buf[i]) & 0xff);
+    return crc;
+}
+
+static void test_crc32c(void)
+{
+    uint8_t buf[300];
+
+    /* RFC 3720 / the usual "123456789" check value */
+    g_assert_cmphex(~crc32c_calculate_no_swap("123456789", 9, CRC32C_PRELOAD), ==, 0xe3069283);
+    g_assert_cmphex(~CRC32C_SWAP(crc32c_calculate("123456789", 9, CRC32C_PRELOAD)), ==, 0xe3069283);
+
+    for (size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (uint8_t)(i * 131 + 7);
+
+    /* Whatever implementation is picked must match the table */
+    for (size_t start = 0; start < 8; start++) {
+        for (size_t len = 0; len + start <= sizeof(buf); len++) {
+            g_assert_cmphex(crc32c_calculate_no_swap(buf + start, (int)len, CRC32C_PRELOAD), ==,
+                            crc32c_reference(buf + start, len, CRC32C_PRELOAD));
+        }
+    }
+}
+
+static void test_crc32c_perf(void)
+{
+    /* Common packet sizes: minimal frame, IPv4 minimum MTU, Ethernet, jumbo */
+    static const size_t sizes[] = { 64, 576, 1500, 9000 };
+    uint8_t *buf = g_malloc(9000);
+    volatile uint32_t crc = 0;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    for (size_t i = 0; i < 9000; i++)
+        buf[i] = (uint8_t)i;
+
+    for (size_t s = 0; s < G_N_ELEMENTS(sizes); s++) {
+        /* about 1 GB of data per size */
+        size_t loops = (1000 * 1000 * 1000) / sizes[s];
+
+        RESOURCE_USAGE_START;
+        for (size_t i = 0; i < loops; i++) {
+            crc = crc32c_calculate_no_swap(buf, (int)sizes[s], CRC32C_PRELOAD);
+        }
+        RESOURCE_USAGE_END;
+        g_test_minimized_result(utime_ms + stime_ms,
+            "crc32c_calculate_no_swap(%zu bytes): u %.3f ms s %.3f ms", sizes[s], utime_ms, stime_ms);
+    }
+    (void)crc;
+    g_free(buf);
+}
+
+#include "unicode-utils.h"
+
+#define REPL "\xef\xbf\xbd"
+
+static size_t
+ascii_span_reference(const uint8_t *ptr, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length && ptr[i] < 0x80; i++)
+        ;
+    return i;
+}
+
+static void test_ascii_span(void)
+{
+    uint8_t buf[200];
+
+    for (size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = 'a' + i % 26;
+
+    /* All offsets and lengths, so every alignment and tail is covered */
+    for (size_t start = 0; start < 16; start++) {
+        for (size_t len = 0; len + start <= sizeof(buf); len++) {
+            g_assert_cmpuint(ws_ascii_span(buf + start, len), ==, len);
+        }
+    }
+
+    /* A non-ASCII byte at each position */
+    for (size_t pos = 0; pos < sizeof(buf); pos++) {
+        buf[pos] = 0x80 | (uint8_t)pos;
+        for (size_t start = 0; start <= pos && start < 16; start++) {
+            size_t len = sizeof(buf) - start;
+            g_assert_cmpuint(ws_ascii_span(buf + start, len), ==,
+                             ascii_span_reference(buf + start, len));
+        }
+        buf[pos] = 'a' + pos % 26;
+    }
+}
+
+static void test_utf8_make_valid(void)
+{
+    uint8_t *str;
+
+    str = ws_utf8_make_valid(NULL, (const uint8_t *)"", 0);
+    g_assert_cmpstr(str, ==, "");
+    g_free(str);
+
+    /* Valid strings are copied as they are, and NUL terminated */
+    str = ws_utf8_make_valid(NULL, (const uint8_t *)"Host: www.example.com:8080xx", 26);
+    g_assert_cmpstr(str, ==, "Host: www.example.com:8080");
+    g_free(str);
+
+    str = ws_utf8_make_valid(NULL, (const uint8_t *)"na\xc3\xafve caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80", 20);
+    g_assert_cmpstr(str, ==, "na\xc3\xafve caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80");
+    g_free(str);
+
+    /* A stray continuation byte and an invalid lead byte */
+    str = ws_utf8_make_valid(NULL, (const uint8_t *)"abc\x80" "def\xff", 8);
+    g_assert_cmpstr(str, ==, "abc" REPL "def" REPL);
+    g_free(str);
+
+    /* An overlong encoding */
+    str = ws_utf8_make_valid(NULL, (const uint8_t *)"\xc0\xaf", 2);
+    g_assert_cmpstr(str, ==, REPL REPL);
+    g_free(str);
+
+    /* A sequence truncated by the end of the string */
+    str = ws_utf8_make_valid(NULL, (const uint8_t *)"0123456789012345678901234567890123456789\xe2\x82", 42);
+    g_assert_cmpstr(str, ==, "0123456789012345678901234567890123456789" REPL);
+    g_free(str);
+}
+
+static void test_utf8_make_valid_perf(void)
+{
+#define MAKE_VALID_LOOP_COUNT (1000 * 1000)
+    /* Strings of the kind dissectors fetch all the time */
+    static const char *strings[] = {
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0",
+        "sip:alice@atlanta.example.com;transport=tcp",
+        "_ldap._tcp.dc._msdcs.example.com",
+        "CN=Administrator,CN=Users,DC=example,DC=com",
+    };
+    wmem_allocator_t *pool = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    uint8_t *str = NULL;
+    size_t span = 0;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    for (size_t s = 0; s < G_N_ELEMENTS(strings); s++) {
+        const uint8_t *ptr = (const uint8_t *)strings[s];
+        size_t len = strlen(strings[s]);
+
+        RESOURCE_USAGE_START;
+        for (int i = 0; i < MAKE_VALID_LOOP_COUNT; i++) {
+            str = ws_utf8_make_valid(pool, ptr, len);
+            if (i % 1000 == 0)
+                wmem_free_all(pool);
+        }
+        RESOURCE_USAGE_END;
+        g_assert_cmpstr(str, ==, strings[s]);
+        wmem_free_all(pool);
+        g_test_minimized_result(utime_ms + stime_ms,
+            "ws_utf8_make_valid(%zu bytes): u %.3f ms s %.3f ms", len, utime_ms, stime_ms);
+
+        RESOURCE_USAGE_START;
+        for (int i = 0; i < MAKE_VALID_LOOP_COUNT; i++) {
+            span += ws_ascii_span(ptr, len);
+        }
+        RESOURCE_USAGE_END;
+        g_test_message("ws_ascii_span(%zu bytes): u %.3f ms s %.3f ms", len, utime_ms, stime_ms);
+
+        RESOURCE_USAGE_START;
+        for (int i = 0; i < MAKE_VALID_LOOP_COUNT; i++) {
+            span += ascii_span_reference(ptr, len);
+        }
+        RESOURCE_USAGE_END;
+        g_test_message("byte at a time: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+    }
+    g_assert_cmpuint(span, >, 0);
+    wmem_destroy_allocator(pool);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -881,6 +1153,25 @@ int main(int argc, char **argv)
 
     g_test_add_func("/nstime/from_iso8601", test_nstime_from_iso8601);
 
+    g_test_add_func("/ws_mempbrk/exec", test_mempbrk);
+
+    if (g_test_perf()) {
+        g_test_add_func("/ws_mempbrk/exec_perf", test_mempbrk_perf);
+    }
+
+    g_test_add_func("/crc32/crc32c", test_crc32c);
+
+    if (g_test_perf()) {
+        g_test_add_func("/crc32/crc32c_perf", test_crc32c_perf);
+    }
+
+    g_test_add_func("/unicode/ascii_span", test_ascii_span);
+    g_test_add_func("/unicode/utf8_make_valid", test_utf8_make_valid);
+
+    if (g_test_perf()) {
+        g_test_add_func("/unicode/utf8_make_valid_perf", test_utf8_make_valid_perf);
+    }
+
     g_test_add_func("/ws_getopt/basic1", test_getopt_long_basic1);
     g_test_add_func("/ws_getopt/basic2", test_getopt_long_basic2);
     g_test_add_func("/ws_getopt/optional1", test_getopt_optional_argument1);
@@ -280,6 +280,19 @@ ws_clock_get_realtime(struct timespec *ts)
 #endif
 }
 
+uint64_t
+ws_clock_get_monotonic_ns(void)
+{
+#if defined(HAVE_CLOCK_GETTIME)
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+		return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+	/* Microsecond resolution only. */
+	return (uint64_t)g_get_monotonic_time() * 1000;
+}
+
 struct tm *
 ws_localtime_r(const time_t *timep, struct tm *result)
 {
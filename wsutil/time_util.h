@@ -68,6 +68,13 @@ void ws_tzset(void);
 WS_DLL_PUBLIC
 struct timespec *ws_clock_get_realtime(struct timespec *ts);
 
+/**
+ * Fetch a monotonic clock in nanoseconds, for measuring elapsed time.
+ * The starting point is unspecified.
+ */
+WS_DLL_PUBLIC
+uint64_t ws_clock_get_monotonic_ns(void);
+
 WS_DLL_PUBLIC
 struct tm *ws_localtime_r(const time_t *timep, struct tm *result);
 
@@ -0,0 +1,59 @@
+/* unicode-utils-avx2.c
+ * Find the end of an ASCII run with AVX2 intrinsics
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_AVX2
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#include <immintrin.h>
+#include "unicode-utils-int.h"
+
+#include <wsutil/bits_ctz.h>
+
+bool
+ws_ascii_span_avx2_available(void)
+{
+    return ws_cpuid_avx2() != 0;
+}
+
+/* The byte mask has a bit set for every byte with its top bit set. */
+size_t
+ws_ascii_span_avx2(const uint8_t *ptr, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i + 32 <= length; i += 32) {
+        __m256i data = _mm256_loadu_si256((const __m256i *) (const void *) (ptr + i));
+        uint32_t bits = (uint32_t) _mm256_movemask_epi8(data);
+
+        if (bits)
+            return i + ws_ctz(bits);
+    }
+
+    return i;
+}
+
+#endif /* HAVE_AVX2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,30 @@
+/** @file
+ *
+ * Vectorized Unicode routines, internal to wsutil.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __UNICODE_UTILS_INT_H__
+#define __UNICODE_UTILS_INT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef HAVE_AVX2
+bool ws_ascii_span_avx2_available(void);
+
+/*
+ * Checks whole 32-byte blocks only. Returns the offset of the first byte
+ * that isn't ASCII or, if there is none in those blocks, the number of
+ * bytes they cover.
+ */
+size_t ws_ascii_span_avx2(const uint8_t *ptr, size_t length);
+#endif
+
+#endif /* __UNICODE_UTILS_INT_H__ */
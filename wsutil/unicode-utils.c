@@ -11,6 +11,20 @@
 #include "config.h"
 
 #include "unicode-utils.h"
+#include "unicode-utils-int.h"
+
+#include <string.h>
+
+#include <wsutil/bits_ctz.h>
+
+/* SSE2 is part of the baseline on x86-64, and NEON on 64-bit Arm */
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define WS_ASCII_SPAN_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define WS_ASCII_SPAN_NEON
+#endif
 
 const int ws_utf8_seqlen[256] = {
     1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  /* 0x00...0x0f */
@@ -31,6 +45,92 @@ const int ws_utf8_seqlen[256] = {
     4,4,4,4,4,0,0,0,0,0,0,0,0,0,0,0,  /* 0xf0...0xff */
 };
 
+/* Checks eight bytes at a time while none of them has its top bit set. */
+static size_t
+ascii_span_portable(const uint8_t *ptr, size_t length)
+{
+    size_t i = 0;
+    uint64_t word;
+
+    for (; i + 8 <= length; i += 8) {
+        memcpy(&word, ptr + i, sizeof(word));
+        if (word & UINT64_C(0x8080808080808080))
+            break;
+    }
+    while (i < length && ptr[i] < 0x80)
+        i++;
+
+    return i;
+}
+
+#if defined(WS_ASCII_SPAN_SSE2)
+static size_t
+ascii_span_vector(const uint8_t *ptr, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i + 16 <= length; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i *) (const void *) (ptr + i));
+        unsigned bits = (unsigned) _mm_movemask_epi8(data);
+
+        if (bits)
+            return i + ws_ctz(bits);
+    }
+
+    return i + ascii_span_portable(ptr + i, length - i);
+}
+#elif defined(WS_ASCII_SPAN_NEON)
+static size_t
+ascii_span_vector(const uint8_t *ptr, size_t length)
+{
+    size_t i;
+
+    /* Find the block, then let the portable code find the byte. */
+    for (i = 0; i + 16 <= length; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(ptr + i)) >= 0x80)
+            break;
+    }
+
+    return i + ascii_span_portable(ptr + i, length - i);
+}
+#else
+#define ascii_span_vector ascii_span_portable
+#endif
+
+#ifdef HAVE_AVX2
+/*
+ * 0 until the first call checks the CPU, then 1 if AVX2 can't be used
+ * and 2 if it can.
+ */
+static gsize ascii_span_avx2_state;
+
+static inline bool
+ascii_span_use_avx2(void)
+{
+    if (g_once_init_enter(&ascii_span_avx2_state))
+        g_once_init_leave(&ascii_span_avx2_state, ws_ascii_span_avx2_available() ? 2 : 1);
+    return ascii_span_avx2_state == 2;
+}
+#endif
+
+size_t
+ws_ascii_span(const uint8_t *ptr, size_t length)
+{
+    size_t span = 0;
+
+#ifdef HAVE_AVX2
+    if (length >= 32) {
+        if (ascii_span_use_avx2()) {
+            span = ws_ascii_span_avx2(ptr, length);
+            if (span == length || ptr[span] >= 0x80)
+                return span;
+        }
+    }
+#endif
+
+    return span + ascii_span_vector(ptr + span, length - span);
+}
+
 /* Given a pointer and a length, validates a string of bytes as UTF-8.
  * Returns the number of valid bytes, and a pointer immediately past
  * the checked region.
@@ -54,9 +154,12 @@ utf_8_validate(const uint8_t *start, ssize_t length, const uint8_t **end)
         ch = *ptr;
 
         if (ch < 0x80) {
-            valid_bytes++;
-            ptr++;
-            length--;
+            /* Text is mostly ASCII, so skip all of it at once. */
+            size_t ascii_bytes = ws_ascii_span(ptr, length);
+
+            valid_bytes += ascii_bytes;
+            ptr += ascii_bytes;
+            length -= ascii_bytes;
             continue;
         }
 
@@ -157,6 +260,40 @@ utf_8_validate(const uint8_t *start, ssize_t length, const uint8_t **end)
     return valid_bytes;
 }
 
+/* Copies a string known to be valid, which may contain NULs. */
+static uint8_t *
+utf_8_copy(wmem_allocator_t *scope, const uint8_t *ptr, size_t length)
+{
+    uint8_t *buf = (uint8_t *)wmem_alloc(scope, length + 1);
+
+    memcpy(buf, ptr, length);
+    buf[length] = '\0';
+    return buf;
+}
+
+static void
+utf_8_append_valid(wmem_strbuf_t *str, const uint8_t *ptr, ssize_t length)
+{
+    /* See the Unicode Standard conformance chapter at
+     * https://www.unicode.org/versions/Unicode15.0.0/ch03.pdf especially
+     * Table 3-7 "Well-Formed UTF-8 Byte Sequences" and
+     * U+FFFD Substitution of Maximal Subparts. */
+
+    while (length > 0) {
+        const uint8_t *prev = ptr;
+        size_t valid_bytes = utf_8_validate(prev, length, &ptr);
+
+        if (valid_bytes) {
+            wmem_strbuf_append_len(str, prev, valid_bytes);
+        }
+        length -= ptr - prev;
+        prev += valid_bytes;
+        if (ptr - prev) {
+            wmem_strbuf_append_unichar_repl(str);
+        }
+    }
+}
+
 /*
  * Given a wmem scope, a pointer, and a length, treat the string of bytes
  * referred to by the pointer and length as a UTF-8 string, and return a
@@ -195,25 +332,7 @@ ws_utf8_make_valid_strbuf(wmem_allocator_t *scope, const uint8_t *ptr, ssize_t l
     wmem_strbuf_t *str;
 
     str = wmem_strbuf_new_sized(scope, length+1);
-
-    /* See the Unicode Standard conformance chapter at
-     * https://www.unicode.org/versions/Unicode15.0.0/ch03.pdf especially
-     * Table 3-7 "Well-Formed UTF-8 Byte Sequences" and
-     * U+FFFD Substitution of Maximal Subparts. */
-
-    while (length > 0) {
-        const uint8_t *prev = ptr;
-        size_t valid_bytes = utf_8_validate(prev, length, &ptr);
-
-        if (valid_bytes) {
-            wmem_strbuf_append_len(str, prev, valid_bytes);
-        }
-        length -= ptr - prev;
-        prev += valid_bytes;
-        if (ptr - prev) {
-            wmem_strbuf_append_unichar_repl(str);
-        }
-    }
+    utf_8_append_valid(str, ptr, length);
 
     return str;
 }
@@ -221,7 +340,23 @@ ws_utf8_make_valid_strbuf(wmem_allocator_t *scope, const uint8_t *ptr, ssize_t l
 uint8_t *
 ws_utf8_make_valid(wmem_allocator_t *scope, const uint8_t *ptr, ssize_t length)
 {
-    wmem_strbuf_t *str = ws_utf8_make_valid_strbuf(scope, ptr, length);
+    wmem_strbuf_t *str;
+    const uint8_t *end;
+    size_t valid_bytes;
+
+    if (length <= 0)
+        return (uint8_t *)wmem_strdup(scope, "");
+
+    /* Most strings are valid; copy those with a single allocation. */
+    valid_bytes = utf_8_validate(ptr, length, &end);
+    if (valid_bytes == (size_t)length)
+        return utf_8_copy(scope, ptr, valid_bytes);
+
+    str = wmem_strbuf_new_sized(scope, length+1);
+    wmem_strbuf_append_len(str, ptr, valid_bytes);
+    wmem_strbuf_append_unichar_repl(str);
+    utf_8_append_valid(str, end, length - (end - ptr));
+
     return wmem_strbuf_finalize(str);
 }
 
@@ -59,6 +59,13 @@ const int ws_utf8_seqlen[256];
  */
 #define ws_utf8_char_len(ch)  (ws_utf8_seqlen[(ch)])
 
+/*
+ * Return the length of the longest prefix of the buffer made only of
+ * 7-bit ASCII bytes, using vector instructions where available.
+ */
+WS_DLL_PUBLIC size_t
+ws_ascii_span(const uint8_t *ptr, size_t length);
+
 /*
  * Given a wmem scope, a pointer, and a length, treat the string of bytes
  * referred to by the pointer and length as a UTF-8 string, and return a
@@ -14,6 +14,7 @@
 #define __WMEM_ALLOCATOR_H__
 
 #include <glib.h>
+#include <stdint.h>
 #include <string.h>
 
 #ifdef __cplusplus
@@ -38,6 +39,9 @@ struct _wmem_allocator_t {
     /* Callback List */
     struct _wmem_user_cb_container_t *callbacks;
 
+    /* Bytes requested through wmem_alloc() and wmem_realloc() */
+    uint64_t                     allocated_bytes;
+
     /* Implementation details */
     void                        *private_data;
     enum _wmem_allocator_type_t  type;
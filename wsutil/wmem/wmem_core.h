@@ -232,6 +232,18 @@ WS_DLL_PUBLIC
 bool
 wmem_in_scope(wmem_allocator_t *allocator);
 
+/** Returns the number of bytes requested from an allocator since it was
+ * created. Reallocations count their full new size, and freeing memory
+ * doesn't reduce the total, so the difference between two calls is the
+ * allocation volume of the code that ran in between.
+ *
+ * @param allocator The allocator object to query.
+ * @return The number of bytes requested.
+ */
+WS_DLL_PUBLIC
+uint64_t
+wmem_allocated_bytes(wmem_allocator_t *allocator);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -10,6 +10,8 @@
  */
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include "wmem_core.h"
@@ -35,10 +37,21 @@ wmem_init_hashing(void)
     postseed = g_random_int();
 }
 
+/* The map is an open-addressing hash table using linear probing with
+ * Robin Hood insertion and backward-shift deletion. Keys and values are
+ * stored inline in the table, so inserting doesn't allocate and a lookup
+ * touches at most a couple of cache lines instead of following a chain of
+ * separately allocated items.
+ *
+ * Next to the items we keep an array with the (scrambled) hash of every
+ * occupied slot. The low bit of a stored hash is always set, so 0 marks an
+ * empty slot, and comparing the stored hash first avoids most calls to the
+ * equality function. The home slot of an item is given by the top bits of
+ * its hash, so the distance of an item from its home slot can be computed
+ * without calling the hash function again. */
 typedef struct _wmem_map_item_t {
     const void *key;
     void *value;
-    struct _wmem_map_item_t *next;
 } wmem_map_item_t;
 
 struct _wmem_map_t {
@@ -50,7 +63,8 @@ struct _wmem_map_t {
      * logarithms is expensive. */
     size_t capacity;
 
-    wmem_map_item_t **table;
+    wmem_map_item_t *items;  /* CAPACITY(map) items, followed by... */
+    uint32_t        *hashes; /* ...CAPACITY(map) hashes, 0 if the slot is empty */
 
     GHashFunc  hash_func;
     GEqualFunc eql_func;
@@ -70,18 +84,46 @@ struct _wmem_map_t {
  * do the 2^x operation. */
 #define CAPACITY(MAP) (((size_t)1) << (MAP)->capacity)
 
+#define MASK(MAP) (CAPACITY(MAP) - 1)
+
+/* The table is grown once it is 7/8 full, which keeps probe sequences short
+ * with Robin Hood hashing. */
+#define MAX_COUNT(MAP) (CAPACITY(MAP) - (CAPACITY(MAP) >> 3))
+
 /* Efficient universal integer hashing:
  * https://en.wikipedia.org/wiki/Universal_hashing#Avoiding_modular_arithmetic
+ * The low bit is forced on so a stored hash is never 0 (an empty slot); it
+ * doesn't influence the home slot, which comes from the top bits.
  */
 #define HASH(MAP, KEY) \
-    ((uint32_t)(((MAP)->hash_func(KEY) * x) >> (32 - (MAP)->capacity)))
+    ((uint32_t)((MAP)->hash_func(KEY) * x) | 1)
+
+#define HOME_SLOT(MAP, HASH) \
+    ((size_t)((HASH) >> (32 - (MAP)->capacity)))
+
+/* How far the item in SLOT with hash HASH is from its home slot */
+#define PROBE_DISTANCE(MAP, HASH, SLOT) \
+    (((SLOT) - HOME_SLOT(MAP, HASH)) & MASK(MAP))
+
+#define SLOT_NOT_FOUND SIZE_MAX
+
+static void
+wmem_map_alloc_table(wmem_map_t *map)
+{
+    size_t cap = CAPACITY(map);
+
+    map->items  = (wmem_map_item_t *)wmem_alloc(map->data_allocator,
+            cap * (sizeof(wmem_map_item_t) + sizeof(uint32_t)));
+    map->hashes = (uint32_t *)(map->items + cap);
+    memset(map->hashes, 0, cap * sizeof(uint32_t));
+}
 
 static void
 wmem_map_init_table(wmem_map_t *map)
 {
     map->count     = 0;
     map->capacity  = WMEM_MAP_DEFAULT_CAPACITY;
-    map->table     = wmem_alloc0_array(map->data_allocator, wmem_map_item_t*, CAPACITY(map));
+    wmem_map_alloc_table(map);
 }
 
 wmem_map_t *
@@ -97,7 +139,8 @@ wmem_map_new(wmem_allocator_t *allocator,
     map->metadata_allocator    = allocator;
     map->data_allocator = allocator;
     map->count = 0;
-    map->table = NULL;
+    map->items = NULL;
+    map->hashes = NULL;
 
     return map;
 }
@@ -109,7 +152,8 @@ wmem_map_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
     wmem_map_t *map = (wmem_map_t*)user_data;
 
     map->count = 0;
-    map->table = NULL;
+    map->items = NULL;
+    map->hashes = NULL;
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(map->metadata_allocator, map->metadata_scope_cb_id);
@@ -143,7 +187,8 @@ wmem_map_new_autoreset(wmem_allocator_t *metadata_scope, wmem_allocator_t *data_
     map->metadata_allocator = metadata_scope;
     map->data_allocator = data_scope;
     map->count = 0;
-    map->table = NULL;
+    map->items = NULL;
+    map->hashes = NULL;
 
     map->metadata_scope_cb_id = wmem_register_callback(metadata_scope, wmem_map_destroy_cb, map);
     map->data_scope_cb_id  = wmem_register_callback(data_scope, wmem_map_reset_cb, map);
@@ -151,77 +196,149 @@ wmem_map_new_autoreset(wmem_allocator_t *metadata_scope, wmem_allocator_t *data_
     return map;
 }
 
+/* Returns the slot holding key, or SLOT_NOT_FOUND. */
+static inline size_t
+wmem_map_find_slot(const wmem_map_t *map, const void *key)
+{
+    uint32_t hash = HASH(map, key);
+    size_t   mask = MASK(map);
+    size_t   slot = HOME_SLOT(map, hash);
+    size_t   dist = 0;
+
+    for (;;) {
+        uint32_t cur = map->hashes[slot];
+
+        if (cur == 0) {
+            return SLOT_NOT_FOUND;
+        }
+        /* Robin Hood invariant: items are ordered by their distance from
+         * their home slot, so if this item is closer to its home than we
+         * are to ours, the key isn't in the table. */
+        if (PROBE_DISTANCE(map, cur, slot) < dist) {
+            return SLOT_NOT_FOUND;
+        }
+        if (cur == hash && map->eql_func(key, map->items[slot].key)) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+        dist++;
+    }
+}
+
+/* Puts an item that isn't in the table yet into it; the caller makes sure
+ * there is room. */
+static inline void
+wmem_map_place(wmem_map_t *map, uint32_t hash, const void *key, void *value)
+{
+    wmem_map_item_t item, tmp_item;
+    uint32_t        tmp_hash;
+    size_t          mask = MASK(map);
+    size_t          slot = HOME_SLOT(map, hash);
+    size_t          dist = 0, cur_dist;
+
+    item.key   = key;
+    item.value = value;
+
+    for (;;) {
+        if (map->hashes[slot] == 0) {
+            map->hashes[slot] = hash;
+            map->items[slot]  = item;
+            return;
+        }
+
+        /* Take the slot from an item that is closer to its home than we
+         * are, and carry on looking for a slot for that item instead. */
+        cur_dist = PROBE_DISTANCE(map, map->hashes[slot], slot);
+        if (cur_dist < dist) {
+            tmp_hash = map->hashes[slot];
+            tmp_item = map->items[slot];
+            map->hashes[slot] = hash;
+            map->items[slot]  = item;
+            hash = tmp_hash;
+            item = tmp_item;
+            dist = cur_dist;
+        }
+        slot = (slot + 1) & mask;
+        dist++;
+    }
+}
+
+/* Empties a slot, shifting the following items of the same probe sequence
+ * back by one so no tombstones are needed. Only items after slot (up to the
+ * next empty slot) are moved. */
+static inline void
+wmem_map_erase_slot(wmem_map_t *map, size_t slot)
+{
+    size_t mask = MASK(map);
+    size_t next = (slot + 1) & mask;
+
+    while (map->hashes[next] != 0 &&
+            PROBE_DISTANCE(map, map->hashes[next], next) != 0) {
+        map->hashes[slot] = map->hashes[next];
+        map->items[slot]  = map->items[next];
+        slot = next;
+        next = (next + 1) & mask;
+    }
+    map->hashes[slot] = 0;
+    map->count--;
+}
+
 static inline void
 wmem_map_grow(wmem_map_t *map)
 {
-    wmem_map_item_t **old_table, *cur, *nxt;
-    size_t            old_cap, i;
-    unsigned          slot;
+    wmem_map_item_t *old_items;
+    uint32_t        *old_hashes;
+    size_t           old_cap, i;
 
     /* store the old table and capacity */
-    old_table = map->table;
-    old_cap   = CAPACITY(map);
+    old_items  = map->items;
+    old_hashes = map->hashes;
+    old_cap    = CAPACITY(map);
 
     /* double the size (capacity is base-2 logarithm, so this just means
      * increment it) and allocate new table */
     map->capacity++;
-    map->table = wmem_alloc0_array(map->data_allocator, wmem_map_item_t*, CAPACITY(map));
+    wmem_map_alloc_table(map);
 
     /* copy all the elements over from the old table */
     for (i=0; i<old_cap; i++) {
-        cur = old_table[i];
-        while (cur) {
-            nxt              = cur->next;
-            slot             = HASH(map, cur->key);
-            cur->next        = map->table[slot];
-            map->table[slot] = cur;
-            cur              = nxt;
+        if (old_hashes[i] != 0) {
+            wmem_map_place(map, old_hashes[i], old_items[i].key, old_items[i].value);
         }
     }
 
     /* free the old table */
-    wmem_free(map->data_allocator, old_table);
+    wmem_free(map->data_allocator, old_items);
 }
 
 void *
 wmem_map_insert(wmem_map_t *map, const void *key, void *value)
 {
-    wmem_map_item_t **item;
+    size_t slot;
     void *old_val;
 
     /* Make sure we have a table */
-    if (map->table == NULL) {
+    if (map->items == NULL) {
         wmem_map_init_table(map);
     }
 
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
-
-    /* check existing items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* replace and return old value for this key */
-            old_val = (*item)->value;
-            (*item)->value = value;
-            return old_val;
-        }
-        item = &((*item)->next);
+    /* replace and return old value for an existing key */
+    slot = wmem_map_find_slot(map, key);
+    if (slot != SLOT_NOT_FOUND) {
+        old_val = map->items[slot].value;
+        map->items[slot].value = value;
+        return old_val;
     }
 
-    /* insert new item */
-    (*item) = wmem_new(map->data_allocator, wmem_map_item_t);
-
-    (*item)->key   = key;
-    (*item)->value = value;
-    (*item)->next  = NULL;
-
-    map->count++;
-
     /* increase size if we are over-full */
-    if (map->count >= CAPACITY(map)) {
+    if (map->count >= MAX_COUNT(map)) {
         wmem_map_grow(map);
     }
 
+    /* insert new item */
+    wmem_map_place(map, HASH(map, key), key, value);
+    map->count++;
+
     /* no previous entry, return NULL */
     return NULL;
 }
@@ -229,158 +346,111 @@ wmem_map_insert(wmem_map_t *map, const void *key, void *value)
 bool
 wmem_map_contains(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t *item;
-
     /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    if (map == NULL || map->items == NULL) {
         return false;
     }
 
-    /* find correct slot */
-    item = map->table[HASH(map, key)];
-
-    /* scan list of items in this slot for the correct value */
-    while (item) {
-        if (map->eql_func(key, item->key)) {
-            return true;
-        }
-        item = item->next;
-    }
-
-    return false;
+    return wmem_map_find_slot(map, key) != SLOT_NOT_FOUND;
 }
 
 void *
 wmem_map_lookup(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t *item;
+    size_t slot;
 
     /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    if (map == NULL || map->items == NULL) {
         return NULL;
     }
 
-    /* find correct slot */
-    item = map->table[HASH(map, key)];
-
-    /* scan list of items in this slot for the correct value */
-    while (item) {
-        if (map->eql_func(key, item->key)) {
-            return item->value;
-        }
-        item = item->next;
+    slot = wmem_map_find_slot(map, key);
+    if (slot == SLOT_NOT_FOUND) {
+        return NULL;
     }
 
-    return NULL;
+    return map->items[slot].value;
 }
 
 bool
 wmem_map_lookup_extended(wmem_map_t *map, const void *key, const void **orig_key, void **value)
 {
-    wmem_map_item_t *item;
+    size_t slot;
 
     /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    if (map == NULL || map->items == NULL) {
         return false;
     }
 
-    /* find correct slot */
-    item = map->table[HASH(map, key)];
-
-    /* scan list of items in this slot for the correct value */
-    while (item) {
-        if (map->eql_func(key, item->key)) {
-            if (orig_key) {
-                *orig_key = item->key;
-            }
-            if (value) {
-                *value = item->value;
-            }
-            return true;
-        }
-        item = item->next;
+    slot = wmem_map_find_slot(map, key);
+    if (slot == SLOT_NOT_FOUND) {
+        return false;
     }
 
-    return false;
+    if (orig_key) {
+        *orig_key = map->items[slot].key;
+    }
+    if (value) {
+        *value = map->items[slot].value;
+    }
+    return true;
 }
 
 void *
 wmem_map_remove(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t **item, *tmp;
+    size_t slot;
     void *value;
 
     /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    if (map == NULL || map->items == NULL) {
         return NULL;
     }
 
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
-
-    /* check the items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* found it */
-            tmp     = (*item);
-            value   = tmp->value;
-            (*item) = tmp->next;
-            wmem_free(map->data_allocator, tmp);
-            map->count--;
-            return value;
-        }
-        item = &((*item)->next);
+    slot = wmem_map_find_slot(map, key);
+    if (slot == SLOT_NOT_FOUND) {
+        /* didn't find it */
+        return NULL;
     }
 
-    /* didn't find it */
-    return NULL;
+    value = map->items[slot].value;
+    wmem_map_erase_slot(map, slot);
+    return value;
 }
 
 bool
 wmem_map_steal(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t **item, *tmp;
+    size_t slot;
 
     /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    if (map == NULL || map->items == NULL) {
         return false;
     }
 
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
-
-    /* check the items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* found it */
-            tmp     = (*item);
-            (*item) = tmp->next;
-            map->count--;
-            return true;
-        }
-        item = &((*item)->next);
+    slot = wmem_map_find_slot(map, key);
+    if (slot == SLOT_NOT_FOUND) {
+        /* didn't find it */
+        return false;
     }
 
-    /* didn't find it */
-    return false;
+    wmem_map_erase_slot(map, slot);
+    return true;
 }
 
 wmem_list_t*
 wmem_map_get_keys(wmem_allocator_t *list_allocator, wmem_map_t *map)
 {
     size_t capacity, i;
-    wmem_map_item_t *cur;
     wmem_list_t* list = wmem_list_new(list_allocator);
 
-    if (map->table != NULL) {
+    if (map->items != NULL) {
         capacity = CAPACITY(map);
 
         /* copy all the elements into the list over from table */
         for (i=0; i<capacity; i++) {
-            cur = map->table[i];
-            while (cur) {
-                wmem_list_prepend(list, (void*)cur->key);
-                cur = cur->next;
+            if (map->hashes[i] != 0) {
+                wmem_list_prepend(list, (void*)map->items[i].key);
             }
         }
     }
@@ -391,19 +461,16 @@ wmem_map_get_keys(wmem_allocator_t *list_allocator, wmem_map_t *map)
 void
 wmem_map_foreach(wmem_map_t *map, GHFunc foreach_func, void * user_data)
 {
-    wmem_map_item_t *cur;
-    unsigned i;
+    size_t i;
 
     /* Make sure we have a table */
-    if (map == NULL || map->table == NULL) {
+    if (map == NULL || map->items == NULL) {
         return;
     }
 
     for (i = 0; i < CAPACITY(map); i++) {
-        cur = map->table[i];
-        while (cur) {
-            foreach_func((void *)cur->key, (void *)cur->value, user_data);
-            cur = cur->next;
+        if (map->hashes[i] != 0) {
+            foreach_func((void *)map->items[i].key, map->items[i].value, user_data);
         }
     }
 }
@@ -411,26 +478,29 @@ wmem_map_foreach(wmem_map_t *map, GHFunc foreach_func, void * user_data)
 unsigned
 wmem_map_foreach_remove(wmem_map_t *map, GHRFunc foreach_func, void * user_data)
 {
-    wmem_map_item_t **item, *tmp;
-    unsigned i, deleted = 0;
+    size_t   cap, mask, start, n, i;
+    unsigned deleted = 0;
 
     /* Make sure we have a table */
-    if (map == NULL || map->table == NULL) {
+    if (map == NULL || map->items == NULL) {
         return 0;
     }
 
-    for (i = 0; i < CAPACITY(map); i++) {
-        item = &(map->table[i]);
-        while (*item) {
-            if (foreach_func((void *)(*item)->key, (void *)(*item)->value, user_data)) {
-                tmp   = *item;
-                *item = tmp->next;
-                wmem_free(map->data_allocator, tmp);
-                map->count--;
-                deleted++;
-            } else {
-                item = &((*item)->next);
-            }
+    cap  = CAPACITY(map);
+    mask = MASK(map);
+
+    /* Start right after an empty slot (there always is one): removing an
+     * item only moves later items of the same run back, so every item is
+     * still visited exactly once. */
+    for (start = 0; map->hashes[start] != 0; start++)
+        ;
+
+    for (n = 1; n <= cap; n++) {
+        i = (start + n) & mask;
+        while (map->hashes[i] != 0 &&
+                foreach_func((void *)map->items[i].key, map->items[i].value, user_data)) {
+            wmem_map_erase_slot(map, i);
+            deleted++;
         }
     }
     return deleted;
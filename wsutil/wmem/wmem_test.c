@@ -43,6 +43,7 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
     allocator->type = type;
     allocator->callbacks = NULL;
     allocator->in_scope = true;
+    allocator->allocated_bytes = 0;
 
     switch (type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -194,6 +195,32 @@ wmem_test_allocator_callbacks(void)
     g_assert_true(cb_called_count == 3);
 }
 
+static void
+wmem_test_allocator_allocated_bytes(void)
+{
+    wmem_allocator_t *allocator;
+    void *ptr;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    g_assert_true(wmem_allocated_bytes(allocator) == 0);
+
+    ptr = wmem_alloc(allocator, 100);
+    g_assert_true(wmem_allocated_bytes(allocator) == 100);
+
+    ptr = wmem_realloc(allocator, ptr, 300);
+    g_assert_true(wmem_allocated_bytes(allocator) == 400);
+
+    wmem_free(allocator, ptr);
+    wmem_alloc(allocator, 0);
+    g_assert_true(wmem_allocated_bytes(allocator) == 400);
+
+    wmem_free_all(allocator);
+    wmem_alloc0(allocator, 10);
+    g_assert_true(wmem_allocated_bytes(allocator) == 410);
+
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_allocator_det(wmem_allocator_t *allocator, wmem_verify_func verify,
         unsigned len)
@@ -903,11 +930,18 @@ equal_val_map(void * key _U_, void * val, void * user_data)
     return val == user_data;
 }
 
+static gboolean
+equal_val_map_odd(void * key, void * val _U_, void * user_data _U_)
+{
+    return GPOINTER_TO_UINT(key) & 1;
+}
+
 static void
 wmem_test_map(void)
 {
     wmem_allocator_t   *allocator, *extra_allocator;
     wmem_map_t       *map;
+    GHashTable       *shadow;
     char             *str_key;
     const void       *str_key_ret;
     unsigned int      i;
@@ -1015,10 +1049,130 @@ wmem_test_map(void)
     }
     g_assert_true(wmem_map_size(map) == CONTAINER_ITERS/2);
 
+    /* random inserts and removals, checked against a GHashTable */
+    map = wmem_map_new(allocator, g_direct_hash, g_direct_equal);
+    g_assert_true(map);
+    shadow = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (i=0; i<CONTAINER_ITERS*10; i++) {
+        unsigned int key = g_test_rand_int_range(1, CONTAINER_ITERS);
+
+        if (g_test_rand_bit()) {
+            ret = wmem_map_insert(map, GUINT_TO_POINTER(key), GUINT_TO_POINTER(key));
+            g_assert_true((ret != NULL) == g_hash_table_contains(shadow, GUINT_TO_POINTER(key)));
+            g_hash_table_add(shadow, GUINT_TO_POINTER(key));
+        } else {
+            ret = wmem_map_remove(map, GUINT_TO_POINTER(key));
+            g_assert_true((ret != NULL) == g_hash_table_remove(shadow, GUINT_TO_POINTER(key)));
+        }
+        g_assert_true(wmem_map_size(map) == g_hash_table_size(shadow));
+    }
+    /* removing while iterating must visit every item exactly once */
+    g_assert_true(wmem_map_foreach_remove(map, equal_val_map_odd, NULL) ==
+            g_hash_table_foreach_remove(shadow, equal_val_map_odd, NULL));
+    for (i=1; i<CONTAINER_ITERS; i++) {
+        g_assert_true(wmem_map_contains(map, GUINT_TO_POINTER(i)) ==
+                g_hash_table_contains(shadow, GUINT_TO_POINTER(i)));
+    }
+    g_hash_table_destroy(shadow);
+
     wmem_destroy_allocator(extra_allocator);
     wmem_destroy_allocator(allocator);
 }
 
+static void
+wmem_test_mapperf(void)
+{
+#define MAP_PERF_COUNT (1 * 1000 * 1000)
+    wmem_allocator_t   *allocator;
+    wmem_map_t         *map;
+    GHashTable         *table;
+    unsigned           *keys;
+    unsigned            i;
+    volatile void      *ret = NULL;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    keys = g_new(unsigned, MAP_PERF_COUNT);
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        keys[i] = g_test_rand_int();
+    }
+
+    map = wmem_map_new(allocator, g_direct_hash, g_direct_equal);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        wmem_map_insert(map, GUINT_TO_POINTER(keys[i]), GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_insert: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        ret = wmem_map_lookup(map, GUINT_TO_POINTER(keys[i]));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_lookup (hit): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        ret = wmem_map_lookup(map, GUINT_TO_POINTER(keys[i] ^ 0x80000000));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_lookup (miss): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        wmem_map_remove(map, GUINT_TO_POINTER(keys[i]));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_remove: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    /* GLib's GHashTable, for comparison */
+    table = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        g_hash_table_insert(table, GUINT_TO_POINTER(keys[i]), GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "g_hash_table_insert: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        ret = g_hash_table_lookup(table, GUINT_TO_POINTER(keys[i]));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "g_hash_table_lookup (hit): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        ret = g_hash_table_lookup(table, GUINT_TO_POINTER(keys[i] ^ 0x80000000));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "g_hash_table_lookup (miss): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_COUNT; i++) {
+        g_hash_table_remove(table, GUINT_TO_POINTER(keys[i]));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "g_hash_table_remove: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    (void)ret;
+    g_hash_table_destroy(table);
+    g_free(keys);
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_queue(void)
 {
@@ -1226,6 +1380,28 @@ wmem_test_tree(void)
     g_assert_true(wmem_tree_count(tree) == CONTAINER_ITERS);
     wmem_free_all(allocator);
 
+    /* keys inserted in descending order, with gaps for the predecessor
+     * lookups to fall into */
+    tree = wmem_tree_new(allocator);
+    for (i=CONTAINER_ITERS; i>0; i--) {
+        wmem_tree_insert32(tree, i*4, GINT_TO_POINTER(i));
+    }
+    g_assert_true(wmem_tree_count(tree) == CONTAINER_ITERS);
+    g_assert_true(wmem_tree_lookup32_le(tree, 3) == NULL);
+    for (i=1; i<=CONTAINER_ITERS; i++) {
+        g_assert_true(wmem_tree_contains32(tree, i*4));
+        g_assert_true(!wmem_tree_contains32(tree, i*4+1));
+        g_assert_true(wmem_tree_lookup32(tree, i*4+1) == NULL);
+        g_assert_true(wmem_tree_lookup32_le(tree, i*4) == GINT_TO_POINTER(i));
+        g_assert_true(wmem_tree_lookup32_le(tree, i*4+3) == GINT_TO_POINTER(i));
+    }
+    g_assert_true(wmem_tree_lookup32_le(tree, UINT32_MAX) ==
+            GINT_TO_POINTER(CONTAINER_ITERS));
+    g_assert_true(wmem_tree_remove32(tree, 8) == GINT_TO_POINTER(2));
+    g_assert_true(wmem_tree_lookup32(tree, 8) == NULL);
+    g_assert_true(wmem_tree_lookup32(tree, 12) == GINT_TO_POINTER(3));
+    wmem_free_all(allocator);
+
     /* test auto-reset functionality */
     tree = wmem_tree_new_autoreset(allocator, extra_allocator);
     for (i=0; i<CONTAINER_ITERS; i++) {
@@ -1341,6 +1517,69 @@ wmem_test_tree(void)
 }
 
 
+static void
+wmem_test_treeperf(void)
+{
+#define TREE_PERF_COUNT (1 * 1000 * 1000)
+    wmem_allocator_t   *allocator;
+    wmem_tree_t        *tree;
+    unsigned           *keys;
+    unsigned            i;
+    volatile void      *ret = NULL;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    keys = g_new(unsigned, TREE_PERF_COUNT);
+    for (i = 0; i < TREE_PERF_COUNT; i++) {
+        keys[i] = g_test_rand_int();
+    }
+
+    /* Frame numbers: ascending keys, predecessor lookups */
+    tree = wmem_tree_new(allocator);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_COUNT; i++) {
+        wmem_tree_insert32(tree, i * 2, GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_insert32 (ascending): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_COUNT; i++) {
+        ret = wmem_tree_lookup32_le(tree, keys[i] % (TREE_PERF_COUNT * 2));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32_le: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    wmem_free_all(allocator);
+
+    /* Sequence numbers and the like: random keys */
+    tree = wmem_tree_new(allocator);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_COUNT; i++) {
+        wmem_tree_insert32(tree, keys[i], GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_insert32 (random): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_COUNT; i++) {
+        ret = wmem_tree_lookup32(tree, keys[i]);
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    (void)ret;
+    g_free(keys);
+    wmem_destroy_allocator(allocator);
+}
+
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
     wmem_range_t range;
@@ -1457,6 +1696,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/allocated_bytes", wmem_test_allocator_allocated_bytes);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);
@@ -1468,11 +1708,17 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
     g_test_add_func("/wmem/datastruct/list",   wmem_test_list);
     g_test_add_func("/wmem/datastruct/map",    wmem_test_map);
+    if (g_test_perf()) {
+        g_test_add_func("/wmem/datastruct/mapperf", wmem_test_mapperf);
+    }
     g_test_add_func("/wmem/datastruct/queue",  wmem_test_queue);
     g_test_add_func("/wmem/datastruct/stack",  wmem_test_stack);
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/strbuf/validate", wmem_test_strbuf_validate);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
+    if (g_test_perf()) {
+        g_test_add_func("/wmem/datastruct/treeperf", wmem_test_treeperf);
+    }
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
 
     ret = g_test_run();
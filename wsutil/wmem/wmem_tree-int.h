@@ -45,10 +45,16 @@ typedef struct _wmem_tree_node_t wmem_tree_node_t;
 
 typedef struct _wmem_itree_node_t wmem_itree_node_t;
 
+/* uint32_t keys (and the per-element trees of uint32_t array keys) are kept
+ * in a B+tree rooted at broot rather than in the red/black tree, see
+ * wmem_tree.c. */
+typedef struct _wmem_btree_node_t wmem_btree_node_t;
+
 struct _wmem_tree_t {
     wmem_allocator_t *metadata_allocator;
     wmem_allocator_t *data_allocator;
     wmem_tree_node_t *root;
+    wmem_btree_node_t *broot;
     unsigned          metadata_scope_cb_id;
     unsigned          data_scope_cb_id;
 
@@ -23,6 +23,41 @@
 #include "wmem_tree-int.h"
 #include "wmem_user_cb.h"
 
+/*
+ * uint32_t keys do not go into the red/black tree but into a B+tree rooted
+ * at tree->broot. Frame and sequence number keyed trees are looked up many
+ * times per packet, and with one allocation per key every level of the
+ * red/black tree is a likely cache miss. A B+tree node keeps a sorted run
+ * of up to WMEM_BTREE_ORDER keys next to each other, so a tree with a
+ * million keys is only four or five levels deep.
+ *
+ * Values are only stored in leaves. In an interior node keys[i] is the
+ * smallest key reachable through child i; keys[0] is never compared. Keys
+ * are never deleted (wmem_tree_remove32 stores NULL instead), so the first
+ * key of every leaf equals the separator leading to it and a search can
+ * only end left of a leaf's first key in the leftmost leaf.
+ *
+ * A node is a header followed by three arrays sized by its capacity: the
+ * data pointers (or child pointers), the keys, and for leaves the subtree
+ * flags. A root leaf starts out small and doubles until it reaches
+ * WMEM_BTREE_ORDER, so that the many trees holding only a few keys stay
+ * cheap; every other node is allocated at full size.
+ */
+#define WMEM_BTREE_ORDER    32
+#define WMEM_BTREE_MIN_LEAF 4
+
+struct _wmem_btree_node_t {
+    unsigned  count;
+    unsigned  capacity;
+    bool      is_leaf;
+    void     *slots[];
+};
+
+#define BTREE_KEYS(node)       ((uint32_t *)(void *)((char *)(node)->slots + \
+                                    (node)->capacity * sizeof(void *)))
+#define BTREE_SUBTREE(node)    ((bool *)(BTREE_KEYS(node) + (node)->capacity))
+#define BTREE_CHILD(node, i)   ((wmem_btree_node_t *)(node)->slots[i])
+
 static wmem_tree_node_t *
 node_uncle(wmem_tree_node_t *node)
 {
@@ -211,6 +246,7 @@ wmem_tree_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
     wmem_tree_t *tree = (wmem_tree_t *)user_data;
 
     tree->root = NULL;
+    tree->broot = NULL;
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(tree->metadata_allocator, tree->metadata_scope_cb_id);
@@ -278,10 +314,33 @@ free_tree_node(wmem_allocator_t *allocator, wmem_tree_node_t* node, bool free_ke
     wmem_free(allocator, node);
 }
 
+static void
+free_btree_node(wmem_allocator_t *allocator, wmem_btree_node_t *node, bool free_keys, bool free_values)
+{
+    unsigned i;
+
+    if (node == NULL) {
+        return;
+    }
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            free_btree_node(allocator, BTREE_CHILD(node, i), free_keys, free_values);
+        } else if (BTREE_SUBTREE(node)[i]) {
+            wmem_tree_destroy((wmem_tree_t *)node->slots[i], free_keys, free_values);
+        } else if (free_values) {
+            wmem_free(allocator, node->slots[i]);
+        }
+    }
+
+    wmem_free(allocator, node);
+}
+
 void
 wmem_tree_destroy(wmem_tree_t *tree, bool free_keys, bool free_values)
 {
     free_tree_node(tree->data_allocator, tree->root, free_keys, free_values);
+    free_btree_node(tree->data_allocator, tree->broot, free_keys, free_values);
     if (tree->metadata_allocator) {
         wmem_unregister_callback(tree->metadata_allocator, tree->metadata_scope_cb_id);
     }
@@ -294,7 +353,7 @@ wmem_tree_destroy(wmem_tree_t *tree, bool free_keys, bool free_values)
 bool
 wmem_tree_is_empty(wmem_tree_t *tree)
 {
-    return tree->root == NULL;
+    return tree->root == NULL && tree->broot == NULL;
 }
 
 static bool
@@ -342,75 +401,203 @@ create_node(wmem_allocator_t *allocator, wmem_tree_node_t *parent, const void *k
 
 #define CREATE_DATA(TRANSFORM, DATA) ((TRANSFORM) ? (TRANSFORM)(DATA) : (DATA))
 
+static wmem_btree_node_t *
+btree_node_new(wmem_allocator_t *allocator, bool is_leaf, unsigned capacity)
+{
+    wmem_btree_node_t *node;
+    size_t size;
+
+    size = sizeof(wmem_btree_node_t) +
+        capacity * (sizeof(void *) + sizeof(uint32_t));
+    if (is_leaf) {
+        size += capacity * sizeof(bool);
+    }
+
+    node = (wmem_btree_node_t *)wmem_alloc(allocator, size);
+    node->count    = 0;
+    node->capacity = capacity;
+    node->is_leaf  = is_leaf;
+
+    return node;
+}
+
+/* Returns lo plus the number of keys in keys[lo, hi) that are <= key.
+ * The loop is written so that compilers turn the comparison into a
+ * conditional move; with random keys a branch here is mispredicted half
+ * of the time. */
+static inline unsigned
+btree_upper_bound(const uint32_t *keys, unsigned lo, unsigned hi, uint32_t key)
+{
+    const uint32_t *base = keys + lo;
+    unsigned len = hi - lo;
+
+    if (len == 0) {
+        return lo;
+    }
+
+    while (len > 1) {
+        unsigned half = len / 2;
+        base = (base[half - 1] <= key) ? base + half : base;
+        len -= half;
+    }
+
+    return (unsigned)(base - keys) + (*base <= key);
+}
+
+static inline wmem_btree_node_t *
+btree_child_for(wmem_btree_node_t *node, uint32_t key, unsigned *idx)
+{
+    unsigned i = btree_upper_bound(BTREE_KEYS(node), 1, node->count, key) - 1;
+
+    if (idx) {
+        *idx = i;
+    }
+    return BTREE_CHILD(node, i);
+}
+
+/* Moves the entries [from, count) of src to the (empty) node dst. */
+static void
+btree_move_tail(wmem_btree_node_t *dst, wmem_btree_node_t *src, unsigned from)
+{
+    unsigned n = src->count - from;
+
+    memcpy(dst->slots, &src->slots[from], n * sizeof(void *));
+    memcpy(BTREE_KEYS(dst), &BTREE_KEYS(src)[from], n * sizeof(uint32_t));
+    if (src->is_leaf) {
+        memcpy(BTREE_SUBTREE(dst), &BTREE_SUBTREE(src)[from], n * sizeof(bool));
+    }
+    dst->count = n;
+    src->count = from;
+}
+
+/* Opens a gap at position pos of a node that is not full. */
+static void
+btree_make_room(wmem_btree_node_t *node, unsigned pos)
+{
+    unsigned n = node->count - pos;
+
+    memmove(&node->slots[pos + 1], &node->slots[pos], n * sizeof(void *));
+    memmove(&BTREE_KEYS(node)[pos + 1], &BTREE_KEYS(node)[pos], n * sizeof(uint32_t));
+    if (node->is_leaf) {
+        memmove(&BTREE_SUBTREE(node)[pos + 1], &BTREE_SUBTREE(node)[pos], n * sizeof(bool));
+    }
+    node->count++;
+}
 
-/**
- * return inserted node
+/*
+ * Splits the full child i of parent, which must not be full itself. When
+ * keys are appended in ascending order (the usual case for frame numbers)
+ * a half/half split would leave every node half empty, so in that case only
+ * the last entry is moved to the new node.
  */
-static wmem_tree_node_t *
-lookup_or_insert32_node(wmem_tree_t *tree, uint32_t key,
+static void
+btree_split_child(wmem_allocator_t *allocator, wmem_btree_node_t *parent,
+        unsigned i, bool append)
+{
+    wmem_btree_node_t *child = BTREE_CHILD(parent, i);
+    wmem_btree_node_t *right;
+
+    right = btree_node_new(allocator, child->is_leaf, WMEM_BTREE_ORDER);
+    btree_move_tail(right, child, append ? child->count - 1 : child->count / 2);
+
+    btree_make_room(parent, i + 1);
+    parent->slots[i + 1] = right;
+    BTREE_KEYS(parent)[i + 1] = BTREE_KEYS(right)[0];
+}
+
+static wmem_btree_node_t *
+btree_grow_root(wmem_tree_t *tree, uint32_t key)
+{
+    wmem_btree_node_t *old_root = tree->broot;
+    wmem_btree_node_t *root;
+
+    if (old_root->is_leaf && old_root->capacity < WMEM_BTREE_ORDER) {
+        root = btree_node_new(tree->data_allocator, true, old_root->capacity * 2);
+        btree_move_tail(root, old_root, 0);
+        wmem_free(tree->data_allocator, old_root);
+    } else {
+        root = btree_node_new(tree->data_allocator, false, WMEM_BTREE_ORDER);
+        root->slots[0] = old_root;
+        BTREE_KEYS(root)[0] = BTREE_KEYS(old_root)[0];
+        root->count = 1;
+        btree_split_child(tree->data_allocator, root, 0,
+                key > BTREE_KEYS(old_root)[old_root->count - 1]);
+    }
+
+    tree->broot = root;
+    return root;
+}
+
+static void *
+lookup_or_insert32(wmem_tree_t *tree, uint32_t key,
         void*(*func)(void*), void* data, bool is_subtree, bool replace)
 {
-    wmem_tree_node_t *node     = tree->root;
-    wmem_tree_node_t *new_node = NULL;
+    wmem_btree_node_t *node = tree->broot;
+    unsigned pos;
 
     /* is this the first node ?*/
     if (!node) {
-        new_node = create_node(tree->data_allocator, NULL, GUINT_TO_POINTER(key),
-                CREATE_DATA(func, data), WMEM_NODE_COLOR_BLACK, is_subtree);
-        tree->root = new_node;
-        return new_node;
+        node = btree_node_new(tree->data_allocator, true, WMEM_BTREE_MIN_LEAF);
+        tree->broot = node;
+    } else if (node->count == node->capacity) {
+        node = btree_grow_root(tree, key);
     }
 
-    /* it was not the new root so walk the tree until we find where to
-     * insert this new leaf.
+    /* Split full nodes on the way down so that there is always room in
+     * the parent for the new separator and in the leaf for the new key.
      */
-    while (!new_node) {
-        /* this node already exists, so just return the data pointer*/
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            if (replace) {
-                node->data = CREATE_DATA(func, data);
-            }
-            return node;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            if (node->left) {
-                node = node->left;
-            }
-            else {
-                /* new node to the left */
-                new_node = create_node(tree->data_allocator, node, GUINT_TO_POINTER(key),
-                        CREATE_DATA(func, data), WMEM_NODE_COLOR_RED,
-                        is_subtree);
-                node->left = new_node;
+    while (!node->is_leaf) {
+        unsigned i;
+        wmem_btree_node_t *child = btree_child_for(node, key, &i);
+
+        if (child->count == child->capacity) {
+            bool append = i == node->count - 1 &&
+                key > BTREE_KEYS(child)[child->count - 1];
+
+            btree_split_child(tree->data_allocator, node, i, append);
+            if (key >= BTREE_KEYS(node)[i + 1]) {
+                i++;
             }
+            child = BTREE_CHILD(node, i);
         }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            if (node->right) {
-                node = node->right;
-            }
-            else {
-                /* new node to the right */
-                new_node = create_node(tree->data_allocator, node, GUINT_TO_POINTER(key),
-                        CREATE_DATA(func, data), WMEM_NODE_COLOR_RED,
-                        is_subtree);
-                node->right = new_node;
-            }
+        node = child;
+    }
+
+    pos = btree_upper_bound(BTREE_KEYS(node), 0, node->count, key);
+
+    /* this key already exists, so just return the data pointer */
+    if (pos > 0 && BTREE_KEYS(node)[pos - 1] == key) {
+        if (replace) {
+            node->slots[pos - 1] = CREATE_DATA(func, data);
         }
+        return node->slots[pos - 1];
     }
 
-    /* node will now point to the newly created node */
-    rb_insert_case1(tree, new_node);
+    btree_make_room(node, pos);
+    BTREE_KEYS(node)[pos]    = key;
+    BTREE_SUBTREE(node)[pos] = is_subtree;
+    node->slots[pos]         = CREATE_DATA(func, data);
 
-    return new_node;
+    return node->slots[pos];
 }
 
-
-static void *
-lookup_or_insert32(wmem_tree_t *tree, uint32_t key,
-        void*(*func)(void*), void* data, bool is_subtree, bool replace)
+/* Returns the leaf that key belongs to and in *pos the number of keys in
+ * that leaf which are <= key. */
+static wmem_btree_node_t *
+btree_find_leaf(const wmem_tree_t *tree, uint32_t key, unsigned *pos)
 {
-    wmem_tree_node_t *node = lookup_or_insert32_node(tree, key, func, data, is_subtree, replace);
-    return node->data;
+    wmem_btree_node_t *node = tree->broot;
+
+    if (!node) {
+        return NULL;
+    }
+
+    while (!node->is_leaf) {
+        node = btree_child_for(node, key, NULL);
+    }
+
+    *pos = btree_upper_bound(BTREE_KEYS(node), 0, node->count, key);
+    return node;
 }
 
 static void *
@@ -500,46 +687,32 @@ wmem_tree_insert32(wmem_tree_t *tree, uint32_t key, void *data)
 
 bool wmem_tree_contains32(wmem_tree_t *tree, uint32_t key)
 {
+    wmem_btree_node_t *leaf;
+    unsigned pos;
+
     if (!tree) {
         return false;
     }
 
-    wmem_tree_node_t *node = tree->root;
-
-    while (node) {
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            return true;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            node = node->left;
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            node = node->right;
-        }
-    }
+    leaf = btree_find_leaf(tree, key, &pos);
 
-    return false;
+    return leaf && pos > 0 && BTREE_KEYS(leaf)[pos - 1] == key;
 }
 
 void *
 wmem_tree_lookup32(wmem_tree_t *tree, uint32_t key)
 {
+    wmem_btree_node_t *leaf;
+    unsigned pos;
+
     if (!tree) {
         return NULL;
     }
 
-    wmem_tree_node_t *node = tree->root;
+    leaf = btree_find_leaf(tree, key, &pos);
 
-    while (node) {
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            return node->data;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            node = node->left;
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            node = node->right;
-        }
+    if (leaf && pos > 0 && BTREE_KEYS(leaf)[pos - 1] == key) {
+        return leaf->slots[pos - 1];
     }
 
     return NULL;
@@ -548,67 +721,24 @@ wmem_tree_lookup32(wmem_tree_t *tree, uint32_t key)
 void *
 wmem_tree_lookup32_le(wmem_tree_t *tree, uint32_t key)
 {
+    wmem_btree_node_t *leaf;
+    unsigned pos;
+
     if (!tree) {
         return NULL;
     }
 
-    wmem_tree_node_t *node = tree->root;
-
-    while (node) {
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            return node->data;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            if (node->left == NULL) {
-                break;
-            }
-            node = node->left;
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            if (node->right == NULL) {
-                break;
-            }
-            node = node->right;
-        }
-    }
+    leaf = btree_find_leaf(tree, key, &pos);
 
-    if (!node) {
-        return NULL;
-    }
-
-    /* If we are still at the root of the tree this means that this node
-     * is either smaller than the search key and then we return this
-     * node or else there is no smaller key available and then
-     * we return NULL.
+    /* As keys are never deleted, the only leaf whose keys can all be bigger
+     * than the search key is the leftmost one, in which case there is no
+     * smaller key in the tree.
      */
-    if (node->parent == NULL) {
-        if (key > GPOINTER_TO_UINT(node->key)) {
-            return node->data;
-        } else {
-            return NULL;
-        }
-    }
-
-    if (GPOINTER_TO_UINT(node->key) <= key) {
-        /* if our key is <= the search key, we have the right node */
-        return node->data;
-    }
-    else if (node == node->parent->left) {
-        /* our key is bigger than the search key and we're a left child,
-         * we have to check if any of our ancestors are smaller. */
-        while (node) {
-            if (key > GPOINTER_TO_UINT(node->key)) {
-                return node->data;
-            }
-            node=node->parent;
-        }
+    if (!leaf || pos == 0) {
         return NULL;
     }
-    else {
-        /* our key is bigger than the search key and we're a right child,
-         * our parent is the one we want */
-        return node->parent->data;
-    }
+
+    return leaf->slots[pos - 1];
 }
 
 void *
@@ -779,14 +909,47 @@ wmem_tree_foreach_nodes(wmem_tree_node_t* node, wmem_foreach_func callback,
     return false;
 }
 
+static bool
+wmem_btree_foreach_nodes(wmem_btree_node_t* node, wmem_foreach_func callback,
+        void *user_data)
+{
+    unsigned i;
+    bool stop_traverse;
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            stop_traverse = wmem_btree_foreach_nodes(BTREE_CHILD(node, i),
+                    callback, user_data);
+        } else if (BTREE_SUBTREE(node)[i]) {
+            stop_traverse = wmem_tree_foreach((wmem_tree_t *)node->slots[i],
+                    callback, user_data);
+        } else {
+            stop_traverse = callback(GUINT_TO_POINTER(BTREE_KEYS(node)[i]),
+                    node->slots[i], user_data);
+        }
+
+        if (stop_traverse) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool
 wmem_tree_foreach(wmem_tree_t* tree, wmem_foreach_func callback,
         void *user_data)
 {
-    if(!tree->root)
-        return false;
+    if (tree->root &&
+            wmem_tree_foreach_nodes(tree->root, callback, user_data)) {
+        return true;
+    }
+
+    if (tree->broot) {
+        return wmem_btree_foreach_nodes(tree->broot, callback, user_data);
+    }
 
-    return wmem_tree_foreach_nodes(tree->root, callback, user_data);
+    return false;
 }
 
 static void wmem_print_subtree(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_printer, wmem_printer_func data_printer);
@@ -835,6 +998,42 @@ wmem_tree_print_nodes(const char *prefix, wmem_tree_node_t *node, uint32_t level
 }
 
 
+static void
+wmem_btree_print_nodes(const char *prefix, wmem_btree_node_t *node, uint32_t level,
+    wmem_printer_func key_printer, wmem_printer_func data_printer)
+{
+    unsigned i;
+
+    wmem_print_indent(level);
+
+    printf("%sBNODE:%p %s count:%u capacity:%u\n",
+            prefix, (void *)node, node->is_leaf?"leaf":"interior",
+            node->count, node->capacity);
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            wmem_btree_print_nodes("C-", BTREE_CHILD(node, i), level+1, key_printer, data_printer);
+            continue;
+        }
+
+        wmem_print_indent(level+1);
+        printf("key:%u %s:%p\n", BTREE_KEYS(node)[i],
+                BTREE_SUBTREE(node)[i]?"tree":"data", node->slots[i]);
+        if (key_printer) {
+            wmem_print_indent(level+1);
+            key_printer(GUINT_TO_POINTER(BTREE_KEYS(node)[i]));
+            printf("\n");
+        }
+        if (BTREE_SUBTREE(node)[i]) {
+            wmem_print_subtree((wmem_tree_t *)node->slots[i], level+2, key_printer, data_printer);
+        } else if (data_printer) {
+            wmem_print_indent(level+1);
+            data_printer(node->slots[i]);
+            printf("\n");
+        }
+    }
+}
+
 static void
 wmem_print_subtree(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_printer, wmem_printer_func data_printer)
 {
@@ -843,10 +1042,14 @@ wmem_print_subtree(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_prin
 
     wmem_print_indent(level);
 
-    printf("WMEM tree:%p root:%p\n", (void *)tree, (void *)tree->root);
+    printf("WMEM tree:%p root:%p broot:%p\n", (void *)tree, (void *)tree->root,
+            (void *)tree->broot);
     if (tree->root) {
         wmem_tree_print_nodes("Root-", tree->root, level, key_printer, data_printer);
     }
+    if (tree->broot) {
+        wmem_btree_print_nodes("Root-", tree->broot, level, key_printer, data_printer);
+    }
 }
 
 void
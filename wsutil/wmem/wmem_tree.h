@@ -30,6 +30,11 @@ extern "C" {
  *    time for lookups, compared to linked lists that are O(n). This means
  *    red/black trees scale very well when many objects are being stored.
  *
+ *    Nodes with uint32_t keys (including the individual elements of
+ *    wmem_tree_key_t array keys) are kept in a B+tree instead, which packs
+ *    many keys into each node and so needs far fewer cache misses per lookup
+ *    than one allocation per key. The API is the same either way.
+ *
  *    @{
  */
 
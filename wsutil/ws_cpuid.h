@@ -47,13 +47,15 @@
  * on Windows anyway, so the answer is probably "no".
  */
 #if defined(_M_IX86) || defined(_M_X64)
+#include <immintrin.h>
+
 static bool
 ws_cpuid(uint32_t *CPUInfo, uint32_t selector)
 {
 	/* https://docs.microsoft.com/en-us/cpp/intrinsics/cpuid-cpuidex */
 
 	CPUInfo[0] = CPUInfo[1] = CPUInfo[2] = CPUInfo[3] = 0;
-	__cpuid((int *) CPUInfo, selector);
+	__cpuidex((int *) CPUInfo, selector, 0);
 	/* XXX, how to check if it's supported on MSVC? just in case clear all flags above */
 	return true;
 }
@@ -128,7 +130,7 @@ ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
 }
 #endif
 
-static int
+static inline int
 ws_cpuid_sse42(void)
 {
 	uint32_t CPUInfo[4];
@@ -139,3 +141,45 @@ ws_cpuid_sse42(void)
 	/* in ECX bit 20 toggled on */
 	return (CPUInfo[2] & (1 << 20));
 }
+
+/*
+ * AVX2 needs both the CPU support (CPUID leaf 7, EBX bit 5) and the OS
+ * saving the YMM registers on context switches (OSXSAVE set and XCR0
+ * bits 1 and 2 set).
+ */
+static inline int
+ws_cpuid_avx2(void)
+{
+	uint32_t CPUInfo[4];
+	uint64_t xcr0;
+
+	if (!ws_cpuid(CPUInfo, 0) || CPUInfo[0] < 7)
+		return 0;
+
+	if (!ws_cpuid(CPUInfo, 1))
+		return 0;
+
+	/* OSXSAVE (ECX bit 27) and AVX (ECX bit 28) */
+	if ((CPUInfo[2] & (3U << 27)) != (3U << 27))
+		return 0;
+
+#if defined(_MSC_VER)
+	xcr0 = _xgetbv(0);
+#elif defined(__GNUC__) && defined(__x86_64__)
+	{
+		uint32_t eax, edx;
+
+		__asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+		xcr0 = ((uint64_t) edx << 32) | eax;
+	}
+#else
+	xcr0 = 0;
+#endif
+	if ((xcr0 & 0x6) != 0x6)
+		return 0;
+
+	if (!ws_cpuid(CPUInfo, 7))
+		return 0;
+
+	return (CPUInfo[1] & (1 << 5));
+}
@@ -27,16 +27,46 @@
 
 #include <string.h>
 
+#include <wsutil/bits_ctz.h>
+
+/* NEON is part of the baseline on 64-bit Arm, so no runtime check is needed */
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define WS_MEMPBRK_NEON
+#endif
+
 void
 ws_mempbrk_compile(ws_mempbrk_pattern* pattern, const char *needles)
 {
     const char *n = needles;
     memset(pattern->patt, 0, 256);
     while (*n) {
-        pattern->patt[(int)*n] = 1;
+        pattern->patt[(uint8_t)*n] = 1;
         n++;
     }
 
+    /*
+     * Collect the distinct needles for the vector search; unused slots
+     * repeat the first needle so the search can always compare against
+     * all of them.
+     */
+    pattern->num_needles = 0;
+    for (unsigned c = 1; c < 256; c++) {
+        if (!pattern->patt[(uint8_t) c])
+            continue;
+        if (pattern->num_needles == WS_MEMPBRK_MAX_VECTOR_NEEDLES) {
+            pattern->num_needles = 0;
+            break;
+        }
+        pattern->needles[pattern->num_needles++] = (uint8_t) c;
+    }
+    for (unsigned i = pattern->num_needles; i < WS_MEMPBRK_MAX_VECTOR_NEEDLES; i++)
+        pattern->needles[i] = pattern->needles[0];
+
+#ifdef HAVE_AVX2
+    ws_mempbrk_avx2_compile(pattern);
+#endif
+
 #ifdef HAVE_SSE4_2
     ws_mempbrk_sse42_compile(pattern, needles);
 #endif
@@ -60,15 +90,54 @@ ws_mempbrk_portable_exec(const uint8_t* haystack, size_t haystacklen, const ws_m
     return NULL;
 }
 
+#ifdef WS_MEMPBRK_NEON
+static const uint8_t *
+ws_mempbrk_neon_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
+{
+    const uint8_t *haystack_end = haystack + haystacklen;
+    const uint8x16_t n0 = vdupq_n_u8(pattern->needles[0]);
+    const uint8x16_t n1 = vdupq_n_u8(pattern->needles[1]);
+    const uint8x16_t n2 = vdupq_n_u8(pattern->needles[2]);
+    const uint8x16_t n3 = vdupq_n_u8(pattern->needles[3]);
+
+    while (haystack_end - haystack >= 16) {
+        uint8x16_t data = vld1q_u8(haystack);
+        uint8x16_t match = vorrq_u8(vorrq_u8(vceqq_u8(data, n0), vceqq_u8(data, n1)),
+                                    vorrq_u8(vceqq_u8(data, n2), vceqq_u8(data, n3)));
+        /* NEON has no movemask; shrink every byte of the match mask to a nibble */
+        uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+
+        if (bits) {
+            haystack += ws_ctz(bits) / 4;
+            if (found_needle)
+                *found_needle = *haystack;
+            return haystack;
+        }
+        haystack += 16;
+    }
+
+    return ws_mempbrk_portable_exec(haystack, haystack_end - haystack, pattern, found_needle);
+}
+#endif
 
 WS_DLL_PUBLIC const uint8_t *
 ws_mempbrk_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
 {
+#ifdef HAVE_AVX2
+    if (haystacklen >= 32 && pattern->use_avx2)
+        return ws_mempbrk_avx2_exec(haystack, haystacklen, pattern, found_needle);
+#endif
+
 #ifdef HAVE_SSE4_2
     if (haystacklen >= 16 && pattern->use_sse42)
         return ws_mempbrk_sse42_exec(haystack, haystacklen, pattern, found_needle);
 #endif
 
+#ifdef WS_MEMPBRK_NEON
+    if (haystacklen >= 16 && pattern->num_needles)
+        return ws_mempbrk_neon_exec(haystack, haystacklen, pattern, found_needle);
+#endif
+
     return ws_mempbrk_portable_exec(haystack, haystacklen, pattern, found_needle);
 }
 
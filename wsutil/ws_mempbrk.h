@@ -18,8 +18,20 @@
 
 /** The pattern object used for ws_mempbrk_exec().
  */
+/*
+ * Patterns with at most this many distinct needles (e.g. CR/LF, or
+ * CR/LF/double quote) are also searched by comparing each needle against
+ * a whole vector of haystack bytes (AVX2 on x86, NEON on Arm).
+ */
+#define WS_MEMPBRK_MAX_VECTOR_NEEDLES 4
+
 typedef struct {
     char patt[256];
+    unsigned num_needles;  /* 0 if there are too many for the vector search */
+    uint8_t needles[WS_MEMPBRK_MAX_VECTOR_NEEDLES];
+#ifdef HAVE_AVX2
+    bool use_avx2;
+#endif
 #ifdef HAVE_SSE4_2
     bool use_sse42;
     __m128i mask;
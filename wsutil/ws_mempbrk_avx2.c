@@ -0,0 +1,75 @@
+/* ws_mempbrk_avx2.c
+ * Search a buffer for a small set of bytes with AVX2 intrinsics
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_AVX2
+
+#include <glib.h>
+#include "ws_cpuid.h"
+
+#include <immintrin.h>
+#include "ws_mempbrk.h"
+#include "ws_mempbrk_int.h"
+
+#include <wsutil/bits_ctz.h>
+
+void
+ws_mempbrk_avx2_compile(ws_mempbrk_pattern* pattern)
+{
+    pattern->use_avx2 = pattern->num_needles != 0 && ws_cpuid_avx2();
+}
+
+/*
+ * Compare 32 bytes at a time against every needle and OR the results;
+ * the first set bit of the byte mask is the first match.
+ */
+const uint8_t *
+ws_mempbrk_avx2_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
+{
+    const uint8_t *haystack_end = haystack + haystacklen;
+    const __m256i n0 = _mm256_set1_epi8((char) pattern->needles[0]);
+    const __m256i n1 = _mm256_set1_epi8((char) pattern->needles[1]);
+    const __m256i n2 = _mm256_set1_epi8((char) pattern->needles[2]);
+    const __m256i n3 = _mm256_set1_epi8((char) pattern->needles[3]);
+
+    while (haystack_end - haystack >= 32) {
+        __m256i data = _mm256_loadu_si256((const __m256i *) (const void *) haystack);
+        __m256i match = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(data, n0), _mm256_cmpeq_epi8(data, n1)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(data, n2), _mm256_cmpeq_epi8(data, n3)));
+        uint32_t bits = (uint32_t) _mm256_movemask_epi8(match);
+
+        if (bits) {
+            haystack += ws_ctz(bits);
+            if (found_needle)
+                *found_needle = *haystack;
+            return haystack;
+        }
+        haystack += 32;
+    }
+
+    return ws_mempbrk_portable_exec(haystack, haystack_end - haystack, pattern, found_needle);
+}
+
+#endif /* HAVE_AVX2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
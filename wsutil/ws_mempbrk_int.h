@@ -17,4 +17,9 @@ void ws_mempbrk_sse42_compile(ws_mempbrk_pattern* pattern, const char *needles);
 const char *ws_mempbrk_sse42_exec(const char* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle);
 #endif
 
+#ifdef HAVE_AVX2
+void ws_mempbrk_avx2_compile(ws_mempbrk_pattern* pattern);
+const uint8_t *ws_mempbrk_avx2_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle);
+#endif
+
 #endif /* __WS_MEMPBRK_INT_H__ */